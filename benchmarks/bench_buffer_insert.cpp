@@ -0,0 +1,132 @@
+// Compares the two ways of loading TransformedLogRecord batches into a
+// partition buffer table:
+//   sql      - IcebergUtils::buildInsertSQL + Connection::Query
+//   appender - IcebergUtils::appendRecords (DuckDB Appender / DataChunk)
+//   batch    - IcebergUtils::appendBatch (columnar LogRecordBatch input)
+//
+// Usage: bench_buffer_insert [records_per_batch] [batches]
+
+#include "../src/appender/iceberg_utils.hpp"
+#include "duckdb.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using duckdb::DuckDB;
+using duckdb::Connection;
+
+static std::vector<TransformedLogRecord> makeBatch(size_t count, int64_t base_offset) {
+    std::vector<TransformedLogRecord> records;
+    records.reserve(count);
+    auto now = std::chrono::system_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        TransformedLogRecord record;
+        record.kafka_topic = "otel-logs";
+        record.kafka_partition = 0;
+        record.kafka_offset = base_offset + static_cast<int64_t>(i);
+        record.timestamp = now;
+        record.severity = "INFO";
+        record.body = "GET /api/v1/orders/" + std::to_string(i) +
+                      " completed in 12ms with status 200 for user 'demo'";
+        record.trace_id = "0102030405060708090a0b0c0d0e0f10";
+        record.span_id = "0102030405060708";
+        record.service_name = "checkout-service";
+        record.deployment_environment = "production";
+        record.host_name = "checkout-7f9c8d-abcde";
+        record.attributes = {
+            {"http.method", "GET"},
+            {"http.route", "/api/v1/orders/{id}"},
+            {"http.status_code", "200"},
+            {"k8s.namespace.name", "shop"},
+            {"k8s.pod.name", "checkout-7f9c8d-abcde"},
+        };
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+static double runBenchmark(const std::string& name,
+                           const std::vector<std::vector<TransformedLogRecord>>& batches,
+                           const std::function<bool(Connection&, const std::string&,
+                                                    const std::vector<TransformedLogRecord>&)>& insert) {
+    DuckDB db(nullptr);
+    Connection conn(db);
+    if (!IcebergUtils::createBufferTable(conn, name)) {
+        std::cerr << "Failed to create buffer table for " << name << std::endl;
+        return 0.0;
+    }
+    std::string table = "local_buffer_" + name;
+
+    size_t total_records = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& batch : batches) {
+        if (!insert(conn, table, batch)) {
+            std::cerr << name << ": insert failed" << std::endl;
+            return 0.0;
+        }
+        total_records += batch.size();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    double records_per_sec = total_records / elapsed.count();
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(10) << total_records << " records  "
+              << std::fixed << std::setprecision(3) << std::setw(8) << elapsed.count() << " s  "
+              << std::setprecision(0) << std::setw(12) << records_per_sec << " records/s" << std::endl;
+    return records_per_sec;
+}
+
+int main(int argc, char** argv) {
+    size_t batch_size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    size_t num_batches = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+
+    std::vector<std::vector<TransformedLogRecord>> batches;
+    batches.reserve(num_batches);
+    for (size_t b = 0; b < num_batches; ++b) {
+        batches.push_back(makeBatch(batch_size, static_cast<int64_t>(b * batch_size)));
+    }
+
+    std::cout << "Buffer insert benchmark: " << num_batches << " batches x "
+              << batch_size << " records" << std::endl;
+
+    double sql_rate = runBenchmark("sql", batches,
+        [](Connection& conn, const std::string& table, const std::vector<TransformedLogRecord>& records) {
+            auto result = conn.Query(IcebergUtils::buildInsertSQL(records, table));
+            return !result->HasError();
+        });
+
+    double appender_rate = runBenchmark("appender", batches,
+        [](Connection& conn, const std::string& table, const std::vector<TransformedLogRecord>& records) {
+            return IcebergUtils::appendRecords(conn, table, records);
+        });
+
+    std::vector<LogRecordBatch> columnar;
+    columnar.reserve(batches.size());
+    for (const auto& batch : batches) {
+        LogRecordBatch converted;
+        for (const auto& record : batch) {
+            converted.append(record);
+        }
+        columnar.push_back(std::move(converted));
+    }
+    size_t next_batch = 0;
+    double batch_rate = runBenchmark("batch", batches,
+        [&columnar, &next_batch](Connection& conn, const std::string& table,
+                                 const std::vector<TransformedLogRecord>&) {
+            return IcebergUtils::appendBatch(conn, table, columnar[next_batch++]);
+        });
+
+    if (sql_rate > 0.0 && appender_rate > 0.0) {
+        std::cout << "Speedup (appender vs sql): " << std::setprecision(2)
+                  << appender_rate / sql_rate << "x" << std::endl;
+    }
+    if (sql_rate > 0.0 && batch_rate > 0.0) {
+        std::cout << "Speedup (batch vs sql): " << std::setprecision(2)
+                  << batch_rate / sql_rate << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Compares gzip request-body decompression strategies:
+//   legacy     - fresh inflate state, 4 KB stack buffer appended to the output
+//   zlib       - GzipDecompressor with the zlib backend
+//   libdeflate - GzipDecompressor with the libdeflate backend (USE_LIBDEFLATE builds)
+//
+// Usage: bench_gzip_decompress [iterations] [payload.gz ...]
+// Without payload files a synthetic OTLP/JSON-like payload of [kb] KB is used:
+//        bench_gzip_decompress [iterations] --kb N
+
+#include "../src/gzip_decompressor.hpp"
+#include <zlib.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The decompressor http_server.cpp used before GzipDecompressor
+static bool legacyDecompress(const std::string& in, std::string& out) {
+    out.clear();
+    if (in.empty()) return true;
+    z_stream strm{};
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    strm.avail_in = static_cast<uInt>(in.size());
+    if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    char buf[4096];
+    int ret;
+    do {
+        strm.next_out = reinterpret_cast<Bytef*>(buf);
+        strm.avail_out = sizeof(buf);
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            inflateEnd(&strm);
+            return false;
+        }
+        out.append(buf, sizeof(buf) - strm.avail_out);
+    } while (ret != Z_STREAM_END);
+    inflateEnd(&strm);
+    return true;
+}
+
+static std::string compressGzip(const std::string& in) {
+    z_stream strm{};
+    deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&strm, in.size()), '\0');
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    strm.avail_in = static_cast<uInt>(in.size());
+    strm.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    strm.avail_out = static_cast<uInt>(out.size());
+    deflate(&strm, Z_FINISH);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+    return out;
+}
+
+static std::string makePayload(size_t kb) {
+    std::ostringstream json;
+    json << R"({"resourceLogs":[{"scopeLogs":[{"logRecords":[)";
+    for (size_t i = 0; json.tellp() < static_cast<std::streamoff>(kb * 1024); ++i) {
+        if (i > 0) json << ',';
+        json << R"({"timeUnixNano":")" << 1672531200000000000ULL + i * 7919 << R"(",)"
+             << R"("severityNumber":9,"body":{"stringValue":"GET /api/v1/orders/)" << i * 31
+             << R"( completed in )" << i % 97 << R"(ms"},"traceId":")" << std::hex << i * 2654435761u
+             << std::dec << R"("})";
+    }
+    json << "]}]}]}";
+    return json.str();
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    out = contents.str();
+    return true;
+}
+
+static double runBenchmark(const std::string& name,
+                           const std::vector<std::string>& payloads,
+                           size_t iterations,
+                           const std::function<bool(const std::string&, std::string&)>& decompress) {
+    size_t total_bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        for (const auto& payload : payloads) {
+            // Each request gets a fresh output string, as in the HTTP handler
+            std::string body;
+            if (!decompress(payload, body)) {
+                std::cerr << name << ": decompression failed" << std::endl;
+                return 0.0;
+            }
+            total_bytes += body.size();
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    double mb_per_sec = total_bytes / elapsed.count() / (1024 * 1024);
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::fixed << std::setprecision(3) << std::setw(8) << elapsed.count() << " s  "
+              << std::setprecision(1) << std::setw(10) << mb_per_sec << " MB/s (decompressed)" << std::endl;
+    return mb_per_sec;
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+    size_t synthetic_kb = 1024;
+
+    std::vector<std::string> payloads;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--kb" && i + 1 < argc) {
+            synthetic_kb = std::strtoul(argv[++i], nullptr, 10);
+            continue;
+        }
+        std::string payload;
+        if (!readFile(arg, payload)) {
+            std::cerr << "Failed to read " << arg << std::endl;
+            return 1;
+        }
+        payloads.push_back(std::move(payload));
+    }
+    if (payloads.empty()) {
+        payloads.push_back(compressGzip(makePayload(synthetic_kb)));
+    }
+
+    size_t payload_bytes = 0;
+    for (const auto& payload : payloads) {
+        payload_bytes += payload.size();
+    }
+    std::cout << "Gzip decompress benchmark: " << payloads.size() << " payload(s), "
+              << payload_bytes << " compressed bytes, " << iterations << " iterations" << std::endl;
+
+    const size_t max_size = SIZE_MAX;
+    double legacy_rate = runBenchmark("legacy", payloads, iterations, legacyDecompress);
+
+    double zlib_rate = runBenchmark("zlib", payloads, iterations,
+        [max_size](const std::string& in, std::string& out) {
+            return GzipDecompressor::decompress(in, out, max_size, GzipDecompressor::Backend::ZLIB) ==
+                   GzipResult::SUCCESS;
+        });
+
+    double libdeflate_rate = 0.0;
+    if (GzipDecompressor::isAvailable(GzipDecompressor::Backend::LIBDEFLATE)) {
+        libdeflate_rate = runBenchmark("libdeflate", payloads, iterations,
+            [max_size](const std::string& in, std::string& out) {
+                return GzipDecompressor::decompress(in, out, max_size, GzipDecompressor::Backend::LIBDEFLATE) ==
+                       GzipResult::SUCCESS;
+            });
+    } else {
+        std::cout << "libdeflate  (not built; configure with -DUSE_LIBDEFLATE=ON)" << std::endl;
+    }
+
+    if (legacy_rate > 0.0) {
+        std::cout << "Speedup (zlib vs legacy): " << std::setprecision(2) << zlib_rate / legacy_rate << "x" << std::endl;
+        if (libdeflate_rate > 0.0) {
+            std::cout << "Speedup (libdeflate vs legacy): " << libdeflate_rate / legacy_rate << "x" << std::endl;
+        }
+    }
+    return 0;
+}
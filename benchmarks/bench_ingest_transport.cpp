@@ -0,0 +1,215 @@
+// Compares request throughput of the two OTLP ingest paths on loopback:
+//   http - HttpServer on Crow, POST /v1/logs over keep-alive HTTP/1.1
+//   grpc - GrpcServer, LogsService/Export unary calls over HTTP/2
+//
+// Both servers run without a queue producer, so this measures the transport
+// and request handling cost per request, not Kafka.
+//
+// Usage: bench_ingest_transport [requests per client] [clients] [payload kb]
+
+#include "../src/ingester/http_server.hpp"
+#include "../src/ingester/grpc_server.hpp"
+#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
+#include "crow.h"
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
+
+static constexpr int kHttpPort = 24318;
+
+// Swallows the per-request logging of the no-producer fallback
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+static std::string makePayload(size_t kb) {
+    ExportLogsServiceRequest request;
+    auto* scope_logs = request.add_resource_logs()->add_scope_logs();
+    for (size_t i = 0; request.ByteSizeLong() < kb * 1024; ++i) {
+        auto* record = scope_logs->add_log_records();
+        record->set_time_unix_nano(1672531200000000000ULL + i * 7919);
+        record->set_severity_number(opentelemetry::proto::logs::v1::SEVERITY_NUMBER_INFO);
+        record->mutable_body()->set_string_value("GET /api/v1/orders/" + std::to_string(i * 31) +
+                                                 " completed in " + std::to_string(i % 97) + "ms");
+    }
+    return request.SerializeAsString();
+}
+
+// One keep-alive HTTP/1.1 connection posting to /v1/logs
+static bool httpClient(const std::string& payload, size_t requests) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kHttpPort);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    std::string request = "POST /v1/logs HTTP/1.1\r\nHost: localhost\r\n"
+                          "Content-Type: application/x-protobuf\r\n"
+                          "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+    std::string response;
+    char buf[16384];
+    bool ok = true;
+    for (size_t i = 0; i < requests && ok; ++i) {
+        for (size_t sent = 0; sent < request.size();) {
+            ssize_t n = send(fd, request.data() + sent, request.size() - sent, 0);
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+
+        // Read one response: headers, then Content-Length bytes of body
+        size_t body_end = std::string::npos;
+        while (ok && (body_end == std::string::npos || response.size() < body_end)) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            response.append(buf, static_cast<size_t>(n));
+            size_t header_end = response.find("\r\n\r\n");
+            if (body_end == std::string::npos && header_end != std::string::npos) {
+                size_t length_pos = response.find("Content-Length: ");
+                size_t length = length_pos < header_end ? std::strtoul(response.c_str() + length_pos + 16, nullptr, 10) : 0;
+                body_end = header_end + 4 + length;
+            }
+        }
+        ok = ok && response.compare(0, 12, "HTTP/1.1 200") == 0;
+        if (ok) {
+            response.erase(0, body_end);
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+// One gRPC channel (its own HTTP/2 connection) making unary Export calls
+static bool grpcClient(int port, const std::string& payload, size_t requests) {
+    grpc::ChannelArguments args;
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    auto channel = grpc::CreateCustomChannel("127.0.0.1:" + std::to_string(port),
+                                             grpc::InsecureChannelCredentials(), args);
+    grpc::GenericStub stub(channel);
+
+    grpc::Slice slice(payload);
+    grpc::ByteBuffer request(&slice, 1);
+    for (size_t i = 0; i < requests; ++i) {
+        grpc::ClientContext context;
+        grpc::ByteBuffer reply;
+        std::promise<grpc::Status> done;
+        stub.UnaryCall(&context, GrpcServer::kExportMethod, grpc::StubOptions(), &request, &reply,
+                       [&done](grpc::Status status) { done.set_value(status); });
+        if (!done.get_future().get().ok()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double runBenchmark(std::ostream& out, const std::string& name,
+                           size_t clients, size_t requests, size_t payload_size,
+                           const std::function<bool(size_t)>& client) {
+    std::atomic<bool> ok{true};
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&ok, &client, requests] {
+            if (!client(requests)) {
+                ok.store(false);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    if (!ok.load()) {
+        out << name << ": requests failed" << std::endl;
+        return 0.0;
+    }
+    double total = static_cast<double>(clients * requests);
+    double requests_per_sec = total / elapsed.count();
+    out << std::left << std::setw(6) << name
+        << std::right << std::fixed << std::setprecision(3) << std::setw(8) << elapsed.count() << " s  "
+        << std::setprecision(0) << std::setw(10) << requests_per_sec << " req/s  "
+        << std::setprecision(1) << std::setw(8) << total * payload_size / elapsed.count() / (1024 * 1024)
+        << " MB/s" << std::endl;
+    return requests_per_sec;
+}
+
+int main(int argc, char** argv) {
+    size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t clients = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    size_t payload_kb = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+
+    std::string payload = makePayload(payload_kb);
+    std::cout << "Ingest transport benchmark: " << clients << " client(s) x " << requests
+              << " requests, " << payload.size() << " byte payload" << std::endl;
+
+    // Results go to the real stdout while std::cout is silenced
+    std::ostream out(std::cout.rdbuf());
+    NullBuffer null_buffer;
+    std::streambuf* stdout_buffer = std::cout.rdbuf(&null_buffer);
+
+    HttpServer http_server;
+    crow::SimpleApp app;
+    app.loglevel(crow::LogLevel::Warning);
+    http_server.setupRoutes(app);
+    app.bindaddr("127.0.0.1").port(kHttpPort).concurrency(std::thread::hardware_concurrency());
+    auto http_done = app.run_async();
+    app.wait_for_server_start();
+
+    IngesterConfig config;
+    GrpcServer grpc_server(nullptr, config);
+    if (!grpc_server.start("127.0.0.1", 0)) {
+        std::cout.rdbuf(stdout_buffer);
+        app.stop();
+        return 1;
+    }
+    int grpc_port = grpc_server.port();
+
+    double http_rate = runBenchmark(out, "http", clients, requests, payload.size(),
+        [&payload](size_t n) { return httpClient(payload, n); });
+    double grpc_rate = runBenchmark(out, "grpc", clients, requests, payload.size(),
+        [&payload, grpc_port](size_t n) { return grpcClient(grpc_port, payload, n); });
+
+    grpc_server.shutdown();
+    app.stop();
+    http_done.wait();
+    std::cout.rdbuf(stdout_buffer);
+
+    if (http_rate > 0.0 && grpc_rate > 0.0) {
+        std::cout << "Speedup (grpc vs http): " << std::setprecision(2) << grpc_rate / http_rate << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Compares the two ways of turning an OTLP/JSON logs payload into a LogRecordBatch:
+//   protobuf - JsonStringToMessage + LogTransformer::transformToBatch
+//   native   - OtlpJsonDecoder::decode
+//
+// Usage: bench_json_decode [iterations] [payload.json ...]
+// Without payload files a synthetic request with [records] records is used:
+//        bench_json_decode [iterations] --records N
+
+#include "../src/appender/otlp_json_decoder.hpp"
+#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
+#include <google/protobuf/util/json_util.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
+
+// OTLP/JSON as SDK exporters send it: hex ids, string-encoded int64
+static std::string makePayload(size_t records) {
+    std::ostringstream json;
+    json << R"({"resourceLogs":[{"resource":{"attributes":[)"
+         << R"({"key":"service.name","value":{"stringValue":"checkout-service"}},)"
+         << R"({"key":"deployment.environment","value":{"stringValue":"production"}},)"
+         << R"({"key":"host.name","value":{"stringValue":"checkout-7f9c8d-abcde"}},)"
+         << R"({"key":"k8s.namespace.name","value":{"stringValue":"shop"}}]},)"
+         << R"("scopeLogs":[{"scope":{"name":"io.opentelemetry.example"},"logRecords":[)";
+    for (size_t i = 0; i < records; ++i) {
+        if (i > 0) json << ',';
+        json << R"({"timeUnixNano":")" << 1672531200000000000ULL + i << R"(",)"
+             << R"("severityNumber":9,"severityText":"INFO",)"
+             << R"("body":{"stringValue":"GET /api/v1/orders/)" << i
+             << R"( completed in 12ms with status 200 for user \"demo\""},)"
+             << R"("traceId":"0102030405060708090a0b0c0d0e0f10","spanId":"0102030405060708",)"
+             << R"("attributes":[{"key":"http.method","value":{"stringValue":"GET"}},)"
+             << R"({"key":"http.route","value":{"stringValue":"/api/v1/orders/{id}"}},)"
+             << R"({"key":"http.status_code","value":{"intValue":"200"}},)"
+             << R"({"key":"duration_ms","value":{"doubleValue":12.5}}]})";
+    }
+    json << "]}]}]}";
+    return json.str();
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    out = contents.str();
+    return true;
+}
+
+static double runBenchmark(const std::string& name,
+                           const std::vector<std::string>& payloads,
+                           size_t iterations,
+                           const std::function<size_t(const std::string&, LogRecordBatch&)>& decode) {
+    size_t total_records = 0;
+    size_t total_bytes = 0;
+    LogRecordBatch batch;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        for (const auto& payload : payloads) {
+            batch.clear();
+            total_records += decode(payload, batch);
+            total_bytes += payload.size();
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    double records_per_sec = total_records / elapsed.count();
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(10) << total_records << " records  "
+              << std::fixed << std::setprecision(3) << std::setw(8) << elapsed.count() << " s  "
+              << std::setprecision(0) << std::setw(12) << records_per_sec << " records/s  "
+              << std::setprecision(1) << std::setw(8) << total_bytes / elapsed.count() / (1024 * 1024)
+              << " MB/s" << std::endl;
+    return records_per_sec;
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    size_t synthetic_records = 1000;
+
+    std::vector<std::string> payloads;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--records" && i + 1 < argc) {
+            synthetic_records = std::strtoul(argv[++i], nullptr, 10);
+            continue;
+        }
+        std::string payload;
+        if (!readFile(arg, payload)) {
+            std::cerr << "Failed to read " << arg << std::endl;
+            return 1;
+        }
+        payloads.push_back(std::move(payload));
+    }
+    if (payloads.empty()) {
+        payloads.push_back(makePayload(synthetic_records));
+    }
+
+    size_t payload_bytes = 0;
+    for (const auto& payload : payloads) {
+        payload_bytes += payload.size();
+    }
+    std::cout << "JSON decode benchmark: " << payloads.size() << " payload(s), "
+              << payload_bytes << " bytes, " << iterations << " iterations" << std::endl;
+
+    double protobuf_rate = runBenchmark("protobuf", payloads, iterations,
+        [](const std::string& payload, LogRecordBatch& batch) -> size_t {
+            ExportLogsServiceRequest request;
+            if (!google::protobuf::util::JsonStringToMessage(payload, &request).ok()) {
+                return 0;
+            }
+            return LogTransformer::transformToBatch(request, "otel-logs", 0, 0, batch);
+        });
+
+    double native_rate = runBenchmark("native", payloads, iterations,
+        [](const std::string& payload, LogRecordBatch& batch) -> size_t {
+            return OtlpJsonDecoder::decode(payload, "otel-logs", 0, 0, batch);
+        });
+
+    if (protobuf_rate > 0.0 && native_rate > 0.0) {
+        std::cout << "Speedup (native vs protobuf): " << std::setprecision(2)
+                  << native_rate / protobuf_rate << "x" << std::endl;
+    }
+    return 0;
+}
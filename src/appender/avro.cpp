@@ -0,0 +1,348 @@
+#include "avro.hpp"
+#include <zlib.h>
+#include <cstring>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kMagic[4] = {'O', 'b', 'j', 1};
+constexpr int kMaxDepth = 64;
+
+class Decoder {
+public:
+    explicit Decoder(std::string_view data) : data_(data), pos_(0) {}
+
+    bool atEnd() const { return pos_ >= data_.size(); }
+    size_t pos() const { return pos_; }
+
+    int64_t readLong() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = readByte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+        }
+        throw std::runtime_error("Invalid Avro varint");
+    }
+
+    std::string_view readFixed(size_t size) {
+        if (size > data_.size() - pos_) {
+            throw std::runtime_error("Truncated Avro data");
+        }
+        std::string_view value = data_.substr(pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    std::string_view readBytes() {
+        int64_t size = readLong();
+        if (size < 0) {
+            throw std::runtime_error("Negative Avro length");
+        }
+        return readFixed(static_cast<size_t>(size));
+    }
+
+    uint8_t readByte() {
+        if (pos_ >= data_.size()) {
+            throw std::runtime_error("Truncated Avro data");
+        }
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    // Item count of the next array/map block; a negative count is followed by the block size
+    int64_t readBlockCount() {
+        int64_t count = readLong();
+        if (count < 0) {
+            readLong();
+            count = -count;
+        }
+        return count;
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_;
+};
+
+// Resolves named types while decoding against a writer schema
+class SchemaDecoder {
+public:
+    explicit SchemaDecoder(const JsonValue& schema) {
+        collectNames(schema, "");
+    }
+
+    JsonValue decode(const JsonValue& schema, Decoder& in, int depth = 0) {
+        if (depth > kMaxDepth) {
+            throw std::runtime_error("Avro schema nesting too deep");
+        }
+        if (schema.isArray()) {
+            int64_t index = in.readLong();
+            if (index < 0 || static_cast<size_t>(index) >= schema.size()) {
+                throw std::runtime_error("Invalid Avro union index");
+            }
+            return decode(schema.items()[static_cast<size_t>(index)], in, depth + 1);
+        }
+        if (schema.isString()) {
+            return decodeNamed(schema.asString(), in, depth);
+        }
+
+        const std::string& type = schema["type"].asString();
+        if (type == "record" || type == "error") {
+            JsonValue record = JsonValue::object();
+            for (const auto& field : schema["fields"].items()) {
+                record.set(field["name"].asString(), decode(field["type"], in, depth + 1));
+            }
+            return record;
+        }
+        if (type == "enum") {
+            int64_t index = in.readLong();
+            const auto& symbols = schema["symbols"].items();
+            if (index < 0 || static_cast<size_t>(index) >= symbols.size()) {
+                throw std::runtime_error("Invalid Avro enum index");
+            }
+            return symbols[static_cast<size_t>(index)];
+        }
+        if (type == "array") {
+            JsonValue array = JsonValue::array();
+            for (int64_t count = in.readBlockCount(); count != 0; count = in.readBlockCount()) {
+                for (int64_t i = 0; i < count; ++i) {
+                    array.push(decode(schema["items"], in, depth + 1));
+                }
+            }
+            return array;
+        }
+        if (type == "map") {
+            JsonValue map = JsonValue::object();
+            for (int64_t count = in.readBlockCount(); count != 0; count = in.readBlockCount()) {
+                for (int64_t i = 0; i < count; ++i) {
+                    std::string key(in.readBytes());
+                    map.set(key, decode(schema["values"], in, depth + 1));
+                }
+            }
+            return map;
+        }
+        if (type == "fixed") {
+            return JsonValue(std::string(in.readFixed(static_cast<size_t>(schema["size"].asInt()))));
+        }
+        // {"type": "long", "logicalType": ...} and friends
+        return decodeNamed(type, in, depth);
+    }
+
+private:
+    std::map<std::string, const JsonValue*> named_;
+
+    void collectNames(const JsonValue& schema, const std::string& enclosing_namespace) {
+        if (schema.isArray()) {
+            for (const auto& branch : schema.items()) {
+                collectNames(branch, enclosing_namespace);
+            }
+            return;
+        }
+        if (!schema.isObject()) {
+            return;
+        }
+        std::string ns = schema.find("namespace") ? schema["namespace"].asString() : enclosing_namespace;
+        const std::string& name = schema["name"].asString();
+        if (!name.empty()) {
+            named_[name] = &schema;
+            if (!ns.empty() && name.find('.') == std::string::npos) {
+                named_[ns + "." + name] = &schema;
+            }
+        }
+        for (const auto& field : schema["fields"].items()) {
+            collectNames(field["type"], ns);
+        }
+        collectNames(schema["items"], ns);
+        collectNames(schema["values"], ns);
+    }
+
+    JsonValue decodeNamed(const std::string& type, Decoder& in, int depth) {
+        if (type == "null") {
+            return JsonValue();
+        }
+        if (type == "boolean") {
+            return JsonValue(in.readByte() != 0);
+        }
+        if (type == "int" || type == "long") {
+            return JsonValue(in.readLong());
+        }
+        if (type == "float") {
+            std::string_view bytes = in.readFixed(4);
+            uint32_t bits = 0;
+            for (int i = 0; i < 4; ++i) {
+                bits |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+            }
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return JsonValue(static_cast<double>(value));
+        }
+        if (type == "double") {
+            std::string_view bytes = in.readFixed(8);
+            uint64_t bits = 0;
+            for (int i = 0; i < 8; ++i) {
+                bits |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+            }
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return JsonValue(value);
+        }
+        if (type == "bytes" || type == "string") {
+            return JsonValue(std::string(in.readBytes()));
+        }
+        auto it = named_.find(type);
+        if (it == named_.end()) {
+            throw std::runtime_error("Unknown Avro type: " + type);
+        }
+        return decode(*it->second, in, depth + 1);
+    }
+};
+
+std::string inflateRaw(std::string_view compressed) {
+    z_stream stream{};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        throw std::runtime_error("Failed to initialize inflate");
+    }
+    std::string out;
+    char buffer[16384];
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    int rc;
+    do {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        rc = inflate(&stream, Z_NO_FLUSH);
+        if (rc != Z_OK && rc != Z_STREAM_END) {
+            inflateEnd(&stream);
+            throw std::runtime_error("Invalid deflate block in Avro file");
+        }
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+    } while (rc != Z_STREAM_END && (stream.avail_in > 0 || stream.avail_out == 0));
+    inflateEnd(&stream);
+    return out;
+}
+
+}  // namespace
+
+void AvroEncoder::writeLong(int64_t value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        data_.push_back(static_cast<char>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    data_.push_back(static_cast<char>(zigzag));
+}
+
+void AvroEncoder::writeBytes(std::string_view value) {
+    writeLong(static_cast<int64_t>(value.size()));
+    data_.append(value.data(), value.size());
+}
+
+void AvroEncoder::arrayStart(size_t count) {
+    if (count > 0) {
+        writeLong(static_cast<int64_t>(count));
+    }
+}
+
+std::string AvroFile::metadataValue(std::string_view key) const {
+    for (const auto& entry : metadata) {
+        if (entry.first == key) {
+            return entry.second;
+        }
+    }
+    return std::string();
+}
+
+std::string AvroContainer::write(const JsonValue& schema,
+                                 const std::vector<std::pair<std::string, std::string>>& metadata,
+                                 const AvroEncoder& records,
+                                 size_t record_count) {
+    static thread_local std::mt19937_64 gen(std::random_device{}());
+    std::string sync(16, '\0');
+    for (size_t i = 0; i < sync.size(); i += 8) {
+        uint64_t random = gen();
+        for (size_t j = 0; j < 8; ++j) {
+            sync[i + j] = static_cast<char>(random >> (8 * j));
+        }
+    }
+
+    AvroEncoder header;
+    header.arrayStart(metadata.size() + 2);
+    header.writeString("avro.schema");
+    header.writeBytes(schema.dump());
+    header.writeString("avro.codec");
+    header.writeBytes("null");
+    for (const auto& entry : metadata) {
+        header.writeString(entry.first);
+        header.writeBytes(entry.second);
+    }
+    header.arrayEnd();
+
+    AvroEncoder block;
+    block.writeLong(static_cast<int64_t>(record_count));
+    block.writeLong(static_cast<int64_t>(records.data().size()));
+
+    std::string out(kMagic, sizeof(kMagic));
+    out += header.data();
+    out += sync;
+    if (record_count > 0) {
+        out += block.data();
+        out += records.data();
+        out += sync;
+    }
+    return out;
+}
+
+AvroFile AvroContainer::read(std::string_view data) {
+    if (data.size() < sizeof(kMagic) || data.substr(0, sizeof(kMagic)) != std::string_view(kMagic, sizeof(kMagic))) {
+        throw std::runtime_error("Not an Avro container file");
+    }
+
+    Decoder in(data.substr(sizeof(kMagic)));
+    AvroFile file;
+    std::string codec = "null";
+    for (int64_t count = in.readBlockCount(); count != 0; count = in.readBlockCount()) {
+        for (int64_t i = 0; i < count; ++i) {
+            std::string key(in.readBytes());
+            std::string value(in.readBytes());
+            if (key == "avro.schema") {
+                file.schema = JsonValue::parse(value);
+            } else if (key == "avro.codec") {
+                codec = value;
+            } else {
+                file.metadata.emplace_back(std::move(key), std::move(value));
+            }
+        }
+    }
+    if (codec != "null" && codec != "deflate") {
+        throw std::runtime_error("Unsupported Avro codec: " + codec);
+    }
+    std::string_view sync = in.readFixed(16);
+
+    SchemaDecoder decoder(file.schema);
+    while (!in.atEnd()) {
+        int64_t count = in.readLong();
+        int64_t size = in.readLong();
+        if (count < 0 || size < 0) {
+            throw std::runtime_error("Invalid Avro block header");
+        }
+        std::string_view block = in.readFixed(static_cast<size_t>(size));
+        std::string inflated;
+        if (codec == "deflate") {
+            inflated = inflateRaw(block);
+            block = inflated;
+        }
+
+        Decoder records(block);
+        for (int64_t i = 0; i < count; ++i) {
+            file.records.push_back(decoder.decode(file.schema, records));
+        }
+        if (in.readFixed(16) != sync) {
+            throw std::runtime_error("Avro sync marker mismatch");
+        }
+    }
+    return file;
+}
@@ -0,0 +1,59 @@
+#ifndef AVRO_HPP
+#define AVRO_HPP
+
+#include "json_value.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Avro binary encoder for the records of an object container file
+// Callers write values in schema order; unions are an index followed by the
+// branch value, arrays and maps a count followed by the items (see arrayStart)
+class AvroEncoder {
+public:
+    void writeBool(bool value) { data_.push_back(value ? 1 : 0); }
+    void writeInt(int32_t value) { writeLong(value); }
+    void writeLong(int64_t value);
+    void writeBytes(std::string_view value);
+    void writeString(std::string_view value) { writeBytes(value); }
+    void writeUnionIndex(int index) { writeLong(index); }
+
+    // One block holding `count` items, then the terminating empty block
+    void arrayStart(size_t count);
+    void arrayEnd() { writeLong(0); }
+
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+};
+
+// A decoded container file; records are decoded against the writer schema:
+// records and maps become objects, arrays arrays, bytes/fixed strings and
+// unions their branch value
+struct AvroFile {
+    JsonValue schema;
+    std::vector<std::pair<std::string, std::string>> metadata;
+    std::vector<JsonValue> records;
+
+    // Empty if the key is absent
+    std::string metadataValue(std::string_view key) const;
+};
+
+class AvroContainer {
+public:
+    // Object container file with one data block (null codec)
+    // `metadata` holds user metadata; avro.schema and avro.codec are added
+    static std::string write(const JsonValue& schema,
+                             const std::vector<std::pair<std::string, std::string>>& metadata,
+                             const AvroEncoder& records,
+                             size_t record_count);
+
+    // Decode a container file written with the null or deflate codec
+    // Throws std::runtime_error on malformed or unsupported input
+    static AvroFile read(std::string_view data);
+};
+
+#endif // AVRO_HPP
@@ -1,5 +1,7 @@
 #include "buffer_manager.hpp"
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
 
 BufferManager::BufferManager(size_t max_size_bytes, int max_time_seconds)
     : max_size_bytes_(max_size_bytes),
@@ -32,7 +34,93 @@ std::chrono::seconds BufferManager::getTimeSinceReset() const {
 }
 
 void BufferManager::reset() {
+    {
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        usage_.clear();
+    }
     current_size_.store(0);
     resetTime();
 }
 
+
+void BufferManager::setUsage(int32_t consumer, size_t bytes, size_t flushable,
+                             std::chrono::system_clock::time_point oldest) {
+    std::lock_guard<std::mutex> lock(usage_mutex_);
+    Usage& usage = usage_[consumer];
+    current_size_ -= usage.bytes;
+    current_size_ += bytes;
+    usage.bytes = bytes;
+    usage.flushable = flushable;
+    usage.oldest = oldest;
+}
+
+void BufferManager::removeUsage(int32_t consumer) {
+    std::lock_guard<std::mutex> lock(usage_mutex_);
+    auto it = usage_.find(consumer);
+    if (it != usage_.end()) {
+        current_size_ -= it->second.bytes;
+        usage_.erase(it);
+    }
+}
+
+size_t BufferManager::getUsage(int32_t consumer) const {
+    std::lock_guard<std::mutex> lock(usage_mutex_);
+    auto it = usage_.find(consumer);
+    return it == usage_.end() ? 0 : it->second.bytes;
+}
+
+std::vector<int32_t> BufferManager::selectFlushTargets(size_t bytes, FlushPolicy policy, size_t min_flushable) const {
+    min_flushable = std::max<size_t>(1, min_flushable);
+    std::vector<std::pair<int32_t, Usage>> candidates;
+    {
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        for (const auto& kv : usage_) {
+            if (kv.second.flushable >= min_flushable) {
+                candidates.emplace_back(kv.first, kv.second);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [policy](const auto& a, const auto& b) {
+        if (policy == FlushPolicy::OLDEST && a.second.oldest != b.second.oldest) {
+            return a.second.oldest < b.second.oldest;
+        }
+        return a.second.flushable > b.second.flushable;
+    });
+
+    std::vector<int32_t> targets;
+    size_t freed = 0;
+    for (const auto& candidate : candidates) {
+        if (freed >= bytes) {
+            break;
+        }
+        targets.push_back(candidate.first);
+        freed += candidate.second.flushable;
+    }
+    return targets;
+}
+
+BufferManager::FlushPolicy BufferManager::parseFlushPolicy(const std::string& name) {
+    return name == "oldest" ? FlushPolicy::OLDEST : FlushPolicy::LARGEST;
+}
+
+size_t BufferManager::readCgroupMemoryLimit(const std::string& cgroup_root) {
+    // cgroup v2 first, then v1; "max" and v1's page-rounded INT64_MAX mean unlimited
+    for (const char* file : {"/memory.max", "/memory/memory.limit_in_bytes"}) {
+        std::ifstream in(cgroup_root + file);
+        std::string value;
+        if (!(in >> value)) {
+            continue;
+        }
+        if (value == "max") {
+            return 0;
+        }
+        char* end = nullptr;
+        unsigned long long limit = std::strtoull(value.c_str(), &end, 10);
+        if (end == value.c_str() || *end != '\0') {
+            return 0;
+        }
+        return limit >= (1ULL << 60) ? 0 : static_cast<size_t>(limit);
+    }
+    return 0;
+}
@@ -2,38 +2,87 @@
 #define BUFFER_MANAGER_HPP
 
 #include <chrono>
+#include <cstdint>
+#include <map>
 #include <mutex>
 #include <atomic>
+#include <string>
+#include <vector>
 
+// Size and time thresholds for a buffer
+//
+// Also used as the process-wide memory budget shared by all partition
+// workers: max_size_bytes is the budget, each worker's resident bytes are
+// reported with setUsage(), the current size is their sum and
+// selectFlushTargets() picks the buffers to flush when it runs short, by the
+// part of each worker's usage a flush actually frees.
 class BufferManager {
 public:
+    // Which buffers are flushed first under memory pressure
+    enum class FlushPolicy {
+        LARGEST,  // Frees the most memory per flush
+        OLDEST    // Keeps data freshness even; flushes the longest-open buffers
+    };
+
     BufferManager(size_t max_size_bytes, int max_time_seconds);
-    
+
     // Add data to buffer, returns true if flush should be triggered
     bool add(size_t data_size_bytes);
-    
+
     // Check if time threshold is met
     bool shouldFlushByTime() const;
-    
+
     // Reset time counter (call after flush)
     void resetTime();
-    
+
     // Get current buffer size
     size_t getCurrentSize() const { return current_size_.load(); }
-    
+    size_t getMaxSize() const { return max_size_bytes_; }
+
     // Get time since last reset
     std::chrono::seconds getTimeSinceReset() const;
-    
+
     // Reset buffer (call after flush)
     void reset();
 
+    // Set the bytes one consumer (partition worker) holds, how many of them a
+    // flush would free and when its oldest buffered data arrived; replaces its
+    // previous report
+    void setUsage(int32_t consumer, size_t bytes, size_t flushable,
+                  std::chrono::system_clock::time_point oldest);
+
+    // Forget a consumer (worker destroyed)
+    void removeUsage(int32_t consumer);
+
+    size_t getUsage(int32_t consumer) const;
+
+    // Consumers to flush to free at least `bytes`, in policy order
+    // Consumers with less than min_flushable (at least 1) flushable bytes are never picked
+    std::vector<int32_t> selectFlushTargets(size_t bytes, FlushPolicy policy, size_t min_flushable = 1) const;
+
+    // "oldest" or "largest" (default)
+    static FlushPolicy parseFlushPolicy(const std::string& name);
+
+    // Memory limit of the cgroup this process runs in: cgroup v2 memory.max or
+    // cgroup v1 memory.limit_in_bytes under cgroup_root
+    // Returns 0 when there is no limit or it cannot be read
+    static size_t readCgroupMemoryLimit(const std::string& cgroup_root = "/sys/fs/cgroup");
+
 private:
+    struct Usage {
+        size_t bytes;
+        size_t flushable;
+        std::chrono::system_clock::time_point oldest;
+    };
+
     size_t max_size_bytes_;
     int max_time_seconds_;
     std::atomic<size_t> current_size_;
     std::chrono::system_clock::time_point last_reset_time_;
     mutable std::mutex time_mutex_;
+
+    std::map<int32_t, Usage> usage_;
+    mutable std::mutex usage_mutex_;
 };
 
 #endif // BUFFER_MANAGER_HPP
-
@@ -0,0 +1,156 @@
+#include "commit_aggregator.hpp"
+#include <algorithm>
+#include <iostream>
+
+CommitAggregator::CommitAggregator(const AppenderConfig& config, CommitFunction commit)
+    : config_(config)
+    , commit_(std::move(commit))
+    , urgent_(false)
+    , stop_(true)
+    , commit_count_(0)
+    , committed_files_(0) {
+}
+
+CommitAggregator::~CommitAggregator() {
+    stop();
+}
+
+void CommitAggregator::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stop_) {
+        return;
+    }
+    stop_ = false;
+    // The first snapshot also waits one interval, so a restart that flushes
+    // every partition at once still produces a single commit
+    last_commit_ = std::chrono::steady_clock::now();
+    thread_ = std::thread(&CommitAggregator::run, this);
+}
+
+void CommitAggregator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool CommitAggregator::submit(int32_t partition, const IcebergDataFile& file, int64_t max_offset, bool urgent) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // No commit thread (stopped or never started): commit on its own
+    if (stop_) {
+        lock.unlock();
+        Batch batch;
+        batch.files.push_back(file);
+        batch.partitions.push_back(partition);
+        if (max_offset >= 0) {
+            batch.offsets[partition] = max_offset;
+        }
+        return commitBatch(batch);
+    }
+
+    if (!pending_) {
+        pending_ = std::make_shared<Batch>();
+    }
+    std::shared_ptr<Batch> batch = pending_;
+    batch->files.push_back(file);
+    batch->partitions.push_back(partition);
+    if (max_offset >= 0) {
+        auto it = batch->offsets.find(partition);
+        if (it == batch->offsets.end() || max_offset > it->second) {
+            batch->offsets[partition] = max_offset;
+        }
+    }
+    urgent_ = urgent_ || urgent;
+    cv_.notify_all();
+
+    done_cv_.wait(lock, [&batch] { return batch->done; });
+    return batch->committed.count(partition) > 0;
+}
+
+void CommitAggregator::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto interval = std::chrono::milliseconds(std::max(0, config_.iceberg_commit_interval_ms));
+    size_t max_files = static_cast<size_t>(std::max(1, config_.iceberg_commit_max_files));
+
+    while (true) {
+        if (!pending_) {
+            if (stop_) {
+                break;
+            }
+            cv_.wait(lock, [this] { return pending_ || stop_; });
+            continue;
+        }
+
+        // Keep collecting until the interval is up, unless something can't wait
+        auto due = last_commit_ + interval;
+        if (!stop_ && !urgent_ && pending_->files.size() < max_files && std::chrono::steady_clock::now() < due) {
+            cv_.wait_until(lock, due);
+            continue;
+        }
+
+        std::shared_ptr<Batch> batch = std::move(pending_);
+        pending_.reset();
+        urgent_ = false;
+        lock.unlock();
+
+        // Files submitted meanwhile go into the next batch
+        std::set<int32_t> partitions(batch->partitions.begin(), batch->partitions.end());
+        commitPartitions(*batch, std::vector<int32_t>(partitions.begin(), partitions.end()));
+
+        lock.lock();
+        last_commit_ = std::chrono::steady_clock::now();
+        batch->done = true;
+        done_cv_.notify_all();
+    }
+}
+
+bool CommitAggregator::commitBatch(const Batch& batch) {
+    if (!commit_(batch.files, batch.offsets)) {
+        std::cerr << "Failed to commit " << batch.files.size() << " file(s) from "
+                  << batch.offsets.size() << " partition(s)" << std::endl;
+        return false;
+    }
+
+    commit_count_ += 1;
+    committed_files_ += batch.files.size();
+    if (batch.files.size() > 1) {
+        std::cout << "Coalesced " << batch.files.size() << " file(s) from "
+                  << batch.offsets.size() << " partition(s) into one Iceberg snapshot" << std::endl;
+    }
+    return true;
+}
+
+void CommitAggregator::commitPartitions(Batch& batch, const std::vector<int32_t>& partitions) {
+    Batch group;
+    for (size_t i = 0; i < batch.files.size(); ++i) {
+        if (std::binary_search(partitions.begin(), partitions.end(), batch.partitions[i])) {
+            group.files.push_back(batch.files[i]);
+            group.partitions.push_back(batch.partitions[i]);
+        }
+    }
+    for (int32_t partition : partitions) {
+        auto it = batch.offsets.find(partition);
+        if (it != batch.offsets.end()) {
+            group.offsets.insert(*it);
+        }
+    }
+
+    if (commitBatch(group)) {
+        batch.committed.insert(partitions.begin(), partitions.end());
+        return;
+    }
+    if (partitions.size() < 2) {
+        return;
+    }
+
+    // One file the catalog rejects must not hold back every other partition
+    std::cerr << "Retrying " << partitions.size() << " partition(s) in two smaller snapshots" << std::endl;
+    auto middle = partitions.begin() + partitions.size() / 2;
+    commitPartitions(batch, std::vector<int32_t>(partitions.begin(), middle));
+    commitPartitions(batch, std::vector<int32_t>(middle, partitions.end()));
+}
@@ -0,0 +1,89 @@
+#ifndef COMMIT_AGGREGATOR_HPP
+#define COMMIT_AGGREGATOR_HPP
+
+#include "../config.hpp"
+#include "iceberg_manifest.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// Coalesces data files sealed by many partition workers into one Iceberg
+// snapshot (ICEBERG_COMMIT_MODE=rest)
+//
+// A worker's flush thread submits its file and blocks until the snapshot that
+// contains it is committed, then reports its offset as usual, so a partition's
+// offset still never runs ahead of its data. A snapshot is committed at most
+// once per iceberg_commit_interval_ms with everything submitted meanwhile;
+// it goes out early once iceberg_commit_max_files are waiting or a forced
+// flush (forceFlush, shutdown) is among them. If the catalog rejects a
+// snapshot, its partitions are retried in halves, so a file that can never be
+// committed holds back only its own partition.
+class CommitAggregator {
+public:
+    // Commits the files and the per-partition offsets they cover in one snapshot
+    using CommitFunction = std::function<bool(const std::vector<IcebergDataFile>& files,
+                                              const std::map<int32_t, int64_t>& offsets)>;
+
+    CommitAggregator(const AppenderConfig& config, CommitFunction commit);
+    ~CommitAggregator();
+
+    // Start the commit thread
+    void start();
+
+    // Commit what is pending and stop the commit thread
+    // Later submissions are committed on the caller's thread, one snapshot each
+    void stop();
+
+    // Add a file covering `partition` up to `max_offset` (-1 for none) to the
+    // next snapshot and wait for it to be committed
+    // Returns false if no snapshot could take this partition's files; the caller
+    // retries with a new submit()
+    bool submit(int32_t partition, const IcebergDataFile& file, int64_t max_offset, bool urgent);
+
+    uint64_t getCommitCount() const { return commit_count_.load(); }
+    uint64_t getCommittedFileCount() const { return committed_files_.load(); }
+
+private:
+    // Files collected for one snapshot; shared with the submitters waiting on it
+    struct Batch {
+        std::vector<IcebergDataFile> files;
+        std::vector<int32_t> partitions;  // Partition of each file
+        std::map<int32_t, int64_t> offsets;
+        std::set<int32_t> committed;      // Partitions whose files are in a snapshot
+        bool done = false;
+    };
+
+    const AppenderConfig& config_;
+    CommitFunction commit_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;       // Wakes the commit thread
+    std::condition_variable done_cv_;  // Wakes submitters when a batch is done
+    std::shared_ptr<Batch> pending_;   // Batch being collected (guarded by mutex_)
+    bool urgent_;                      // Pending batch holds a forced flush (guarded by mutex_)
+    bool stop_;                        // Guarded by mutex_
+    std::chrono::steady_clock::time_point last_commit_;
+
+    std::atomic<uint64_t> commit_count_;
+    std::atomic<uint64_t> committed_files_;
+
+    void run();
+
+    // Run the commit function for a batch and record the outcome
+    bool commitBatch(const Batch& batch);
+
+    // Commit the files of these partitions from batch as one snapshot; if that
+    // fails, split the partitions in half and try each half on its own
+    void commitPartitions(Batch& batch, const std::vector<int32_t>& partitions);
+};
+
+#endif // COMMIT_AGGREGATOR_HPP
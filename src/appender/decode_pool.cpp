@@ -0,0 +1,101 @@
+#include "decode_pool.hpp"
+#include <iostream>
+#include <algorithm>
+
+DecodePool::DecodePool(size_t num_threads)
+    : running_(false)
+    , stop_requested_(false)
+    , pending_tasks_(0) {
+    num_threads = std::max<size_t>(1, num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        lanes_.push_back(std::make_unique<Lane>());
+    }
+}
+
+DecodePool::~DecodePool() {
+    stop();
+}
+
+void DecodePool::start() {
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    stop_requested_ = false;
+    for (auto& lane : lanes_) {
+        lane->thread = std::thread(&DecodePool::run, this, std::ref(*lane));
+    }
+
+    std::cout << "Decode pool started with " << lanes_.size() << " thread(s)" << std::endl;
+}
+
+void DecodePool::stop() {
+    if (!running_) {
+        return;
+    }
+
+    stop_requested_ = true;
+    for (auto& lane : lanes_) {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        lane->cv.notify_all();
+    }
+    for (auto& lane : lanes_) {
+        if (lane->thread.joinable()) {
+            lane->thread.join();
+        }
+    }
+
+    running_ = false;
+    std::cout << "Decode pool stopped" << std::endl;
+}
+
+void DecodePool::submit(int32_t partition, Task task) {
+    size_t index = static_cast<uint32_t>(partition) % lanes_.size();
+    Lane& lane = *lanes_[index];
+
+    pending_tasks_.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(lane.mutex);
+        lane.cv.wait(lock, [&] {
+            return lane.tasks.size() < kMaxQueuedTasksPerThread || stop_requested_;
+        });
+        lane.tasks.push_back(std::move(task));
+    }
+    lane.cv.notify_all();
+}
+
+void DecodePool::waitIdle() {
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    idle_cv_.wait(lock, [this] { return pending_tasks_.load() == 0; });
+}
+
+void DecodePool::run(Lane& lane) {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            lane.cv.wait(lock, [&] { return !lane.tasks.empty() || stop_requested_; });
+
+            // Drain queued tasks before honoring stop
+            if (lane.tasks.empty()) {
+                break;
+            }
+            task = std::move(lane.tasks.front());
+            lane.tasks.pop_front();
+        }
+        // Wake a submitter blocked on a full lane
+        lane.cv.notify_all();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Decode task failed: " << e.what() << std::endl;
+        }
+
+        if (pending_tasks_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+}
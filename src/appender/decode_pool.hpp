@@ -0,0 +1,70 @@
+#ifndef DECODE_POOL_HPP
+#define DECODE_POOL_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+// Fixed pool of threads for the decode/transform stage between the consumer
+// and the partition workers
+//
+// Each task carries a partition key and every key is pinned to one thread
+// (key % num_threads), so tasks for the same partition run one at a time in
+// submission order. That keeps per-partition max_offset tracking correct
+// while different partitions decode in parallel.
+class DecodePool {
+public:
+    using Task = std::function<void()>;
+
+    // Max tasks queued per thread before submit() blocks (backpressure on the poll loop)
+    static constexpr size_t kMaxQueuedTasksPerThread = 64;
+
+    explicit DecodePool(size_t num_threads);
+    ~DecodePool();
+
+    // Start the worker threads
+    void start();
+
+    // Run remaining tasks and stop the worker threads
+    void stop();
+
+    // Queue a task for the given partition
+    // Blocks while the partition's thread has kMaxQueuedTasksPerThread tasks queued
+    void submit(int32_t partition, Task task);
+
+    // Wait until every submitted task has finished
+    void waitIdle();
+
+    size_t getThreadCount() const { return lanes_.size(); }
+
+    // Tasks queued or running across all threads
+    size_t getPendingTaskCount() const { return pending_tasks_.load(); }
+
+private:
+    // One thread and its FIFO of tasks
+    struct Lane {
+        std::thread thread;
+        std::deque<Task> tasks;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_requested_;
+
+    // Tasks submitted but not yet finished
+    std::atomic<size_t> pending_tasks_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+
+    void run(Lane& lane);
+};
+
+#endif // DECODE_POOL_HPP
@@ -0,0 +1,100 @@
+#include "http_client.hpp"
+#include <curl/curl.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+size_t collectBody(char* data, size_t size, size_t count, void* user) {
+    static_cast<std::string*>(user)->append(data, size * count);
+    return size * count;
+}
+
+// Feeds an in-memory request body
+struct BodyReader {
+    std::string_view body;
+    size_t offset = 0;
+};
+
+size_t readBody(char* buffer, size_t size, size_t count, void* user) {
+    auto* reader = static_cast<BodyReader*>(user);
+    size_t n = std::min(size * count, reader->body.size() - reader->offset);
+    std::memcpy(buffer, reader->body.data() + reader->offset, n);
+    reader->offset += n;
+    return n;
+}
+
+}  // namespace
+
+HttpResponse HttpClient::send(const Request& request) {
+    static std::once_flag init;
+    std::call_once(init, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+    HttpResponse response;
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        response.error = "curl_easy_init failed";
+        return response;
+    }
+
+    curl_slist* headers = nullptr;
+    for (const auto& header : request.headers) {
+        headers = curl_slist_append(headers, header.c_str());
+    }
+    // No 100-continue round trip for request bodies
+    headers = curl_slist_append(headers, "Expect:");
+
+    BodyReader reader{request.body, 0};
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, request.timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, collectBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+
+    if (request.method == "PUT" || request.method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        if (request.upload) {
+            curl_easy_setopt(curl, CURLOPT_READDATA, request.upload);
+            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(request.upload_size));
+        } else {
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, readBody);
+            curl_easy_setopt(curl, CURLOPT_READDATA, &reader);
+            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+        }
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+    } else if (request.method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (request.method != "GET") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+    }
+
+    CURLcode rc = curl_easy_perform(curl);
+    if (rc == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    } else {
+        response.error = curl_easy_strerror(rc);
+    }
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return response;
+}
+
+std::string HttpClient::urlEncode(std::string_view value, bool keep_slash) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(value.size());
+    for (unsigned char c : value) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '_' || c == '.' || c == '~' || (keep_slash && c == '/')) {
+            out.push_back(static_cast<char>(c));
+        } else {
+            out.push_back('%');
+            out.push_back(hex[c >> 4]);
+            out.push_back(hex[c & 0x0F]);
+        }
+    }
+    return out;
+}
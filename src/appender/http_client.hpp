@@ -0,0 +1,34 @@
+#ifndef HTTP_CLIENT_HPP
+#define HTTP_CLIENT_HPP
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct HttpResponse {
+    long status = 0;        // 0 if the request never got a response
+    std::string body;
+    std::string error;      // Transport error, empty on any HTTP response
+};
+
+// Blocking HTTP requests over libcurl, for the Iceberg REST catalog and S3
+class HttpClient {
+public:
+    struct Request {
+        std::string method = "GET";
+        std::string url;
+        std::vector<std::string> headers;  // "Name: value"
+        std::string_view body;
+        FILE* upload = nullptr;            // Streamed request body instead of `body`
+        size_t upload_size = 0;
+        long timeout_ms = 30000;
+    };
+
+    static HttpResponse send(const Request& request);
+
+    // Percent-encode everything but unreserved characters (and '/' if keep_slash)
+    static std::string urlEncode(std::string_view value, bool keep_slash = false);
+};
+
+#endif // HTTP_CLIENT_HPP
@@ -0,0 +1,229 @@
+#include "iceberg_file_io.hpp"
+#include "http_client.hpp"
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace {
+
+std::string toHex(const unsigned char* data, size_t size) {
+    static const char* hex = "0123456789abcdef";
+    std::string out;
+    out.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i) {
+        out.push_back(hex[data[i] >> 4]);
+        out.push_back(hex[data[i] & 0x0F]);
+    }
+    return out;
+}
+
+std::string sha256Hex(std::string_view data) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest);
+    return toHex(digest, sizeof(digest));
+}
+
+std::string hmacSha256(std::string_view key, std::string_view data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest, &length);
+    return std::string(reinterpret_cast<char*>(digest), length);
+}
+
+}  // namespace
+
+IcebergFileIO::IcebergFileIO(S3Options options)
+    : options_(std::move(options)) {
+    if (options_.endpoint.empty()) {
+        options_.endpoint = "https://s3." + options_.region + ".amazonaws.com";
+    } else if (options_.endpoint.find("://") == std::string::npos) {
+        options_.endpoint = "http://" + options_.endpoint;
+    }
+    while (!options_.endpoint.empty() && options_.endpoint.back() == '/') {
+        options_.endpoint.pop_back();
+    }
+}
+
+bool IcebergFileIO::isS3(const std::string& uri) {
+    return uri.compare(0, 5, "s3://") == 0 || uri.compare(0, 6, "s3a://") == 0;
+}
+
+std::string IcebergFileIO::localPath(const std::string& uri) {
+    if (uri.compare(0, 7, "file://") == 0) {
+        return uri.substr(7);
+    }
+    if (uri.compare(0, 5, "file:") == 0) {
+        return uri.substr(5);
+    }
+    return uri;
+}
+
+bool IcebergFileIO::write(const std::string& uri, std::string_view data) {
+    if (isS3(uri)) {
+        long status = s3Request("PUT", uri, data, nullptr, 0, nullptr);
+        if (status != 200) {
+            std::cerr << "Failed to write " << uri << " (HTTP " << status << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::string path = localPath(uri);
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.close();
+    if (!out) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool IcebergFileIO::read(const std::string& uri, std::string& out) {
+    if (isS3(uri)) {
+        long status = s3Request("GET", uri, {}, nullptr, 0, &out);
+        if (status != 200) {
+            std::cerr << "Failed to read " << uri << " (HTTP " << status << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::ifstream in(localPath(uri), std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to read " << uri << std::endl;
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+bool IcebergFileIO::remove(const std::string& uri) {
+    if (isS3(uri)) {
+        long status = s3Request("DELETE", uri, {}, nullptr, 0, nullptr);
+        return status == 204 || status == 200;
+    }
+    return std::remove(localPath(uri).c_str()) == 0;
+}
+
+bool IcebergFileIO::upload(const std::string& local_path, const std::string& uri) {
+    if (!isS3(uri)) {
+        std::error_code ec;
+        std::string path = localPath(uri);
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        std::filesystem::copy_file(local_path, path, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "Failed to copy " << local_path << " to " << path << ": " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    FILE* file = std::fopen(local_path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to open " << local_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    size_t size = fstat(fileno(file), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    long status = s3Request("PUT", uri, {}, file, size, nullptr);
+    std::fclose(file);
+    if (status != 200) {
+        std::cerr << "Failed to upload " << local_path << " to " << uri << " (HTTP " << status << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+long IcebergFileIO::s3Request(const std::string& method, const std::string& uri, std::string_view body,
+                              FILE* upload, size_t upload_size, std::string* response_body) {
+    // s3://bucket/key -> <endpoint>/bucket/key
+    std::string bucket_and_key = uri.substr(uri.find("://") + 3);
+    std::string canonical_uri = "/" + HttpClient::urlEncode(bucket_and_key, true);
+
+    std::string host = options_.endpoint.substr(options_.endpoint.find("://") + 3);
+    char amz_date[17];
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    gmtime_r(&now, &tm);
+    std::strftime(amz_date, sizeof(amz_date), "%Y%m%dT%H%M%SZ", &tm);
+
+    std::map<std::string, std::string> signed_headers = {
+        {"host", host},
+        {"x-amz-content-sha256", "UNSIGNED-PAYLOAD"},
+        {"x-amz-date", amz_date},
+    };
+
+    HttpClient::Request request;
+    request.method = method;
+    request.url = options_.endpoint + canonical_uri;
+    request.body = body;
+    request.upload = upload;
+    request.upload_size = upload_size;
+    request.timeout_ms = 300000;
+    request.headers = {
+        "x-amz-content-sha256: UNSIGNED-PAYLOAD",
+        std::string("x-amz-date: ") + amz_date,
+        "Authorization: " + signV4(method, canonical_uri, signed_headers, "UNSIGNED-PAYLOAD", amz_date,
+                                   options_.region, options_.access_key, options_.secret_key),
+    };
+
+    HttpResponse response = HttpClient::send(request);
+    if (!response.error.empty()) {
+        std::cerr << "S3 " << method << " " << uri << " failed: " << response.error << std::endl;
+    }
+    if (response_body) {
+        *response_body = std::move(response.body);
+    }
+    return response.status;
+}
+
+std::string IcebergFileIO::signV4(const std::string& method,
+                                  const std::string& canonical_uri,
+                                  const std::map<std::string, std::string>& headers,
+                                  const std::string& payload_hash,
+                                  const std::string& amz_date,
+                                  const std::string& region,
+                                  const std::string& access_key,
+                                  const std::string& secret_key) {
+    std::string date = amz_date.substr(0, 8);
+    std::string scope = date + "/" + region + "/s3/aws4_request";
+
+    // std::map keeps the headers sorted by name, as the canonical form requires
+    std::string canonical_headers;
+    std::string signed_header_names;
+    for (const auto& header : headers) {
+        canonical_headers += header.first + ":" + header.second + "\n";
+        if (!signed_header_names.empty()) {
+            signed_header_names += ";";
+        }
+        signed_header_names += header.first;
+    }
+
+    std::string canonical_request = method + "\n" + canonical_uri + "\n" + "\n" +
+                                    canonical_headers + "\n" + signed_header_names + "\n" + payload_hash;
+    std::string string_to_sign = "AWS4-HMAC-SHA256\n" + amz_date + "\n" + scope + "\n" +
+                                 sha256Hex(canonical_request);
+
+    std::string key = hmacSha256("AWS4" + secret_key, date);
+    key = hmacSha256(key, region);
+    key = hmacSha256(key, "s3");
+    key = hmacSha256(key, "aws4_request");
+    std::string signature = hmacSha256(key, string_to_sign);
+
+    return "AWS4-HMAC-SHA256 Credential=" + access_key + "/" + scope +
+           ",SignedHeaders=" + signed_header_names +
+           ",Signature=" + toHex(reinterpret_cast<const unsigned char*>(signature.data()), signature.size());
+}
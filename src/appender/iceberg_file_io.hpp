@@ -0,0 +1,53 @@
+#ifndef ICEBERG_FILE_IO_HPP
+#define ICEBERG_FILE_IO_HPP
+
+#include <map>
+#include <string>
+#include <string_view>
+
+// Reads and writes table files (data files, manifests, manifest lists) by URI
+// file:// URIs and plain paths use the local filesystem. s3:// and s3a:// URIs
+// go to the configured endpoint with path-style addressing (as MinIO needs),
+// signed with AWS Signature Version 4 over an unsigned payload so uploads can
+// be streamed from disk.
+class IcebergFileIO {
+public:
+    struct S3Options {
+        std::string endpoint;     // e.g. http://minio:9000; https://s3.<region>.amazonaws.com if empty
+        std::string access_key;
+        std::string secret_key;
+        std::string region = "us-east-1";
+    };
+
+    explicit IcebergFileIO(S3Options options);
+
+    bool write(const std::string& uri, std::string_view data);
+    bool read(const std::string& uri, std::string& out);
+    bool remove(const std::string& uri);
+
+    // Copy a local file to `uri` without loading it into memory
+    bool upload(const std::string& local_path, const std::string& uri);
+
+    // Authorization header value for an S3 request
+    // `headers` are the lower-case names and values to sign; they must include host
+    static std::string signV4(const std::string& method,
+                              const std::string& canonical_uri,
+                              const std::map<std::string, std::string>& headers,
+                              const std::string& payload_hash,
+                              const std::string& amz_date,  // YYYYMMDDTHHMMSSZ
+                              const std::string& region,
+                              const std::string& access_key,
+                              const std::string& secret_key);
+
+private:
+    S3Options options_;
+
+    static bool isS3(const std::string& uri);
+    static std::string localPath(const std::string& uri);
+
+    // Send a signed S3 request; returns the HTTP status (0 on transport errors)
+    long s3Request(const std::string& method, const std::string& uri, std::string_view body,
+                   FILE* upload, size_t upload_size, std::string* response_body);
+};
+
+#endif // ICEBERG_FILE_IO_HPP
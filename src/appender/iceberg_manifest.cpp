@@ -0,0 +1,287 @@
+#include "iceberg_manifest.hpp"
+#include "avro.hpp"
+#include <stdexcept>
+
+namespace {
+
+// Avro schemas from the Iceberg spec, with field ids
+const char* kManifestEntrySchema = R"({"type":"record","name":"manifest_entry","fields":[
+{"name":"status","type":"int","field-id":0},
+{"name":"snapshot_id","type":["null","long"],"default":null,"field-id":1},
+{"name":"sequence_number","type":["null","long"],"default":null,"field-id":3},
+{"name":"file_sequence_number","type":["null","long"],"default":null,"field-id":4},
+{"name":"data_file","type":{"type":"record","name":"r2","fields":[
+ {"name":"content","type":"int","field-id":134},
+ {"name":"file_path","type":"string","field-id":100},
+ {"name":"file_format","type":"string","field-id":101},
+ {"name":"partition","type":{"type":"record","name":"r102","fields":[]},"field-id":102},
+ {"name":"record_count","type":"long","field-id":103},
+ {"name":"file_size_in_bytes","type":"long","field-id":104},
+ {"name":"column_sizes","type":["null",{"type":"array","items":{"type":"record","name":"k117_v118","fields":[
+  {"name":"key","type":"int","field-id":117},{"name":"value","type":"long","field-id":118}]},"logicalType":"map"}],
+  "default":null,"field-id":108},
+ {"name":"value_counts","type":["null",{"type":"array","items":{"type":"record","name":"k119_v120","fields":[
+  {"name":"key","type":"int","field-id":119},{"name":"value","type":"long","field-id":120}]},"logicalType":"map"}],
+  "default":null,"field-id":109},
+ {"name":"null_value_counts","type":["null",{"type":"array","items":{"type":"record","name":"k121_v122","fields":[
+  {"name":"key","type":"int","field-id":121},{"name":"value","type":"long","field-id":122}]},"logicalType":"map"}],
+  "default":null,"field-id":110},
+ {"name":"nan_value_counts","type":["null",{"type":"array","items":{"type":"record","name":"k138_v139","fields":[
+  {"name":"key","type":"int","field-id":138},{"name":"value","type":"long","field-id":139}]},"logicalType":"map"}],
+  "default":null,"field-id":137},
+ {"name":"lower_bounds","type":["null",{"type":"array","items":{"type":"record","name":"k126_v127","fields":[
+  {"name":"key","type":"int","field-id":126},{"name":"value","type":"bytes","field-id":127}]},"logicalType":"map"}],
+  "default":null,"field-id":125},
+ {"name":"upper_bounds","type":["null",{"type":"array","items":{"type":"record","name":"k129_v130","fields":[
+  {"name":"key","type":"int","field-id":129},{"name":"value","type":"bytes","field-id":130}]},"logicalType":"map"}],
+  "default":null,"field-id":128},
+ {"name":"key_metadata","type":["null","bytes"],"default":null,"field-id":131},
+ {"name":"split_offsets","type":["null",{"type":"array","items":"long","element-id":133}],"default":null,"field-id":132},
+ {"name":"equality_ids","type":["null",{"type":"array","items":"int","element-id":136}],"default":null,"field-id":135},
+ {"name":"sort_order_id","type":["null","int"],"default":null,"field-id":140}
+]},"field-id":2}
+]})";
+
+const char* kManifestFileSchema = R"({"type":"record","name":"manifest_file","fields":[
+{"name":"manifest_path","type":"string","field-id":500},
+{"name":"manifest_length","type":"long","field-id":501},
+{"name":"partition_spec_id","type":"int","field-id":502},
+{"name":"content","type":"int","field-id":517},
+{"name":"sequence_number","type":"long","field-id":515},
+{"name":"min_sequence_number","type":"long","field-id":516},
+{"name":"added_snapshot_id","type":"long","field-id":503},
+{"name":"added_files_count","type":"int","field-id":504},
+{"name":"existing_files_count","type":"int","field-id":505},
+{"name":"deleted_files_count","type":"int","field-id":506},
+{"name":"added_rows_count","type":"long","field-id":512},
+{"name":"existing_rows_count","type":"long","field-id":513},
+{"name":"deleted_rows_count","type":"long","field-id":514},
+{"name":"partitions","type":["null",{"type":"array","items":{"type":"record","name":"r508","fields":[
+ {"name":"contains_null","type":"boolean","field-id":509},
+ {"name":"contains_nan","type":["null","boolean"],"default":null,"field-id":518},
+ {"name":"lower_bound","type":["null","bytes"],"default":null,"field-id":510},
+ {"name":"upper_bound","type":["null","bytes"],"default":null,"field-id":511}]},"element-id":508}],
+ "default":null,"field-id":507},
+{"name":"key_metadata","type":["null","bytes"],"default":null,"field-id":519}
+]})";
+
+constexpr int kStatusAdded = 1;
+
+void writeCountMap(AvroEncoder& out, const std::map<int, int64_t>& counts) {
+    if (counts.empty()) {
+        out.writeUnionIndex(0);
+        return;
+    }
+    out.writeUnionIndex(1);
+    out.arrayStart(counts.size());
+    for (const auto& kv : counts) {
+        out.writeInt(kv.first);
+        out.writeLong(kv.second);
+    }
+    out.arrayEnd();
+}
+
+void writeBoundMap(AvroEncoder& out, const std::map<int, std::string>& bounds) {
+    if (bounds.empty()) {
+        out.writeUnionIndex(0);
+        return;
+    }
+    out.writeUnionIndex(1);
+    out.arrayStart(bounds.size());
+    for (const auto& kv : bounds) {
+        out.writeInt(kv.first);
+        out.writeBytes(kv.second);
+    }
+    out.arrayEnd();
+}
+
+void writeOptionalBytes(AvroEncoder& out, const JsonValue& value) {
+    if (value.isString()) {
+        out.writeUnionIndex(1);
+        out.writeBytes(value.asString());
+    } else {
+        out.writeUnionIndex(0);
+    }
+}
+
+// Int-keyed maps are stored as arrays of {key, value} records
+template <typename T, typename Convert>
+void readIntMap(const JsonValue& entries, std::map<int, T>& out, Convert convert) {
+    for (const auto& entry : entries.items()) {
+        out[static_cast<int>(entry["key"].asInt())] = convert(entry["value"]);
+    }
+}
+
+// Prefer the v2 field name, fall back to the v1 one
+int64_t countField(const JsonValue& record, const char* v2_name, const char* v1_name) {
+    const JsonValue* value = record.find(v2_name);
+    if (!value) {
+        value = record.find(v1_name);
+    }
+    return value ? value->asInt() : 0;
+}
+
+}  // namespace
+
+std::string IcebergManifest::writeManifest(const std::vector<IcebergDataFile>& files,
+                                           const JsonValue& table_schema,
+                                           int32_t partition_spec_id) {
+    AvroEncoder records;
+    for (const auto& file : files) {
+        records.writeInt(kStatusAdded);
+        records.writeUnionIndex(0);  // snapshot_id: inherited
+        records.writeUnionIndex(0);  // sequence_number: inherited
+        records.writeUnionIndex(0);  // file_sequence_number: inherited
+
+        records.writeInt(0);  // content: data
+        records.writeString(file.file_path);
+        records.writeString("PARQUET");
+        // partition: empty record
+        records.writeLong(file.record_count);
+        records.writeLong(file.file_size_in_bytes);
+        records.writeUnionIndex(0);  // column_sizes
+        writeCountMap(records, file.value_counts);
+        writeCountMap(records, file.null_value_counts);
+        records.writeUnionIndex(0);  // nan_value_counts
+        writeBoundMap(records, file.lower_bounds);
+        writeBoundMap(records, file.upper_bounds);
+        records.writeUnionIndex(0);  // key_metadata
+        records.writeUnionIndex(0);  // split_offsets
+        records.writeUnionIndex(0);  // equality_ids
+        records.writeUnionIndex(0);  // sort_order_id
+    }
+
+    std::vector<std::pair<std::string, std::string>> metadata = {
+        {"schema", table_schema.dump()},
+        {"schema-id", std::to_string(table_schema["schema-id"].asInt())},
+        {"partition-spec", "[]"},
+        {"partition-spec-id", std::to_string(partition_spec_id)},
+        {"format-version", "2"},
+        {"content", "data"},
+    };
+    return AvroContainer::write(JsonValue::parse(kManifestEntrySchema), metadata, records, files.size());
+}
+
+std::string IcebergManifest::writeManifestList(const std::vector<IcebergManifestFile>& manifests,
+                                               int64_t snapshot_id,
+                                               int64_t parent_snapshot_id,
+                                               int64_t sequence_number) {
+    AvroEncoder records;
+    for (const auto& manifest : manifests) {
+        records.writeString(manifest.manifest_path);
+        records.writeLong(manifest.manifest_length);
+        records.writeInt(manifest.partition_spec_id);
+        records.writeInt(manifest.content);
+        records.writeLong(manifest.sequence_number);
+        records.writeLong(manifest.min_sequence_number);
+        records.writeLong(manifest.added_snapshot_id);
+        records.writeInt(manifest.added_files_count);
+        records.writeInt(manifest.existing_files_count);
+        records.writeInt(manifest.deleted_files_count);
+        records.writeLong(manifest.added_rows_count);
+        records.writeLong(manifest.existing_rows_count);
+        records.writeLong(manifest.deleted_rows_count);
+
+        if (manifest.partitions.isArray()) {
+            records.writeUnionIndex(1);
+            records.arrayStart(manifest.partitions.size());
+            for (const auto& summary : manifest.partitions.items()) {
+                records.writeBool(summary["contains_null"].asBool());
+                const JsonValue& contains_nan = summary["contains_nan"];
+                if (contains_nan.isBool()) {
+                    records.writeUnionIndex(1);
+                    records.writeBool(contains_nan.asBool());
+                } else {
+                    records.writeUnionIndex(0);
+                }
+                writeOptionalBytes(records, summary["lower_bound"]);
+                writeOptionalBytes(records, summary["upper_bound"]);
+            }
+            records.arrayEnd();
+        } else {
+            records.writeUnionIndex(0);
+        }
+        writeOptionalBytes(records, manifest.key_metadata);
+    }
+
+    std::vector<std::pair<std::string, std::string>> metadata = {
+        {"snapshot-id", std::to_string(snapshot_id)},
+        {"parent-snapshot-id", parent_snapshot_id >= 0 ? std::to_string(parent_snapshot_id) : "null"},
+        {"sequence-number", std::to_string(sequence_number)},
+        {"format-version", "2"},
+    };
+    return AvroContainer::write(JsonValue::parse(kManifestFileSchema), metadata, records, manifests.size());
+}
+
+std::vector<IcebergManifestFile> IcebergManifest::readManifestList(std::string_view data) {
+    AvroFile file = AvroContainer::read(data);
+    std::vector<IcebergManifestFile> manifests;
+    manifests.reserve(file.records.size());
+    for (const auto& record : file.records) {
+        IcebergManifestFile manifest;
+        manifest.manifest_path = record["manifest_path"].asString();
+        if (manifest.manifest_path.empty()) {
+            throw std::runtime_error("Manifest list entry without manifest_path");
+        }
+        manifest.manifest_length = record["manifest_length"].asInt();
+        manifest.partition_spec_id = static_cast<int32_t>(record["partition_spec_id"].asInt());
+        manifest.content = static_cast<int32_t>(record["content"].asInt());
+        manifest.sequence_number = record["sequence_number"].asInt();
+        manifest.min_sequence_number = record["min_sequence_number"].asInt();
+        manifest.added_snapshot_id = record["added_snapshot_id"].asInt();
+        manifest.added_files_count = static_cast<int32_t>(countField(record, "added_files_count", "added_data_files_count"));
+        manifest.existing_files_count = static_cast<int32_t>(countField(record, "existing_files_count", "existing_data_files_count"));
+        manifest.deleted_files_count = static_cast<int32_t>(countField(record, "deleted_files_count", "deleted_data_files_count"));
+        manifest.added_rows_count = record["added_rows_count"].asInt();
+        manifest.existing_rows_count = record["existing_rows_count"].asInt();
+        manifest.deleted_rows_count = record["deleted_rows_count"].asInt();
+        manifest.partitions = record["partitions"];
+        manifest.key_metadata = record["key_metadata"];
+        manifests.push_back(std::move(manifest));
+    }
+    return manifests;
+}
+
+std::vector<IcebergDataFile> IcebergManifest::readManifest(std::string_view data) {
+    AvroFile file = AvroContainer::read(data);
+    std::vector<IcebergDataFile> files;
+    for (const auto& record : file.records) {
+        const JsonValue& data_file = record["data_file"];
+        IcebergDataFile entry;
+        entry.file_path = data_file["file_path"].asString();
+        entry.record_count = data_file["record_count"].asInt();
+        entry.file_size_in_bytes = data_file["file_size_in_bytes"].asInt();
+        auto to_int = [](const JsonValue& v) { return v.asInt(); };
+        auto to_bytes = [](const JsonValue& v) { return v.asString(); };
+        readIntMap(data_file["value_counts"], entry.value_counts, to_int);
+        readIntMap(data_file["null_value_counts"], entry.null_value_counts, to_int);
+        readIntMap(data_file["lower_bounds"], entry.lower_bounds, to_bytes);
+        readIntMap(data_file["upper_bounds"], entry.upper_bounds, to_bytes);
+        files.push_back(std::move(entry));
+    }
+    return files;
+}
+
+std::string IcebergManifest::longBound(int64_t value) {
+    std::string out(8, '\0');
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+    }
+    return out;
+}
+
+std::string IcebergManifest::intBound(int32_t value) {
+    std::string out(4, '\0');
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>(static_cast<uint32_t>(value) >> (8 * i));
+    }
+    return out;
+}
+
+int64_t IcebergManifest::parseLongBound(std::string_view bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes.size() && i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+    }
+    return static_cast<int64_t>(value);
+}
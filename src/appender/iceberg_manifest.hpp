@@ -0,0 +1,70 @@
+#ifndef ICEBERG_MANIFEST_HPP
+#define ICEBERG_MANIFEST_HPP
+
+#include "json_value.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A data file added to an (unpartitioned) Iceberg table
+struct IcebergDataFile {
+    std::string file_path;
+    int64_t record_count = 0;
+    int64_t file_size_in_bytes = 0;
+
+    // Optional column metrics keyed by field id; bounds use Iceberg's
+    // single-value binary serialization (see IcebergManifest::longBound)
+    std::map<int, int64_t> value_counts;
+    std::map<int, int64_t> null_value_counts;
+    std::map<int, std::string> lower_bounds;
+    std::map<int, std::string> upper_bounds;
+};
+
+// One entry of a manifest list
+struct IcebergManifestFile {
+    std::string manifest_path;
+    int64_t manifest_length = 0;
+    int32_t partition_spec_id = 0;
+    int32_t content = 0;                 // 0 data, 1 deletes
+    int64_t sequence_number = 0;
+    int64_t min_sequence_number = 0;
+    int64_t added_snapshot_id = 0;
+    int32_t added_files_count = 0;
+    int32_t existing_files_count = 0;
+    int32_t deleted_files_count = 0;
+    int64_t added_rows_count = 0;
+    int64_t existing_rows_count = 0;
+    int64_t deleted_rows_count = 0;
+    JsonValue partitions;                // Field summaries as read, or null
+    JsonValue key_metadata;              // Bytes as a string, or null
+};
+
+// Avro manifests and manifest lists (table format v2)
+class IcebergManifest {
+public:
+    // Manifest listing `files` as ADDED data files
+    // Snapshot id and sequence numbers are left null so they are inherited from
+    // the manifest list entry: a commit rebased onto a newer snapshot reuses the
+    // manifest and only rewrites the manifest list.
+    static std::string writeManifest(const std::vector<IcebergDataFile>& files,
+                                     const JsonValue& table_schema,
+                                     int32_t partition_spec_id);
+
+    static std::string writeManifestList(const std::vector<IcebergManifestFile>& manifests,
+                                         int64_t snapshot_id,
+                                         int64_t parent_snapshot_id,  // -1 for none
+                                         int64_t sequence_number);
+
+    // Throw std::runtime_error on malformed files
+    static std::vector<IcebergManifestFile> readManifestList(std::string_view data);
+    static std::vector<IcebergDataFile> readManifest(std::string_view data);
+
+    // Single-value serialization of a long or timestamp bound (8 bytes, little endian)
+    static std::string longBound(int64_t value);
+    static std::string intBound(int32_t value);  // 4 bytes, little endian
+    static int64_t parseLongBound(std::string_view bytes);
+};
+
+#endif // ICEBERG_MANIFEST_HPP
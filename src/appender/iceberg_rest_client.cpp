@@ -0,0 +1,579 @@
+#include "iceberg_rest_client.hpp"
+#include "http_client.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace {
+
+const char* kOffsetSummaryPrefix = "otel-kafka-offset/";
+
+HttpResponse catalogRequest(const std::string& method, const std::string& url, const std::string& body = "") {
+    HttpClient::Request request;
+    request.method = method;
+    request.url = url;
+    request.body = body;
+    request.headers = {"Accept: application/json"};
+    if (!body.empty()) {
+        request.headers.push_back("Content-Type: application/json");
+    }
+    return HttpClient::send(request);
+}
+
+bool startsWith(const std::string& value, const std::string& prefix) {
+    return value.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Summary totals are optional; carry them forward only when the parent has them
+void addTotal(JsonValue& summary, const JsonValue& parent_summary, bool has_parent,
+              const char* name, int64_t added) {
+    const JsonValue& parent_total = parent_summary[name];
+    if (has_parent && !parent_total.isString()) {
+        return;
+    }
+    summary.set(name, std::to_string(parent_total.asInt(0) + added));
+}
+
+}  // namespace
+
+IcebergRestClient::IcebergRestClient(const AppenderConfig& config)
+    : config_(config)
+    , file_io_(IcebergFileIO::S3Options{config.s3_endpoint, config.s3_access_key, config.s3_secret_key, "us-east-1"})
+    , catalog_uri_(config.iceberg_catalog_uri) {
+    while (!catalog_uri_.empty() && catalog_uri_.back() == '/') {
+        catalog_uri_.pop_back();
+    }
+}
+
+bool IcebergRestClient::fetchConfig() {
+    std::string url = catalog_uri_ + "/v1/config";
+    if (!config_.iceberg_warehouse.empty()) {
+        url += "?warehouse=" + HttpClient::urlEncode(config_.iceberg_warehouse);
+    }
+
+    HttpResponse response = catalogRequest("GET", url);
+    if (response.status != 200) {
+        std::cerr << "Failed to fetch Iceberg catalog config from " << url << ": "
+                  << (response.error.empty() ? "HTTP " + std::to_string(response.status) : response.error)
+                  << std::endl;
+        return false;
+    }
+
+    try {
+        JsonValue body = JsonValue::parse(response.body);
+        // Overrides win over defaults; the prefix scopes every other route
+        std::string prefix = body["overrides"]["prefix"].asString();
+        if (prefix.empty()) {
+            prefix = body["defaults"]["prefix"].asString();
+        }
+
+        std::string path = "/v1/";
+        if (!prefix.empty()) {
+            path += HttpClient::urlEncode(prefix) + "/";
+        }
+        path += "namespaces/default/tables/" + HttpClient::urlEncode(config_.iceberg_table_name);
+
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        table_path_ = path;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid Iceberg catalog config: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool IcebergRestClient::loadTable() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        path = table_path_;
+    }
+    if (path.empty()) {
+        if (!fetchConfig()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        path = table_path_;
+    }
+
+    HttpResponse response = catalogRequest("GET", catalog_uri_ + path);
+    if (response.status != 200) {
+        std::cerr << "Failed to load Iceberg table " << config_.iceberg_table_name << ": "
+                  << (response.error.empty() ? "HTTP " + std::to_string(response.status) : response.error)
+                  << std::endl;
+        return false;
+    }
+
+    try {
+        return parseTable(JsonValue::parse(response.body)["metadata"]);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid Iceberg table metadata: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool IcebergRestClient::parseTable(const JsonValue& metadata) {
+    IcebergTableState state;
+    state.location = metadata["location"].asString();
+    state.table_uuid = metadata["table-uuid"].asString();
+    state.format_version = static_cast<int>(metadata["format-version"].asInt());
+    state.last_sequence_number = metadata["last-sequence-number"].asInt();
+    state.default_spec_id = static_cast<int32_t>(metadata["default-spec-id"].asInt());
+    state.snapshots = metadata["snapshots"];
+
+    while (!state.location.empty() && state.location.back() == '/') {
+        state.location.pop_back();
+    }
+    if (state.location.empty() || state.table_uuid.empty()) {
+        std::cerr << "Iceberg table metadata without location or table-uuid" << std::endl;
+        return false;
+    }
+    if (state.format_version != 2) {
+        std::cerr << "Iceberg table format v" << state.format_version
+                  << " is not supported for REST commits (v2 required)" << std::endl;
+        return false;
+    }
+
+    // The main branch is the head; current-snapshot-id mirrors it
+    state.current_snapshot_id = metadata["current-snapshot-id"].asInt(-1);
+    const JsonValue* main_ref = metadata["refs"].find("main");
+    if (main_ref) {
+        state.current_snapshot_id = (*main_ref)["snapshot-id"].asInt(-1);
+    }
+    for (const auto& snapshot : state.snapshots.items()) {
+        if (snapshot["snapshot-id"].asInt(-1) == state.current_snapshot_id) {
+            state.manifest_list = snapshot["manifest-list"].asString();
+            state.current_summary = snapshot["summary"];
+        }
+    }
+    if (state.current_snapshot_id >= 0 && state.manifest_list.empty()) {
+        std::cerr << "Iceberg snapshot " << state.current_snapshot_id
+                  << " has no manifest list" << std::endl;
+        return false;
+    }
+
+    for (const auto& spec : metadata["partition-specs"].items()) {
+        if (spec["spec-id"].asInt() == state.default_spec_id) {
+            state.partitioned = spec["fields"].size() > 0;
+        }
+    }
+    if (state.partitioned) {
+        std::cerr << "Partitioned Iceberg tables are not supported for REST commits" << std::endl;
+        return false;
+    }
+
+    int64_t schema_id = metadata["current-schema-id"].asInt();
+    for (const auto& schema : metadata["schemas"].items()) {
+        if (schema["schema-id"].asInt() == schema_id) {
+            state.current_schema = schema;
+        }
+    }
+    for (const auto& field : state.current_schema["fields"].items()) {
+        const std::string& name = field["name"].asString();
+        state.field_ids[name] = static_cast<int>(field["id"].asInt());
+        const JsonValue& type = field["type"];
+        if (type.isObject() && type["type"].asString() == "map") {
+            state.field_ids[name + ".key"] = static_cast<int>(type["key-id"].asInt());
+            state.field_ids[name + ".value"] = static_cast<int>(type["value-id"].asInt());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    state_ = std::move(state);
+    return true;
+}
+
+IcebergTableState IcebergRestClient::tableState() const {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return state_;
+}
+
+std::map<std::string, int> IcebergRestClient::fieldIds() const {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return state_.field_ids;
+}
+
+bool IcebergRestClient::uploadDataFile(const std::string& local_path, std::string& uri) {
+    std::string location;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        location = state_.location;
+    }
+    if (location.empty()) {
+        if (!loadTable()) {
+            return false;
+        }
+        location = tableState().location;
+    }
+
+    // Local names are only unique on this host (pids repeat across pods), so
+    // the object name gets a random UUID
+    std::string name = local_path.substr(local_path.find_last_of('/') + 1);
+    size_t dot = name.rfind('.');
+    uri = location + "/data/" + name.substr(0, dot) + "-" + randomUuid() +
+          (dot == std::string::npos ? "" : name.substr(dot));
+    return file_io_.upload(local_path, uri);
+}
+
+bool IcebergRestClient::appendFiles(const std::vector<IcebergDataFile>& files,
+                                    const std::map<int32_t, int64_t>& offsets,
+                                    const std::string& topic) {
+    if (files.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+
+    if (tableState().table_uuid.empty() && !loadTable()) {
+        return false;
+    }
+    IcebergTableState state = tableState();
+
+    // The manifest is written once and reused by every attempt
+    IcebergManifestFile manifest;
+    manifest.manifest_path = state.location + "/metadata/" + randomUuid() + "-m0.avro";
+    manifest.partition_spec_id = state.default_spec_id;
+    manifest.added_files_count = static_cast<int32_t>(files.size());
+    manifest.partitions = JsonValue::array();
+    for (const auto& file : files) {
+        manifest.added_rows_count += file.record_count;
+    }
+
+    std::string manifest_data = IcebergManifest::writeManifest(files, state.current_schema, state.default_spec_id);
+    manifest.manifest_length = static_cast<int64_t>(manifest_data.size());
+    if (!file_io_.write(manifest.manifest_path, manifest_data)) {
+        return false;
+    }
+
+    // One id for all attempts, so a commit that went through despite an
+    // error can be recognized after reloading
+    int64_t snapshot_id = newSnapshotId(state);
+    bool maybe_committed = false;
+    int attempts = std::max(1, config_.iceberg_commit_retries);
+    int attempted = 0;
+
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+        attempted++;
+        std::string manifest_list_uri;
+        CommitResult result = commitSnapshot(manifest, files, offsets, topic, snapshot_id, attempt, manifest_list_uri);
+
+        if (result == CommitResult::COMMITTED) {
+            std::cout << "Committed Iceberg snapshot " << snapshot_id << " (" << files.size() << " file(s), "
+                      << manifest.added_rows_count << " records"
+                      << (attempt > 0 ? ", " + std::to_string(attempt) + " retries" : "") << ")" << std::endl;
+            return true;
+        }
+        if (result == CommitResult::UNKNOWN) {
+            maybe_committed = true;
+        } else if (!manifest_list_uri.empty()) {
+            file_io_.remove(manifest_list_uri);
+        }
+        if (result == CommitResult::FAILED) {
+            break;
+        }
+
+        // Rebase onto the current head (or find our snapshot already there)
+        if (loadTable() && maybe_committed) {
+            IcebergTableState current = tableState();
+            for (const auto& snapshot : current.snapshots.items()) {
+                if (snapshot["snapshot-id"].asInt(-1) == snapshot_id) {
+                    std::cout << "Iceberg snapshot " << snapshot_id << " was committed despite the error" << std::endl;
+                    return true;
+                }
+            }
+        }
+
+        // A conflict is retried right away; anything else waits first
+        if (result != CommitResult::CONFLICT && attempt + 1 < attempts) {
+            std::this_thread::sleep_for(backoff(attempt));
+        }
+    }
+
+    std::cerr << "Giving up on Iceberg commit of " << files.size() << " file(s) after "
+              << attempted << " attempt(s)" << std::endl;
+    if (!maybe_committed) {
+        file_io_.remove(manifest.manifest_path);
+    }
+    return false;
+}
+
+IcebergRestClient::CommitResult IcebergRestClient::commitSnapshot(const IcebergManifestFile& manifest,
+                                                                  const std::vector<IcebergDataFile>& files,
+                                                                  const std::map<int32_t, int64_t>& offsets,
+                                                                  const std::string& topic,
+                                                                  int64_t snapshot_id,
+                                                                  int attempt,
+                                                                  std::string& manifest_list_uri) {
+    IcebergTableState state = tableState();
+    bool has_parent = state.current_snapshot_id >= 0;
+    int64_t sequence_number = state.last_sequence_number + 1;
+
+    // New manifest first, then everything the parent snapshot had
+    std::vector<IcebergManifestFile> manifests;
+    manifests.push_back(manifest);
+    manifests.back().sequence_number = sequence_number;
+    manifests.back().min_sequence_number = sequence_number;
+    manifests.back().added_snapshot_id = snapshot_id;
+    if (has_parent) {
+        std::string parent_list;
+        if (!file_io_.read(state.manifest_list, parent_list)) {
+            return CommitResult::RETRY;
+        }
+        try {
+            for (auto& parent : IcebergManifest::readManifestList(parent_list)) {
+                manifests.push_back(std::move(parent));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid manifest list " << state.manifest_list << ": " << e.what() << std::endl;
+            return CommitResult::FAILED;
+        }
+    }
+
+    manifest_list_uri = state.location + "/metadata/snap-" + std::to_string(snapshot_id) + "-" +
+                        std::to_string(attempt) + "-" + randomUuid() + ".avro";
+    std::string list_data = IcebergManifest::writeManifestList(
+        manifests, snapshot_id, has_parent ? state.current_snapshot_id : -1, sequence_number);
+    if (!file_io_.write(manifest_list_uri, list_data)) {
+        manifest_list_uri.clear();
+        return CommitResult::RETRY;
+    }
+
+    int64_t added_bytes = 0;
+    for (const auto& file : files) {
+        added_bytes += file.file_size_in_bytes;
+    }
+
+    JsonValue summary = JsonValue::object();
+    summary.set("operation", "append");
+    summary.set("added-data-files", std::to_string(files.size()));
+    summary.set("added-records", std::to_string(manifest.added_rows_count));
+    summary.set("added-files-size", std::to_string(added_bytes));
+    addTotal(summary, state.current_summary, has_parent, "total-data-files", static_cast<int64_t>(files.size()));
+    addTotal(summary, state.current_summary, has_parent, "total-records", manifest.added_rows_count);
+    addTotal(summary, state.current_summary, has_parent, "total-files-size", added_bytes);
+
+    // Offsets of every partition carry forward; ours only ever move ahead
+    for (const auto& member : state.current_summary.members()) {
+        if (startsWith(member.first, kOffsetSummaryPrefix)) {
+            summary.set(member.first, member.second);
+        }
+    }
+    for (const auto& kv : offsets) {
+        std::string key = offsetSummaryKey(topic, kv.first);
+        if (kv.second > summary[key].asInt(-1)) {
+            summary.set(key, std::to_string(kv.second));
+        }
+    }
+
+    JsonValue snapshot = JsonValue::object();
+    snapshot.set("snapshot-id", snapshot_id);
+    if (has_parent) {
+        snapshot.set("parent-snapshot-id", state.current_snapshot_id);
+    }
+    snapshot.set("sequence-number", sequence_number);
+    snapshot.set("timestamp-ms", static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    snapshot.set("manifest-list", manifest_list_uri);
+    snapshot.set("summary", std::move(summary));
+    snapshot.set("schema-id", state.current_schema["schema-id"].asInt());
+
+    JsonValue assert_uuid = JsonValue::object();
+    assert_uuid.set("type", "assert-table-uuid");
+    assert_uuid.set("uuid", state.table_uuid);
+
+    // Fails with 409 if main moved since the table was loaded
+    JsonValue assert_head = JsonValue::object();
+    assert_head.set("type", "assert-ref-snapshot-id");
+    assert_head.set("ref", "main");
+    assert_head.set("snapshot-id", has_parent ? JsonValue(state.current_snapshot_id) : JsonValue(nullptr));
+
+    JsonValue add_snapshot = JsonValue::object();
+    add_snapshot.set("action", "add-snapshot");
+    add_snapshot.set("snapshot", std::move(snapshot));
+
+    JsonValue set_ref = JsonValue::object();
+    set_ref.set("action", "set-snapshot-ref");
+    set_ref.set("ref-name", "main");
+    set_ref.set("type", "branch");
+    set_ref.set("snapshot-id", snapshot_id);
+
+    JsonValue requirements = JsonValue::array();
+    requirements.push(std::move(assert_uuid));
+    requirements.push(std::move(assert_head));
+    JsonValue updates = JsonValue::array();
+    updates.push(std::move(add_snapshot));
+    updates.push(std::move(set_ref));
+
+    JsonValue body = JsonValue::object();
+    body.set("requirements", std::move(requirements));
+    body.set("updates", std::move(updates));
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        path = table_path_;
+    }
+    HttpResponse response = catalogRequest("POST", catalog_uri_ + path, body.dump());
+
+    if (response.status == 200) {
+        try {
+            parseTable(JsonValue::parse(response.body)["metadata"]);
+        } catch (const std::exception&) {
+            // Committed regardless; the next load picks up the metadata
+        }
+        return CommitResult::COMMITTED;
+    }
+    if (response.status == 409) {
+        std::cout << "Iceberg commit conflict on snapshot " << state.current_snapshot_id
+                  << ", rebasing" << std::endl;
+        return CommitResult::CONFLICT;
+    }
+    if (response.status == 0 || response.status >= 500) {
+        std::cerr << "Iceberg commit outcome unknown: "
+                  << (response.error.empty() ? "HTTP " + std::to_string(response.status) : response.error)
+                  << std::endl;
+        return CommitResult::UNKNOWN;
+    }
+    std::cerr << "Iceberg commit rejected (HTTP " << response.status << "): " << response.body << std::endl;
+    return CommitResult::FAILED;
+}
+
+bool IcebergRestClient::committedOffsets(const std::string& topic, std::map<int32_t, int64_t>& offsets) {
+    if (!loadTable()) {
+        return false;
+    }
+
+    // Any snapshot may hold the newest offset, e.g. when a writer that does
+    // not carry the keys forward committed after us
+    std::string prefix = kOffsetSummaryPrefix + topic + "/";
+    IcebergTableState state = tableState();
+    for (const auto& snapshot : state.snapshots.items()) {
+        for (const auto& member : snapshot["summary"].members()) {
+            if (!startsWith(member.first, prefix)) {
+                continue;
+            }
+            int32_t partition = static_cast<int32_t>(std::atoi(member.first.c_str() + prefix.size()));
+            int64_t offset = member.second.asInt(-1);
+            auto it = offsets.find(partition);
+            if (offset >= 0 && (it == offsets.end() || offset > it->second)) {
+                offsets[partition] = offset;
+            }
+        }
+    }
+    return true;
+}
+
+bool IcebergRestClient::offsetsFromFileBounds(const std::string& topic, std::map<int32_t, int64_t>& offsets) {
+    if (!loadTable()) {
+        return false;
+    }
+    IcebergTableState state = tableState();
+    if (state.current_snapshot_id < 0) {
+        return true;  // Empty table
+    }
+
+    auto id = [&state](const char* column) {
+        auto it = state.field_ids.find(column);
+        return it == state.field_ids.end() ? -1 : it->second;
+    };
+    int topic_id = id("_kafka_topic");
+    int partition_id = id("_kafka_partition");
+    int offset_id = id("_kafka_offset");
+    if (topic_id < 0 || partition_id < 0 || offset_id < 0) {
+        std::cerr << "Iceberg table has no Kafka offset columns" << std::endl;
+        return false;
+    }
+
+    try {
+        std::string list_data;
+        if (!file_io_.read(state.manifest_list, list_data)) {
+            return false;
+        }
+        for (const auto& manifest : IcebergManifest::readManifestList(list_data)) {
+            if (manifest.content != 0) {
+                continue;  // Deleted rows only lower the true maximum; skipping them is still safe
+            }
+            std::string manifest_data;
+            if (!file_io_.read(manifest.manifest_path, manifest_data)) {
+                return false;
+            }
+            for (const auto& file : IcebergManifest::readManifest(manifest_data)) {
+                auto topic_lower = file.lower_bounds.find(topic_id);
+                auto topic_upper = file.upper_bounds.find(topic_id);
+                auto partition_lower = file.lower_bounds.find(partition_id);
+                auto partition_upper = file.upper_bounds.find(partition_id);
+                auto offset_upper = file.upper_bounds.find(offset_id);
+                if (topic_lower == file.lower_bounds.end() || topic_upper == file.upper_bounds.end() ||
+                    partition_lower == file.lower_bounds.end() || partition_upper == file.upper_bounds.end() ||
+                    offset_upper == file.upper_bounds.end()) {
+                    std::cerr << "Data file " << file.file_path << " has no Kafka column bounds" << std::endl;
+                    return false;
+                }
+                // String bounds may be truncated; any file whose range covers the topic counts
+                if (topic < topic_lower->second || topic > topic_upper->second) {
+                    continue;
+                }
+                if (partition_lower->second != partition_upper->second) {
+                    std::cerr << "Data file " << file.file_path << " spans Kafka partitions" << std::endl;
+                    return false;
+                }
+                int32_t partition = static_cast<int32_t>(IcebergManifest::parseLongBound(partition_lower->second));
+                int64_t offset = IcebergManifest::parseLongBound(offset_upper->second);
+                auto it = offsets.find(partition);
+                if (it == offsets.end() || offset > it->second) {
+                    offsets[partition] = offset;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid manifest in " << state.manifest_list << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string IcebergRestClient::offsetSummaryKey(const std::string& topic, int32_t partition) {
+    return kOffsetSummaryPrefix + topic + "/" + std::to_string(partition);
+}
+
+int64_t IcebergRestClient::newSnapshotId(const IcebergTableState& state) const {
+    static thread_local std::mt19937_64 gen(std::random_device{}());
+    while (true) {
+        int64_t id = static_cast<int64_t>(gen() & 0x7FFFFFFFFFFFFFFFULL);
+        bool taken = id == 0;
+        for (const auto& snapshot : state.snapshots.items()) {
+            taken = taken || snapshot["snapshot-id"].asInt(-1) == id;
+        }
+        if (!taken) {
+            return id;
+        }
+    }
+}
+
+std::chrono::milliseconds IcebergRestClient::backoff(int attempt) const {
+    int delay = config_.iceberg_retry_base_delay_ms * (1 << std::min(attempt, 16));
+    delay = std::min(delay, config_.iceberg_retry_max_delay_ms);
+
+    static thread_local std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<> dist(0, std::max(0, delay / 2));
+    return std::chrono::milliseconds(delay + dist(gen));
+}
+
+std::string IcebergRestClient::randomUuid() {
+    static thread_local std::mt19937_64 gen(std::random_device{}());
+    uint64_t high = gen();
+    uint64_t low = gen();
+    high = (high & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;  // Version 4
+    low = (low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;    // RFC 4122 variant
+
+    char out[37];
+    std::snprintf(out, sizeof(out), "%08x-%04x-%04x-%04x-%012llx",
+                  static_cast<unsigned>(high >> 32),
+                  static_cast<unsigned>((high >> 16) & 0xFFFF),
+                  static_cast<unsigned>(high & 0xFFFF),
+                  static_cast<unsigned>(low >> 48),
+                  static_cast<unsigned long long>(low & 0xFFFFFFFFFFFFULL));
+    return out;
+}
@@ -0,0 +1,119 @@
+#ifndef ICEBERG_REST_CLIENT_HPP
+#define ICEBERG_REST_CLIENT_HPP
+
+#include "../config.hpp"
+#include "iceberg_file_io.hpp"
+#include "iceberg_manifest.hpp"
+#include "json_value.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// What the client needs to know about the table, from its last load or commit
+struct IcebergTableState {
+    std::string location;                 // Table root, e.g. s3://bucket/warehouse/default/logs
+    std::string table_uuid;
+    int format_version = 0;
+    int64_t current_snapshot_id = -1;     // Head of the main branch, -1 for an empty table
+    int64_t last_sequence_number = 0;
+    int32_t default_spec_id = 0;
+    bool partitioned = false;
+    JsonValue current_schema;
+    std::string manifest_list;            // Manifest list of the current snapshot
+    JsonValue current_summary;            // Summary of the current snapshot
+    std::map<std::string, int> field_ids; // Column path ("attributes.key") -> field id
+    JsonValue snapshots;                  // All snapshots still in the metadata
+};
+
+// Iceberg REST catalog client that commits pre-written data files with
+// fast-append, instead of going through DuckDB's iceberg extension
+//
+// A commit writes one manifest for the new data files and a manifest list
+// that puts it in front of the current snapshot's manifests, then asks the
+// catalog to move main from the snapshot it was based on to the new one.
+// If another writer got there first (409) the table is reloaded and only the
+// manifest list is rewritten on top of the new head: the manifest leaves
+// snapshot id and sequence numbers to inheritance, so neither it nor the data
+// files are written again. A 5xx or lost response leaves the outcome unknown;
+// the table is reloaded and the commit counts as done if the snapshot is there.
+//
+// Kafka offsets covered by a commit are stored in the snapshot summary
+// (otel-kafka-offset/<topic>/<partition>) and carried forward from the parent,
+// so data and offsets land in the same atomic metadata swap.
+//
+// Only unpartitioned format v2 tables are supported. Commits from one process
+// are serialized; they would only conflict with each other otherwise.
+class IcebergRestClient {
+public:
+    explicit IcebergRestClient(const AppenderConfig& config);
+
+    // Fetch catalog config (once) and the table metadata
+    // Fails for tables this client cannot append to
+    bool loadTable();
+
+    IcebergTableState tableState() const;
+    std::map<std::string, int> fieldIds() const;
+
+    // Copy a finished local data file into the table's data directory, under
+    // its local name plus a random UUID
+    bool uploadDataFile(const std::string& local_path, std::string& uri);
+
+    // Fast-append `files` in one snapshot that also records `offsets`
+    // (partition -> max offset) for `topic`
+    bool appendFiles(const std::vector<IcebergDataFile>& files,
+                     const std::map<int32_t, int64_t>& offsets,
+                     const std::string& topic);
+
+    // Highest offset recorded per partition of `topic` across all snapshots
+    // Reloads the table first
+    bool committedOffsets(const std::string& topic, std::map<int32_t, int64_t>& offsets);
+
+    static std::string offsetSummaryKey(const std::string& topic, int32_t partition);
+
+    // Highest offset per partition of `topic` from the _kafka_offset upper
+    // bounds of the current snapshot's data files, for tables written without
+    // recorded offsets; reads manifests only, never data files
+    // Each data file must hold a single partition (one flush). Fails if a file
+    // lacks the bounds or spans partitions, so the caller can scan instead.
+    bool offsetsFromFileBounds(const std::string& topic, std::map<int32_t, int64_t>& offsets);
+
+private:
+    enum class CommitResult {
+        COMMITTED,
+        CONFLICT,   // Requirements failed; rebase and retry
+        RETRY,      // Nothing was committed (e.g. storage error); retry after a pause
+        UNKNOWN,    // 5xx or no response; the snapshot may or may not be in
+        FAILED      // Rejected for good
+    };
+
+    const AppenderConfig& config_;
+    IcebergFileIO file_io_;
+    std::string catalog_uri_;
+    std::string table_path_;   // /v1/{prefix}/namespaces/default/tables/{table}, once configured
+
+    IcebergTableState state_;
+    mutable std::mutex state_mutex_;
+    std::mutex commit_mutex_;  // One commit at a time
+
+    bool fetchConfig();
+    bool parseTable(const JsonValue& metadata);
+
+    // Build and send one commit for the current state
+    CommitResult commitSnapshot(const IcebergManifestFile& manifest,
+                                const std::vector<IcebergDataFile>& files,
+                                const std::map<int32_t, int64_t>& offsets,
+                                const std::string& topic,
+                                int64_t snapshot_id,
+                                int attempt,
+                                std::string& manifest_list_uri);
+
+    int64_t newSnapshotId(const IcebergTableState& state) const;
+    std::chrono::milliseconds backoff(int attempt) const;
+    static std::string randomUuid();
+};
+
+#endif // ICEBERG_REST_CLIENT_HPP
@@ -3,6 +3,31 @@
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <algorithm>
+
+namespace {
+
+// Column positions in the buffer table (must match createBufferTable)
+enum BufferColumn : size_t {
+    COL_KAFKA_TOPIC = 0,
+    COL_KAFKA_PARTITION,
+    COL_KAFKA_OFFSET,
+    COL_TIMESTAMP,
+    COL_SEVERITY,
+    COL_BODY,
+    COL_TRACE_ID,
+    COL_SPAN_ID,
+    COL_SERVICE_NAME,
+    COL_DEPLOYMENT_ENVIRONMENT,
+    COL_HOST_NAME,
+    COL_ATTRIBUTES,
+};
+
+inline duckdb::string_t addString(duckdb::Vector& vec, std::string_view str) {
+    return duckdb::StringVector::AddString(vec, str.data(), str.size());
+}
+
+} // namespace
 
 std::string IcebergUtils::escapeSqlString(const std::string& str) {
     std::string result;
@@ -219,6 +244,26 @@ std::string IcebergUtils::buildInsertSQL(const std::vector<TransformedLogRecord>
     return sql.str();
 }
 
+size_t IcebergUtils::estimateBatchSize(const LogRecordBatch& batch) {
+    size_t rows = batch.size();
+    size_t estimated_size = rows * (batch.kafka_topic.size() + sizeof(int32_t) + sizeof(int64_t) + 100);
+    estimated_size += batch.severity.byteSize() + batch.body.byteSize() +
+                      batch.trace_id.byteSize() + batch.span_id.byteSize() +
+                      batch.attr_keys.byteSize() + batch.attr_values.byteSize();
+
+    // Resource-level values are charged once per row that references them
+    for (size_t i = 0; i < rows; ++i) {
+        uint32_t res = batch.resource_index[i];
+        estimated_size += batch.service_name.get(res).size() +
+                          batch.deployment_environment.get(res).size() +
+                          batch.host_name.get(res).size();
+        for (size_t a = batch.resource_attr_offsets[res]; a < batch.resource_attr_offsets[res + 1]; ++a) {
+            estimated_size += batch.resource_attr_keys.get(a).size() + batch.resource_attr_values.get(a).size();
+        }
+    }
+    return estimated_size;
+}
+
 size_t IcebergUtils::estimateRecordsSize(const std::vector<TransformedLogRecord>& records) {
     size_t estimated_size = 0;
     for (const auto& record : records) {
@@ -233,3 +278,206 @@ size_t IcebergUtils::estimateRecordsSize(const std::vector<TransformedLogRecord>
     }
     return estimated_size;
 }
+
+std::vector<duckdb::LogicalType> IcebergUtils::bufferTableTypes() {
+    return {
+        duckdb::LogicalType::VARCHAR,    // _kafka_topic
+        duckdb::LogicalType::INTEGER,    // _kafka_partition
+        duckdb::LogicalType::BIGINT,     // _kafka_offset
+        duckdb::LogicalType::TIMESTAMP,  // timestamp
+        duckdb::LogicalType::VARCHAR,    // severity
+        duckdb::LogicalType::VARCHAR,    // body
+        duckdb::LogicalType::VARCHAR,    // trace_id
+        duckdb::LogicalType::VARCHAR,    // span_id
+        duckdb::LogicalType::VARCHAR,    // service_name
+        duckdb::LogicalType::VARCHAR,    // deployment_environment
+        duckdb::LogicalType::VARCHAR,    // host_name
+        duckdb::LogicalType::MAP(duckdb::LogicalType::VARCHAR, duckdb::LogicalType::VARCHAR),
+    };
+}
+
+duckdb::timestamp_t IcebergUtils::toDuckDBTimestamp(const std::chrono::system_clock::time_point& tp) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch());
+    return duckdb::Timestamp::FromEpochMicroSeconds(micros.count());
+}
+
+bool IcebergUtils::appendRecords(Connection& conn,
+                                 const std::string& buffer_table_name,
+                                 const std::vector<TransformedLogRecord>& records) {
+    if (records.empty()) {
+        return true;
+    }
+
+    try {
+        duckdb::Appender appender(conn, buffer_table_name);
+
+        duckdb::DataChunk chunk;
+        chunk.Initialize(duckdb::Allocator::DefaultAllocator(), bufferTableTypes());
+
+        // DataChunks hold at most STANDARD_VECTOR_SIZE rows, so append in slices
+        for (size_t start = 0; start < records.size(); start += STANDARD_VECTOR_SIZE) {
+            size_t count = std::min<size_t>(STANDARD_VECTOR_SIZE, records.size() - start);
+            chunk.Reset();
+
+            auto& topic_vec = chunk.data[COL_KAFKA_TOPIC];
+            auto& severity_vec = chunk.data[COL_SEVERITY];
+            auto& body_vec = chunk.data[COL_BODY];
+            auto& trace_vec = chunk.data[COL_TRACE_ID];
+            auto& span_vec = chunk.data[COL_SPAN_ID];
+            auto& service_vec = chunk.data[COL_SERVICE_NAME];
+            auto& env_vec = chunk.data[COL_DEPLOYMENT_ENVIRONMENT];
+            auto& host_vec = chunk.data[COL_HOST_NAME];
+            auto& attrs_vec = chunk.data[COL_ATTRIBUTES];
+
+            auto* topics = duckdb::FlatVector::GetData<duckdb::string_t>(topic_vec);
+            auto* partitions = duckdb::FlatVector::GetData<int32_t>(chunk.data[COL_KAFKA_PARTITION]);
+            auto* offsets = duckdb::FlatVector::GetData<int64_t>(chunk.data[COL_KAFKA_OFFSET]);
+            auto* timestamps = duckdb::FlatVector::GetData<duckdb::timestamp_t>(chunk.data[COL_TIMESTAMP]);
+            auto* severities = duckdb::FlatVector::GetData<duckdb::string_t>(severity_vec);
+            auto* bodies = duckdb::FlatVector::GetData<duckdb::string_t>(body_vec);
+            auto* trace_ids = duckdb::FlatVector::GetData<duckdb::string_t>(trace_vec);
+            auto* span_ids = duckdb::FlatVector::GetData<duckdb::string_t>(span_vec);
+            auto* services = duckdb::FlatVector::GetData<duckdb::string_t>(service_vec);
+            auto* envs = duckdb::FlatVector::GetData<duckdb::string_t>(env_vec);
+            auto* hosts = duckdb::FlatVector::GetData<duckdb::string_t>(host_vec);
+            auto* attr_entries = duckdb::FlatVector::GetData<duckdb::list_entry_t>(attrs_vec);
+
+            // Size the MAP child vectors once for the whole slice
+            size_t total_attrs = 0;
+            for (size_t i = 0; i < count; ++i) {
+                total_attrs += records[start + i].attributes.size();
+            }
+            duckdb::ListVector::Reserve(attrs_vec, total_attrs);
+            auto& key_vec = duckdb::MapVector::GetKeys(attrs_vec);
+            auto& value_vec = duckdb::MapVector::GetValues(attrs_vec);
+            auto* keys = duckdb::FlatVector::GetData<duckdb::string_t>(key_vec);
+            auto* values = duckdb::FlatVector::GetData<duckdb::string_t>(value_vec);
+
+            size_t attr_offset = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const auto& record = records[start + i];
+
+                topics[i] = addString(topic_vec, record.kafka_topic);
+                partitions[i] = record.kafka_partition;
+                offsets[i] = record.kafka_offset;
+                timestamps[i] = toDuckDBTimestamp(record.timestamp);
+                severities[i] = addString(severity_vec, record.severity);
+                bodies[i] = addString(body_vec, record.body);
+                trace_ids[i] = addString(trace_vec, record.trace_id);
+                span_ids[i] = addString(span_vec, record.span_id);
+                services[i] = addString(service_vec, record.service_name);
+                envs[i] = addString(env_vec, record.deployment_environment);
+                hosts[i] = addString(host_vec, record.host_name);
+
+                attr_entries[i].offset = attr_offset;
+                attr_entries[i].length = record.attributes.size();
+                for (const auto& kv : record.attributes) {
+                    keys[attr_offset] = addString(key_vec, kv.first);
+                    values[attr_offset] = addString(value_vec, kv.second);
+                    ++attr_offset;
+                }
+            }
+            duckdb::ListVector::SetListSize(attrs_vec, total_attrs);
+
+            chunk.SetCardinality(count);
+            appender.AppendDataChunk(chunk);
+        }
+
+        appender.Close();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error appending to " << buffer_table_name << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool IcebergUtils::appendBatch(Connection& conn,
+                               const std::string& buffer_table_name,
+                               const LogRecordBatch& batch) {
+    if (batch.empty()) {
+        return true;
+    }
+
+    try {
+        duckdb::Appender appender(conn, buffer_table_name);
+
+        duckdb::DataChunk chunk;
+        chunk.Initialize(duckdb::Allocator::DefaultAllocator(), bufferTableTypes());
+
+        for (size_t start = 0; start < batch.size(); start += STANDARD_VECTOR_SIZE) {
+            size_t count = std::min<size_t>(STANDARD_VECTOR_SIZE, batch.size() - start);
+            chunk.Reset();
+
+            auto& topic_vec = chunk.data[COL_KAFKA_TOPIC];
+            auto& severity_vec = chunk.data[COL_SEVERITY];
+            auto& body_vec = chunk.data[COL_BODY];
+            auto& trace_vec = chunk.data[COL_TRACE_ID];
+            auto& span_vec = chunk.data[COL_SPAN_ID];
+            auto& service_vec = chunk.data[COL_SERVICE_NAME];
+            auto& env_vec = chunk.data[COL_DEPLOYMENT_ENVIRONMENT];
+            auto& host_vec = chunk.data[COL_HOST_NAME];
+            auto& attrs_vec = chunk.data[COL_ATTRIBUTES];
+
+            auto* topics = duckdb::FlatVector::GetData<duckdb::string_t>(topic_vec);
+            auto* partitions = duckdb::FlatVector::GetData<int32_t>(chunk.data[COL_KAFKA_PARTITION]);
+            auto* offsets = duckdb::FlatVector::GetData<int64_t>(chunk.data[COL_KAFKA_OFFSET]);
+            auto* timestamps = duckdb::FlatVector::GetData<duckdb::timestamp_t>(chunk.data[COL_TIMESTAMP]);
+            auto* severities = duckdb::FlatVector::GetData<duckdb::string_t>(severity_vec);
+            auto* bodies = duckdb::FlatVector::GetData<duckdb::string_t>(body_vec);
+            auto* trace_ids = duckdb::FlatVector::GetData<duckdb::string_t>(trace_vec);
+            auto* span_ids = duckdb::FlatVector::GetData<duckdb::string_t>(span_vec);
+            auto* services = duckdb::FlatVector::GetData<duckdb::string_t>(service_vec);
+            auto* envs = duckdb::FlatVector::GetData<duckdb::string_t>(env_vec);
+            auto* hosts = duckdb::FlatVector::GetData<duckdb::string_t>(host_vec);
+            auto* attr_entries = duckdb::FlatVector::GetData<duckdb::list_entry_t>(attrs_vec);
+
+            size_t max_attrs = 0;
+            for (size_t i = 0; i < count; ++i) {
+                max_attrs += batch.maxAttributeCount(start + i);
+            }
+            duckdb::ListVector::Reserve(attrs_vec, max_attrs);
+            auto& key_vec = duckdb::MapVector::GetKeys(attrs_vec);
+            auto& value_vec = duckdb::MapVector::GetValues(attrs_vec);
+            auto* keys = duckdb::FlatVector::GetData<duckdb::string_t>(key_vec);
+            auto* values = duckdb::FlatVector::GetData<duckdb::string_t>(value_vec);
+
+            duckdb::string_t topic = addString(topic_vec, batch.kafka_topic);
+
+            size_t attr_offset = 0;
+            for (size_t i = 0; i < count; ++i) {
+                size_t row = start + i;
+                uint32_t res = batch.resource_index[row];
+
+                topics[i] = topic;
+                partitions[i] = batch.kafka_partition;
+                offsets[i] = batch.kafka_offset[row];
+                timestamps[i] = toDuckDBTimestamp(batch.timestamp[row]);
+                severities[i] = addString(severity_vec, batch.severity.get(row));
+                bodies[i] = addString(body_vec, batch.body.get(row));
+                trace_ids[i] = addString(trace_vec, batch.trace_id.get(row));
+                span_ids[i] = addString(span_vec, batch.span_id.get(row));
+                services[i] = addString(service_vec, batch.service_name.get(res));
+                envs[i] = addString(env_vec, batch.deployment_environment.get(res));
+                hosts[i] = addString(host_vec, batch.host_name.get(res));
+
+                attr_entries[i].offset = attr_offset;
+                batch.forEachAttribute(row, [&](std::string_view key, std::string_view value) {
+                    keys[attr_offset] = addString(key_vec, key);
+                    values[attr_offset] = addString(value_vec, value);
+                    ++attr_offset;
+                });
+                attr_entries[i].length = attr_offset - attr_entries[i].offset;
+            }
+            duckdb::ListVector::SetListSize(attrs_vec, attr_offset);
+
+            chunk.SetCardinality(count);
+            appender.AppendDataChunk(chunk);
+        }
+
+        appender.Close();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error appending to " << buffer_table_name << ": " << e.what() << std::endl;
+        return false;
+    }
+}
@@ -44,8 +44,28 @@ public:
     static std::string buildInsertSQL(const std::vector<TransformedLogRecord>& records,
                                        const std::string& buffer_table_name);
 
+    // Append records into a buffer table through DuckDB's Appender using typed
+    // DataChunks (TIMESTAMP and MAP columns are written natively, no SQL text)
+    static bool appendRecords(Connection& conn,
+                              const std::string& buffer_table_name,
+                              const std::vector<TransformedLogRecord>& records);
+
+    // Append a columnar batch into a buffer table through DuckDB's Appender
+    static bool appendBatch(Connection& conn,
+                            const std::string& buffer_table_name,
+                            const LogRecordBatch& batch);
+
+    // Column types of the buffer table, in declaration order
+    static std::vector<duckdb::LogicalType> bufferTableTypes();
+
+    // Convert a time_point to a DuckDB timestamp (microseconds since epoch)
+    static duckdb::timestamp_t toDuckDBTimestamp(const std::chrono::system_clock::time_point& tp);
+
     // Estimate size of records in bytes
     static size_t estimateRecordsSize(const std::vector<TransformedLogRecord>& records);
+
+    // Estimate size of a columnar batch in bytes (same accounting as estimateRecordsSize)
+    static size_t estimateBatchSize(const LogRecordBatch& batch);
 };
 
 #endif // ICEBERG_UTILS_HPP
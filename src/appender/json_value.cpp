@@ -0,0 +1,408 @@
+#include "json_value.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+class Parser {
+public:
+    explicit Parser(std::string_view text) : text_(text), pos_(0) {}
+
+    JsonValue parseDocument() {
+        JsonValue value = parseValue(0);
+        skipWhitespace();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    static constexpr int kMaxDepth = 128;
+
+    std::string_view text_;
+    size_t pos_;
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("Invalid JSON: ") + what + " at offset " + std::to_string(pos_));
+    }
+
+    void skipWhitespace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail("unexpected character");
+        }
+    }
+
+    bool consumeLiteral(std::string_view literal) {
+        if (text_.substr(pos_, literal.size()) == literal) {
+            pos_ += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parseValue(int depth) {
+        if (depth > kMaxDepth) {
+            fail("nesting too deep");
+        }
+        skipWhitespace();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+
+        char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            JsonValue object = JsonValue::object();
+            if (consume('}')) {
+                return object;
+            }
+            do {
+                skipWhitespace();
+                if (pos_ >= text_.size() || text_[pos_] != '"') {
+                    fail("expected member name");
+                }
+                std::string key = parseString();
+                expect(':');
+                object.set(key, parseValue(depth + 1));
+            } while (consume(','));
+            expect('}');
+            return object;
+        }
+        if (c == '[') {
+            ++pos_;
+            JsonValue array = JsonValue::array();
+            if (consume(']')) {
+                return array;
+            }
+            do {
+                array.push(parseValue(depth + 1));
+            } while (consume(','));
+            expect(']');
+            return array;
+        }
+        if (c == '"') {
+            return JsonValue(parseString());
+        }
+        if (consumeLiteral("true")) {
+            return JsonValue(true);
+        }
+        if (consumeLiteral("false")) {
+            return JsonValue(false);
+        }
+        if (consumeLiteral("null")) {
+            return JsonValue();
+        }
+        return parseNumber();
+    }
+
+    JsonValue parseNumber() {
+        size_t start = pos_;
+        bool integral = true;
+        if (pos_ < text_.size() && text_[pos_] == '-') {
+            ++pos_;
+        }
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c >= '0' && c <= '9') {
+                ++pos_;
+            } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                integral = false;
+                ++pos_;
+            } else {
+                break;
+            }
+        }
+        std::string number(text_.substr(start, pos_ - start));
+        if (number.empty() || number == "-") {
+            fail("unexpected character");
+        }
+
+        char* end = nullptr;
+        errno = 0;
+        if (integral) {
+            long long value = std::strtoll(number.c_str(), &end, 10);
+            if (errno == 0 && *end == '\0') {
+                return JsonValue(static_cast<int64_t>(value));
+            }
+        }
+        errno = 0;
+        double value = std::strtod(number.c_str(), &end);
+        if (*end != '\0') {
+            fail("malformed number");
+        }
+        return JsonValue(value);
+    }
+
+    void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    uint32_t parseHex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("truncated escape");
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text_[pos_++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                fail("invalid escape");
+            }
+        }
+        return value;
+    }
+
+    std::string parseString() {
+        ++pos_;  // Opening quote
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            char c = text_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            char escape = text_[pos_++];
+            switch (escape) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp = parseHex4();
+                    if (cp >= 0xD800 && cp < 0xDC00 && consumeLiteral("\\u")) {
+                        uint32_t low = parseHex4();
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    fail("invalid escape");
+            }
+        }
+    }
+};
+
+void dumpString(std::string& out, const std::string& value) {
+    out.push_back('"');
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+}  // namespace
+
+JsonValue JsonValue::array() {
+    JsonValue value;
+    value.type_ = Type::ARRAY;
+    return value;
+}
+
+JsonValue JsonValue::object() {
+    JsonValue value;
+    value.type_ = Type::OBJECT;
+    return value;
+}
+
+JsonValue JsonValue::parse(std::string_view text) {
+    return Parser(text).parseDocument();
+}
+
+std::string JsonValue::dump() const {
+    std::string out;
+    dumpTo(out);
+    return out;
+}
+
+void JsonValue::dumpTo(std::string& out) const {
+    switch (type_) {
+        case Type::NUL:
+            out += "null";
+            break;
+        case Type::BOOL:
+            out += bool_ ? "true" : "false";
+            break;
+        case Type::INT:
+            out += std::to_string(int_);
+            break;
+        case Type::DOUBLE: {
+            if (!std::isfinite(double_)) {
+                out += "null";
+                break;
+            }
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.17g", double_);
+            out += buf;
+            break;
+        }
+        case Type::STRING:
+            dumpString(out, string_);
+            break;
+        case Type::ARRAY:
+            out.push_back('[');
+            for (size_t i = 0; i < items_.size(); ++i) {
+                if (i > 0) {
+                    out.push_back(',');
+                }
+                items_[i].dumpTo(out);
+            }
+            out.push_back(']');
+            break;
+        case Type::OBJECT:
+            out.push_back('{');
+            for (size_t i = 0; i < members_.size(); ++i) {
+                if (i > 0) {
+                    out.push_back(',');
+                }
+                dumpString(out, members_[i].first);
+                out.push_back(':');
+                members_[i].second.dumpTo(out);
+            }
+            out.push_back('}');
+            break;
+    }
+}
+
+bool JsonValue::asBool(bool fallback) const {
+    return type_ == Type::BOOL ? bool_ : fallback;
+}
+
+int64_t JsonValue::asInt(int64_t fallback) const {
+    if (type_ == Type::INT) {
+        return int_;
+    }
+    if (type_ == Type::DOUBLE) {
+        return static_cast<int64_t>(double_);
+    }
+    if (type_ == Type::STRING && !string_.empty()) {
+        char* end = nullptr;
+        long long value = std::strtoll(string_.c_str(), &end, 10);
+        if (*end == '\0') {
+            return value;
+        }
+    }
+    return fallback;
+}
+
+double JsonValue::asDouble(double fallback) const {
+    if (type_ == Type::DOUBLE) {
+        return double_;
+    }
+    if (type_ == Type::INT) {
+        return static_cast<double>(int_);
+    }
+    return fallback;
+}
+
+const std::string& JsonValue::asString() const {
+    static const std::string empty;
+    return type_ == Type::STRING ? string_ : empty;
+}
+
+void JsonValue::push(JsonValue value) {
+    items_.push_back(std::move(value));
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const {
+    for (const auto& member : members_) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+    static const JsonValue null_value;
+    const JsonValue* value = find(key);
+    return value ? *value : null_value;
+}
+
+JsonValue& JsonValue::set(const std::string& key, JsonValue value) {
+    for (auto& member : members_) {
+        if (member.first == key) {
+            member.second = std::move(value);
+            return member.second;
+        }
+    }
+    members_.emplace_back(key, std::move(value));
+    return members_.back().second;
+}
+
+size_t JsonValue::size() const {
+    if (type_ == Type::ARRAY) {
+        return items_.size();
+    }
+    if (type_ == Type::OBJECT) {
+        return members_.size();
+    }
+    return 0;
+}
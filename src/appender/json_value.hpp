@@ -0,0 +1,88 @@
+#ifndef JSON_VALUE_HPP
+#define JSON_VALUE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Small JSON document model for Iceberg REST catalog payloads and Avro schemas
+//
+// Integers are kept exact as int64 (snapshot ids use all 63 bits, which a
+// double cannot hold) and object members keep their order. Lookups on
+// missing members return a shared null value so nested access needs no checks.
+class JsonValue {
+public:
+    enum class Type {
+        NUL,
+        BOOL,
+        INT,
+        DOUBLE,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    using Member = std::pair<std::string, JsonValue>;
+
+    JsonValue() : type_(Type::NUL) {}
+    JsonValue(std::nullptr_t) : type_(Type::NUL) {}
+    JsonValue(bool value) : type_(Type::BOOL), bool_(value) {}
+    JsonValue(int value) : type_(Type::INT), int_(value) {}
+    JsonValue(int64_t value) : type_(Type::INT), int_(value) {}
+    JsonValue(double value) : type_(Type::DOUBLE), double_(value) {}
+    JsonValue(std::string value) : type_(Type::STRING), string_(std::move(value)) {}
+    JsonValue(const char* value) : type_(Type::STRING), string_(value) {}
+
+    static JsonValue array();
+    static JsonValue object();
+
+    // Parse a complete JSON document
+    // Throws std::runtime_error on malformed input
+    static JsonValue parse(std::string_view text);
+
+    // Compact serialization
+    std::string dump() const;
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::NUL; }
+    bool isBool() const { return type_ == Type::BOOL; }
+    bool isInt() const { return type_ == Type::INT; }
+    bool isNumber() const { return type_ == Type::INT || type_ == Type::DOUBLE; }
+    bool isString() const { return type_ == Type::STRING; }
+    bool isArray() const { return type_ == Type::ARRAY; }
+    bool isObject() const { return type_ == Type::OBJECT; }
+
+    // Conversions fall back to the given default on a type mismatch
+    bool asBool(bool fallback = false) const;
+    int64_t asInt(int64_t fallback = 0) const;
+    double asDouble(double fallback = 0.0) const;
+    const std::string& asString() const;  // Empty unless a string
+
+    // Arrays
+    const std::vector<JsonValue>& items() const { return items_; }
+    std::vector<JsonValue>& items() { return items_; }
+    void push(JsonValue value);
+
+    // Objects
+    const std::vector<Member>& members() const { return members_; }
+    const JsonValue* find(std::string_view key) const;
+    const JsonValue& operator[](std::string_view key) const;
+    JsonValue& set(const std::string& key, JsonValue value);  // Replaces an existing member
+
+    size_t size() const;
+
+private:
+    Type type_;
+    bool bool_ = false;
+    int64_t int_ = 0;
+    double double_ = 0.0;
+    std::string string_;
+    std::vector<JsonValue> items_;
+    std::vector<Member> members_;
+
+    void dumpTo(std::string& out) const;
+};
+
+#endif // JSON_VALUE_HPP
@@ -2,28 +2,241 @@
 #include "opentelemetry/proto/common/v1/common.pb.h"
 #include "opentelemetry/proto/resource/v1/resource.pb.h"
 #include "opentelemetry/proto/logs/v1/logs.pb.h"
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
+void StringColumn::appendColumn(const StringColumn& other) {
+    size_t base = data.size();
+    data.append(other.data);
+    offsets.reserve(offsets.size() + other.size());
+    for (size_t i = 1; i < other.offsets.size(); ++i) {
+        offsets.push_back(base + other.offsets[i]);
+    }
+}
+
+size_t LogRecordBatch::maxAttributeCount(size_t row) const {
+    uint32_t res = resource_index[row];
+    return (attr_offsets[row + 1] - attr_offsets[row]) +
+           (resource_attr_offsets[res + 1] - resource_attr_offsets[res]);
+}
+
+void LogRecordBatch::append(const TransformedLogRecord& record) {
+    if (empty()) {
+        kafka_topic = record.kafka_topic;
+        kafka_partition = record.kafka_partition;
+    }
+
+    // Consecutive records from the same resource share one resource entry
+    size_t res_count = resourceCount();
+    bool reuse_resource = res_count > 0 &&
+        resource_attr_offsets[res_count] == resource_attr_offsets[res_count - 1] &&
+        service_name.get(res_count - 1) == record.service_name &&
+        deployment_environment.get(res_count - 1) == record.deployment_environment &&
+        host_name.get(res_count - 1) == record.host_name;
+    if (!reuse_resource) {
+        service_name.append(record.service_name);
+        deployment_environment.append(record.deployment_environment);
+        host_name.append(record.host_name);
+        resource_attr_offsets.push_back(resource_attr_keys.size());
+        res_count++;
+    }
+
+    kafka_offset.push_back(record.kafka_offset);
+    timestamp.push_back(record.timestamp);
+    severity.append(record.severity);
+    body.append(record.body);
+    trace_id.append(record.trace_id);
+    span_id.append(record.span_id);
+    resource_index.push_back(static_cast<uint32_t>(res_count - 1));
+    for (const auto& kv : record.attributes) {
+        attr_keys.append(kv.first);
+        attr_values.append(kv.second);
+    }
+    attr_offsets.push_back(attr_keys.size());
+}
+
+void LogRecordBatch::appendBatch(const LogRecordBatch& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (empty()) {
+        kafka_topic = other.kafka_topic;
+        kafka_partition = other.kafka_partition;
+    }
+
+    // Resource columns
+    uint32_t res_base = static_cast<uint32_t>(resourceCount());
+    size_t res_attr_base = resource_attr_keys.size();
+    service_name.appendColumn(other.service_name);
+    deployment_environment.appendColumn(other.deployment_environment);
+    host_name.appendColumn(other.host_name);
+    resource_attr_keys.appendColumn(other.resource_attr_keys);
+    resource_attr_values.appendColumn(other.resource_attr_values);
+    for (size_t i = 1; i < other.resource_attr_offsets.size(); ++i) {
+        resource_attr_offsets.push_back(res_attr_base + other.resource_attr_offsets[i]);
+    }
+
+    // Row columns
+    size_t attr_base = attr_keys.size();
+    kafka_offset.insert(kafka_offset.end(), other.kafka_offset.begin(), other.kafka_offset.end());
+    timestamp.insert(timestamp.end(), other.timestamp.begin(), other.timestamp.end());
+    severity.appendColumn(other.severity);
+    body.appendColumn(other.body);
+    trace_id.appendColumn(other.trace_id);
+    span_id.appendColumn(other.span_id);
+    attr_keys.appendColumn(other.attr_keys);
+    attr_values.appendColumn(other.attr_values);
+    resource_index.reserve(resource_index.size() + other.size());
+    for (uint32_t res : other.resource_index) {
+        resource_index.push_back(res_base + res);
+    }
+    for (size_t i = 1; i < other.attr_offsets.size(); ++i) {
+        attr_offsets.push_back(attr_base + other.attr_offsets[i]);
+    }
+}
+
+std::vector<TransformedLogRecord> LogRecordBatch::toRecords() const {
+    std::vector<TransformedLogRecord> records;
+    records.reserve(size());
+
+    for (size_t i = 0; i < size(); ++i) {
+        uint32_t res = resource_index[i];
+
+        TransformedLogRecord record;
+        record.kafka_topic = kafka_topic;
+        record.kafka_partition = kafka_partition;
+        record.kafka_offset = kafka_offset[i];
+        record.timestamp = timestamp[i];
+        record.severity = std::string(severity.get(i));
+        record.body = std::string(body.get(i));
+        record.trace_id = std::string(trace_id.get(i));
+        record.span_id = std::string(span_id.get(i));
+        record.service_name = std::string(service_name.get(res));
+        record.deployment_environment = std::string(deployment_environment.get(res));
+        record.host_name = std::string(host_name.get(res));
+        forEachAttribute(i, [&record](std::string_view key, std::string_view value) {
+            record.attributes.emplace(std::string(key), std::string(value));
+        });
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+void LogRecordBatch::truncate(size_t rows, size_t resources) {
+    kafka_offset.resize(rows);
+    timestamp.resize(rows);
+    severity.truncate(rows);
+    body.truncate(rows);
+    trace_id.truncate(rows);
+    span_id.truncate(rows);
+    resource_index.resize(rows);
+    attr_offsets.resize(rows + 1);
+    attr_keys.truncate(attr_offsets[rows]);
+    attr_values.truncate(attr_offsets[rows]);
+
+    service_name.truncate(resources);
+    deployment_environment.truncate(resources);
+    host_name.truncate(resources);
+    resource_attr_offsets.resize(resources + 1);
+    resource_attr_keys.truncate(resource_attr_offsets[resources]);
+    resource_attr_values.truncate(resource_attr_offsets[resources]);
+}
+
+void LogRecordBatch::clear() {
+    kafka_topic.clear();
+    kafka_partition = 0;
+    kafka_offset.clear();
+    timestamp.clear();
+    severity.clear();
+    body.clear();
+    trace_id.clear();
+    span_id.clear();
+    resource_index.clear();
+    attr_offsets.assign(1, 0);
+    attr_keys.clear();
+    attr_values.clear();
+    service_name.clear();
+    deployment_environment.clear();
+    host_name.clear();
+    resource_attr_offsets.assign(1, 0);
+    resource_attr_keys.clear();
+    resource_attr_values.clear();
+}
+
 std::vector<TransformedLogRecord> LogTransformer::transform(
     const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
     const std::string& kafka_topic,
     int32_t kafka_partition,
     int64_t kafka_offset) {
 
-    std::vector<TransformedLogRecord> records;
+    LogRecordBatch batch;
+    transformToBatch(request, kafka_topic, kafka_partition, kafka_offset, batch);
+    return batch.toRecords();
+}
+
+size_t LogTransformer::transformToBatch(
+    const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
+    const std::string& kafka_topic,
+    int32_t kafka_partition,
+    int64_t kafka_offset,
+    LogRecordBatch& batch) {
+
+    if (batch.empty()) {
+        batch.kafka_topic = kafka_topic;
+        batch.kafka_partition = kafka_partition;
+    }
+
+    size_t appended = 0;
 
     // Iterate through all resource logs
     for (int i = 0; i < request.resource_logs_size(); ++i) {
         const auto& resource_logs = request.resource_logs(i);
         const auto& resource = resource_logs.resource();
 
-        // Extract well-known attributes from resource
-        std::string service_name;
-        std::string deployment_environment;
-        std::string host_name;
-        extractWellKnownAttributes(resource, service_name, deployment_environment, host_name);
+        size_t record_count = 0;
+        for (int j = 0; j < resource_logs.scope_logs_size(); ++j) {
+            record_count += resource_logs.scope_logs(j).log_records_size();
+        }
+        if (record_count == 0) {
+            continue;
+        }
+
+        // Resource columns: well-known attributes (last occurrence wins) are
+        // promoted to their own columns, the rest are stored once per resource
+        const opentelemetry::proto::common::v1::KeyValue* service_name = nullptr;
+        const opentelemetry::proto::common::v1::KeyValue* deployment_environment = nullptr;
+        const opentelemetry::proto::common::v1::KeyValue* host_name = nullptr;
+
+        for (int attr_idx = 0; attr_idx < resource.attributes_size(); ++attr_idx) {
+            const auto& attr = resource.attributes(attr_idx);
+            const std::string& key = attr.key();
+
+            if (key == "service.name") {
+                service_name = &attr;
+            } else if (key == "deployment.environment") {
+                deployment_environment = &attr;
+            } else if (key == "host.name") {
+                host_name = &attr;
+            } else {
+                batch.resource_attr_keys.append(key);
+                appendStringValue(attr.value(), batch.resource_attr_values.data);
+                batch.resource_attr_values.commit();
+            }
+        }
+        batch.resource_attr_offsets.push_back(batch.resource_attr_keys.size());
+
+        if (service_name) appendStringValue(service_name->value(), batch.service_name.data);
+        batch.service_name.commit();
+        if (deployment_environment) appendStringValue(deployment_environment->value(), batch.deployment_environment.data);
+        batch.deployment_environment.commit();
+        if (host_name) appendStringValue(host_name->value(), batch.host_name.data);
+        batch.host_name.commit();
+
+        uint32_t res_idx = static_cast<uint32_t>(batch.resourceCount() - 1);
+
+        batch.kafka_offset.reserve(batch.size() + record_count);
+        batch.timestamp.reserve(batch.size() + record_count);
+        batch.resource_index.reserve(batch.size() + record_count);
+        batch.attr_offsets.reserve(batch.size() + record_count + 1);
 
         // Iterate through all scope logs
         for (int j = 0; j < resource_logs.scope_logs_size(); ++j) {
@@ -33,136 +246,100 @@ std::vector<TransformedLogRecord> LogTransformer::transform(
             for (int k = 0; k < scope_logs.log_records_size(); ++k) {
                 const auto& log_record = scope_logs.log_records(k);
 
-                TransformedLogRecord transformed;
-
                 // Set Kafka metadata for exactly-once semantics
-                transformed.kafka_topic = kafka_topic;
-                transformed.kafka_partition = kafka_partition;
-                transformed.kafka_offset = kafka_offset;
-                
-                // Extract timestamp
+                batch.kafka_offset.push_back(kafka_offset);
+
+                // Extract timestamp, using observed time if time_unix_nano is not set
                 if (log_record.time_unix_nano() > 0) {
-                    transformed.timestamp = nanosToTimePoint(log_record.time_unix_nano());
+                    batch.timestamp.push_back(nanosToTimePoint(log_record.time_unix_nano()));
                 } else {
-                    // Use observed time if time_unix_nano is not set
-                    transformed.timestamp = nanosToTimePoint(log_record.observed_time_unix_nano());
-                }
-                
-                // Extract severity
-                transformed.severity = getSeverityText(log_record);
-                
-                // Extract body
-                if (log_record.has_body()) {
-                    transformed.body = extractStringValue(log_record.body());
+                    batch.timestamp.push_back(nanosToTimePoint(log_record.observed_time_unix_nano()));
                 }
-                
-                // Extract trace_id and span_id
-                if (log_record.trace_id().size() > 0) {
-                    transformed.trace_id = bytesToHex(log_record.trace_id());
-                }
-                if (log_record.span_id().size() > 0) {
-                    transformed.span_id = bytesToHex(log_record.span_id());
+
+                // Prefer severity_text, fall back to severity_number
+                if (!log_record.severity_text().empty()) {
+                    batch.severity.append(log_record.severity_text());
+                } else {
+                    batch.severity.append(severityNumberText(log_record.severity_number()));
                 }
-                
-                // Set well-known attributes
-                transformed.service_name = service_name;
-                transformed.deployment_environment = deployment_environment;
-                transformed.host_name = host_name;
-                
-                // Extract all attributes (from both resource and log record)
-                // Well-known ones are already extracted, so we'll skip them
-                std::map<std::string, std::string> all_attributes;
-                
-                // Add resource attributes (except well-known ones)
-                for (int attr_idx = 0; attr_idx < resource.attributes_size(); ++attr_idx) {
-                    const auto& attr = resource.attributes(attr_idx);
-                    std::string key = attr.key();
-                    
-                    // Skip well-known attributes
-                    if (key != "service.name" && 
-                        key != "deployment.environment" && 
-                        key != "host.name") {
-                        all_attributes[key] = extractAttributeValue(attr);
-                    }
+
+                if (log_record.has_body()) {
+                    appendStringValue(log_record.body(), batch.body.data);
                 }
-                
-                // Add log record attributes
+                batch.body.commit();
+
+                appendHex(log_record.trace_id(), batch.trace_id.data);
+                batch.trace_id.commit();
+                appendHex(log_record.span_id(), batch.span_id.data);
+                batch.span_id.commit();
+
+                batch.resource_index.push_back(res_idx);
+
                 for (int attr_idx = 0; attr_idx < log_record.attributes_size(); ++attr_idx) {
                     const auto& attr = log_record.attributes(attr_idx);
-                    all_attributes[attr.key()] = extractAttributeValue(attr);
+                    batch.attr_keys.append(attr.key());
+                    appendStringValue(attr.value(), batch.attr_values.data);
+                    batch.attr_values.commit();
                 }
-                
-                transformed.attributes = all_attributes;
-                
-                records.push_back(transformed);
+                batch.attr_offsets.push_back(batch.attr_keys.size());
+
+                ++appended;
             }
         }
     }
-    
-    return records;
+
+    return appended;
 }
 
-std::string LogTransformer::extractStringValue(const opentelemetry::proto::common::v1::AnyValue& value) {
+void LogTransformer::appendStringValue(const opentelemetry::proto::common::v1::AnyValue& value,
+                                       std::string& out) {
     switch (value.value_case()) {
         case opentelemetry::proto::common::v1::AnyValue::kStringValue:
-            return value.string_value();
+            out.append(value.string_value());
+            break;
         case opentelemetry::proto::common::v1::AnyValue::kBoolValue:
-            return value.bool_value() ? "true" : "false";
+            out.append(value.bool_value() ? "true" : "false");
+            break;
         case opentelemetry::proto::common::v1::AnyValue::kIntValue:
-            return std::to_string(value.int_value());
+            out.append(std::to_string(value.int_value()));
+            break;
         case opentelemetry::proto::common::v1::AnyValue::kDoubleValue:
-            return std::to_string(value.double_value());
+            out.append(std::to_string(value.double_value()));
+            break;
         case opentelemetry::proto::common::v1::AnyValue::kBytesValue:
-            return bytesToHex(value.bytes_value());
+            appendHex(value.bytes_value(), out);
+            break;
         case opentelemetry::proto::common::v1::AnyValue::kArrayValue: {
-            std::ostringstream oss;
             const auto& array = value.array_value();
             for (int i = 0; i < array.values_size(); ++i) {
-                if (i > 0) oss << ",";
-                oss << extractStringValue(array.values(i));
+                if (i > 0) out.push_back(',');
+                appendStringValue(array.values(i), out);
             }
-            return oss.str();
+            break;
         }
         case opentelemetry::proto::common::v1::AnyValue::kKvlistValue: {
-            std::ostringstream oss;
             const auto& kvlist = value.kvlist_value();
             for (int i = 0; i < kvlist.values_size(); ++i) {
-                if (i > 0) oss << ",";
+                if (i > 0) out.push_back(',');
                 const auto& kv = kvlist.values(i);
-                oss << kv.key() << "=" << extractStringValue(kv.value());
+                out.append(kv.key());
+                out.push_back('=');
+                appendStringValue(kv.value(), out);
             }
-            return oss.str();
+            break;
         }
         default:
-            return "";
-    }
-}
-
-std::string LogTransformer::extractAttributeValue(const opentelemetry::proto::common::v1::KeyValue& kv) {
-    if (kv.has_value()) {
-        return extractStringValue(kv.value());
+            break;
     }
-    return "";
 }
 
-void LogTransformer::extractWellKnownAttributes(
-    const opentelemetry::proto::resource::v1::Resource& resource,
-    std::string& service_name,
-    std::string& deployment_environment,
-    std::string& host_name) {
-    
-    for (int i = 0; i < resource.attributes_size(); ++i) {
-        const auto& attr = resource.attributes(i);
-        std::string key = attr.key();
-        std::string value = extractAttributeValue(attr);
-        
-        if (key == "service.name") {
-            service_name = value;
-        } else if (key == "deployment.environment") {
-            deployment_environment = value;
-        } else if (key == "host.name") {
-            host_name = value;
-        }
+void LogTransformer::appendHex(std::string_view bytes, std::string& out) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    size_t pos = out.size();
+    out.resize(pos + bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        out[pos++] = kHexDigits[c >> 4];
+        out[pos++] = kHexDigits[c & 0x0f];
     }
 }
 
@@ -182,22 +359,8 @@ std::chrono::system_clock::time_point LogTransformer::nanosToTimePoint(uint64_t
     return tp;
 }
 
-std::string LogTransformer::bytesToHex(const std::string& bytes) {
-    std::ostringstream oss;
-    for (unsigned char c : bytes) {
-        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(c);
-    }
-    return oss.str();
-}
-
-std::string LogTransformer::getSeverityText(const opentelemetry::proto::logs::v1::LogRecord& log_record) {
-    // Prefer severity_text if available
-    if (!log_record.severity_text().empty()) {
-        return log_record.severity_text();
-    }
-    
-    // Fall back to severity_number
-    switch (log_record.severity_number()) {
+std::string_view LogTransformer::severityNumberText(int severity_number) {
+    switch (severity_number) {
         case opentelemetry::proto::logs::v1::SEVERITY_NUMBER_TRACE:
         case opentelemetry::proto::logs::v1::SEVERITY_NUMBER_TRACE2:
         case opentelemetry::proto::logs::v1::SEVERITY_NUMBER_TRACE3:
@@ -232,4 +395,3 @@ std::string LogTransformer::getSeverityText(const opentelemetry::proto::logs::v1
             return "UNSPECIFIED";
     }
 }
-
@@ -3,9 +3,11 @@
 
 #include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
 #include <string>
+#include <string_view>
 #include <map>
 #include <vector>
 #include <chrono>
+#include <cstdint>
 
 // Represents a single transformed log record ready for insertion into Iceberg
 struct TransformedLogRecord {
@@ -26,41 +28,179 @@ struct TransformedLogRecord {
     std::map<std::string, std::string> attributes;  // All other attributes
 };
 
+// Contiguous column of variable-length strings
+// All values share one character buffer; value i spans [offsets[i], offsets[i + 1])
+struct StringColumn {
+    std::string data;
+    std::vector<size_t> offsets{0};
+
+    size_t size() const { return offsets.size() - 1; }
+    bool empty() const { return offsets.size() == 1; }
+    size_t byteSize() const { return data.size(); }
+
+    std::string_view get(size_t i) const {
+        return std::string_view(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    void append(std::string_view value) {
+        data.append(value.data(), value.size());
+        offsets.push_back(data.size());
+    }
+
+    // Seal a value that was written directly into `data`
+    void commit() { offsets.push_back(data.size()); }
+
+    // Append all values of another column
+    void appendColumn(const StringColumn& other);
+
+    void reserve(size_t values, size_t bytes) {
+        offsets.reserve(offsets.size() + values);
+        data.reserve(data.size() + bytes);
+    }
+
+    // Keep the first n values, dropping any uncommitted bytes
+    void truncate(size_t n) {
+        offsets.resize(n + 1);
+        data.resize(offsets[n]);
+    }
+
+    void clear() {
+        data.clear();
+        offsets.assign(1, 0);
+    }
+};
+
+// Columnar (struct-of-arrays) batch of transformed log records
+//
+// Row columns hold one entry per log record. Resource-level columns hold one
+// entry per ResourceLogs and rows refer to them through resource_index, so
+// service/environment/host and resource attributes are stored once per
+// resource instead of once per record. Attributes live in flat key/value
+// columns addressed by offset ranges.
+//
+// The effective attribute map of a row is the resource's attributes (minus
+// the well-known ones) overlaid with the record's own attributes; see
+// forEachAttribute().
+struct LogRecordBatch {
+    // Kafka source metadata (topic and partition are fixed per batch)
+    std::string kafka_topic;
+    int32_t kafka_partition = 0;
+
+    // Row columns
+    std::vector<int64_t> kafka_offset;
+    std::vector<std::chrono::system_clock::time_point> timestamp;
+    StringColumn severity;
+    StringColumn body;
+    StringColumn trace_id;  // hex-encoded
+    StringColumn span_id;   // hex-encoded
+    std::vector<uint32_t> resource_index;
+    std::vector<size_t> attr_offsets{0};  // row i attributes: [attr_offsets[i], attr_offsets[i + 1])
+    StringColumn attr_keys;
+    StringColumn attr_values;
+
+    // Resource columns
+    StringColumn service_name;
+    StringColumn deployment_environment;
+    StringColumn host_name;
+    std::vector<size_t> resource_attr_offsets{0};
+    StringColumn resource_attr_keys;
+    StringColumn resource_attr_values;
+
+    size_t size() const { return kafka_offset.size(); }
+    bool empty() const { return kafka_offset.empty(); }
+    size_t resourceCount() const { return service_name.size(); }
+
+    // Upper bound on the number of attributes of a row (before de-duplication)
+    size_t maxAttributeCount(size_t row) const;
+
+    // Visit the effective attributes of a row as (key, value) pairs
+    // Record attributes override resource attributes with the same key and
+    // the last occurrence of a duplicated key wins, matching std::map assignment
+    template <typename Fn>
+    void forEachAttribute(size_t row, Fn&& fn) const;
+
+    // Append a row-oriented record (used by tests and adapters)
+    void append(const TransformedLogRecord& record);
+
+    // Append all rows of another batch for the same topic/partition
+    void appendBatch(const LogRecordBatch& other);
+
+    // Materialize as row-oriented records
+    std::vector<TransformedLogRecord> toRecords() const;
+
+    // Roll back to the first `rows` rows and `resources` resources
+    // Used by decoders to undo a partially appended message
+    void truncate(size_t rows, size_t resources);
+
+    void clear();
+};
+
+template <typename Fn>
+void LogRecordBatch::forEachAttribute(size_t row, Fn&& fn) const {
+    const size_t row_begin = attr_offsets[row];
+    const size_t row_end = attr_offsets[row + 1];
+    const uint32_t res = resource_index[row];
+    const size_t res_begin = resource_attr_offsets[res];
+    const size_t res_end = resource_attr_offsets[res + 1];
+
+    // Attribute lists are short, so quadratic duplicate checks beat hashing
+    for (size_t i = res_begin; i < res_end; ++i) {
+        std::string_view key = resource_attr_keys.get(i);
+        bool shadowed = false;
+        for (size_t j = i + 1; j < res_end && !shadowed; ++j) {
+            shadowed = resource_attr_keys.get(j) == key;
+        }
+        for (size_t j = row_begin; j < row_end && !shadowed; ++j) {
+            shadowed = attr_keys.get(j) == key;
+        }
+        if (!shadowed) {
+            fn(key, resource_attr_values.get(i));
+        }
+    }
+    for (size_t i = row_begin; i < row_end; ++i) {
+        std::string_view key = attr_keys.get(i);
+        bool shadowed = false;
+        for (size_t j = i + 1; j < row_end && !shadowed; ++j) {
+            shadowed = attr_keys.get(j) == key;
+        }
+        if (!shadowed) {
+            fn(key, attr_values.get(i));
+        }
+    }
+}
+
 class LogTransformer {
 public:
     // Transform an ExportLogsServiceRequest into a vector of TransformedLogRecord
     // Each log record in the request becomes one TransformedLogRecord
     // The Kafka metadata is propagated to each record for exactly-once semantics
     static std::vector<TransformedLogRecord> transform(
+        const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
+        const std::string& kafka_topic = "",
+        int32_t kafka_partition = 0,
+        int64_t kafka_offset = 0);
+
+    // Transform an ExportLogsServiceRequest into columnar form, appending to `batch`
+    // Returns the number of log records appended
+    static size_t transformToBatch(
         const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
         const std::string& kafka_topic,
         int32_t kafka_partition,
-        int64_t kafka_offset);
-
-private:
-    // Extract a string value from an AnyValue
-    static std::string extractStringValue(const opentelemetry::proto::common::v1::AnyValue& value);
-    
-    // Extract attribute value as string
-    static std::string extractAttributeValue(const opentelemetry::proto::common::v1::KeyValue& kv);
-    
-    // Extract well-known attributes from resource
-    static void extractWellKnownAttributes(
-        const opentelemetry::proto::resource::v1::Resource& resource,
-        std::string& service_name,
-        std::string& deployment_environment,
-        std::string& host_name);
-    
+        int64_t kafka_offset,
+        LogRecordBatch& batch);
+
+    // Render an AnyValue as text, appending to `out`
+    static void appendStringValue(const opentelemetry::proto::common::v1::AnyValue& value,
+                                  std::string& out);
+
+    // Append the lowercase hex encoding of `bytes` to `out`
+    static void appendHex(std::string_view bytes, std::string& out);
+
+    // Severity text for an OTLP severity number
+    static std::string_view severityNumberText(int severity_number);
+
     // Convert nanoseconds since epoch to time_point
     static std::chrono::system_clock::time_point nanosToTimePoint(uint64_t nanos);
-    
-    // Convert bytes to hex string
-    static std::string bytesToHex(const std::string& bytes);
-    
-    // Convert severity number to text if severity_text is empty
-    static std::string getSeverityText(
-        const opentelemetry::proto::logs::v1::LogRecord& log_record);
 };
 
 #endif // LOG_TRANSFORMER_HPP
-
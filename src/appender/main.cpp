@@ -153,6 +153,28 @@ int main() {
         std::cerr << "  ICEBERG_RETRY_BASE_DELAY_MS - Base retry delay in ms (default: 100)" << std::endl;
         std::cerr << "  ICEBERG_RETRY_MAX_DELAY_MS - Max retry delay in ms (default: 5000)" << std::endl;
         std::cerr << "  REBALANCE_TIMEOUT_SECONDS - Worker shutdown timeout on rebalance (default: 30)" << std::endl;
+        std::cerr << "  PARTITION_MAX_PENDING_FLUSHES - Sealed buffers awaiting Iceberg commit per partition (default: 2)" << std::endl;
+        std::cerr << "  PARTITION_QUEUE_MAX_MESSAGES - Queued messages per partition before pausing it (default: 100)" << std::endl;
+        std::cerr << "  PARTITION_QUEUE_MAX_MB - Queued MB per partition before pausing it (default: 64)" << std::endl;
+        std::cerr << "  PARTITION_QUEUE_RESUME_PERCENT - Resume a paused partition below this % of both limits (default: 50)" << std::endl;
+        std::cerr << "  CONSUMER_BATCH_SIZE - Max Kafka messages per poll cycle (default: 500)" << std::endl;
+        std::cerr << "  CONSUMER_POLL_TIMEOUT_MS - Max wait for a poll cycle to fill (default: 100)" << std::endl;
+        std::cerr << "  DECODE_THREADS - Decode/transform threads, 0 decodes on the poll thread (default: 4)" << std::endl;
+        std::cerr << "  MAX_DECOMPRESSED_SIZE_MB - Max size of a compressed payload once inflated (default: 64)" << std::endl;
+        std::cerr << "  BUFFER_SINK - Partition buffer: duckdb table or parquet file (default: duckdb)" << std::endl;
+        std::cerr << "  PARQUET_STAGING_DIR - Parquet buffer files and spilled buffers (default: /tmp/otel-appender)" << std::endl;
+        std::cerr << "  PARQUET_ROW_GROUP_MB - Parquet row group size (default: 16)" << std::endl;
+        std::cerr << "  PARQUET_COMPRESSION - Parquet compression: gzip or none (default: gzip)" << std::endl;
+        std::cerr << "  BUFFER_DB_PATH - On-disk DuckDB file for buffers, recovered after a crash (default: in memory)" << std::endl;
+        std::cerr << "  ICEBERG_COMMIT_MODE - duckdb or rest, rest needs BUFFER_SINK=parquet (default: duckdb)" << std::endl;
+        std::cerr << "  ICEBERG_WAREHOUSE - Warehouse for the REST catalog's /v1/config (optional)" << std::endl;
+        std::cerr << "  ICEBERG_COMMIT_INTERVAL_MS - Min interval between shared REST commits (default: 10000)" << std::endl;
+        std::cerr << "  ICEBERG_COMMIT_MAX_FILES - Commit a shared snapshot early at this many files (default: 256)" << std::endl;
+        std::cerr << "  MEMORY_BUDGET_MB - Memory for all queues and buffers, 0 uses MEMORY_BUDGET_PERCENT (default: 0)" << std::endl;
+        std::cerr << "  MEMORY_BUDGET_PERCENT - Share of the cgroup memory limit used as budget (default: 60)" << std::endl;
+        std::cerr << "  MEMORY_FLUSH_PERCENT - Flush early above this % of the budget (default: 75)" << std::endl;
+        std::cerr << "  MEMORY_FLUSH_POLICY - Flush largest or oldest buffers first (default: largest)" << std::endl;
+        std::cerr << "  MEMORY_FLUSH_MIN_MB - Smallest active buffer flushed early (default: 4)" << std::endl;
         std::cerr << "  HEALTH_PORT - Health/flush endpoint port (default: 8080)" << std::endl;
         return 1;
     }
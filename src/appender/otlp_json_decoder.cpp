@@ -0,0 +1,740 @@
+#include "otlp_json_decoder.hpp"
+#include "opentelemetry/proto/logs/v1/logs.pb.h"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Objects and arrays nested deeper than this are rejected
+constexpr int kMaxDepth = 64;
+
+[[noreturn]] void fail(const char* what) {
+    throw std::runtime_error(std::string("Failed to parse JSON payload: ") + what);
+}
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool isHexDigit(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Standard and URL-safe alphabets, as accepted by the protobuf JSON mapping
+int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+' || c == '-') return 62;
+    if (c == '/' || c == '_') return 63;
+    return -1;
+}
+
+// Decode base64 (padding optional) and append the bytes hex-encoded
+bool appendBase64AsHex(std::string_view in, std::string& out) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : in) {
+        if (c == '=') {
+            break;
+        }
+        int v = base64Value(c);
+        if (v < 0) {
+            return false;
+        }
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            unsigned char byte = static_cast<unsigned char>(acc >> bits);
+            out.push_back(kHexDigits[byte >> 4]);
+            out.push_back(kHexDigits[byte & 0x0f]);
+            acc &= (1u << bits) - 1;
+        }
+    }
+    return true;
+}
+
+void appendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// First '"' or '\' in [p, end), or end
+// String bodies dominate OTLP payloads, so this scans 16 bytes at a time where SSE2 is available
+const char* findQuoteOrBackslash(const char* p, const char* end) {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                  _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    return p;
+}
+
+bool isField(std::string_view key, std::string_view json_name, std::string_view proto_name) {
+    return key == json_name || key == proto_name;
+}
+
+// Reused across messages on the same thread
+struct Scratch {
+    std::string key;           // escaped object keys
+    std::string text;          // numeric strings, ids
+    std::string attr_key;
+    std::string attr_value;
+    std::string severity_text;
+    std::string service_name;
+    std::string deployment_environment;
+    std::string host_name;
+};
+
+class Parser {
+public:
+    Parser(std::string_view json, int64_t kafka_offset, LogRecordBatch& batch, Scratch& scratch)
+        : p_(json.data())
+        , end_(json.data() + json.size())
+        , depth_(0)
+        , kafka_offset_(kafka_offset)
+        , batch_(batch)
+        , scratch_(scratch) {}
+
+    void parseRequest() {
+        parseObject([this](std::string_view key) {
+            if (isField(key, "resourceLogs", "resource_logs")) {
+                parseArray([this] { parseResourceLogs(); });
+            } else {
+                skipValue();
+            }
+        });
+
+        skipWhitespace();
+        if (p_ != end_) {
+            fail("trailing characters");
+        }
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+    int depth_;
+    int64_t kafka_offset_;
+    LogRecordBatch& batch_;
+    Scratch& scratch_;
+
+    // ---- OTLP structure ----
+
+    void parseResourceLogs() {
+        const size_t rows_before = batch_.size();
+        const uint32_t res_idx = static_cast<uint32_t>(batch_.resourceCount());
+        scratch_.service_name.clear();
+        scratch_.deployment_environment.clear();
+        scratch_.host_name.clear();
+
+        parseObject([&](std::string_view key) {
+            if (key == "resource") {
+                parseObject([&](std::string_view resource_key) {
+                    if (resource_key == "attributes") {
+                        parseArray([&] { parseResourceAttribute(); });
+                    } else {
+                        skipValue();
+                    }
+                });
+            } else if (isField(key, "scopeLogs", "scope_logs")) {
+                parseArray([&] {
+                    parseObject([&](std::string_view scope_key) {
+                        if (isField(scope_key, "logRecords", "log_records")) {
+                            parseArray([&] { parseLogRecord(res_idx); });
+                        } else {
+                            skipValue();
+                        }
+                    });
+                });
+            } else {
+                skipValue();
+            }
+        });
+
+        // Resources without records are dropped, like transformToBatch does
+        if (batch_.size() == rows_before) {
+            size_t committed = batch_.resource_attr_offsets.back();
+            batch_.resource_attr_keys.truncate(committed);
+            batch_.resource_attr_values.truncate(committed);
+            return;
+        }
+
+        batch_.resource_attr_offsets.push_back(batch_.resource_attr_keys.size());
+        batch_.service_name.append(scratch_.service_name);
+        batch_.deployment_environment.append(scratch_.deployment_environment);
+        batch_.host_name.append(scratch_.host_name);
+    }
+
+    // Well-known attributes (last occurrence wins) go to their own columns
+    void parseResourceAttribute() {
+        parseKeyValue(scratch_.attr_key, scratch_.attr_value);
+        const std::string& key = scratch_.attr_key;
+        if (key == "service.name") {
+            scratch_.service_name = scratch_.attr_value;
+        } else if (key == "deployment.environment") {
+            scratch_.deployment_environment = scratch_.attr_value;
+        } else if (key == "host.name") {
+            scratch_.host_name = scratch_.attr_value;
+        } else {
+            batch_.resource_attr_keys.append(key);
+            batch_.resource_attr_values.append(scratch_.attr_value);
+        }
+    }
+
+    void parseLogRecord(uint32_t res_idx) {
+        uint64_t time_nanos = 0;
+        uint64_t observed_nanos = 0;
+        int severity_number = 0;
+        scratch_.severity_text.clear();
+
+        // Body and ids are written straight into their columns and committed below
+        const size_t body_start = batch_.body.data.size();
+        const size_t trace_start = batch_.trace_id.data.size();
+        const size_t span_start = batch_.span_id.data.size();
+
+        parseObject([&](std::string_view key) {
+            if (isField(key, "timeUnixNano", "time_unix_nano")) {
+                time_nanos = parseUint64();
+            } else if (isField(key, "observedTimeUnixNano", "observed_time_unix_nano")) {
+                observed_nanos = parseUint64();
+            } else if (isField(key, "severityNumber", "severity_number")) {
+                severity_number = parseSeverityNumber();
+            } else if (isField(key, "severityText", "severity_text")) {
+                scratch_.severity_text.clear();
+                parseString(scratch_.severity_text);
+            } else if (key == "body") {
+                batch_.body.data.resize(body_start);
+                parseAnyValue(batch_.body.data);
+            } else if (isField(key, "traceId", "trace_id")) {
+                batch_.trace_id.data.resize(trace_start);
+                parseId(batch_.trace_id.data);
+            } else if (isField(key, "spanId", "span_id")) {
+                batch_.span_id.data.resize(span_start);
+                parseId(batch_.span_id.data);
+            } else if (key == "attributes") {
+                parseArray([&] {
+                    parseKeyValue(scratch_.attr_key, scratch_.attr_value);
+                    batch_.attr_keys.append(scratch_.attr_key);
+                    batch_.attr_values.append(scratch_.attr_value);
+                });
+            } else {
+                skipValue();
+            }
+        });
+
+        batch_.kafka_offset.push_back(kafka_offset_);
+        batch_.timestamp.push_back(LogTransformer::nanosToTimePoint(time_nanos > 0 ? time_nanos : observed_nanos));
+        if (!scratch_.severity_text.empty()) {
+            batch_.severity.append(scratch_.severity_text);
+        } else {
+            batch_.severity.append(LogTransformer::severityNumberText(severity_number));
+        }
+        batch_.body.commit();
+        batch_.trace_id.commit();
+        batch_.span_id.commit();
+        batch_.resource_index.push_back(res_idx);
+        batch_.attr_offsets.push_back(batch_.attr_keys.size());
+    }
+
+    void parseKeyValue(std::string& key, std::string& value) {
+        key.clear();
+        value.clear();
+        parseObject([&](std::string_view member) {
+            if (member == "key") {
+                key.clear();
+                parseString(key);
+            } else if (member == "value") {
+                value.clear();
+                parseAnyValue(value);
+            } else {
+                skipValue();
+            }
+        });
+    }
+
+    // Render an AnyValue as text, matching LogTransformer::appendStringValue
+    void parseAnyValue(std::string& out) {
+        const size_t start = out.size();
+
+        // AnyValue is a oneof, so a later member replaces an earlier one
+        parseObject([&](std::string_view key) {
+            if (isField(key, "stringValue", "string_value")) {
+                out.resize(start);
+                parseString(out);
+            } else if (isField(key, "boolValue", "bool_value")) {
+                out.resize(start);
+                if (!consumeNull()) {
+                    out.append(parseBool() ? "true" : "false");
+                }
+            } else if (isField(key, "intValue", "int_value")) {
+                out.resize(start);
+                if (!consumeNull()) {
+                    out.append(std::to_string(parseInt64()));
+                }
+            } else if (isField(key, "doubleValue", "double_value")) {
+                out.resize(start);
+                if (!consumeNull()) {
+                    out.append(std::to_string(parseDouble()));
+                }
+            } else if (isField(key, "bytesValue", "bytes_value")) {
+                out.resize(start);
+                scratch_.text.clear();
+                parseString(scratch_.text);
+                if (!appendBase64AsHex(scratch_.text, out)) {
+                    fail("invalid base64 in bytesValue");
+                }
+            } else if (isField(key, "arrayValue", "array_value")) {
+                out.resize(start);
+                parseObject([&](std::string_view array_key) {
+                    if (array_key != "values") {
+                        skipValue();
+                        return;
+                    }
+                    out.resize(start);
+                    bool first = true;
+                    parseArray([&] {
+                        if (!first) out.push_back(',');
+                        first = false;
+                        parseAnyValue(out);
+                    });
+                });
+            } else if (isField(key, "kvlistValue", "kvlist_value")) {
+                out.resize(start);
+                parseObject([&](std::string_view kvlist_key) {
+                    if (kvlist_key != "values") {
+                        skipValue();
+                        return;
+                    }
+                    out.resize(start);
+                    bool first = true;
+                    // Nested lists are rare; locals keep the shared scratch untouched
+                    std::string nested_key;
+                    std::string nested_value;
+                    parseArray([&] {
+                        parseKeyValue(nested_key, nested_value);
+                        if (!first) out.push_back(',');
+                        first = false;
+                        out.append(nested_key);
+                        out.push_back('=');
+                        out.append(nested_value);
+                    });
+                });
+            } else {
+                skipValue();
+            }
+        });
+    }
+
+    // Trace and span ids: OTLP/JSON uses hex, the generic protobuf mapping uses base64
+    // An even-length all-hex string is taken as hex; anything else must be base64
+    void parseId(std::string& out) {
+        scratch_.text.clear();
+        parseString(scratch_.text);
+        const std::string& text = scratch_.text;
+
+        bool hex = text.size() % 2 == 0;
+        for (size_t i = 0; hex && i < text.size(); ++i) {
+            hex = isHexDigit(text[i]);
+        }
+
+        if (hex) {
+            for (char c : text) {
+                out.push_back(c >= 'A' && c <= 'F' ? static_cast<char>(c - 'A' + 'a') : c);
+            }
+        } else if (!appendBase64AsHex(text, out)) {
+            fail("invalid trace or span id");
+        }
+    }
+
+    // ---- scalars ----
+
+    // int64/uint64 are usually strings in OTLP/JSON but plain numbers are accepted too
+    std::string_view numericText() {
+        if (peek() == '"') {
+            scratch_.text.clear();
+            parseString(scratch_.text);
+            return scratch_.text;
+        }
+        return numberToken();
+    }
+
+    template <typename T>
+    T parseInteger() {
+        std::string_view text = numericText();
+        T value = 0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+            return value;
+        }
+
+        // Exponent forms such as 1e9 are valid as long as the value is integral
+        double d = toDouble(text);
+        if (!std::isfinite(d) || std::trunc(d) != d ||
+            d < static_cast<double>(std::numeric_limits<T>::min()) ||
+            d > static_cast<double>(std::numeric_limits<T>::max())) {
+            fail("invalid integer");
+        }
+        return static_cast<T>(d);
+    }
+
+    uint64_t parseUint64() {
+        return consumeNull() ? 0 : parseInteger<uint64_t>();
+    }
+
+    int64_t parseInt64() {
+        return parseInteger<int64_t>();
+    }
+
+    double parseDouble() {
+        if (peek() == '"') {
+            scratch_.text.clear();
+            parseString(scratch_.text);
+            return toDouble(scratch_.text);
+        }
+        return toDouble(numberToken());
+    }
+
+    static double toDouble(std::string_view text) {
+        if (text == "NaN") return std::nan("");
+        if (text == "Infinity") return HUGE_VAL;
+        if (text == "-Infinity") return -HUGE_VAL;
+
+        std::string terminated(text);
+        char* parse_end = nullptr;
+        double value = std::strtod(terminated.c_str(), &parse_end);
+        if (terminated.empty() || parse_end != terminated.c_str() + terminated.size()) {
+            fail("invalid number");
+        }
+        return value;
+    }
+
+    bool parseBool() {
+        if (consumeLiteral("true")) return true;
+        if (consumeLiteral("false")) return false;
+        fail("expected boolean");
+    }
+
+    // Enum values may be given by name or by number
+    int parseSeverityNumber() {
+        if (consumeNull()) {
+            return 0;
+        }
+        if (peek() != '"') {
+            return parseInteger<int>();
+        }
+
+        scratch_.text.clear();
+        parseString(scratch_.text);
+        opentelemetry::proto::logs::v1::SeverityNumber value;
+        if (opentelemetry::proto::logs::v1::SeverityNumber_Parse(scratch_.text, &value)) {
+            return value;
+        }
+        int number = 0;
+        auto result = std::from_chars(scratch_.text.data(), scratch_.text.data() + scratch_.text.size(), number);
+        if (result.ec == std::errc() && result.ptr == scratch_.text.data() + scratch_.text.size()) {
+            return number;
+        }
+        return 0;
+    }
+
+    // ---- JSON grammar ----
+
+    void skipWhitespace() {
+        while (p_ < end_ && isWhitespace(*p_)) {
+            ++p_;
+        }
+    }
+
+    char peek() {
+        skipWhitespace();
+        if (p_ >= end_) {
+            fail("unexpected end of input");
+        }
+        return *p_;
+    }
+
+    void expect(char c) {
+        if (peek() != c) {
+            fail("unexpected character");
+        }
+        ++p_;
+    }
+
+    bool consumeLiteral(std::string_view literal) {
+        skipWhitespace();
+        if (static_cast<size_t>(end_ - p_) >= literal.size() &&
+            std::string_view(p_, literal.size()) == literal) {
+            p_ += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeNull() {
+        return peek() == 'n' && consumeLiteral("null");
+    }
+
+    // Calls onMember(key) with the cursor on each member's value; null is an empty object
+    template <typename Fn>
+    void parseObject(Fn&& onMember) {
+        if (consumeNull()) {
+            return;
+        }
+        expect('{');
+        if (++depth_ > kMaxDepth) {
+            fail("nesting too deep");
+        }
+
+        if (peek() == '}') {
+            ++p_;
+        } else {
+            while (true) {
+                std::string_view key = parseKey();
+                expect(':');
+                onMember(key);
+
+                char c = peek();
+                ++p_;
+                if (c == '}') break;
+                if (c != ',') fail("expected ',' or '}'");
+            }
+        }
+        --depth_;
+    }
+
+    // Calls onElement() with the cursor on each element; null is an empty array
+    template <typename Fn>
+    void parseArray(Fn&& onElement) {
+        if (consumeNull()) {
+            return;
+        }
+        expect('[');
+        if (++depth_ > kMaxDepth) {
+            fail("nesting too deep");
+        }
+
+        if (peek() == ']') {
+            ++p_;
+        } else {
+            while (true) {
+                onElement();
+
+                char c = peek();
+                ++p_;
+                if (c == ']') break;
+                if (c != ',') fail("expected ',' or ']'");
+            }
+        }
+        --depth_;
+    }
+
+    // Object key as a view into the input, or into scratch if it had escapes
+    // Only valid until the member's value is parsed
+    std::string_view parseKey() {
+        expect('"');
+        const char* start = p_;
+        const char* stop = findQuoteOrBackslash(p_, end_);
+        if (stop < end_ && *stop == '"') {
+            p_ = stop + 1;
+            return std::string_view(start, static_cast<size_t>(stop - start));
+        }
+
+        --p_;
+        scratch_.key.clear();
+        parseString(scratch_.key);
+        return scratch_.key;
+    }
+
+    // Append the unescaped contents of a string; null appends nothing
+    void parseString(std::string& out) {
+        if (consumeNull()) {
+            return;
+        }
+        expect('"');
+        while (true) {
+            const char* stop = findQuoteOrBackslash(p_, end_);
+            out.append(p_, static_cast<size_t>(stop - p_));
+            p_ = stop;
+            if (p_ >= end_) {
+                fail("unterminated string");
+            }
+            if (*p_++ == '"') {
+                return;
+            }
+            parseEscape(out);
+        }
+    }
+
+    void parseEscape(std::string& out) {
+        if (p_ >= end_) {
+            fail("unterminated string");
+        }
+        switch (*p_++) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t cp = parseHex4();
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                        fail("unpaired surrogate");
+                    }
+                    p_ += 2;
+                    uint32_t low = parseHex4();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        fail("unpaired surrogate");
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    fail("unpaired surrogate");
+                }
+                appendUtf8(cp, out);
+                break;
+            }
+            default:
+                fail("invalid escape");
+        }
+    }
+
+    uint32_t parseHex4() {
+        if (end_ - p_ < 4) {
+            fail("invalid unicode escape");
+        }
+        uint32_t cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            int v = hexValue(*p_++);
+            if (v < 0) {
+                fail("invalid unicode escape");
+            }
+            cp = (cp << 4) | static_cast<uint32_t>(v);
+        }
+        return cp;
+    }
+
+    std::string_view numberToken() {
+        skipWhitespace();
+        const char* start = p_;
+        while (p_ < end_ && ((*p_ >= '0' && *p_ <= '9') || *p_ == '-' || *p_ == '+' ||
+                             *p_ == '.' || *p_ == 'e' || *p_ == 'E')) {
+            ++p_;
+        }
+        if (p_ == start) {
+            fail("expected number");
+        }
+        return std::string_view(start, static_cast<size_t>(p_ - start));
+    }
+
+    void skipValue() {
+        switch (peek()) {
+            case '{':
+                parseObject([this](std::string_view) { skipValue(); });
+                break;
+            case '[':
+                parseArray([this] { skipValue(); });
+                break;
+            case '"':
+                skipString();
+                break;
+            case 't':
+            case 'f':
+                parseBool();
+                break;
+            case 'n':
+                if (!consumeNull()) fail("unexpected character");
+                break;
+            default:
+                numberToken();
+                break;
+        }
+    }
+
+    void skipString() {
+        expect('"');
+        while (true) {
+            p_ = findQuoteOrBackslash(p_, end_);
+            if (p_ >= end_) {
+                fail("unterminated string");
+            }
+            if (*p_++ == '"') {
+                return;
+            }
+            if (p_ >= end_) {
+                fail("unterminated string");
+            }
+            ++p_;  // escaped character
+        }
+    }
+};
+
+}  // namespace
+
+size_t OtlpJsonDecoder::decode(std::string_view json,
+                               const std::string& kafka_topic,
+                               int32_t kafka_partition,
+                               int64_t kafka_offset,
+                               LogRecordBatch& batch) {
+    thread_local Scratch scratch;
+
+    if (batch.empty()) {
+        batch.kafka_topic = kafka_topic;
+        batch.kafka_partition = kafka_partition;
+    }
+
+    const size_t rows_before = batch.size();
+    const size_t resources_before = batch.resourceCount();
+    try {
+        Parser parser(json, kafka_offset, batch, scratch);
+        parser.parseRequest();
+    } catch (...) {
+        batch.truncate(rows_before, resources_before);
+        throw;
+    }
+
+    return batch.size() - rows_before;
+}
@@ -0,0 +1,31 @@
+#ifndef OTLP_JSON_DECODER_HPP
+#define OTLP_JSON_DECODER_HPP
+
+#include "log_transformer.hpp"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Decodes OTLP/JSON ExportLogsServiceRequest payloads straight into a LogRecordBatch
+//
+// Single pass over the input with no intermediate protobuf message. Output
+// matches JsonStringToMessage followed by LogTransformer::transformToBatch,
+// plus the OTLP/JSON quirks that the generic protobuf mapping gets wrong:
+//   - traceId/spanId are hex strings (base64 is still accepted)
+//   - int64/uint64 fields may be JSON strings or numbers
+//   - enum fields may be names or numbers
+//   - both lowerCamelCase and original field names are accepted
+// Unknown fields are skipped.
+class OtlpJsonDecoder {
+public:
+    // Decode `json` and append its log records to `batch`
+    // Returns the number of log records appended
+    // Throws std::runtime_error on malformed input, leaving `batch` unchanged
+    static size_t decode(std::string_view json,
+                         const std::string& kafka_topic,
+                         int32_t kafka_partition,
+                         int64_t kafka_offset,
+                         LogRecordBatch& batch);
+};
+
+#endif // OTLP_JSON_DECODER_HPP
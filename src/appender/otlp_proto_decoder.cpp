@@ -0,0 +1,438 @@
+#include "otlp_proto_decoder.hpp"
+#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
+#include "opentelemetry/proto/common/v1/common.pb.h"
+#include "opentelemetry/proto/resource/v1/resource.pb.h"
+#include "opentelemetry/proto/logs/v1/logs.pb.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
+using opentelemetry::proto::logs::v1::ResourceLogs;
+using opentelemetry::proto::logs::v1::ScopeLogs;
+using opentelemetry::proto::logs::v1::LogRecord;
+using opentelemetry::proto::resource::v1::Resource;
+using opentelemetry::proto::common::v1::AnyValue;
+using opentelemetry::proto::common::v1::ArrayValue;
+using opentelemetry::proto::common::v1::KeyValueList;
+using opentelemetry::proto::common::v1::KeyValue;
+
+// Same as the protobuf parser's default recursion limit
+constexpr int kMaxDepth = 100;
+
+enum WireType : uint32_t {
+    kVarint = 0,
+    kFixed64 = 1,
+    kLengthDelimited = 2,
+    kStartGroup = 3,
+    kEndGroup = 4,
+    kFixed32 = 5,
+};
+
+[[noreturn]] void fail(const char* what) {
+    throw std::runtime_error(std::string("Failed to parse Protobuf payload: ") + what);
+}
+
+// Cursor over the fields of one (sub)message
+class WireReader {
+public:
+    explicit WireReader(std::string_view data)
+        : p_(reinterpret_cast<const uint8_t*>(data.data()))
+        , end_(p_ + data.size()) {}
+
+    bool done() const { return p_ >= end_; }
+
+    void nextTag(uint32_t& field, uint32_t& wire_type) {
+        uint64_t tag = readVarint();
+        if (tag > 0xFFFFFFFFu || (tag >> 3) == 0) {
+            fail("invalid tag");
+        }
+        field = static_cast<uint32_t>(tag >> 3);
+        wire_type = static_cast<uint32_t>(tag & 7);
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p_ >= end_) {
+                fail("truncated varint");
+            }
+            uint8_t byte = *p_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+        fail("malformed varint");
+    }
+
+    uint64_t readFixed64() {
+        require(8);
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i) {
+            value = (value << 8) | p_[i];
+        }
+        p_ += 8;
+        return value;
+    }
+
+    // View of a length-delimited field's bytes in the input
+    std::string_view readBytes() {
+        uint64_t length = readVarint();
+        require(length);
+        std::string_view bytes(reinterpret_cast<const char*>(p_), static_cast<size_t>(length));
+        p_ += length;
+        return bytes;
+    }
+
+    void skipField(uint32_t field, uint32_t wire_type, int depth) {
+        switch (wire_type) {
+            case kVarint:
+                readVarint();
+                break;
+            case kFixed64:
+                require(8);
+                p_ += 8;
+                break;
+            case kLengthDelimited:
+                readBytes();
+                break;
+            case kFixed32:
+                require(4);
+                p_ += 4;
+                break;
+            case kStartGroup:
+                if (depth >= kMaxDepth) {
+                    fail("nesting too deep");
+                }
+                while (true) {
+                    if (done()) {
+                        fail("unterminated group");
+                    }
+                    uint32_t group_field;
+                    uint32_t group_wire_type;
+                    nextTag(group_field, group_wire_type);
+                    if (group_wire_type == kEndGroup) {
+                        if (group_field != field) {
+                            fail("mismatched end group");
+                        }
+                        return;
+                    }
+                    skipField(group_field, group_wire_type, depth + 1);
+                }
+            default:
+                fail("invalid wire type");
+        }
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+
+    void require(uint64_t bytes) {
+        if (bytes > static_cast<uint64_t>(end_ - p_)) {
+            fail("truncated field");
+        }
+    }
+};
+
+// Calls fn(field, wire_type, reader) for each field of a message
+// fn reads the fields it handles and returns true; other fields are skipped
+template <typename Fn>
+void forEachField(std::string_view message, int depth, Fn&& fn) {
+    if (depth > kMaxDepth) {
+        fail("nesting too deep");
+    }
+    WireReader reader(message);
+    while (!reader.done()) {
+        uint32_t field;
+        uint32_t wire_type;
+        reader.nextTag(field, wire_type);
+        if (!fn(field, wire_type, reader)) {
+            reader.skipField(field, wire_type, depth);
+        }
+    }
+}
+
+// Key and encoded AnyValue of a KeyValue message
+void readKeyValue(std::string_view message, int depth, std::string_view& key, std::string_view& value) {
+    key = std::string_view();
+    value = std::string_view();
+    forEachField(message, depth, [&](uint32_t field, uint32_t wire_type, WireReader& reader) {
+        if (wire_type != kLengthDelimited) {
+            return false;
+        }
+        if (field == KeyValue::kKeyFieldNumber) {
+            key = reader.readBytes();
+            return true;
+        }
+        if (field == KeyValue::kValueFieldNumber) {
+            value = reader.readBytes();
+            return true;
+        }
+        return false;
+    });
+}
+
+// Render an encoded AnyValue as text, matching LogTransformer::appendStringValue
+void appendAnyValue(std::string_view message, int depth, std::string& out) {
+    const size_t start = out.size();
+
+    // AnyValue is a oneof, so a later member replaces an earlier one
+    forEachField(message, depth, [&](uint32_t field, uint32_t wire_type, WireReader& reader) {
+        switch (field) {
+            case AnyValue::kStringValueFieldNumber:
+                if (wire_type != kLengthDelimited) return false;
+                out.resize(start);
+                out.append(reader.readBytes());
+                return true;
+            case AnyValue::kBoolValueFieldNumber:
+                if (wire_type != kVarint) return false;
+                out.resize(start);
+                out.append(reader.readVarint() != 0 ? "true" : "false");
+                return true;
+            case AnyValue::kIntValueFieldNumber:
+                if (wire_type != kVarint) return false;
+                out.resize(start);
+                out.append(std::to_string(static_cast<int64_t>(reader.readVarint())));
+                return true;
+            case AnyValue::kDoubleValueFieldNumber: {
+                if (wire_type != kFixed64) return false;
+                uint64_t bits = reader.readFixed64();
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                out.resize(start);
+                out.append(std::to_string(value));
+                return true;
+            }
+            case AnyValue::kBytesValueFieldNumber:
+                if (wire_type != kLengthDelimited) return false;
+                out.resize(start);
+                LogTransformer::appendHex(reader.readBytes(), out);
+                return true;
+            case AnyValue::kArrayValueFieldNumber: {
+                if (wire_type != kLengthDelimited) return false;
+                out.resize(start);
+                bool first = true;
+                forEachField(reader.readBytes(), depth + 1,
+                             [&](uint32_t array_field, uint32_t array_wire_type, WireReader& array_reader) {
+                    if (array_field != ArrayValue::kValuesFieldNumber || array_wire_type != kLengthDelimited) {
+                        return false;
+                    }
+                    if (!first) out.push_back(',');
+                    first = false;
+                    appendAnyValue(array_reader.readBytes(), depth + 2, out);
+                    return true;
+                });
+                return true;
+            }
+            case AnyValue::kKvlistValueFieldNumber: {
+                if (wire_type != kLengthDelimited) return false;
+                out.resize(start);
+                bool first = true;
+                forEachField(reader.readBytes(), depth + 1,
+                             [&](uint32_t list_field, uint32_t list_wire_type, WireReader& list_reader) {
+                    if (list_field != KeyValueList::kValuesFieldNumber || list_wire_type != kLengthDelimited) {
+                        return false;
+                    }
+                    std::string_view key;
+                    std::string_view value;
+                    readKeyValue(list_reader.readBytes(), depth + 2, key, value);
+                    if (!first) out.push_back(',');
+                    first = false;
+                    out.append(key);
+                    out.push_back('=');
+                    appendAnyValue(value, depth + 3, out);
+                    return true;
+                });
+                return true;
+            }
+            default:
+                return false;
+        }
+    });
+}
+
+class Decoder {
+public:
+    Decoder(int64_t kafka_offset, LogRecordBatch& batch)
+        : kafka_offset_(kafka_offset)
+        , batch_(batch) {}
+
+    void decodeRequest(std::string_view message) {
+        forEachField(message, 0, [this](uint32_t field, uint32_t wire_type, WireReader& reader) {
+            if (field != ExportLogsServiceRequest::kResourceLogsFieldNumber || wire_type != kLengthDelimited) {
+                return false;
+            }
+            decodeResourceLogs(reader.readBytes());
+            return true;
+        });
+    }
+
+private:
+    int64_t kafka_offset_;
+    LogRecordBatch& batch_;
+
+    void decodeResourceLogs(std::string_view message) {
+        const size_t rows_before = batch_.size();
+        const uint32_t res_idx = static_cast<uint32_t>(batch_.resourceCount());
+
+        // Encoded values of the well-known attributes (last occurrence wins)
+        std::string_view service_name;
+        std::string_view deployment_environment;
+        std::string_view host_name;
+
+        forEachField(message, 1, [&](uint32_t field, uint32_t wire_type, WireReader& reader) {
+            if (wire_type != kLengthDelimited) {
+                return false;
+            }
+            if (field == ResourceLogs::kResourceFieldNumber) {
+                forEachField(reader.readBytes(), 2, [&](uint32_t res_field, uint32_t res_wire_type, WireReader& res_reader) {
+                    if (res_field != Resource::kAttributesFieldNumber || res_wire_type != kLengthDelimited) {
+                        return false;
+                    }
+                    std::string_view key;
+                    std::string_view value;
+                    readKeyValue(res_reader.readBytes(), 3, key, value);
+                    if (key == "service.name") {
+                        service_name = value;
+                    } else if (key == "deployment.environment") {
+                        deployment_environment = value;
+                    } else if (key == "host.name") {
+                        host_name = value;
+                    } else {
+                        batch_.resource_attr_keys.append(key);
+                        appendAnyValue(value, 4, batch_.resource_attr_values.data);
+                        batch_.resource_attr_values.commit();
+                    }
+                    return true;
+                });
+                return true;
+            }
+            if (field == ResourceLogs::kScopeLogsFieldNumber) {
+                forEachField(reader.readBytes(), 2, [&](uint32_t scope_field, uint32_t scope_wire_type, WireReader& scope_reader) {
+                    if (scope_field != ScopeLogs::kLogRecordsFieldNumber || scope_wire_type != kLengthDelimited) {
+                        return false;
+                    }
+                    decodeLogRecord(scope_reader.readBytes(), res_idx);
+                    return true;
+                });
+                return true;
+            }
+            return false;
+        });
+
+        // Resources without records are dropped, like transformToBatch does
+        if (batch_.size() == rows_before) {
+            size_t committed = batch_.resource_attr_offsets.back();
+            batch_.resource_attr_keys.truncate(committed);
+            batch_.resource_attr_values.truncate(committed);
+            return;
+        }
+
+        batch_.resource_attr_offsets.push_back(batch_.resource_attr_keys.size());
+        appendAnyValue(service_name, 4, batch_.service_name.data);
+        batch_.service_name.commit();
+        appendAnyValue(deployment_environment, 4, batch_.deployment_environment.data);
+        batch_.deployment_environment.commit();
+        appendAnyValue(host_name, 4, batch_.host_name.data);
+        batch_.host_name.commit();
+    }
+
+    void decodeLogRecord(std::string_view message, uint32_t res_idx) {
+        uint64_t time_nanos = 0;
+        uint64_t observed_nanos = 0;
+        int32_t severity_number = 0;
+        std::string_view severity_text;
+        std::string_view body;
+        std::string_view trace_id;
+        std::string_view span_id;
+
+        forEachField(message, 3, [&](uint32_t field, uint32_t wire_type, WireReader& reader) {
+            switch (field) {
+                case LogRecord::kTimeUnixNanoFieldNumber:
+                    if (wire_type != kFixed64) return false;
+                    time_nanos = reader.readFixed64();
+                    return true;
+                case LogRecord::kObservedTimeUnixNanoFieldNumber:
+                    if (wire_type != kFixed64) return false;
+                    observed_nanos = reader.readFixed64();
+                    return true;
+                case LogRecord::kSeverityNumberFieldNumber:
+                    if (wire_type != kVarint) return false;
+                    severity_number = static_cast<int32_t>(reader.readVarint());
+                    return true;
+                case LogRecord::kSeverityTextFieldNumber:
+                    if (wire_type != kLengthDelimited) return false;
+                    severity_text = reader.readBytes();
+                    return true;
+                case LogRecord::kBodyFieldNumber:
+                    if (wire_type != kLengthDelimited) return false;
+                    body = reader.readBytes();
+                    return true;
+                case LogRecord::kTraceIdFieldNumber:
+                    if (wire_type != kLengthDelimited) return false;
+                    trace_id = reader.readBytes();
+                    return true;
+                case LogRecord::kSpanIdFieldNumber:
+                    if (wire_type != kLengthDelimited) return false;
+                    span_id = reader.readBytes();
+                    return true;
+                case LogRecord::kAttributesFieldNumber: {
+                    if (wire_type != kLengthDelimited) return false;
+                    std::string_view key;
+                    std::string_view value;
+                    readKeyValue(reader.readBytes(), 4, key, value);
+                    batch_.attr_keys.append(key);
+                    appendAnyValue(value, 5, batch_.attr_values.data);
+                    batch_.attr_values.commit();
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        });
+
+        batch_.kafka_offset.push_back(kafka_offset_);
+        batch_.timestamp.push_back(LogTransformer::nanosToTimePoint(time_nanos > 0 ? time_nanos : observed_nanos));
+        if (!severity_text.empty()) {
+            batch_.severity.append(severity_text);
+        } else {
+            batch_.severity.append(LogTransformer::severityNumberText(severity_number));
+        }
+        appendAnyValue(body, 4, batch_.body.data);
+        batch_.body.commit();
+        LogTransformer::appendHex(trace_id, batch_.trace_id.data);
+        batch_.trace_id.commit();
+        LogTransformer::appendHex(span_id, batch_.span_id.data);
+        batch_.span_id.commit();
+        batch_.resource_index.push_back(res_idx);
+        batch_.attr_offsets.push_back(batch_.attr_keys.size());
+    }
+};
+
+}  // namespace
+
+size_t OtlpProtoDecoder::decode(std::string_view payload,
+                                const std::string& kafka_topic,
+                                int32_t kafka_partition,
+                                int64_t kafka_offset,
+                                LogRecordBatch& batch) {
+    if (batch.empty()) {
+        batch.kafka_topic = kafka_topic;
+        batch.kafka_partition = kafka_partition;
+    }
+
+    const size_t rows_before = batch.size();
+    const size_t resources_before = batch.resourceCount();
+    try {
+        Decoder decoder(kafka_offset, batch);
+        decoder.decodeRequest(payload);
+    } catch (...) {
+        batch.truncate(rows_before, resources_before);
+        throw;
+    }
+
+    return batch.size() - rows_before;
+}
@@ -0,0 +1,29 @@
+#ifndef OTLP_PROTO_DECODER_HPP
+#define OTLP_PROTO_DECODER_HPP
+
+#include "log_transformer.hpp"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Decodes protobuf ExportLogsServiceRequest payloads straight into a LogRecordBatch
+//
+// Single pass over the wire format with no intermediate protobuf message:
+// resource, scope and log-record fields are streamed into the batch columns
+// and string fields are read as views of the input, so each string is copied
+// once, into its column. Output matches ParseFromArray followed by
+// LogTransformer::transformToBatch for well-formed input. Unknown fields are
+// skipped. Strings are not UTF-8 validated.
+class OtlpProtoDecoder {
+public:
+    // Decode `payload` and append its log records to `batch`
+    // Returns the number of log records appended
+    // Throws std::runtime_error on malformed input, leaving `batch` unchanged
+    static size_t decode(std::string_view payload,
+                         const std::string& kafka_topic,
+                         int32_t kafka_partition,
+                         int64_t kafka_offset,
+                         LogRecordBatch& batch);
+};
+
+#endif // OTLP_PROTO_DECODER_HPP
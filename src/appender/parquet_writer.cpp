@@ -0,0 +1,637 @@
+#include "parquet_writer.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Parquet physical types, encodings and codecs (parquet.thrift)
+constexpr int32_t kTypeInt32 = 1;
+constexpr int32_t kTypeInt64 = 2;
+constexpr int32_t kTypeByteArray = 6;
+constexpr int32_t kRequired = 0;
+constexpr int32_t kOptional = 1;
+constexpr int32_t kRepeated = 2;
+constexpr int32_t kConvertedUtf8 = 0;
+constexpr int32_t kConvertedMap = 1;
+constexpr int32_t kEncodingPlain = 0;
+constexpr int32_t kEncodingRle = 3;
+constexpr int32_t kCodecUncompressed = 0;
+constexpr int32_t kCodecGzip = 2;
+constexpr int32_t kDataPage = 0;
+
+enum Column : size_t {
+    KAFKA_TOPIC,
+    KAFKA_PARTITION,
+    KAFKA_OFFSET,
+    TIMESTAMP,
+    SEVERITY,
+    BODY,
+    TRACE_ID,
+    SPAN_ID,
+    SERVICE_NAME,
+    DEPLOYMENT_ENVIRONMENT,
+    HOST_NAME,
+    ATTRIBUTE_KEY,
+    ATTRIBUTE_VALUE,
+    COLUMN_COUNT
+};
+
+// Leaf column layout; field ids follow Iceberg's assignment for the logs
+// table (top-level fields first, then the map's key and value)
+struct ColumnSpec {
+    const char* name;
+    int32_t type;
+    int field_id;
+    int max_rep;
+    int max_def;
+};
+
+constexpr ColumnSpec kColumns[COLUMN_COUNT] = {
+    {"_kafka_topic", kTypeByteArray, 1, 0, 1},
+    {"_kafka_partition", kTypeInt32, 2, 0, 1},
+    {"_kafka_offset", kTypeInt64, 3, 0, 1},
+    {"timestamp", kTypeInt64, 4, 0, 1},
+    {"severity", kTypeByteArray, 5, 0, 1},
+    {"body", kTypeByteArray, 6, 0, 1},
+    {"trace_id", kTypeByteArray, 7, 0, 1},
+    {"span_id", kTypeByteArray, 8, 0, 1},
+    {"service_name", kTypeByteArray, 9, 0, 1},
+    {"deployment_environment", kTypeByteArray, 10, 0, 1},
+    {"host_name", kTypeByteArray, 11, 0, 1},
+    {"key", kTypeByteArray, 13, 1, 2},
+    {"value", kTypeByteArray, 14, 1, 3},
+};
+
+constexpr int kAttributesFieldId = 12;
+
+// Thrift compact protocol encoder, enough for the Parquet footer
+class CompactWriter {
+public:
+    explicit CompactWriter(std::string& out) : out_(out), last_field_(0) {}
+
+    void structBegin() {
+        stack_.push_back(last_field_);
+        last_field_ = 0;
+    }
+
+    void structEnd() {
+        out_.push_back(0);  // STOP
+        last_field_ = stack_.back();
+        stack_.pop_back();
+    }
+
+    void fieldStruct(int16_t id) {
+        fieldHeader(id, 12);
+        structBegin();
+    }
+
+    void fieldI32(int16_t id, int32_t value) {
+        fieldHeader(id, 5);
+        varint(zigzag(value));
+    }
+
+    void fieldI64(int16_t id, int64_t value) {
+        fieldHeader(id, 6);
+        varint(zigzag(value));
+    }
+
+    void fieldBinary(int16_t id, std::string_view value) {
+        fieldHeader(id, 8);
+        binary(value);
+    }
+
+    void fieldBool(int16_t id, bool value) {
+        fieldHeader(id, value ? 1 : 2);
+    }
+
+    void fieldList(int16_t id, uint8_t element_type, size_t size) {
+        fieldHeader(id, 9);
+        if (size < 15) {
+            out_.push_back(static_cast<char>((size << 4) | element_type));
+        } else {
+            out_.push_back(static_cast<char>(0xF0 | element_type));
+            varint(size);
+        }
+    }
+
+    // List elements
+    void i32(int32_t value) { varint(zigzag(value)); }
+
+    void binary(std::string_view value) {
+        varint(value.size());
+        out_.append(value.data(), value.size());
+    }
+
+private:
+    std::string& out_;
+    int16_t last_field_;
+    std::vector<int16_t> stack_;
+
+    static uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void fieldHeader(int16_t id, uint8_t type) {
+        int delta = id - last_field_;
+        if (delta > 0 && delta <= 15) {
+            out_.push_back(static_cast<char>((delta << 4) | type));
+        } else {
+            out_.push_back(static_cast<char>(type));
+            varint(zigzag(id));
+        }
+        last_field_ = id;
+    }
+};
+
+void appendLE32(std::string& out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+    out.append(bytes, 4);
+}
+
+void appendLE64(std::string& out, uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+    out.append(bytes, 8);
+}
+
+void appendPlainString(std::string& out, std::string_view value) {
+    appendLE32(out, static_cast<uint32_t>(value.size()));
+    out.append(value.data(), value.size());
+}
+
+// RLE/bit-packing hybrid levels with the 4-byte length prefix of a V1 data
+// page; only RLE runs are emitted. A flat column's levels are all 1.
+void appendLevels(std::string& out, const std::vector<uint8_t>& levels, uint64_t uniform_count) {
+    size_t length_at = out.size();
+    appendLE32(out, 0);
+
+    auto run = [&out](uint64_t count, uint8_t level) {
+        uint64_t header = count << 1;
+        while (header >= 0x80) {
+            out.push_back(static_cast<char>(header | 0x80));
+            header >>= 7;
+        }
+        out.push_back(static_cast<char>(header));
+        out.push_back(static_cast<char>(level));  // Bit widths here are at most 2
+    };
+
+    if (levels.empty()) {
+        if (uniform_count > 0) {
+            run(uniform_count, 1);
+        }
+    } else {
+        size_t i = 0;
+        while (i < levels.size()) {
+            size_t j = i + 1;
+            while (j < levels.size() && levels[j] == levels[i]) {
+                ++j;
+            }
+            run(j - i, levels[i]);
+            i = j;
+        }
+    }
+
+    uint32_t length = static_cast<uint32_t>(out.size() - length_at - 4);
+    for (int i = 0; i < 4; ++i) {
+        out[length_at + i] = static_cast<char>(length >> (8 * i));
+    }
+}
+
+int fieldId(const std::map<std::string, int>& field_ids, const std::string& path, int fallback) {
+    auto it = field_ids.find(path);
+    return it != field_ids.end() ? it->second : fallback;
+}
+
+void writeSchemaLeaf(CompactWriter& w, const ColumnSpec& spec, int32_t repetition, int field_id) {
+    w.structBegin();
+    w.fieldI32(1, spec.type);
+    w.fieldI32(3, repetition);
+    w.fieldBinary(4, spec.name);
+    if (spec.type == kTypeByteArray) {
+        w.fieldI32(6, kConvertedUtf8);
+    }
+    w.fieldI32(9, field_id);
+    if (spec.type == kTypeByteArray) {
+        w.fieldStruct(10);  // LogicalType
+        w.fieldStruct(1);   // STRING
+        w.structEnd();
+        w.structEnd();
+    } else if (&spec == &kColumns[TIMESTAMP]) {
+        w.fieldStruct(10);  // LogicalType
+        w.fieldStruct(8);   // TIMESTAMP
+        w.fieldBool(1, false);  // isAdjustedToUTC
+        w.fieldStruct(2);   // unit
+        w.fieldStruct(2);   // MICROS
+        w.structEnd();
+        w.structEnd();
+        w.structEnd();
+        w.structEnd();
+    }
+    w.structEnd();
+}
+
+void writeSchema(CompactWriter& w, const std::map<std::string, int>& field_ids) {
+    // Root, the eleven flat columns, then attributes (MAP) > key_value > key, value
+    w.fieldList(2, 12, 1 + ATTRIBUTE_KEY + 4);
+
+    w.structBegin();
+    w.fieldBinary(4, "schema");
+    w.fieldI32(5, ATTRIBUTE_KEY + 1);
+    w.structEnd();
+
+    for (size_t c = 0; c < ATTRIBUTE_KEY; ++c) {
+        writeSchemaLeaf(w, kColumns[c], kOptional, fieldId(field_ids, kColumns[c].name, kColumns[c].field_id));
+    }
+
+    w.structBegin();
+    w.fieldI32(3, kOptional);
+    w.fieldBinary(4, "attributes");
+    w.fieldI32(5, 1);
+    w.fieldI32(6, kConvertedMap);
+    w.fieldI32(9, fieldId(field_ids, "attributes", kAttributesFieldId));
+    w.fieldStruct(10);  // LogicalType
+    w.fieldStruct(2);   // MAP
+    w.structEnd();
+    w.structEnd();
+    w.structEnd();
+
+    w.structBegin();
+    w.fieldI32(3, kRepeated);
+    w.fieldBinary(4, "key_value");
+    w.fieldI32(5, 2);
+    w.structEnd();
+
+    writeSchemaLeaf(w, kColumns[ATTRIBUTE_KEY], kRequired,
+                    fieldId(field_ids, "attributes.key", kColumns[ATTRIBUTE_KEY].field_id));
+    writeSchemaLeaf(w, kColumns[ATTRIBUTE_VALUE], kOptional,
+                    fieldId(field_ids, "attributes.value", kColumns[ATTRIBUTE_VALUE].field_id));
+}
+
+std::string statValue(int32_t type, int64_t value) {
+    std::string out;
+    if (type == kTypeInt32) {
+        appendLE32(out, static_cast<uint32_t>(value));
+    } else {
+        appendLE64(out, static_cast<uint64_t>(value));
+    }
+    return out;
+}
+
+}  // namespace
+
+ParquetWriter::ParquetWriter(Options options)
+    : options_(options)
+    , file_(nullptr)
+    , offset_(0)
+    , failed_(false)
+    , columns_(COLUMN_COUNT)
+    , group_rows_(0) {}
+
+ParquetWriter::~ParquetWriter() {
+    if (file_) {
+        abort();
+    }
+}
+
+ParquetWriter::Codec ParquetWriter::parseCodec(const std::string& name) {
+    if (name == "none" || name == "uncompressed") {
+        return Codec::UNCOMPRESSED;
+    }
+    return Codec::GZIP;
+}
+
+bool ParquetWriter::open(const std::string& path) {
+    if (file_) {
+        abort();
+    }
+    path_ = path;
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to create Parquet file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    offset_ = 0;
+    failed_ = false;
+    group_rows_ = 0;
+    row_groups_.clear();
+    stats_ = FileStats();
+    resetColumns();
+    return writeBytes("PAR1", 4);
+}
+
+bool ParquetWriter::append(const LogRecordBatch& batch) {
+    if (!file_ || failed_) {
+        return false;
+    }
+
+    const size_t rows = batch.size();
+    auto& topic = columns_[KAFKA_TOPIC];
+    auto& partition = columns_[KAFKA_PARTITION];
+    auto& offset = columns_[KAFKA_OFFSET];
+    auto& timestamp = columns_[TIMESTAMP];
+    auto& keys = columns_[ATTRIBUTE_KEY];
+    auto& values = columns_[ATTRIBUTE_VALUE];
+
+    for (size_t row = 0; row < rows; ++row) {
+        appendPlainString(topic.values, batch.kafka_topic);
+        appendLE32(partition.values, static_cast<uint32_t>(batch.kafka_partition));
+        appendLE64(offset.values, static_cast<uint64_t>(batch.kafka_offset[row]));
+        int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            batch.timestamp[row].time_since_epoch()).count();
+        appendLE64(timestamp.values, static_cast<uint64_t>(micros));
+
+        appendPlainString(columns_[SEVERITY].values, batch.severity.get(row));
+        appendPlainString(columns_[BODY].values, batch.body.get(row));
+        appendPlainString(columns_[TRACE_ID].values, batch.trace_id.get(row));
+        appendPlainString(columns_[SPAN_ID].values, batch.span_id.get(row));
+
+        uint32_t res = batch.resource_index[row];
+        appendPlainString(columns_[SERVICE_NAME].values, batch.service_name.get(res));
+        appendPlainString(columns_[DEPLOYMENT_ENVIRONMENT].values, batch.deployment_environment.get(res));
+        appendPlainString(columns_[HOST_NAME].values, batch.host_name.get(res));
+
+        // One level entry per map entry, or a single entry for an empty map
+        uint8_t rep = 0;
+        batch.forEachAttribute(row, [&](std::string_view key, std::string_view value) {
+            keys.rep_levels.push_back(rep);
+            keys.def_levels.push_back(2);
+            values.rep_levels.push_back(rep);
+            values.def_levels.push_back(3);
+            appendPlainString(keys.values, key);
+            appendPlainString(values.values, value);
+            rep = 1;
+        });
+        if (rep == 0) {
+            keys.rep_levels.push_back(0);
+            keys.def_levels.push_back(1);
+            values.rep_levels.push_back(0);
+            values.def_levels.push_back(1);
+        }
+
+        for (size_t c : {KAFKA_PARTITION, KAFKA_OFFSET, TIMESTAMP}) {
+            auto& column = columns_[c];
+            int64_t value = c == KAFKA_PARTITION ? batch.kafka_partition
+                          : c == KAFKA_OFFSET ? batch.kafka_offset[row] : micros;
+            if (!column.has_stats) {
+                column.has_stats = true;
+                column.min = column.max = value;
+            } else {
+                column.min = std::min(column.min, value);
+                column.max = std::max(column.max, value);
+            }
+        }
+    }
+
+    for (size_t c = 0; c < ATTRIBUTE_KEY; ++c) {
+        columns_[c].num_values += rows;
+    }
+    keys.num_values = keys.rep_levels.size();
+    values.num_values = values.rep_levels.size();
+    group_rows_ += rows;
+
+    if (bufferedBytes() >= options_.row_group_bytes) {
+        return flushRowGroup();
+    }
+    return true;
+}
+
+size_t ParquetWriter::bufferedBytes() const {
+    size_t bytes = 0;
+    for (const auto& column : columns_) {
+        bytes += column.values.size() + column.rep_levels.size() + column.def_levels.size();
+    }
+    return bytes;
+}
+
+bool ParquetWriter::close() {
+    if (!file_) {
+        return false;
+    }
+    bool ok = !failed_ && flushRowGroup() && writeFooter();
+    if (std::fclose(file_) != 0) {
+        ok = false;
+    }
+    file_ = nullptr;
+    resetColumns();
+    if (!ok) {
+        std::cerr << "Failed to write Parquet file " << path_ << std::endl;
+        std::remove(path_.c_str());
+        return false;
+    }
+    stats_.file_bytes = offset_;
+    return true;
+}
+
+void ParquetWriter::abort() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    if (!path_.empty()) {
+        std::remove(path_.c_str());
+    }
+    resetColumns();
+    row_groups_.clear();
+}
+
+bool ParquetWriter::writeBytes(const void* data, size_t size) {
+    if (failed_) {
+        return false;
+    }
+    if (std::fwrite(data, 1, size, file_) != size) {
+        std::cerr << "Failed to write Parquet file " << path_ << ": " << std::strerror(errno) << std::endl;
+        failed_ = true;
+        return false;
+    }
+    offset_ += size;
+    return true;
+}
+
+bool ParquetWriter::flushRowGroup() {
+    if (group_rows_ == 0) {
+        return true;
+    }
+
+    RowGroupMeta group;
+    group.num_rows = static_cast<int64_t>(group_rows_);
+    group.columns.resize(COLUMN_COUNT);
+    for (size_t c = 0; c < COLUMN_COUNT; ++c) {
+        if (!writeColumnChunk(c, group.columns[c])) {
+            return false;
+        }
+        group.total_byte_size += group.columns[c].uncompressed_size;
+    }
+
+    const auto& offsets = group.columns[KAFKA_OFFSET];
+    const auto& timestamps = group.columns[TIMESTAMP];
+    if (stats_.rows == 0) {
+        stats_.min_offset = offsets.min;
+        stats_.max_offset = offsets.max;
+        stats_.min_timestamp_us = timestamps.min;
+        stats_.max_timestamp_us = timestamps.max;
+    } else {
+        stats_.min_offset = std::min(stats_.min_offset, offsets.min);
+        stats_.max_offset = std::max(stats_.max_offset, offsets.max);
+        stats_.min_timestamp_us = std::min(stats_.min_timestamp_us, timestamps.min);
+        stats_.max_timestamp_us = std::max(stats_.max_timestamp_us, timestamps.max);
+    }
+    stats_.rows += group_rows_;
+
+    row_groups_.push_back(std::move(group));
+    group_rows_ = 0;
+    resetColumns();
+    return true;
+}
+
+bool ParquetWriter::writeColumnChunk(size_t column, ChunkMeta& meta) {
+    const ColumnSpec& spec = kColumns[column];
+    ColumnBuffer& buffer = columns_[column];
+
+    // Page body: repetition levels, definition levels, values
+    std::string page;
+    page.reserve(buffer.values.size() + buffer.rep_levels.size() / 4 + 64);
+    if (spec.max_rep > 0) {
+        appendLevels(page, buffer.rep_levels, buffer.num_values);
+    }
+    appendLevels(page, buffer.def_levels, buffer.num_values);
+    page.append(buffer.values);
+
+    std::string_view body = page;
+    if (options_.codec == Codec::GZIP) {
+        z_stream stream{};
+        if (deflateInit2(&stream, options_.compression_level, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            std::cerr << "Failed to initialize gzip for Parquet page" << std::endl;
+            failed_ = true;
+            return false;
+        }
+        compressed_.resize(deflateBound(&stream, page.size()));
+        stream.next_in = reinterpret_cast<Bytef*>(page.data());
+        stream.avail_in = static_cast<uInt>(page.size());
+        stream.next_out = reinterpret_cast<Bytef*>(compressed_.data());
+        stream.avail_out = static_cast<uInt>(compressed_.size());
+        int rc = deflate(&stream, Z_FINISH);
+        size_t compressed_size = stream.total_out;
+        deflateEnd(&stream);
+        if (rc != Z_STREAM_END) {
+            std::cerr << "Failed to compress Parquet page" << std::endl;
+            failed_ = true;
+            return false;
+        }
+        body = std::string_view(compressed_.data(), compressed_size);
+    }
+
+    std::string header;
+    CompactWriter w(header);
+    w.structBegin();
+    w.fieldI32(1, kDataPage);
+    w.fieldI32(2, static_cast<int32_t>(page.size()));
+    w.fieldI32(3, static_cast<int32_t>(body.size()));
+    w.fieldStruct(5);  // DataPageHeader
+    w.fieldI32(1, static_cast<int32_t>(buffer.num_values));
+    w.fieldI32(2, kEncodingPlain);
+    w.fieldI32(3, kEncodingRle);
+    w.fieldI32(4, kEncodingRle);
+    w.structEnd();
+    w.structEnd();
+
+    meta.data_page_offset = static_cast<int64_t>(offset_);
+    meta.uncompressed_size = static_cast<int64_t>(header.size() + page.size());
+    meta.compressed_size = static_cast<int64_t>(header.size() + body.size());
+    meta.num_values = static_cast<int64_t>(buffer.num_values);
+    meta.has_stats = buffer.has_stats;
+    meta.min = buffer.min;
+    meta.max = buffer.max;
+
+    return writeBytes(header.data(), header.size()) && writeBytes(body.data(), body.size());
+}
+
+bool ParquetWriter::writeFooter() {
+    std::string footer;
+    CompactWriter w(footer);
+    w.structBegin();  // FileMetaData
+    w.fieldI32(1, 1);
+    writeSchema(w, options_.field_ids);
+    w.fieldI64(3, static_cast<int64_t>(stats_.rows));
+
+    w.fieldList(4, 12, row_groups_.size());
+    for (const auto& group : row_groups_) {
+        w.structBegin();  // RowGroup
+        w.fieldList(1, 12, group.columns.size());
+        int64_t compressed_size = 0;
+        for (size_t c = 0; c < group.columns.size(); ++c) {
+            const ColumnSpec& spec = kColumns[c];
+            const ChunkMeta& chunk = group.columns[c];
+            compressed_size += chunk.compressed_size;
+
+            w.structBegin();  // ColumnChunk
+            w.fieldI64(2, chunk.data_page_offset);
+            w.fieldStruct(3);  // ColumnMetaData
+            w.fieldI32(1, spec.type);
+            w.fieldList(2, 5, 2);
+            w.i32(kEncodingPlain);
+            w.i32(kEncodingRle);
+            if (c >= ATTRIBUTE_KEY) {
+                w.fieldList(3, 8, 3);
+                w.binary("attributes");
+                w.binary("key_value");
+            } else {
+                w.fieldList(3, 8, 1);
+            }
+            w.binary(spec.name);
+            w.fieldI32(4, options_.codec == Codec::GZIP ? kCodecGzip : kCodecUncompressed);
+            w.fieldI64(5, chunk.num_values);
+            w.fieldI64(6, chunk.uncompressed_size);
+            w.fieldI64(7, chunk.compressed_size);
+            w.fieldI64(9, chunk.data_page_offset);
+            if (chunk.has_stats) {
+                w.fieldStruct(12);  // Statistics
+                w.fieldI64(3, 0);   // null_count
+                w.fieldBinary(5, statValue(spec.type, chunk.max));
+                w.fieldBinary(6, statValue(spec.type, chunk.min));
+                w.structEnd();
+            }
+            w.structEnd();
+            w.structEnd();
+        }
+        w.fieldI64(2, group.total_byte_size);
+        w.fieldI64(3, group.num_rows);
+        w.fieldI64(5, group.columns.front().data_page_offset);
+        w.fieldI64(6, compressed_size);
+        w.structEnd();
+    }
+
+    w.fieldBinary(6, "otel-appender");
+    w.structEnd();
+
+    appendLE32(footer, static_cast<uint32_t>(footer.size()));
+    footer.append("PAR1", 4);
+    return writeBytes(footer.data(), footer.size()) && std::fflush(file_) == 0;
+}
+
+void ParquetWriter::resetColumns() {
+    for (auto& column : columns_) {
+        column.values.clear();
+        column.rep_levels.clear();
+        column.def_levels.clear();
+        column.num_values = 0;
+        column.has_stats = false;
+    }
+}
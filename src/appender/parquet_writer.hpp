@@ -0,0 +1,126 @@
+#ifndef PARQUET_WRITER_HPP
+#define PARQUET_WRITER_HPP
+
+#include "log_transformer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Streams LogRecordBatches into a Parquet file with the Iceberg logs schema
+// Only the current row group is held in memory: once it reaches
+// row_group_bytes its column chunks are written out (one PLAIN-encoded data
+// page per column) and the buffers are reused. close() writes the footer.
+//
+// Columns are optional (nullable, as in the DuckDB-created table) but never
+// null; attributes is a MAP of required keys to optional values. Every
+// column carries its Iceberg field id so the file can be added to the table
+// as-is.
+class ParquetWriter {
+public:
+    enum class Codec {
+        UNCOMPRESSED,
+        GZIP
+    };
+
+    struct Options {
+        size_t row_group_bytes = 16 * 1024 * 1024;
+        Codec codec = Codec::GZIP;
+        int compression_level = 1;
+
+        // Iceberg field ids by column path ("attributes.key"); columns not
+        // listed keep the ids of a freshly created logs table
+        std::map<std::string, int> field_ids;
+    };
+
+    // Per-file metrics for the data file's manifest entry
+    struct FileStats {
+        uint64_t rows = 0;
+        uint64_t file_bytes = 0;
+        int64_t min_offset = 0;
+        int64_t max_offset = -1;
+        int64_t min_timestamp_us = 0;
+        int64_t max_timestamp_us = 0;
+    };
+
+    explicit ParquetWriter(Options options);
+    ~ParquetWriter();
+
+    ParquetWriter(const ParquetWriter&) = delete;
+    ParquetWriter& operator=(const ParquetWriter&) = delete;
+
+    // Create (truncate) the file and write the header
+    bool open(const std::string& path);
+
+    // Buffer a batch; writes out the row group once it is full
+    bool append(const LogRecordBatch& batch);
+
+    // Write the last row group and the footer
+    bool close();
+
+    // Close and delete the file
+    void abort();
+
+    bool isOpen() const { return file_ != nullptr; }
+    const std::string& path() const { return path_; }
+    const FileStats& stats() const { return stats_; }
+
+    // Bytes held for the current row group
+    size_t bufferedBytes() const;
+
+    // "none" or "uncompressed" is UNCOMPRESSED; anything else is GZIP
+    static Codec parseCodec(const std::string& name);
+
+private:
+    // One leaf column of the current row group
+    struct ColumnBuffer {
+        std::string values;              // PLAIN-encoded values
+        std::vector<uint8_t> rep_levels; // Only for the map columns
+        std::vector<uint8_t> def_levels; // Only for the map columns
+        uint64_t num_values = 0;         // Level entries (rows for flat columns)
+        bool has_stats = false;
+        int64_t min = 0;
+        int64_t max = 0;
+    };
+
+    // Where a written column chunk ended up, for the footer
+    struct ChunkMeta {
+        int64_t data_page_offset = 0;
+        int64_t uncompressed_size = 0;
+        int64_t compressed_size = 0;
+        int64_t num_values = 0;
+        bool has_stats = false;
+        int64_t min = 0;
+        int64_t max = 0;
+    };
+
+    struct RowGroupMeta {
+        int64_t num_rows = 0;
+        int64_t total_byte_size = 0;
+        std::vector<ChunkMeta> columns;
+    };
+
+    Options options_;
+    std::string path_;
+    FILE* file_;
+    uint64_t offset_;  // Bytes written so far
+    bool failed_;
+
+    std::vector<ColumnBuffer> columns_;
+    uint64_t group_rows_;
+    std::vector<RowGroupMeta> row_groups_;
+    FileStats stats_;
+
+    // Page compression scratch
+    std::string compressed_;
+
+    bool writeBytes(const void* data, size_t size);
+    bool flushRowGroup();
+    bool writeColumnChunk(size_t column, ChunkMeta& meta);
+    bool writeFooter();
+    void resetColumns();
+};
+
+#endif // PARQUET_WRITER_HPP
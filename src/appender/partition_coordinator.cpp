@@ -1,6 +1,7 @@
 #include "partition_coordinator.hpp"
 #include <iostream>
 #include <algorithm>
+#include <filesystem>
 
 PartitionCoordinator::PartitionCoordinator(const AppenderConfig& config)
     : config_(config)
@@ -15,8 +16,23 @@ PartitionCoordinator::~PartitionCoordinator() {
 
 bool PartitionCoordinator::initialize() {
     try {
-        // Initialize shared DuckDB instance (in-memory for speed)
-        db_ = std::make_unique<DuckDB>(nullptr);
+        // Initialize shared DuckDB instance (in-memory for speed, or on disk so
+        // buffers survive a crash)
+        if (!config_.buffer_db_path.empty() && config_.useParquetSink()) {
+            std::cerr << "BUFFER_DB_PATH requires BUFFER_SINK=duckdb" << std::endl;
+            return false;
+        }
+        if (config_.usePersistentBuffer()) {
+            std::error_code ec;
+            std::filesystem::path db_dir = std::filesystem::path(config_.buffer_db_path).parent_path();
+            if (!db_dir.empty()) {
+                std::filesystem::create_directories(db_dir, ec);
+            }
+            db_ = std::make_unique<DuckDB>(config_.buffer_db_path.c_str());
+            std::cout << "Buffering in " << config_.buffer_db_path << std::endl;
+        } else {
+            db_ = std::make_unique<DuckDB>(nullptr);
+        }
         main_conn_ = std::make_unique<Connection>(*db_);
 
         // Load extensions on main connection
@@ -37,6 +53,27 @@ bool PartitionCoordinator::initialize() {
             return false;
         }
 
+        // Native commits append the Parquet buffer files through the REST catalog
+        if (config_.iceberg_commit_mode == "rest") {
+            if (!config_.useParquetSink()) {
+                std::cerr << "ICEBERG_COMMIT_MODE=rest requires BUFFER_SINK=parquet" << std::endl;
+                return false;
+            }
+            rest_client_ = std::make_shared<IcebergRestClient>(config_);
+            if (!rest_client_->loadTable()) {
+                std::cerr << "Failed to load Iceberg table through the REST catalog" << std::endl;
+                return false;
+            }
+            std::shared_ptr<IcebergRestClient> client = rest_client_;
+            std::string topic = config_.queue_topic;
+            commit_aggregator_ = std::make_shared<CommitAggregator>(
+                config_,
+                [client, topic](const std::vector<IcebergDataFile>& files, const std::map<int32_t, int64_t>& offsets) {
+                    return client->appendFiles(files, offsets, topic);
+                });
+            commit_aggregator_->start();
+        }
+
         // Initialize consumer
         consumer_ = std::make_unique<QueueConsumer>(config_);
         if (!consumer_->initialize()) {
@@ -44,15 +81,38 @@ bool PartitionCoordinator::initialize() {
             return false;
         }
 
+        // Memory budget: configured, or a share of the container's memory limit
+        size_t memory_budget = config_.memory_budget_mb * 1024 * 1024;
+        if (memory_budget == 0) {
+            size_t cgroup_limit = BufferManager::readCgroupMemoryLimit();
+            memory_budget = cgroup_limit / 100 * static_cast<size_t>(std::clamp(config_.memory_budget_percent, 1, 100));
+        }
+        if (memory_budget > 0) {
+            memory_budget_ = std::make_unique<BufferManager>(memory_budget, config_.partition_buffer_time_seconds);
+            memory_flush_policy_ = BufferManager::parseFlushPolicy(config_.memory_flush_policy);
+        }
+
+        // Decode off the poll thread when configured
+        if (config_.decode_threads > 0) {
+            decode_pool_ = std::make_unique<DecodePool>(static_cast<size_t>(config_.decode_threads));
+        }
+
         // Set up rebalance callbacks
-        consumer_->setAssignmentCallback([this](const std::vector<int32_t>& partitions) {
-            onPartitionsAssigned(partitions);
+        consumer_->setAssignmentCallback([this](const std::vector<int32_t>& partitions,
+                                                std::map<int32_t, int64_t>& start_offsets) {
+            onPartitionsAssigned(partitions, start_offsets);
         });
 
         consumer_->setRevocationCallback([this](const std::vector<int32_t>& partitions) {
             onPartitionsRevoked(partitions);
         });
 
+        // Pause/resume partitions as worker queues fill and drain
+        consumer_->setPollCallback([this]() {
+            rewindLostBuffers();
+            applyBackpressure();
+        });
+
         std::cout << "PartitionCoordinator initialized successfully" << std::endl;
         std::cout << "Iceberg table: " << full_table_name_ << std::endl;
         return true;
@@ -76,14 +136,29 @@ void PartitionCoordinator::start() {
               << config_.partition_buffer_time_seconds << " seconds" << std::endl;
     std::cout << "Iceberg commit retries: " << config_.iceberg_commit_retries
               << " (base delay: " << config_.iceberg_retry_base_delay_ms << "ms)" << std::endl;
+    std::cout << "Per-partition queue limit: " << config_.partition_queue_max_messages << " messages or "
+              << config_.partition_queue_max_mb << " MB" << std::endl;
+    if (memory_budget_) {
+        std::cout << "Memory budget: " << (memory_budget_->getMaxSize() / (1024 * 1024)) << " MB (flush "
+                  << config_.memory_flush_policy << " buffers above " << config_.memory_flush_percent << "%)" << std::endl;
+    }
 
-    // Start consuming messages - the callback dispatches to workers
-    consumer_->start([this](const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
-                            const KafkaMessageMeta& meta) {
+    // Poll thread only groups messages by partition; decoding and dispatch run
+    // on the decode pool when configured, otherwise inline
+    if (decode_pool_) {
+        decode_pool_->start();
+    }
+    consumer_->startRaw([this](RawBatch& batch) {
         if (!running_ || stop_requested_) {
             return;
         }
-        processMessage(request, meta);
+        if (decode_pool_) {
+            submitRawBatch(batch);
+            return;
+        }
+        for (const auto& kv : batch) {
+            decodeAndDispatch(kv.first, kv.second);
+        }
     });
 
     running_ = false;
@@ -103,6 +178,11 @@ void PartitionCoordinator::stop() {
         consumer_->stop();
     }
 
+    // Finish decoding what was already polled so workers flush it
+    if (decode_pool_) {
+        decode_pool_->stop();
+    }
+
     // Stop all workers
     {
         std::lock_guard<std::mutex> lock(workers_mutex_);
@@ -119,6 +199,11 @@ void PartitionCoordinator::stop() {
         workers_.clear();
     }
 
+    // Workers' final files are committed; nothing else will be submitted
+    if (commit_aggregator_) {
+        commit_aggregator_->stop();
+    }
+
     // Final offset commit
     commitPendingOffsets();
 
@@ -162,12 +247,13 @@ size_t PartitionCoordinator::getTotalBufferRecordCount() const {
     return total;
 }
 
-void PartitionCoordinator::createWorker(int32_t partition) {
-    std::lock_guard<std::mutex> lock(workers_mutex_);
-
-    if (workers_.find(partition) != workers_.end()) {
-        std::cout << "Partition " << partition << ": Worker already exists" << std::endl;
-        return;
+int64_t PartitionCoordinator::createWorker(int32_t partition) {
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        if (workers_.find(partition) != workers_.end()) {
+            std::cout << "Partition " << partition << ": Worker already exists" << std::endl;
+            return -1;
+        }
     }
 
     auto worker = std::make_unique<PartitionWorker>(
@@ -175,19 +261,54 @@ void PartitionCoordinator::createWorker(int32_t partition) {
         *db_,
         config_,
         full_table_name_,
-        [this](int32_t p, int64_t offset) { onOffsetCommitted(p, offset); }
+        [this](int32_t p, int64_t offset) { onOffsetCommitted(p, offset); },
+        rest_client_,
+        commit_aggregator_
     );
 
-    // Recover max offset from Iceberg and seek consumer
-    int64_t max_offset = worker->recoverMaxOffset(config_.queue_topic);
-    if (max_offset >= 0) {
-        consumer_->seekPartition(partition, max_offset + 1);
+    // Recover max offset from Iceberg; the partition starts right after it
+    // Done without holding workers_mutex_ so other partitions keep flowing
+    int64_t max_offset = worker->recoverMaxOffset(config_.queue_topic, [this](int32_t p, int64_t& offset) {
+        return offsetFromFileBounds(p, offset);
+    });
+
+    // Buffers left on disk by a previous run are flushed from there; skip them in Kafka
+    if (config_.usePersistentBuffer()) {
+        max_offset = worker->recoverLocalBuffers(max_offset);
+    }
+
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    if (workers_.find(partition) != workers_.end()) {
+        std::cout << "Partition " << partition << ": Worker already exists" << std::endl;
+        return -1;
     }
 
     worker->start();
     workers_[partition] = std::move(worker);
 
     std::cout << "Partition " << partition << ": Created worker" << std::endl;
+    return max_offset >= 0 ? max_offset + 1 : -1;
+}
+
+bool PartitionCoordinator::offsetFromFileBounds(int32_t partition, int64_t& max_offset) {
+    if (!file_bounds_loaded_) {
+        file_bounds_loaded_ = true;
+        if (!bounds_client_) {
+            bounds_client_ = rest_client_ ? rest_client_ : std::make_shared<IcebergRestClient>(config_);
+        }
+        file_bound_offsets_.clear();
+        file_bounds_ok_ = bounds_client_->offsetsFromFileBounds(config_.queue_topic, file_bound_offsets_);
+        if (!file_bounds_ok_) {
+            std::cerr << "Data file bounds unavailable for offset recovery" << std::endl;
+        }
+    }
+    if (!file_bounds_ok_) {
+        return false;
+    }
+
+    auto it = file_bound_offsets_.find(partition);
+    max_offset = it == file_bound_offsets_.end() ? -1 : it->second;
+    return true;
 }
 
 void PartitionCoordinator::destroyWorker(int32_t partition) {
@@ -202,6 +323,10 @@ void PartitionCoordinator::destroyWorker(int32_t partition) {
     workers_.erase(it);
     lock.unlock();
 
+    if (memory_budget_) {
+        memory_budget_->removeUsage(partition);
+    }
+
     // Stop worker gracefully
     worker->signalStop();
     if (!worker->waitForStop(config_.rebalance_timeout_seconds)) {
@@ -211,15 +336,25 @@ void PartitionCoordinator::destroyWorker(int32_t partition) {
     std::cout << "Partition " << partition << ": Destroyed worker" << std::endl;
 }
 
-void PartitionCoordinator::onPartitionsAssigned(const std::vector<int32_t>& partitions) {
+void PartitionCoordinator::onPartitionsAssigned(const std::vector<int32_t>& partitions,
+                                                std::map<int32_t, int64_t>& start_offsets) {
     std::cout << "Partitions assigned: ";
     for (int32_t p : partitions) {
         std::cout << p << " ";
     }
     std::cout << std::endl;
 
+    // A new assignment starts unpaused; re-pause on the next poll if still full
+    paused_partitions_.clear();
+
+    // Reread the file bounds if a worker needs them; other writers may have added files
+    file_bounds_loaded_ = false;
+
     for (int32_t partition : partitions) {
-        createWorker(partition);
+        int64_t start_offset = createWorker(partition);
+        if (start_offset >= 0) {
+            start_offsets[partition] = start_offset;
+        }
     }
 }
 
@@ -230,10 +365,17 @@ void PartitionCoordinator::onPartitionsRevoked(const std::vector<int32_t>& parti
     }
     std::cout << std::endl;
 
+    // Let in-flight decode tasks reach their workers before those are destroyed
+    // Runs on the poll thread, so no new tasks are submitted meanwhile
+    if (decode_pool_) {
+        decode_pool_->waitIdle();
+    }
+
     // Commit pending offsets before losing partitions
     commitPendingOffsets();
 
     for (int32_t partition : partitions) {
+        paused_partitions_.erase(partition);
         destroyWorker(partition);
     }
 }
@@ -272,41 +414,179 @@ void PartitionCoordinator::commitPendingOffsets() {
     }
 }
 
-void PartitionCoordinator::processMessage(
-    const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
-    const KafkaMessageMeta& meta) {
+void PartitionCoordinator::applyBackpressure() {
+    enforceMemoryBudget();
+
+    std::vector<int32_t> to_pause;
+    std::vector<int32_t> to_resume;
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (const auto& kv : workers_) {
+            bool paused = paused_partitions_.count(kv.first) > 0;
+            if (!paused && (kv.second->isQueueFull() || memory_paused_)) {
+                to_pause.push_back(kv.first);
+            } else if (paused && kv.second->isQueueDrained() && !memory_paused_) {
+                to_resume.push_back(kv.first);
+            }
+        }
+    }
+
+    // Already-polled messages (one poll cycle plus the decode pool backlog)
+    // still reach a paused worker, so its queue may overshoot the limit slightly
+    for (int32_t partition : to_pause) {
+        if (consumer_->pausePartition(partition)) {
+            paused_partitions_.insert(partition);
+            std::cout << "Partition " << partition << ": Paused, worker queue full" << std::endl;
+        }
+    }
+
+    for (int32_t partition : to_resume) {
+        if (consumer_->resumePartition(partition)) {
+            paused_partitions_.erase(partition);
+            std::cout << "Partition " << partition << ": Resumed" << std::endl;
+        }
+    }
+}
+
+void PartitionCoordinator::rewindLostBuffers() {
+    std::vector<std::pair<int32_t, int64_t>> rewinds;
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (const auto& kv : workers_) {
+            if (kv.second->isRewindRequested()) {
+                rewinds.emplace_back(kv.first, kv.second->getRewindOffset());
+            }
+        }
+    }
+    if (rewinds.empty()) {
+        return;
+    }
+
+    // Let already-polled messages reach the workers, which discard them
+    // Runs on the poll thread, so no new tasks are submitted meanwhile
+    if (decode_pool_) {
+        decode_pool_->waitIdle();
+    }
+
+    for (const auto& rewind : rewinds) {
+        // Retried on the next poll if the seek fails; the worker keeps discarding
+        if (!consumer_->seekPartition(rewind.first, rewind.second)) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        auto it = workers_.find(rewind.first);
+        if (it != workers_.end()) {
+            it->second->finishRewind();
+        }
+    }
+}
+
+void PartitionCoordinator::enforceMemoryBudget() {
+    if (!memory_budget_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (const auto& kv : workers_) {
+            // Only the active buffer is freed by sealing it; queued and sealed bytes stay
+            memory_budget_->setUsage(kv.first, kv.second->getMemoryUsage(), kv.second->getActiveMemoryUsage(),
+                                     kv.second->getBufferStartTime());
+        }
+    }
+
+    size_t budget = memory_budget_->getMaxSize();
+    size_t flush_at = budget / 100 * static_cast<size_t>(std::clamp(config_.memory_flush_percent, 1, 100));
+    size_t used = memory_budget_->getCurrentSize();
+
+    if (used >= flush_at) {
+        if (!memory_pressure_) {
+            std::cout << "Memory pressure: " << (used / (1024 * 1024)) << " of "
+                      << (budget / (1024 * 1024)) << " MB in use, flushing early" << std::endl;
+            memory_pressure_ = true;
+        }
+
+        // Aim for half the budget (or the watermark, if lower) so the same workers
+        // are not nudged every poll; buffers below the minimum are left to fill up
+        // Over budget, flushing is not keeping up and buffers go to disk
+        bool spill = used >= budget;
+        size_t target = std::min(budget / 2, flush_at);
+        std::vector<int32_t> targets = memory_budget_->selectFlushTargets(
+            used - target, memory_flush_policy_, config_.memory_flush_min_mb * 1024 * 1024);
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (int32_t partition : targets) {
+            auto it = workers_.find(partition);
+            if (it != workers_.end()) {
+                it->second->requestFlush(spill);
+            }
+        }
+    } else if (memory_pressure_) {
+        std::cout << "Memory pressure relieved: " << (used / (1024 * 1024)) << " MB in use" << std::endl;
+        memory_pressure_ = false;
+    }
+
+    // Over budget: stop fetching until usage is back under the flush watermark
+    if (!memory_paused_ && used >= budget) {
+        std::cerr << "Memory budget exceeded, pausing all partitions" << std::endl;
+        memory_paused_ = true;
+    } else if (memory_paused_ && used < flush_at) {
+        memory_paused_ = false;
+    }
+}
+
+void PartitionCoordinator::submitRawBatch(RawBatch& batch) {
+    for (auto& kv : batch) {
+        // std::function needs a copyable callable; share the move-only messages
+        auto messages = std::make_shared<std::vector<cppkafka::Message>>(std::move(kv.second));
+        int32_t partition = kv.first;
+        decode_pool_->submit(partition, [this, partition, messages]() {
+            decodeAndDispatch(partition, *messages);
+        });
+    }
+}
 
-    // Transform the message
-    auto transformed = LogTransformer::transform(
-        request, meta.topic, meta.partition, meta.offset);
+void PartitionCoordinator::decodeAndDispatch(int32_t partition,
+                                             const std::vector<cppkafka::Message>& messages) {
+    const size_t max_decompressed_size = config_.max_decompressed_size_mb * 1024 * 1024;
+
+    PartitionMessage msg;
+    msg.max_offset = -1;
+    for (const auto& raw : messages) {
+        try {
+            QueueConsumer::decodeMessageToBatch(raw, msg.batch, max_decompressed_size);
+            msg.max_offset = std::max(msg.max_offset, raw.get_offset());
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing message: " << e.what() << std::endl;
+            // Don't track offset on error - will retry on restart
+        }
+    }
 
-    if (transformed.empty()) {
+    if (msg.batch.empty()) {
         return;
     }
 
-    // Find the worker for this partition
     std::lock_guard<std::mutex> lock(workers_mutex_);
-    auto it = workers_.find(meta.partition);
+    getOrCreateWorkerLocked(partition).enqueue(std::move(msg));
+}
+
+PartitionWorker& PartitionCoordinator::getOrCreateWorkerLocked(int32_t partition) {
+    auto it = workers_.find(partition);
     if (it == workers_.end()) {
-        std::cerr << "No worker for partition " << meta.partition
+        std::cerr << "No worker for partition " << partition
                   << ", creating one now" << std::endl;
         // This shouldn't normally happen if rebalance callbacks work correctly
         // But handle it gracefully
         auto worker = std::make_unique<PartitionWorker>(
-            meta.partition,
+            partition,
             *db_,
             config_,
             full_table_name_,
-            [this](int32_t p, int64_t offset) { onOffsetCommitted(p, offset); }
+            [this](int32_t p, int64_t offset) { onOffsetCommitted(p, offset); },
+            rest_client_,
+            commit_aggregator_
         );
         worker->start();
-        it = workers_.emplace(meta.partition, std::move(worker)).first;
+        it = workers_.emplace(partition, std::move(worker)).first;
     }
-
-    // Create message envelope and enqueue
-    PartitionMessage msg;
-    msg.records = std::move(transformed);
-    msg.max_offset = meta.offset;
-
-    it->second->enqueue(std::move(msg));
+    return *it->second;
 }
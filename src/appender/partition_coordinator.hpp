@@ -6,6 +6,8 @@
 #include "queue_consumer.hpp"
 #include "log_transformer.hpp"
 #include "iceberg_utils.hpp"
+#include "decode_pool.hpp"
+#include "buffer_manager.hpp"
 #include "duckdb.hpp"
 #include <map>
 #include <memory>
@@ -57,13 +59,36 @@ private:
     std::unique_ptr<DuckDB> db_;
     std::unique_ptr<Connection> main_conn_;  // For catalog operations
 
+    // Shared by all workers for ICEBERG_COMMIT_MODE=rest, null otherwise
+    std::shared_ptr<IcebergRestClient> rest_client_;
+    std::shared_ptr<CommitAggregator> commit_aggregator_;  // One snapshot for many partitions' files
+
+    // Offsets from data file bounds, for tables written without recorded
+    // offsets; read through the REST catalog once per assignment (poll thread only)
+    std::shared_ptr<IcebergRestClient> bounds_client_;
+    std::map<int32_t, int64_t> file_bound_offsets_;
+    bool file_bounds_loaded_ = false;
+    bool file_bounds_ok_ = false;
+
     // Consumer
     std::unique_ptr<QueueConsumer> consumer_;
 
+    // Decode/transform threads (null when decoding inline on the poll thread)
+    std::unique_ptr<DecodePool> decode_pool_;
+
     // Active workers by partition
     std::map<int32_t, std::unique_ptr<PartitionWorker>> workers_;
     std::mutex workers_mutex_;
 
+    // Partitions paused because their worker queue is full (poll thread only)
+    std::set<int32_t> paused_partitions_;
+
+    // Process-wide memory budget across workers (null when there is none)
+    std::unique_ptr<BufferManager> memory_budget_;
+    BufferManager::FlushPolicy memory_flush_policy_ = BufferManager::FlushPolicy::LARGEST;
+    bool memory_pressure_ = false;  // Flushing early (poll thread only)
+    bool memory_paused_ = false;    // Over budget, all partitions paused (poll thread only)
+
     // Pending offset commits (partition -> offset)
     std::map<int32_t, int64_t> pending_commits_;
     std::mutex commits_mutex_;
@@ -73,13 +98,18 @@ private:
     std::atomic<bool> stop_requested_;
 
     // Create worker for a partition
-    void createWorker(int32_t partition);
+    // Returns the offset to start consuming from, or -1 for the committed offset
+    int64_t createWorker(int32_t partition);
 
     // Destroy worker for a partition
     void destroyWorker(int32_t partition);
 
+    // OffsetBoundsLookup for recoverMaxOffset
+    bool offsetFromFileBounds(int32_t partition, int64_t& max_offset);
+
     // Handle partition assignment (rebalance)
-    void onPartitionsAssigned(const std::vector<int32_t>& partitions);
+    void onPartitionsAssigned(const std::vector<int32_t>& partitions,
+                              std::map<int32_t, int64_t>& start_offsets);
 
     // Handle partition revocation (rebalance)
     void onPartitionsRevoked(const std::vector<int32_t>& partitions);
@@ -90,9 +120,27 @@ private:
     // Commit pending offsets to Kafka
     void commitPendingOffsets();
 
-    // Process a single message from consumer
-    void processMessage(const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest& request,
-                        const KafkaMessageMeta& meta);
+    // Seek partitions whose worker lost a buffer back to its first offset
+    // (poll thread, before every poll)
+    void rewindLostBuffers();
+
+    // Pause partitions whose worker queue is full and resume drained ones
+    // Runs on the poll thread before every poll
+    void applyBackpressure();
+
+    // Update per-worker memory usage and flush or spill buffers when the
+    // budget runs short (poll thread, from applyBackpressure)
+    void enforceMemoryBudget();
+
+    // Hand one poll cycle to the decode pool, one task per partition
+    void submitRawBatch(RawBatch& batch);
+
+    // Decode and transform one partition's messages from one poll cycle and
+    // dispatch them as a single PartitionMessage (runs on a decode thread when pooled)
+    void decodeAndDispatch(int32_t partition, const std::vector<cppkafka::Message>& messages);
+
+    // Get the worker for a partition, creating one if needed (workers_mutex_ must be held)
+    PartitionWorker& getOrCreateWorkerLocked(int32_t partition);
 };
 
 #endif // PARTITION_COORDINATOR_HPP
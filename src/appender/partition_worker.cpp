@@ -2,29 +2,76 @@
 #include <iostream>
 #include <random>
 #include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <unistd.h>
 
 PartitionWorker::PartitionWorker(int32_t partition_id,
                                  DuckDB& db,
                                  const AppenderConfig& config,
                                  const std::string& full_table_name,
-                                 OffsetCommitCallback commit_callback)
+                                 OffsetCommitCallback commit_callback,
+                                 std::shared_ptr<IcebergRestClient> rest_client,
+                                 std::shared_ptr<CommitAggregator> commit_aggregator)
     : partition_id_(partition_id)
     , config_(config)
     , full_table_name_(full_table_name)
     , commit_callback_(std::move(commit_callback))
+    , rest_client_(std::move(rest_client))
+    , commit_aggregator_(std::move(commit_aggregator))
+    , queued_messages_(0)
+    , queued_bytes_(0)
     , running_(false)
     , stop_requested_(false)
     , flush_requested_(false)
+    , pressure_flush_requested_(false)
+    , spill_requested_(false)
+    , flush_stop_(false)
+    , next_sequence_(1)
+    , durable_sequence_(0)
+    , failed_flush_rounds_(0)
+    , pending_flush_count_(0)
+    , buffer_generation_(0)
     , buffer_size_bytes_(0)
     , buffer_records_(0)
+    , sealed_size_bytes_(0)
+    , sealed_records_(0)
+    , active_memory_bytes_(0)
+    , sealed_memory_bytes_(0)
     , pending_offset_(-1)
-    , committed_offset_(-1) {
+    , committed_offset_(-1)
+    , buffer_first_offset_(-1)
+    , rewind_requested_(false)
+    , rewind_offset_(-1) {
 
     // Create per-worker buffer table name
     buffer_table_name_ = "local_buffer_" + std::to_string(partition_id);
 
-    // Create connection for this worker
+    // Parquet buffer files (and DuckDB buffers spilled under memory pressure)
+    // are unique per process and worker instance
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(config_.parquet_staging_dir, ec);
+        auto started_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        staging_prefix_ = config_.parquet_staging_dir + "/" + buffer_table_name_ + "_" +
+                          std::to_string(getpid()) + "_" + std::to_string(started_ms) + "_";
+
+        // Without a persistent buffer nothing adopts files an earlier worker for this
+        // partition left behind (its data is consumed again from Kafka)
+        if (!config_.usePersistentBuffer()) {
+            std::string prefix = buffer_table_name_ + "_";
+            for (const auto& entry : std::filesystem::directory_iterator(config_.parquet_staging_dir, ec)) {
+                if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+                    std::filesystem::remove(entry.path(), ec);
+                }
+            }
+        }
+    }
+
+    // Create connections for this worker (ingest and background flush)
     conn_ = std::make_unique<Connection>(db);
+    flush_conn_ = std::make_unique<Connection>(db);
 
     // Initialize last flush time
     last_flush_time_ = std::chrono::system_clock::now();
@@ -42,27 +89,49 @@ void PartitionWorker::start() {
         return;
     }
 
-    // Create buffer table for this partition
-    if (!IcebergUtils::createBufferTable(*conn_, std::to_string(partition_id_))) {
+    // Create the first active buffer table for this partition
+    if (!createActiveBuffer()) {
         std::cerr << "Partition " << partition_id_ << ": Failed to create buffer table" << std::endl;
         return;
     }
 
     running_ = true;
     stop_requested_ = false;
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        flush_stop_ = false;
+    }
+    flush_thread_ = std::thread(&PartitionWorker::flushLoop, this);
     worker_thread_ = std::thread(&PartitionWorker::run, this);
 
     std::cout << "Partition " << partition_id_ << ": Worker started" << std::endl;
 }
 
 void PartitionWorker::enqueue(PartitionMessage msg) {
+    msg.size_bytes = IcebergUtils::estimateBatchSize(msg.batch);
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
+        queued_messages_ += 1;
+        queued_bytes_ += msg.size_bytes;
         queue_.push(std::move(msg));
     }
     queue_cv_.notify_one();
 }
 
+bool PartitionWorker::isQueueFull() const {
+    size_t max_bytes = config_.partition_queue_max_mb * 1024 * 1024;
+    size_t max_messages = static_cast<size_t>(std::max(1, config_.partition_queue_max_messages));
+    return queued_messages_.load() >= max_messages || queued_bytes_.load() >= max_bytes;
+}
+
+bool PartitionWorker::isQueueDrained() const {
+    size_t percent = static_cast<size_t>(std::clamp(config_.partition_queue_resume_percent, 0, 100));
+    size_t max_bytes = config_.partition_queue_max_mb * 1024 * 1024;
+    size_t max_messages = static_cast<size_t>(std::max(1, config_.partition_queue_max_messages));
+    return queued_messages_.load() * 100 <= max_messages * percent &&
+           queued_bytes_.load() * 100 <= max_bytes * percent;
+}
+
 void PartitionWorker::signalStop() {
     stop_requested_ = true;
     queue_cv_.notify_all();
@@ -100,35 +169,108 @@ bool PartitionWorker::forceFlush() {
     flush_requested_ = true;
     queue_cv_.notify_one();
 
-    // Wait for flush to complete (simple busy wait)
+    // Wait for the worker to seal the active buffer (simple busy wait)
     auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
     while (flush_requested_ && running_ && std::chrono::steady_clock::now() < deadline) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
+    if (flush_requested_) {
+        return false;
+    }
 
-    return !flush_requested_;
+    // Wait until everything sealed so far is durable, or a flush round fails
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    uint64_t target = next_sequence_ - 1;
+    uint64_t failed_rounds = failed_flush_rounds_;
+    flush_cv_.wait_until(lock, deadline, [&] {
+        return durable_sequence_ >= target || failed_flush_rounds_ != failed_rounds || !running_;
+    });
+    return durable_sequence_ >= target;
 }
 
-int64_t PartitionWorker::recoverMaxOffset(const std::string& topic) {
+void PartitionWorker::requestFlush(bool spill) {
+    if (spill) {
+        spill_requested_ = true;
+    }
+    pressure_flush_requested_ = true;
+    queue_cv_.notify_one();
+}
+
+void PartitionWorker::finishRewind() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        // Everything queued so far was read before the seek
+        while (!queue_.empty()) {
+            queued_bytes_ -= queue_.front().size_bytes;
+            queued_messages_ -= 1;
+            queue_.pop();
+        }
+        rewind_requested_ = false;
+    }
+    std::cout << "Partition " << partition_id_ << ": Re-reading from offset " << rewind_offset_.load() << std::endl;
+    queue_cv_.notify_one();
+}
+
+std::chrono::system_clock::time_point PartitionWorker::getBufferStartTime() const {
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(flush_time_mutex_));
+    return last_flush_time_;
+}
+
+int64_t PartitionWorker::recoverMaxOffset(const std::string& topic, const OffsetBoundsLookup& file_bounds) {
+    // REST commits record the offset in the snapshot that added the data
+    if (rest_client_) {
+        std::map<int32_t, int64_t> offsets;
+        if (rest_client_->committedOffsets(topic, offsets) && offsets.count(partition_id_) > 0) {
+            committed_offset_ = offsets[partition_id_];
+            std::cout << "Partition " << partition_id_
+                      << ": Recovered max offset " << offsets[partition_id_]
+                      << " (from snapshot summary)" << std::endl;
+            return offsets[partition_id_];
+        }
+    }
+
     try {
-        std::ostringstream sql;
-        sql << "SELECT MAX(_kafka_offset) as max_offset "
-            << "FROM " << full_table_name_ << " "
-            << "WHERE _kafka_topic = '" << IcebergUtils::escapeSqlString(topic) << "' "
-            << "AND _kafka_partition = " << partition_id_;
+        // Take the offset from the data files' upper bounds in the manifests,
+        // which does not touch the (potentially huge) data table
+        int64_t recorded_offset = -1;
+        if (file_bounds) {
+            int64_t bound_offset = -1;
+            if (file_bounds(partition_id_, bound_offset)) {
+                if (bound_offset < 0) {
+                    std::cout << "Partition " << partition_id_
+                              << ": No previous data found, starting fresh" << std::endl;
+                    return -1;
+                }
+                recorded_offset = bound_offset;
+            }
+        }
 
-        auto result = conn_->Query(sql.str());
-        if (result->HasError()) {
-            std::cerr << "Partition " << partition_id_
-                      << ": Error querying max offset: " << result->GetError() << std::endl;
+        // Tail check on the data table. With a known offset the range filter lets
+        // Iceberg prune every data file by its manifest min/max bounds except the
+        // newest; without one this is the legacy full scan.
+        if (recorded_offset < 0) {
+            std::cerr << "Partition " << partition_id_ << ": No recorded offset, scanning the data table" << std::endl;
+        }
+        std::ostringstream data_sql;
+        data_sql << "SELECT MAX(_kafka_offset) as max_offset "
+                 << "FROM " << full_table_name_ << " "
+                 << "WHERE _kafka_topic = '" << IcebergUtils::escapeSqlString(topic) << "' "
+                 << "AND _kafka_partition = " << partition_id_;
+        if (recorded_offset >= 0) {
+            data_sql << " AND _kafka_offset > " << recorded_offset;
+        }
+
+        int64_t data_offset = -1;
+        if (!queryMaxOffset(data_sql.str(), data_offset)) {
             return -1;
         }
 
-        if (result->RowCount() > 0 && !result->GetValue(0, 0).IsNull()) {
-            int64_t max_offset = result->GetValue(0, 0).GetValue<int64_t>();
+        int64_t max_offset = std::max(recorded_offset, data_offset);
+        if (max_offset >= 0) {
             committed_offset_ = max_offset;
             std::cout << "Partition " << partition_id_
-                      << ": Recovered max offset " << max_offset << std::endl;
+                      << ": Recovered max offset " << max_offset
+                      << (recorded_offset >= 0 ? " (from file bounds)" : " (from data scan)") << std::endl;
             return max_offset;
         }
 
@@ -142,6 +284,160 @@ int64_t PartitionWorker::recoverMaxOffset(const std::string& topic) {
     }
 }
 
+int64_t PartitionWorker::recoverLocalBuffers(int64_t committed_offset) {
+    // Leftovers are named like this worker's buffers: local_buffer_<partition>_...
+    std::string prefix = buffer_table_name_ + "_";
+    std::vector<SealedBuffer> candidates;
+
+    try {
+        auto tables = conn_->Query("SELECT table_name, estimated_size FROM duckdb_tables() "
+                                   "WHERE table_name LIKE 'local_buffer%';");
+        if (tables->HasError()) {
+            std::cerr << "Partition " << partition_id_
+                      << ": Error listing local buffers: " << tables->GetError() << std::endl;
+            return committed_offset;
+        }
+        for (size_t row = 0; row < tables->RowCount(); ++row) {
+            std::string name = tables->GetValue(0, row).GetValue<std::string>();
+            std::string generation = name.rfind(prefix, 0) == 0 ? name.substr(prefix.size()) : "";
+            if (generation.empty() || generation.find_first_not_of("0123456789") != std::string::npos) {
+                continue;
+            }
+            // New buffer tables must not reuse a leftover's name
+            buffer_generation_ = std::max<uint64_t>(buffer_generation_, std::stoull(generation) + 1);
+
+            SealedBuffer sealed;
+            sealed.table_name = name;
+            duckdb::Value estimated_size = tables->GetValue(1, row);
+            sealed.size_bytes = estimated_size.IsNull() ? 0 : static_cast<size_t>(estimated_size.GetValue<int64_t>());
+            candidates.push_back(std::move(sealed));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Partition " << partition_id_
+                  << ": Exception listing local buffers: " << e.what() << std::endl;
+        return committed_offset;
+    }
+
+    // Buffers spilled under memory pressure; a .tmp file is a spill that never finished
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(config_.parquet_staging_dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) != 0) {
+            continue;
+        }
+        if (entry.path().extension() == ".tmp") {
+            std::filesystem::remove(entry.path(), ec);
+        } else if (entry.path().extension() == ".parquet") {
+            SealedBuffer sealed;
+            sealed.file_path = entry.path().string();
+            sealed.size_bytes = static_cast<size_t>(entry.file_size(ec));
+            candidates.push_back(std::move(sealed));
+        }
+    }
+
+    // Offsets each leftover still has to add to Iceberg
+    std::vector<std::pair<int64_t, SealedBuffer>> recovered;
+    bool unreadable = false;
+    for (auto& sealed : candidates) {
+        std::string source = sealed.file_path.empty()
+            ? sealed.table_name
+            : "read_parquet('" + IcebergUtils::escapeSqlString(sealed.file_path) + "')";
+        try {
+            auto result = conn_->Query("SELECT MIN(_kafka_offset), MAX(_kafka_offset), COUNT(*) FROM " + source +
+                                       " WHERE _kafka_offset > " + std::to_string(committed_offset) + ";");
+            if (result->HasError() || result->RowCount() == 0) {
+                throw std::runtime_error(result->HasError() ? result->GetError() : "no result");
+            }
+
+            int64_t records = result->GetValue(2, 0).GetValue<int64_t>();
+            if (records == 0) {
+                releaseBuffer(*conn_, sealed);  // Already committed before the restart
+                continue;
+            }
+            sealed.max_offset = result->GetValue(1, 0).GetValue<int64_t>();
+            sealed.records = static_cast<size_t>(records);
+            sealed.recovered_after = committed_offset;
+            recovered.emplace_back(result->GetValue(0, 0).GetValue<int64_t>(), std::move(sealed));
+        } catch (const std::exception& e) {
+            std::cerr << "Partition " << partition_id_ << ": Cannot read local buffer "
+                      << (sealed.file_path.empty() ? sealed.table_name : sealed.file_path)
+                      << ", leaving it in place: " << e.what() << std::endl;
+            unreadable = true;
+            if (!sealed.file_path.empty()) {
+                // Renamed so later restarts do not trip over it again
+                std::filesystem::rename(sealed.file_path, sealed.file_path + ".unreadable", ec);
+            }
+        }
+    }
+
+    // An unreadable leftover's offsets are unknown, so nothing past the committed
+    // offset is known to be complete; consume it all again from Kafka instead
+    if (unreadable) {
+        for (auto& kv : recovered) {
+            releaseBuffer(*conn_, kv.second);
+        }
+        std::cerr << "Partition " << partition_id_ << ": Discarded " << recovered.size()
+                  << " readable local buffer(s); resuming after committed offset "
+                  << committed_offset << std::endl;
+        return committed_offset;
+    }
+
+    if (recovered.empty()) {
+        return committed_offset;
+    }
+
+    // Flushed strictly in offset order, ahead of anything sealed later; a spilled
+    // file sorts ahead of a table with the same offsets
+    std::sort(recovered.begin(), recovered.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        return !a.second.file_path.empty() && b.second.file_path.empty();
+    });
+
+    int64_t max_offset = committed_offset;
+    size_t records = 0;
+    size_t adopted = 0;
+    std::lock_guard<std::mutex> lock(flush_mutex_);
+    for (auto& kv : recovered) {
+        SealedBuffer& sealed = kv.second;
+        if (sealed.max_offset <= max_offset) {
+            // Covered by an earlier leftover: a spill that stopped before dropping its table
+            releaseBuffer(*conn_, sealed);
+            continue;
+        }
+        max_offset = sealed.max_offset;
+        ++adopted;
+        records += sealed.records;
+        sealed_size_bytes_ += sealed.size_bytes;
+        sealed_records_ += sealed.records;
+        if (sealed.file_path.empty()) {
+            sealed_memory_bytes_ += sealed.size_bytes;
+        }
+        sealed.sequence = next_sequence_++;
+        sealed_buffers_.push_back(std::move(sealed));
+    }
+    pending_flush_count_ = sealed_buffers_.size();
+
+    std::cout << "Partition " << partition_id_ << ": Recovered " << adopted
+              << " local buffer(s) with " << records << " records up to offset " << max_offset << std::endl;
+    return max_offset;
+}
+
+bool PartitionWorker::queryMaxOffset(const std::string& sql, int64_t& max_offset) {
+    auto result = conn_->Query(sql);
+    if (result->HasError()) {
+        std::cerr << "Partition " << partition_id_
+                  << ": Error querying max offset: " << result->GetError() << std::endl;
+        return false;
+    }
+
+    if (result->RowCount() > 0 && !result->GetValue(0, 0).IsNull()) {
+        max_offset = result->GetValue(0, 0).GetValue<int64_t>();
+    }
+    return true;
+}
+
 void PartitionWorker::run() {
     std::cout << "Partition " << partition_id_ << ": Worker thread running" << std::endl;
 
@@ -154,14 +450,20 @@ void PartitionWorker::run() {
 
             // Wait for message, flush request, or stop signal
             // Use timeout to check time-based flush trigger
+            // While ingestion is blocked messages stay queued, which is what
+            // makes the coordinator pause this partition
             queue_cv_.wait_for(lock, std::chrono::seconds(1), [this] {
-                return !queue_.empty() || stop_requested_ || flush_requested_;
+                return (!queue_.empty() && !isIngestBlocked()) || stop_requested_ || flush_requested_ ||
+                       pressure_flush_requested_;
             });
 
-            if (!queue_.empty()) {
+            if (!queue_.empty() && !isIngestBlocked()) {
                 msg = std::move(queue_.front());
                 queue_.pop();
-                has_message = true;
+                queued_messages_ -= 1;
+                queued_bytes_ -= msg.size_bytes;
+                // Read past a lost buffer; it comes again after the consumer seek
+                has_message = !rewind_requested_;
             }
         }
 
@@ -170,82 +472,92 @@ void PartitionWorker::run() {
             processMessage(msg);
         }
 
-        // Check flush triggers
-        if (shouldFlush() || flush_requested_.exchange(false)) {
-            if (buffer_records_ > 0) {
-                std::cout << "Partition " << partition_id_ << ": Triggering flush ("
-                          << buffer_records_ << " records, "
-                          << (buffer_size_bytes_ / (1024 * 1024)) << " MB)" << std::endl;
-                if (flushWithRetry()) {
-                    // Notify coordinator of committed offset
-                    int64_t offset = committed_offset_.load();
-                    if (commit_callback_ && offset >= 0) {
-                        commit_callback_(partition_id_, offset);
-                    }
-                }
+        // Check flush triggers; sealing is cheap, the Iceberg commit runs on the flush thread
+        // A memory pressure request is one-shot; the coordinator repeats it while needed
+        bool forced = flush_requested_.load();
+        bool pressure = pressure_flush_requested_.exchange(false);
+        bool spill = spill_requested_.exchange(false);
+        if (forced || pressure || shouldFlush()) {
+            if (buffer_records_ == 0 || sealActiveBuffer(forced || spill, spill)) {
+                flush_requested_ = false;
             }
         }
     }
 
-    // Final flush before shutdown
+    // Final flush before shutdown: seal whatever is left and let the flush thread drain
     if (buffer_records_ > 0) {
         std::cout << "Partition " << partition_id_ << ": Final flush on shutdown" << std::endl;
-        if (flushWithRetry()) {
-            int64_t offset = committed_offset_.load();
-            if (commit_callback_ && offset >= 0) {
-                commit_callback_(partition_id_, offset);
-            }
-        }
+        sealActiveBuffer(true);
     }
+    flush_requested_ = false;
 
-    // Cleanup buffer table
-    try {
-        conn_->Query("DROP TABLE IF EXISTS " + buffer_table_name_ + ";");
-    } catch (...) {
-        // Ignore cleanup errors
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        flush_stop_ = true;
+    }
+    flush_cv_.notify_all();
+    if (flush_thread_.joinable()) {
+        flush_thread_.join();
+    }
+
+    // Cleanup buffer tables (a persistent buffer that could not be sealed is kept)
+    if (parquet_writer_) {
+        parquet_writer_->abort();
+        parquet_writer_.reset();
+    }
+    if (!config_.usePersistentBuffer() || buffer_records_ == 0) {
+        dropBuffer(*conn_, active_table_name_);
     }
 
     running_ = false;
+    flush_cv_.notify_all();
     std::cout << "Partition " << partition_id_ << ": Worker thread stopped" << std::endl;
 }
 
 void PartitionWorker::processMessage(const PartitionMessage& msg) {
-    if (msg.records.empty()) {
+    if (msg.batch.empty()) {
         return;
     }
 
     // Insert records into buffer
-    if (!insertToBuffer(msg.records)) {
+    if (!insertToBuffer(msg.batch)) {
         std::cerr << "Partition " << partition_id_
                   << ": Failed to insert records to buffer" << std::endl;
         return;
     }
 
     // Update pending offset
+    if (buffer_records_ == 0) {
+        buffer_first_offset_ = *std::min_element(msg.batch.kafka_offset.begin(), msg.batch.kafka_offset.end());
+    }
     if (msg.max_offset > pending_offset_.load()) {
         pending_offset_ = msg.max_offset;
     }
 
     // Update buffer stats
-    buffer_size_bytes_ += IcebergUtils::estimateRecordsSize(msg.records);
-    buffer_records_ += msg.records.size();
+    buffer_size_bytes_ += msg.size_bytes;
+    buffer_records_ += msg.batch.size();
+    active_memory_bytes_ = parquet_writer_ ? parquet_writer_->bufferedBytes() : buffer_size_bytes_.load();
 }
 
-bool PartitionWorker::insertToBuffer(const std::vector<TransformedLogRecord>& records) {
-    try {
-        std::string sql = IcebergUtils::buildInsertSQL(records, buffer_table_name_);
-        auto result = conn_->Query(sql);
-        if (result->HasError()) {
+bool PartitionWorker::insertToBuffer(const LogRecordBatch& batch) {
+    if (parquet_writer_) {
+        if (!parquet_writer_->append(batch)) {
             std::cerr << "Partition " << partition_id_
-                      << ": Error inserting to buffer: " << result->GetError() << std::endl;
+                      << ": Error appending to buffer file " << parquet_writer_->path() << std::endl;
             return false;
         }
         return true;
-    } catch (const std::exception& e) {
+    }
+
+    // Bulk append through DuckDB's Appender; avoids building and re-parsing
+    // an INSERT statement for every batch
+    if (!IcebergUtils::appendBatch(*conn_, active_table_name_, batch)) {
         std::cerr << "Partition " << partition_id_
-                  << ": Exception inserting to buffer: " << e.what() << std::endl;
+                  << ": Error appending to buffer table " << active_table_name_ << std::endl;
         return false;
     }
+    return true;
 }
 
 bool PartitionWorker::shouldFlush() const {
@@ -266,7 +578,189 @@ bool PartitionWorker::shouldFlush() const {
     return false;
 }
 
-bool PartitionWorker::flushWithRetry() {
+bool PartitionWorker::isIngestBlocked() const {
+    size_t max_pending = static_cast<size_t>(std::max(1, config_.partition_max_pending_flushes));
+    size_t buffer_mb = buffer_size_bytes_ / (1024 * 1024);
+    return pending_flush_count_.load() >= max_pending && buffer_mb >= config_.partition_buffer_size_mb;
+}
+
+bool PartitionWorker::createActiveBuffer() {
+    uint64_t generation = buffer_generation_++;
+    if (config_.useParquetSink()) {
+        ParquetWriter::Options options;
+        options.row_group_bytes = std::max<size_t>(1, config_.parquet_row_group_mb) * 1024 * 1024;
+        options.codec = ParquetWriter::parseCodec(config_.parquet_compression);
+        if (rest_client_) {
+            options.field_ids = rest_client_->fieldIds();
+        }
+        auto writer = std::make_unique<ParquetWriter>(options);
+        if (!writer->open(staging_prefix_ + std::to_string(generation) + ".parquet")) {
+            return false;
+        }
+        parquet_writer_ = std::move(writer);
+        return true;
+    }
+
+    std::string suffix = std::to_string(partition_id_) + "_" + std::to_string(generation);
+    if (!IcebergUtils::createBufferTable(*conn_, suffix)) {
+        return false;
+    }
+    active_table_name_ = buffer_table_name_ + "_" + std::to_string(generation);
+    return true;
+}
+
+bool PartitionWorker::sealActiveBuffer(bool force, bool spill) {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+
+    // Bound the number of buffers waiting on Iceberg; keep filling the active one meanwhile
+    if (!force && sealed_buffers_.size() >= static_cast<size_t>(std::max(1, config_.partition_max_pending_flushes))) {
+        return false;
+    }
+    lock.unlock();
+
+    SealedBuffer sealed;
+    sealed.table_name = active_table_name_;
+    sealed.max_offset = pending_offset_.load();
+    sealed.records = buffer_records_.load();
+    sealed.size_bytes = buffer_size_bytes_.load();
+    sealed.forced = force;
+
+    // Switch ingestion to a fresh table before handing the sealed one over
+    uint64_t sealed_generation = buffer_generation_ - 1;
+    std::unique_ptr<ParquetWriter> sealed_writer = std::move(parquet_writer_);
+    if (!createActiveBuffer()) {
+        parquet_writer_ = std::move(sealed_writer);
+        std::cerr << "Partition " << partition_id_
+                  << ": Failed to create new buffer table, flush postponed" << std::endl;
+        return false;
+    }
+
+    // Finish the Parquet file: last row group and footer
+    if (sealed_writer) {
+        if (!sealed_writer->close()) {
+            // close() removed the file; the records can only be read from Kafka again
+            std::cerr << "Partition " << partition_id_ << ": Failed to finish buffer file, re-reading "
+                      << sealed.records << " records from offset " << buffer_first_offset_ << std::endl;
+            requestRewind(buffer_first_offset_);
+            return false;
+        }
+        sealed.file_path = sealed_writer->path();
+        sealed.file_stats = sealed_writer->stats();
+    } else if (spill) {
+        // Flushed from the file like a Parquet sink buffer; stays in memory if the copy fails
+        std::string path = staging_prefix_ + std::to_string(sealed_generation) + ".parquet";
+        if (spillBuffer(sealed.table_name, path)) {
+            sealed.file_path = path;
+        }
+    }
+
+    sealed_size_bytes_ += sealed.size_bytes;
+    sealed_records_ += sealed.records;
+    if (sealed.file_path.empty()) {
+        sealed_memory_bytes_ += sealed.size_bytes;
+    }
+    buffer_size_bytes_ = 0;
+    buffer_records_ = 0;
+    active_memory_bytes_ = 0;
+
+    // Reset flush timer (starts the next buffer window)
+    {
+        std::lock_guard<std::mutex> time_lock(flush_time_mutex_);
+        last_flush_time_ = std::chrono::system_clock::now();
+    }
+
+    std::cout << "Partition " << partition_id_ << ": Sealed "
+              << (sealed.file_path.empty() ? sealed.table_name : sealed.file_path) << " ("
+              << sealed.records << " records, "
+              << (sealed.size_bytes / (1024 * 1024)) << " MB) for flush" << std::endl;
+
+    lock.lock();
+    sealed.sequence = next_sequence_++;
+    sealed_buffers_.push_back(std::move(sealed));
+    pending_flush_count_ = sealed_buffers_.size();
+    lock.unlock();
+    flush_cv_.notify_all();
+    return true;
+}
+
+void PartitionWorker::flushLoop() {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+
+    while (true) {
+        flush_cv_.wait(lock, [this] { return !sealed_buffers_.empty() || flush_stop_; });
+        if (sealed_buffers_.empty()) {
+            break;  // Stop requested and nothing left to drain
+        }
+
+        // Copy the head; it stays queued until durable so later buffers cannot overtake it
+        SealedBuffer sealed = sealed_buffers_.front();
+        lock.unlock();
+
+        bool flushed = flushWithRetry(sealed);
+
+        if (flushed) {
+            releaseBuffer(*flush_conn_, sealed);
+            sealed_size_bytes_ -= sealed.size_bytes;
+            sealed_records_ -= sealed.records;
+            if (sealed.file_path.empty()) {
+                sealed_memory_bytes_ -= sealed.size_bytes;
+            }
+            committed_offset_ = sealed.max_offset;
+
+            // Notify coordinator of committed offset
+            if (commit_callback_ && sealed.max_offset >= 0) {
+                commit_callback_(partition_id_, sealed.max_offset);
+            }
+        }
+
+        lock.lock();
+        if (flushed) {
+            sealed_buffers_.pop_front();
+            pending_flush_count_ = sealed_buffers_.size();
+            durable_sequence_ = sealed.sequence;
+        } else {
+            failed_flush_rounds_++;
+        }
+        flush_cv_.notify_all();
+
+        // A freed slot may unblock ingestion
+        if (flushed) {
+            queue_cv_.notify_all();
+        }
+
+        if (!flushed) {
+            if (flush_stop_) {
+                // Shutting down: abandon what is left, Kafka replays it after restart
+                // (a persistent buffer keeps it for the next worker instead)
+                std::cerr << "Partition " << partition_id_ << ": "
+                          << (config_.usePersistentBuffer() ? "Keeping " : "Abandoning ")
+                          << sealed_buffers_.size() << " unflushed buffer(s) on shutdown" << std::endl;
+                break;
+            }
+            // Keep order: retry the same buffer after a pause
+            flush_cv_.wait_for(lock, calculateBackoff(config_.iceberg_commit_retries),
+                               [this] { return flush_stop_; });
+        }
+    }
+
+    // Drop anything left behind
+    std::deque<SealedBuffer> remaining;
+    remaining.swap(sealed_buffers_);
+    pending_flush_count_ = 0;
+    lock.unlock();
+    for (const auto& sealed : remaining) {
+        if (!config_.usePersistentBuffer()) {
+            releaseBuffer(*flush_conn_, sealed);
+        }
+        sealed_size_bytes_ -= sealed.size_bytes;
+        sealed_records_ -= sealed.records;
+        if (sealed.file_path.empty()) {
+            sealed_memory_bytes_ -= sealed.size_bytes;
+        }
+    }
+}
+
+bool PartitionWorker::flushWithRetry(const SealedBuffer& sealed) {
     for (int attempt = 0; attempt < config_.iceberg_commit_retries; ++attempt) {
         if (attempt > 0) {
             auto delay = calculateBackoff(attempt);
@@ -276,7 +770,7 @@ bool PartitionWorker::flushWithRetry() {
             std::this_thread::sleep_for(delay);
         }
 
-        if (attemptFlush()) {
+        if (attemptFlush(sealed)) {
             return true;
         }
 
@@ -289,45 +783,38 @@ bool PartitionWorker::flushWithRetry() {
     return false;
 }
 
-bool PartitionWorker::attemptFlush() {
+bool PartitionWorker::attemptFlush(const SealedBuffer& sealed) {
+    if (rest_client_ && !sealed.file_path.empty()) {
+        return attemptRestFlush(sealed);
+    }
+
     try {
         std::cout << "Partition " << partition_id_ << ": Flushing "
-                  << buffer_records_ << " records to Iceberg..." << std::endl;
+                  << sealed.records << " records to Iceberg..." << std::endl;
 
-        // Insert from buffer to Iceberg
+        // Insert from sealed buffer to Iceberg; a Parquet buffer file already
+        // has the table layout and is scanned as-is
         std::ostringstream insert_sql;
-        insert_sql << "INSERT INTO " << full_table_name_
-                   << " SELECT * FROM " << buffer_table_name_ << ";";
+        insert_sql << "INSERT INTO " << full_table_name_ << " SELECT * FROM ";
+        if (sealed.file_path.empty()) {
+            insert_sql << sealed.table_name;
+        } else {
+            insert_sql << "read_parquet('" << IcebergUtils::escapeSqlString(sealed.file_path) << "')";
+        }
+        if (sealed.recovered_after >= 0) {
+            insert_sql << " WHERE _kafka_offset > " << sealed.recovered_after;
+        }
+        insert_sql << ";";
 
-        auto result = conn_->Query(insert_sql.str());
+        auto result = flush_conn_->Query(insert_sql.str());
         if (result->HasError()) {
             std::cerr << "Partition " << partition_id_
                       << ": Error flushing to Iceberg: " << result->GetError() << std::endl;
             return false;
         }
 
-        // Clear buffer
-        if (!clearBuffer()) {
-            std::cerr << "Partition " << partition_id_
-                      << ": Warning: Failed to clear buffer after successful flush" << std::endl;
-            // Data was written successfully, don't fail
-        }
-
-        // Update committed offset
-        committed_offset_ = pending_offset_.load();
-
-        // Reset buffer stats
-        buffer_size_bytes_ = 0;
-        buffer_records_ = 0;
-
-        // Reset flush timer
-        {
-            std::lock_guard<std::mutex> lock(flush_time_mutex_);
-            last_flush_time_ = std::chrono::system_clock::now();
-        }
-
         std::cout << "Partition " << partition_id_
-                  << ": Flush completed, committed offset: " << committed_offset_ << std::endl;
+                  << ": Flush completed, committed offset: " << sealed.max_offset << std::endl;
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Partition " << partition_id_
@@ -336,13 +823,128 @@ bool PartitionWorker::attemptFlush() {
     }
 }
 
-bool PartitionWorker::clearBuffer() {
+bool PartitionWorker::attemptRestFlush(const SealedBuffer& sealed) {
+    std::cout << "Partition " << partition_id_ << ": Committing "
+              << sealed.records << " records to Iceberg..." << std::endl;
+
+    // Upload once; a retried commit reuses the uploaded file
+    if (uploaded_file_ != sealed.file_path) {
+        std::string uri;
+        if (!rest_client_->uploadDataFile(sealed.file_path, uri)) {
+            std::cerr << "Partition " << partition_id_
+                      << ": Error uploading " << sealed.file_path << std::endl;
+            return false;
+        }
+        uploaded_file_ = sealed.file_path;
+        uploaded_uri_ = uri;
+    }
+
+    const ParquetWriter::FileStats& stats = sealed.file_stats;
+    IcebergDataFile file;
+    file.file_path = uploaded_uri_;
+    file.record_count = static_cast<int64_t>(stats.rows);
+    file.file_size_in_bytes = static_cast<int64_t>(stats.file_bytes);
+
+    // Column bounds let readers (and offset recovery) skip the file
+    if (stats.rows > 0) {
+        std::map<std::string, int> field_ids = rest_client_->fieldIds();
+        auto add_metrics = [&](const char* column, std::string lower, std::string upper) {
+            auto it = field_ids.find(column);
+            if (it == field_ids.end()) {
+                return;
+            }
+            file.value_counts[it->second] = file.record_count;
+            file.null_value_counts[it->second] = 0;
+            file.lower_bounds[it->second] = std::move(lower);
+            file.upper_bounds[it->second] = std::move(upper);
+        };
+        add_metrics("_kafka_partition", IcebergManifest::intBound(partition_id_), IcebergManifest::intBound(partition_id_));
+        add_metrics("_kafka_offset", IcebergManifest::longBound(stats.min_offset), IcebergManifest::longBound(stats.max_offset));
+        add_metrics("timestamp", IcebergManifest::longBound(stats.min_timestamp_us),
+                    IcebergManifest::longBound(stats.max_timestamp_us));
+    }
+
+    // Shared snapshot: returns once the snapshot holding this file is committed
+    if (commit_aggregator_) {
+        if (!commit_aggregator_->submit(partition_id_, file, sealed.max_offset, sealed.forced)) {
+            return false;
+        }
+    } else {
+        std::map<int32_t, int64_t> offsets;
+        if (sealed.max_offset >= 0) {
+            offsets[partition_id_] = sealed.max_offset;
+        }
+        if (!rest_client_->appendFiles({file}, offsets, config_.queue_topic)) {
+            return false;
+        }
+    }
+
+    std::cout << "Partition " << partition_id_
+              << ": Flush completed, committed offset: " << sealed.max_offset << std::endl;
+    return true;
+}
+
+void PartitionWorker::dropBuffer(Connection& conn, const std::string& table_name) {
+    if (table_name.empty()) {
+        return;
+    }
     try {
-        auto result = conn_->Query("DELETE FROM " + buffer_table_name_ + ";");
-        return !result->HasError();
+        conn.Query("DROP TABLE IF EXISTS " + table_name + ";");
     } catch (...) {
+        // Ignore cleanup errors
+    }
+}
+
+void PartitionWorker::requestRewind(int64_t offset) {
+    // Sealed buffers carry their own offsets; the next one must not cover the lost records
+    pending_offset_ = offset - 1;
+    buffer_size_bytes_ = 0;
+    buffer_records_ = 0;
+    active_memory_bytes_ = 0;
+    rewind_offset_ = offset;
+    rewind_requested_ = true;
+}
+
+bool PartitionWorker::spillBuffer(const std::string& table_name, const std::string& path) {
+    // Written under a temporary name so a file at `path` is always complete
+    std::string tmp_path = path + ".tmp";
+    try {
+        auto result = conn_->Query("COPY " + table_name + " TO '" + IcebergUtils::escapeSqlString(tmp_path) +
+                                   "' (FORMAT PARQUET);");
+        if (result->HasError()) {
+            std::cerr << "Partition " << partition_id_
+                      << ": Error spilling " << table_name << ": " << result->GetError() << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Partition " << partition_id_
+                  << ": Exception spilling " << table_name << ": " << e.what() << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::cerr << "Partition " << partition_id_
+                  << ": Error renaming spilled buffer " << tmp_path << ": " << ec.message() << std::endl;
+        std::remove(tmp_path.c_str());
         return false;
     }
+
+    dropBuffer(*conn_, table_name);
+    std::cout << "Partition " << partition_id_ << ": Spilled " << table_name
+              << " to " << path << " under memory pressure" << std::endl;
+    return true;
+}
+
+void PartitionWorker::releaseBuffer(Connection& conn, const SealedBuffer& sealed) {
+    if (!sealed.file_path.empty()) {
+        std::remove(sealed.file_path.c_str());
+        return;
+    }
+    dropBuffer(conn, sealed.table_name);
 }
 
 std::chrono::milliseconds PartitionWorker::calculateBackoff(int attempt) const {
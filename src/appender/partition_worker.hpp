@@ -4,44 +4,107 @@
 #include "../config.hpp"
 #include "log_transformer.hpp"
 #include "iceberg_utils.hpp"
+#include "parquet_writer.hpp"
+#include "iceberg_rest_client.hpp"
+#include "commit_aggregator.hpp"
 #include "duckdb.hpp"
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
 
 using duckdb::DuckDB;
 using duckdb::Connection;
 
 // Message envelope for partition worker queue
 struct PartitionMessage {
-    std::vector<TransformedLogRecord> records;
-    int64_t max_offset;  // Max offset in this batch
+    LogRecordBatch batch;  // Columnar records for this partition
+    int64_t max_offset;    // Max offset in this batch
+    size_t size_bytes = 0; // Estimated size, set by enqueue()
 };
 
 // Callback for notifying coordinator of committed offsets
 using OffsetCommitCallback = std::function<void(int32_t partition, int64_t offset)>;
 
+// Max offset of a partition from the data files' column bounds in the table
+// metadata (-1 if it has no data); false when the bounds cannot be used
+using OffsetBoundsLookup = std::function<bool(int32_t partition, int64_t& max_offset)>;
+
+// A buffer table (or, with the Parquet sink, a finished Parquet file) that no
+// longer receives records and is waiting to be written to Iceberg by the
+// background flush thread
+struct SealedBuffer {
+    std::string table_name;
+    std::string file_path;  // Parquet sink: the data file; table_name is unused
+    ParquetWriter::FileStats file_stats;  // Parquet sink: metrics for the manifest entry
+    int64_t max_offset;   // Max Kafka offset contained in this buffer
+    size_t records;
+    size_t size_bytes;
+    uint64_t sequence;    // Seal order; buffers are flushed strictly in this order
+    bool forced = false;  // Sealed by forceFlush or shutdown; commit without waiting for other partitions
+    int64_t recovered_after = -1;  // Left by a previous run: rows up to this offset are already in Iceberg
+};
+
 // Worker thread for a single Kafka partition
-// Each worker has its own DuckDB connection and buffer table
+// Each worker has its own DuckDB connections and buffer tables
+//
+// With BUFFER_SINK=parquet the active buffer is an in-progress Parquet file
+// instead of a DuckDB table: batches are streamed into it row group by row
+// group, and a sealed file is appended to Iceberg without another copy.
+// With ICEBERG_COMMIT_MODE=rest as well, the file is uploaded to the table
+// location and fast-appended through the REST catalog client, with the
+// covered offset recorded in the snapshot summary; the coordinator's commit
+// aggregator puts files from many partitions into one snapshot.
+//
+// Buffers are double-buffered: when a flush triggers, the active buffer table
+// is sealed and handed to a background flush thread, and ingestion continues
+// into a fresh table. Sealed buffers are flushed in seal order and the offset
+// callback fires only after a buffer is durable in Iceberg, so committed
+// offsets never run ahead of the data.
+//
+// When Iceberg falls behind (active buffer full and no more buffers may be
+// sealed) the worker stops taking messages, its queue fills up and
+// isQueueFull() tells the coordinator to pause the Kafka partition.
+//
+// The coordinator also enforces a process-wide memory budget from
+// getMemoryUsage(): requestFlush() seals a buffer early, and with spill a
+// DuckDB buffer is written to a local Parquet file and sealed even when no
+// flush slot is free, so it waits for Iceberg on disk instead of in memory.
+//
+// With a persistent buffer (BUFFER_DB_PATH) buffer tables live in an on-disk
+// DuckDB file and unflushed buffers are kept on shutdown. The next worker for
+// the partition adopts them with recoverLocalBuffers() and flushes them
+// before any new data.
 class PartitionWorker {
 public:
     PartitionWorker(int32_t partition_id,
                     DuckDB& db,
                     const AppenderConfig& config,
                     const std::string& full_table_name,
-                    OffsetCommitCallback commit_callback);
+                    OffsetCommitCallback commit_callback,
+                    std::shared_ptr<IcebergRestClient> rest_client = nullptr,
+                    std::shared_ptr<CommitAggregator> commit_aggregator = nullptr);
     ~PartitionWorker();
 
     // Start the worker thread
     void start();
 
     // Thread-safe message enqueue
+    // Never blocks; callers apply backpressure through isQueueFull()
     void enqueue(PartitionMessage msg);
 
+    // Queue watermarks: full at either configured limit, drained once both
+    // are below partition_queue_resume_percent of their limit
+    bool isQueueFull() const;
+    bool isQueueDrained() const;
+    size_t getQueuedMessages() const { return queued_messages_.load(); }
+    size_t getQueuedBytes() const { return queued_bytes_.load(); }
+
     // Signal worker to stop (graceful)
     void signalStop();
 
@@ -52,45 +115,116 @@ public:
     // Force flush and wait for completion
     bool forceFlush();
 
-    // Get current buffer stats
-    size_t getBufferSize() const { return buffer_size_bytes_.load(); }
-    size_t getBufferRecordCount() const { return buffer_records_.load(); }
+    // Ask for the active buffer to be sealed early (memory pressure); does not wait
+    // With spill, a DuckDB buffer is moved to a local Parquet file and sealed
+    // regardless of the pending flush limit
+    void requestFlush(bool spill);
+
+    // Get current buffer stats (active buffer plus sealed buffers awaiting flush)
+    size_t getBufferSize() const { return buffer_size_bytes_.load() + sealed_size_bytes_.load(); }
+    size_t getBufferRecordCount() const { return buffer_records_.load() + sealed_records_.load(); }
+    size_t getPendingFlushCount() const { return pending_flush_count_.load(); }
     int64_t getLastCommittedOffset() const { return committed_offset_.load(); }
     int32_t getPartitionId() const { return partition_id_; }
 
-    // Query max committed offset for this partition from Iceberg
-    int64_t recoverMaxOffset(const std::string& topic);
+    // Bytes held in memory: queued messages, the active buffer (only the
+    // current row group with the Parquet sink) and sealed DuckDB tables
+    size_t getMemoryUsage() const {
+        return queued_bytes_.load() + active_memory_bytes_.load() + sealed_memory_bytes_.load();
+    }
+
+    // The part of getMemoryUsage() that sealing the active buffer frees
+    size_t getActiveMemoryUsage() const { return active_memory_bytes_.load(); }
+
+    // When the active buffer was started (its oldest data is at most this old)
+    std::chrono::system_clock::time_point getBufferStartTime() const;
+
+    // A Parquet buffer file that could not be finished is lost; its records
+    // must be consumed again from getRewindOffset(). Until finishRewind()
+    // (called once the consumer has been sought there) messages reaching the
+    // worker were read past the lost buffer and are discarded.
+    bool isRewindRequested() const { return rewind_requested_.load(); }
+    int64_t getRewindOffset() const { return rewind_offset_.load(); }
+    void finishRewind();
+
+    // Recover the max committed offset for this partition
+    // With REST commits the snapshot summaries hold it. Otherwise it comes from
+    // file_bounds, and the data table is only consulted for offsets beyond that;
+    // the table is scanned in full only if the bounds are unavailable.
+    int64_t recoverMaxOffset(const std::string& topic, const OffsetBoundsLookup& file_bounds = nullptr);
+
+    // Persistent buffer: queue the buffer tables and spilled files a previous
+    // run left for this partition, oldest first, keeping only rows past
+    // committed_offset (already-committed leftovers are dropped, as is a table
+    // whose spilled copy also survived)
+    // If any leftover cannot be read, all of them are dropped and the partition
+    // resumes after committed_offset, since the unreadable one's offsets are unknown
+    // Call before start(). Returns the highest offset now held locally or in
+    // Iceberg, so the consumer can seek past it.
+    int64_t recoverLocalBuffers(int64_t committed_offset);
 
 private:
     int32_t partition_id_;
     const AppenderConfig& config_;
     std::string full_table_name_;
-    std::string buffer_table_name_;
+    std::string buffer_table_name_;  // Base name; active/sealed tables append a generation
     OffsetCommitCallback commit_callback_;
+    std::shared_ptr<IcebergRestClient> rest_client_;  // Set for ICEBERG_COMMIT_MODE=rest
+    std::shared_ptr<CommitAggregator> commit_aggregator_;  // REST commits shared with other partitions, if set
 
-    // DuckDB connection (per-worker for parallelism)
+    // DuckDB connections (per-worker for parallelism)
+    // conn_ appends to the active buffer, flush_conn_ is used by the flush thread
     std::unique_ptr<Connection> conn_;
+    std::unique_ptr<Connection> flush_conn_;
 
     // Message queue
     std::queue<PartitionMessage> queue_;
     std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
+    std::atomic<size_t> queued_messages_;
+    std::atomic<size_t> queued_bytes_;
 
     // Worker thread
     std::thread worker_thread_;
     std::atomic<bool> running_;
     std::atomic<bool> stop_requested_;
     std::atomic<bool> flush_requested_;
+    std::atomic<bool> pressure_flush_requested_;  // requestFlush(): seal early, don't wait
+    std::atomic<bool> spill_requested_;           // requestFlush(true): ... to disk if needed
 
-    // Buffer tracking
+    // Background flush thread and its queue of sealed buffers
+    std::thread flush_thread_;
+    std::deque<SealedBuffer> sealed_buffers_;
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    bool flush_stop_;                   // Drain remaining buffers and exit (guarded by flush_mutex_)
+    uint64_t next_sequence_;            // Sequence assigned to the next sealed buffer
+    uint64_t durable_sequence_;         // Highest sequence flushed to Iceberg (guarded by flush_mutex_)
+    uint64_t failed_flush_rounds_;      // Flush rounds that exhausted retries (guarded by flush_mutex_)
+    std::atomic<size_t> pending_flush_count_;
+    std::string uploaded_file_;         // REST commits: last buffer file uploaded (flush thread only)
+    std::string uploaded_uri_;          // ... and where it went, so commit retries skip the upload
+
+    // Active buffer tracking
+    std::string active_table_name_;
+    std::unique_ptr<ParquetWriter> parquet_writer_;  // Parquet sink: the active buffer file
+    std::string staging_prefix_;                     // Path prefix of Parquet buffer files and spilled buffers
+    uint64_t buffer_generation_;
     std::atomic<size_t> buffer_size_bytes_;
     std::atomic<size_t> buffer_records_;
+    std::atomic<size_t> sealed_size_bytes_;
+    std::atomic<size_t> sealed_records_;
+    std::atomic<size_t> active_memory_bytes_;  // Resident part of the active buffer
+    std::atomic<size_t> sealed_memory_bytes_;  // Sealed buffers still in DuckDB tables
     std::chrono::system_clock::time_point last_flush_time_;
     std::mutex flush_time_mutex_;
 
     // Offset tracking
-    std::atomic<int64_t> pending_offset_;     // Max offset in buffer
+    std::atomic<int64_t> pending_offset_;     // Max offset in active buffer
     std::atomic<int64_t> committed_offset_;   // Max offset successfully flushed
+    int64_t buffer_first_offset_;             // Min offset in active buffer (worker thread only)
+    std::atomic<bool> rewind_requested_;      // Active buffer lost, waiting for the consumer seek
+    std::atomic<int64_t> rewind_offset_;      // ... to this offset
 
     // Main worker loop
     void run();
@@ -99,19 +233,48 @@ private:
     void processMessage(const PartitionMessage& msg);
 
     // Insert records into buffer table
-    bool insertToBuffer(const std::vector<TransformedLogRecord>& records);
+    bool insertToBuffer(const LogRecordBatch& batch);
 
     // Check if flush thresholds are met
     bool shouldFlush() const;
 
-    // Flush buffer to Iceberg with retry logic
-    bool flushWithRetry();
+    // Active buffer is full and no more buffers may be sealed; stop taking messages
+    bool isIngestBlocked() const;
+
+    // Create a new, empty active buffer table
+    bool createActiveBuffer();
+
+    // Seal the active buffer, queue it for flushing and start a fresh one
+    // With spill a DuckDB buffer table is written to a local Parquet file first
+    // Returns false if the buffer could not be sealed (e.g. too many pending flushes)
+    bool sealActiveBuffer(bool force, bool spill = false);
+
+    // Drop the (lost) active buffer's accounting and ask for a consumer seek to offset
+    void requestRewind(int64_t offset);
+
+    // Copy a buffer table to a local Parquet file and drop the table
+    bool spillBuffer(const std::string& table_name, const std::string& path);
+
+    // Background flush loop: flushes sealed buffers in order
+    void flushLoop();
+
+    // Flush a sealed buffer to Iceberg with retry logic
+    bool flushWithRetry(const SealedBuffer& sealed);
 
     // Single flush attempt
-    bool attemptFlush();
+    bool attemptFlush(const SealedBuffer& sealed);
+
+    // Single flush attempt through the REST catalog client
+    bool attemptRestFlush(const SealedBuffer& sealed);
+
+    // Drop a buffer table
+    void dropBuffer(Connection& conn, const std::string& table_name);
+
+    // Drop a sealed buffer's table or delete its Parquet file
+    void releaseBuffer(Connection& conn, const SealedBuffer& sealed);
 
-    // Clear buffer table
-    bool clearBuffer();
+    // Run a single-value MAX(_kafka_offset) query; leaves max_offset untouched on NULL
+    bool queryMaxOffset(const std::string& sql, int64_t& max_offset);
 
     // Calculate backoff delay with jitter
     std::chrono::milliseconds calculateBackoff(int attempt) const;
@@ -1,11 +1,183 @@
 #include "queue_consumer.hpp"
+#include "otlp_json_decoder.hpp"
+#include "otlp_proto_decoder.hpp"
+#include "../gzip_decompressor.hpp"
 #include "telemetry_wrapper.pb.h"
-#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
-#include <google/protobuf/util/json_util.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 #include <cppkafka/cppkafka.h>
+#include <librdkafka/rdkafka.h>
+#include <string_view>
+
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::internal::WireFormatLite;
+
+namespace {
+
+// Per-thread buffers for inflated payloads larger than this are released after use
+constexpr size_t kMaxRetainedInflateBuffer = 16 * 1024 * 1024;
+
+// RawTelemetryMessage fields we need, pointing into the Kafka message buffer
+struct WrapperView {
+    std::string_view content_type;
+    std::string_view payload;
+    std::string_view content_encoding;
+};
+
+// Read a length-delimited field as a view into the stream's underlying array
+bool readBytesView(CodedInputStream& input, std::string_view& out) {
+    uint32_t length = 0;
+    if (!input.ReadVarint32(&length)) {
+        return false;
+    }
+    if (length == 0) {
+        out = std::string_view();
+        return true;
+    }
+
+    const void* data = nullptr;
+    int available = 0;
+    if (!input.GetDirectBufferPointer(&data, &available) ||
+        static_cast<uint32_t>(available) < length) {
+        return false;
+    }
+    out = std::string_view(static_cast<const char*>(data), length);
+    return input.Skip(static_cast<int>(length));
+}
+
+// Scan the wrapper without materializing it, so the payload is never copied
+WrapperView parseWrapper(const uint8_t* data, size_t size) {
+    WrapperView view;
+    CodedInputStream input(data, static_cast<int>(size));
+
+    while (uint32_t tag = input.ReadTag()) {
+        int field = WireFormatLite::GetTagFieldNumber(tag);
+        bool length_delimited =
+            WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+
+        bool ok;
+        if (field == telemetry::v1::RawTelemetryMessage::kContentTypeFieldNumber && length_delimited) {
+            ok = readBytesView(input, view.content_type);
+        } else if (field == telemetry::v1::RawTelemetryMessage::kPayloadFieldNumber && length_delimited) {
+            ok = readBytesView(input, view.payload);
+        } else if (field == telemetry::v1::RawTelemetryMessage::kContentEncodingFieldNumber && length_delimited) {
+            ok = readBytesView(input, view.content_encoding);
+        } else {
+            ok = WireFormatLite::SkipField(&input, tag);
+        }
+        if (!ok) {
+            throw std::runtime_error("Failed to deserialize RawTelemetryMessage wrapper");
+        }
+    }
+
+    if (!input.ConsumedEntireMessage()) {
+        throw std::runtime_error("Failed to deserialize RawTelemetryMessage wrapper");
+    }
+    return view;
+}
+
+// Holds a passed-through payload after decompression
+// The buffer is per thread and reused, so the view is valid until the next message
+class InflatedPayload {
+public:
+    // Replaces wrapper.payload with its decompressed bytes when content_encoding is set
+    // Throws std::runtime_error on unsupported encodings and malformed or oversized data
+    InflatedPayload(WrapperView& wrapper, size_t max_size) {
+        if (wrapper.content_encoding.empty() || wrapper.content_encoding == "identity") {
+            return;
+        }
+        if (wrapper.content_encoding != "gzip") {
+            throw std::runtime_error("Unsupported content encoding: " + std::string(wrapper.content_encoding));
+        }
+
+        GzipResult result = GzipDecompressor::decompress(wrapper.payload, buffer(), max_size);
+        if (result == GzipResult::TOO_LARGE) {
+            throw std::runtime_error("Decompressed payload exceeds " + std::to_string(max_size) + " bytes");
+        } else if (result != GzipResult::SUCCESS) {
+            throw std::runtime_error("Failed to decompress gzip payload");
+        }
+        wrapper.payload = buffer();
+        used_ = true;
+    }
+
+    ~InflatedPayload() {
+        // Don't pin an unusually large buffer to the thread
+        if (used_ && buffer().capacity() > kMaxRetainedInflateBuffer) {
+            std::string().swap(buffer());
+        }
+    }
+
+private:
+    bool used_ = false;
+
+    static std::string& buffer() {
+        thread_local std::string inflated;
+        return inflated;
+    }
+};
+
+// Scan a queue record: a single RawTelemetryMessage, or a RawTelemetryBatch of them
+// The two have no field numbers in common, so the first tag tells them apart
+void parseRecord(const uint8_t* data, size_t size, std::vector<WrapperView>& wrappers) {
+    wrappers.clear();
+
+    CodedInputStream input(data, static_cast<int>(size));
+    uint32_t tag = input.ReadTag();
+    if (WireFormatLite::GetTagFieldNumber(tag) != telemetry::v1::RawTelemetryBatch::kMessagesFieldNumber) {
+        wrappers.push_back(parseWrapper(data, size));
+        return;
+    }
+
+    do {
+        std::string_view entry;
+        if (WireFormatLite::GetTagFieldNumber(tag) != telemetry::v1::RawTelemetryBatch::kMessagesFieldNumber ||
+            WireFormatLite::GetTagWireType(tag) != WireFormatLite::WIRETYPE_LENGTH_DELIMITED ||
+            !readBytesView(input, entry)) {
+            throw std::runtime_error("Failed to deserialize RawTelemetryBatch");
+        }
+        wrappers.push_back(parseWrapper(reinterpret_cast<const uint8_t*>(entry.data()), entry.size()));
+    } while ((tag = input.ReadTag()) != 0);
+
+    if (!input.ConsumedEntireMessage()) {
+        throw std::runtime_error("Failed to deserialize RawTelemetryBatch");
+    }
+}
+
+bool isProtobufContentType(std::string_view content_type) {
+    return content_type == "application/x-protobuf" || content_type == "application/protobuf";
+}
+
+bool isJsonContentType(std::string_view content_type) {
+    return content_type == "application/json" || content_type == "text/json";
+}
+
+// Decode one wrapper's payload straight into columnar form
+size_t decodePayload(WrapperView& wrapper, const cppkafka::Message& msg, LogRecordBatch& batch,
+                     size_t max_decompressed_size) {
+    InflatedPayload inflated(wrapper, max_decompressed_size);
+
+    if (isProtobufContentType(wrapper.content_type)) {
+        return OtlpProtoDecoder::decode(wrapper.payload, msg.get_topic(), msg.get_partition(),
+                                        msg.get_offset(), batch);
+    }
+    if (isJsonContentType(wrapper.content_type)) {
+        return OtlpJsonDecoder::decode(wrapper.payload, msg.get_topic(), msg.get_partition(),
+                                       msg.get_offset(), batch);
+    }
+    throw std::runtime_error("Unsupported content type: " + std::string(wrapper.content_type));
+}
+
+// Per-thread wrapper list, reused across records
+std::vector<WrapperView>& wrapperScratch() {
+    thread_local std::vector<WrapperView> wrappers;
+    return wrappers;
+}
+
+}  // namespace
 
 QueueConsumer::QueueConsumer(const AppenderConfig& config)
     : config_(config), running_(false) {
@@ -36,7 +208,11 @@ bool QueueConsumer::initialize() {
                 partition_ids.push_back(tp.get_partition());
             }
             if (assignment_callback_) {
-                assignment_callback_(partition_ids);
+                // cppkafka assigns this list once the callback returns, so the
+                // start offsets go in here; a seek now would be overridden
+                std::map<int32_t, int64_t> start_offsets;
+                assignment_callback_(partition_ids, start_offsets);
+                applyStartOffsets(partitions, start_offsets);
             }
         });
 
@@ -63,7 +239,7 @@ bool QueueConsumer::initialize() {
     }
 }
 
-void QueueConsumer::start(MessageCallback callback) {
+void QueueConsumer::startRaw(RawBatchCallback callback) {
     if (running_) {
         std::cerr << "Consumer is already running" << std::endl;
         return;
@@ -75,43 +251,44 @@ void QueueConsumer::start(MessageCallback callback) {
     }
 
     running_ = true;
-    std::cout << "Starting queue consumer..." << std::endl;
+    std::cout << "Starting queue consumer (batch size " << config_.consumer_batch_size
+              << ", poll timeout " << config_.consumer_poll_timeout_ms << "ms)..." << std::endl;
+
+    const size_t batch_size = static_cast<size_t>(std::max(1, config_.consumer_batch_size));
+    const auto poll_timeout = std::chrono::milliseconds(config_.consumer_poll_timeout_ms);
 
     try {
         while (running_) {
-            // Poll for messages with timeout
-            cppkafka::Message msg = consumer_->poll(std::chrono::milliseconds(1000));
+            if (poll_callback_) {
+                poll_callback_();
+            }
 
-            if (msg) {
+            // Poll a batch of messages with timeout
+            std::vector<cppkafka::Message> messages = consumer_->poll_batch(batch_size, poll_timeout);
+            if (messages.empty()) {
+                continue;
+            }
+
+            RawBatch batch;
+            for (auto& msg : messages) {
+                if (!msg) {
+                    continue;
+                }
                 if (msg.get_error()) {
-                    if (msg.is_eof()) {
-                        // End of partition, continue
-                        continue;
-                    } else {
+                    if (!msg.is_eof()) {
                         std::cerr << "Consumer error: " << msg.get_error() << std::endl;
-                        continue;
                     }
+                    continue;
                 }
 
-                // Deserialize wrapper and parse payload
-                try {
-                    auto wrapper = deserializeWrapper(msg.get_payload());
-                    auto request = parsePayload(wrapper);
-
-                    // Create Kafka metadata for callback
-                    KafkaMessageMeta meta;
-                    meta.topic = msg.get_topic();
-                    meta.partition = msg.get_partition();
-                    meta.offset = msg.get_offset();
-
-                    callback(request, meta);
+                int32_t partition = msg.get_partition();
+                batch[partition].push_back(std::move(msg));
+            }
 
-                    // Note: Offset is NOT committed here anymore.
-                    // The caller must track offsets and commit after successful Iceberg flush.
-                } catch (const std::exception& e) {
-                    std::cerr << "Error processing message: " << e.what() << std::endl;
-                    // Don't track offset on error - will retry on restart
-                }
+            if (!batch.empty()) {
+                // Note: Offsets are NOT committed here.
+                // The caller must track offsets and commit after successful Iceberg flush.
+                callback(batch);
             }
         }
     } catch (const cppkafka::HandleException& e) {
@@ -124,6 +301,29 @@ void QueueConsumer::start(MessageCallback callback) {
     std::cout << "Queue consumer stopped" << std::endl;
 }
 
+size_t QueueConsumer::decodeMessageToBatch(const cppkafka::Message& msg, LogRecordBatch& batch,
+                                           size_t max_decompressed_size) {
+    const cppkafka::Buffer& buffer = msg.get_payload();
+    std::vector<WrapperView>& wrappers = wrapperScratch();
+    parseRecord(buffer.get_data(), buffer.get_size(), wrappers);
+
+    if (wrappers.size() == 1) {
+        return decodePayload(wrappers.front(), msg, batch, max_decompressed_size);
+    }
+
+    // One bad request in a batch must not drop the others
+    size_t appended = 0;
+    for (size_t i = 0; i < wrappers.size(); ++i) {
+        try {
+            appended += decodePayload(wrappers[i], msg, batch, max_decompressed_size);
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping batch entry " << i << " of partition " << msg.get_partition()
+                      << " offset " << msg.get_offset() << ": " << e.what() << std::endl;
+        }
+    }
+    return appended;
+}
+
 void QueueConsumer::stop() {
     if (!running_) {
         return;
@@ -140,37 +340,6 @@ void QueueConsumer::stop() {
     }
 }
 
-telemetry::v1::RawTelemetryMessage QueueConsumer::deserializeWrapper(const std::string& data) {
-    telemetry::v1::RawTelemetryMessage wrapper;
-    if (!wrapper.ParseFromString(data)) {
-        throw std::runtime_error("Failed to deserialize RawTelemetryMessage wrapper");
-    }
-    return wrapper;
-}
-
-opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest QueueConsumer::parsePayload(
-    const telemetry::v1::RawTelemetryMessage& wrapper) {
-
-    opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest request;
-    const std::string& content_type = wrapper.content_type();
-    const std::string& payload = wrapper.payload();
-
-    if (content_type == "application/x-protobuf" || content_type == "application/protobuf") {
-        if (!request.ParseFromString(payload)) {
-            throw std::runtime_error("Failed to parse Protobuf payload");
-        }
-    } else if (content_type == "application/json" || content_type == "text/json") {
-        auto status = google::protobuf::util::JsonStringToMessage(payload, &request);
-        if (!status.ok()) {
-            throw std::runtime_error("Failed to parse JSON payload: " + status.ToString());
-        }
-    } else {
-        throw std::runtime_error("Unsupported content type: " + content_type);
-    }
-
-    return request;
-}
-
 void QueueConsumer::trackOffset(int32_t partition, int64_t offset) {
     // Track the max offset seen for each partition
     auto it = pending_offsets_.find(partition);
@@ -264,30 +433,41 @@ bool QueueConsumer::seekPartition(int32_t partition, int64_t offset) {
     if (!consumer_) {
         return false;
     }
+    if (!seekPartition(*consumer_, config_.queue_topic, partition, offset)) {
+        return false;
+    }
+    std::cout << "Sought partition " << partition << " to offset " << offset << std::endl;
+    return true;
+}
 
-    try {
-        // Get current assignment
-        auto assignment = consumer_->get_assignment();
+bool QueueConsumer::seekPartition(cppkafka::Consumer& consumer, const std::string& topic,
+                                  int32_t partition, int64_t offset) {
+    // Seek this partition alone: re-assigning would send every other partition
+    // back to its committed offset and drop pauses
+    rd_kafka_topic_partition_list_t* list = rd_kafka_topic_partition_list_new(1);
+    rd_kafka_topic_partition_list_add(list, topic.c_str(), partition)->offset = offset;
+
+    bool ok = true;
+    rd_kafka_error_t* error = rd_kafka_seek_partitions(consumer.get_handle(), list, 5000);
+    if (error) {
+        std::cerr << "Error seeking partition " << partition << ": " << rd_kafka_error_string(error) << std::endl;
+        rd_kafka_error_destroy(error);
+        ok = false;
+    } else if (list->elems[0].err != RD_KAFKA_RESP_ERR_NO_ERROR) {
+        std::cerr << "Error seeking partition " << partition << ": " << rd_kafka_err2str(list->elems[0].err) << std::endl;
+        ok = false;
+    }
+    rd_kafka_topic_partition_list_destroy(list);
+    return ok;
+}
 
-        // Build new assignment list with updated offset for this partition
-        std::vector<cppkafka::TopicPartition> new_assignment;
-        for (const auto& tp : assignment) {
-            if (tp.get_partition() == partition) {
-                new_assignment.emplace_back(config_.queue_topic, partition, offset);
-            } else {
-                new_assignment.push_back(tp);
-            }
+void QueueConsumer::applyStartOffsets(cppkafka::TopicPartitionList& partitions,
+                                      const std::map<int32_t, int64_t>& start_offsets) {
+    for (auto& tp : partitions) {
+        auto it = start_offsets.find(tp.get_partition());
+        if (it != start_offsets.end()) {
+            tp.set_offset(it->second);
         }
-
-        consumer_->assign(new_assignment);
-        std::cout << "Sought partition " << partition << " to offset " << offset << std::endl;
-        return true;
-    } catch (const cppkafka::HandleException& e) {
-        std::cerr << "Error seeking partition " << partition << ": " << e.what() << std::endl;
-        return false;
-    } catch (const std::exception& e) {
-        std::cerr << "Unexpected error seeking partition " << partition << ": " << e.what() << std::endl;
-        return false;
     }
 }
 
@@ -313,6 +493,44 @@ bool QueueConsumer::commitPartitionOffset(int32_t partition, int64_t offset) {
     }
 }
 
+bool QueueConsumer::pausePartition(int32_t partition) {
+    if (!consumer_) {
+        return false;
+    }
+
+    try {
+        consumer_->pause_partitions({cppkafka::TopicPartition(config_.queue_topic, partition)});
+        return true;
+    } catch (const cppkafka::HandleException& e) {
+        std::cerr << "Error pausing partition " << partition << ": " << e.what() << std::endl;
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Unexpected error pausing partition " << partition << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool QueueConsumer::resumePartition(int32_t partition) {
+    if (!consumer_) {
+        return false;
+    }
+
+    try {
+        consumer_->resume_partitions({cppkafka::TopicPartition(config_.queue_topic, partition)});
+        return true;
+    } catch (const cppkafka::HandleException& e) {
+        std::cerr << "Error resuming partition " << partition << ": " << e.what() << std::endl;
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Unexpected error resuming partition " << partition << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void QueueConsumer::setPollCallback(PollCallback callback) {
+    poll_callback_ = std::move(callback);
+}
+
 void QueueConsumer::setAssignmentCallback(PartitionAssignmentCallback callback) {
     assignment_callback_ = std::move(callback);
 }
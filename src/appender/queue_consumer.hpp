@@ -2,6 +2,8 @@
 #define QUEUE_CONSUMER_HPP
 
 #include "../config.hpp"
+#include "log_transformer.hpp"
+#include "../gzip_decompressor.hpp"
 #include <string>
 #include <functional>
 #include <memory>
@@ -9,45 +11,22 @@
 #include <vector>
 #include <cstdint>
 
-// Forward declarations
-namespace opentelemetry {
-namespace proto {
-namespace collector {
-namespace logs {
-namespace v1 {
-class ExportLogsServiceRequest;
-}
-}
-}
-}
-}
-
-namespace telemetry {
-namespace v1 {
-class RawTelemetryMessage;
-}
-}
-
-using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
-
 #include <cppkafka/cppkafka.h>
 
-// Kafka message metadata passed to callback
-struct KafkaMessageMeta {
-    std::string topic;
-    int32_t partition;
-    int64_t offset;
-};
+// Undecoded messages from one poll cycle grouped by partition, each group in offset order
+using RawBatch = std::map<int32_t, std::vector<cppkafka::Message>>;
 
 // Callback types for rebalance events
-using PartitionAssignmentCallback = std::function<void(const std::vector<int32_t>&)>;
+// The assignment callback may fill start_offsets (partition -> offset) to start
+// those partitions somewhere other than the committed offset
+using PartitionAssignmentCallback = std::function<void(const std::vector<int32_t>& partitions,
+                                                       std::map<int32_t, int64_t>& start_offsets)>;
 using PartitionRevocationCallback = std::function<void(const std::vector<int32_t>&)>;
 
 class QueueConsumer {
 public:
-    using MessageCallback = std::function<void(
-        const opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest&,
-        const KafkaMessageMeta&)>;
+    using RawBatchCallback = std::function<void(RawBatch&)>;
+    using PollCallback = std::function<void()>;
 
     QueueConsumer(const AppenderConfig& config);
     ~QueueConsumer();
@@ -55,9 +34,21 @@ public:
     // Initialize the consumer (must be called before start)
     bool initialize();
 
-    // Start consuming messages
-    // Calls callback for each message received with Kafka metadata
-    void start(MessageCallback callback);
+    // Start consuming undecoded message batches
+    // Polls up to consumer_batch_size messages at a time and calls callback once
+    // per poll cycle with the messages grouped by partition; decoding is left to
+    // the caller, which may move the messages out and decode them on another thread
+    void startRaw(RawBatchCallback callback);
+
+    // Decode a Kafka message straight into columnar form, appending to batch
+    // Payloads are decoded from the librdkafka buffer by OtlpProtoDecoder or
+    // OtlpJsonDecoder without materializing an ExportLogsServiceRequest
+    // Payloads passed through compressed (content_encoding) are inflated first,
+    // up to max_decompressed_size bytes
+    // Returns the number of log records appended
+    // Throws std::runtime_error on malformed messages, leaving batch unchanged
+    static size_t decodeMessageToBatch(const cppkafka::Message& msg, LogRecordBatch& batch,
+                                       size_t max_decompressed_size = GzipDecompressor::kDefaultMaxSize);
 
     // Stop consuming (graceful shutdown)
     void stop();
@@ -81,11 +72,29 @@ public:
     bool seekToOffsets(const std::map<int32_t, int64_t>& offsets);
 
     // Seek a single partition to a specific offset
+    // Only that partition's position changes; it must be assigned already
+    // (use the assignment callback's start offsets instead) and stays paused if it was
     bool seekPartition(int32_t partition, int64_t offset);
+    static bool seekPartition(cppkafka::Consumer& consumer, const std::string& topic,
+                              int32_t partition, int64_t offset);
+
+    // Set the offset each listed partition starts from when the list is assigned
+    // Partitions missing from start_offsets keep their offset (the committed one by default)
+    static void applyStartOffsets(cppkafka::TopicPartitionList& partitions,
+                                  const std::map<int32_t, int64_t>& start_offsets);
 
     // Commit offset for a specific partition
     bool commitPartitionOffset(int32_t partition, int64_t offset);
 
+    // Stop or restart fetching a partition without leaving the consumer group
+    // Must be called from the polling thread (e.g. the poll callback)
+    bool pausePartition(int32_t partition);
+    bool resumePartition(int32_t partition);
+
+    // Set callback invoked on the polling thread before every poll
+    // Runs even when nothing is consumed, so paused partitions can be resumed
+    void setPollCallback(PollCallback callback);
+
     // Set callback for partition assignment (rebalance)
     void setAssignmentCallback(PartitionAssignmentCallback callback);
 
@@ -109,12 +118,7 @@ private:
     PartitionAssignmentCallback assignment_callback_;
     PartitionRevocationCallback revocation_callback_;
 
-    // Deserialize wrapper message from queue
-    telemetry::v1::RawTelemetryMessage deserializeWrapper(const std::string& data);
-
-    // Parse payload into ExportLogsServiceRequest based on content_type
-    opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest parsePayload(
-        const telemetry::v1::RawTelemetryMessage& wrapper);
+    PollCallback poll_callback_;
 };
 
 #endif // QUEUE_CONSUMER_HPP
@@ -10,10 +10,29 @@ struct IngesterConfig {
     std::string queue_brokers;
     std::string queue_topic;
     int max_in_flight = 1000;
+    size_t max_in_flight_mb = 256;         // Upper bound of the adaptive in-flight byte limit
+    size_t min_in_flight_mb = 16;          // Floor the limit is never cut below
+    int target_delivery_latency_ms = 250;  // Kafka acknowledgement latency the limit adapts to
     int acks = -1;  // -1 means all replicas must acknowledge
     std::string compression_type = "snappy";
     int retry_backoff_ms = 100;
     int max_retries = 3;
+    size_t max_decompressed_size_mb = 64;  // Largest gzip request body after decompression
+    bool passthrough_compression = false;  // Forward gzip bodies compressed; the appender inflates them
+    int batch_linger_ms = 0;               // Coalesce requests into batch records for this long (0 = off)
+    size_t batch_max_bytes = 1024 * 1024;  // Batch record size limit
+    int batch_max_messages = 500;          // Requests per batch record
+    int producer_shards = 1;               // Independent Kafka producers, each with its own poll thread
+    bool durable_ack = false;              // Respond to /v1/logs only after Kafka acknowledges the record
+    int retry_after_seconds = 1;           // Retry-After sent when a durable-ack delivery fails
+    std::string partition_key;             // Kafka key source: "", "service.name", "resource" or "header:<name>"
+    std::string spill_dir;                 // Spill records here while Kafka is unavailable ("" = off)
+    size_t spill_max_mb = 1024;            // Disk budget for the spill log
+    size_t spill_segment_mb = 64;          // Spill segment file size
+    std::string spill_fsync = "interval";  // none, interval or always
+    int spill_fsync_interval_ms = 1000;
+    int grpc_port = 4317;                  // OTLP/gRPC listen port (0 = off; needs a gRPC build)
+    int grpc_max_concurrent_streams = 100; // Concurrent Export calls per gRPC connection
 
     static IngesterConfig fromEnv() {
         IngesterConfig config;
@@ -36,6 +55,21 @@ struct IngesterConfig {
             config.max_in_flight = std::atoi(max_in_flight_str);
         }
 
+        const char* max_in_flight_mb = std::getenv("MAX_IN_FLIGHT_MB");
+        if (max_in_flight_mb) {
+            config.max_in_flight_mb = std::strtoull(max_in_flight_mb, nullptr, 10);
+        }
+
+        const char* min_in_flight_mb = std::getenv("MIN_IN_FLIGHT_MB");
+        if (min_in_flight_mb) {
+            config.min_in_flight_mb = std::strtoull(min_in_flight_mb, nullptr, 10);
+        }
+
+        const char* target_latency = std::getenv("TARGET_DELIVERY_LATENCY_MS");
+        if (target_latency) {
+            config.target_delivery_latency_ms = std::atoi(target_latency);
+        }
+
         const char* acks_str = std::getenv("PRODUCER_ACKS");
         if (acks_str) {
             config.acks = std::atoi(acks_str);
@@ -46,6 +80,86 @@ struct IngesterConfig {
             config.compression_type = compression;
         }
 
+        const char* max_decompressed = std::getenv("MAX_DECOMPRESSED_SIZE_MB");
+        if (max_decompressed) {
+            config.max_decompressed_size_mb = std::atoi(max_decompressed);
+        }
+
+        const char* passthrough = std::getenv("PASSTHROUGH_COMPRESSION");
+        if (passthrough) {
+            config.passthrough_compression = std::strcmp(passthrough, "true") == 0 || std::strcmp(passthrough, "1") == 0;
+        }
+
+        const char* batch_linger = std::getenv("BATCH_LINGER_MS");
+        if (batch_linger) {
+            config.batch_linger_ms = std::atoi(batch_linger);
+        }
+
+        const char* batch_max_bytes = std::getenv("BATCH_MAX_BYTES");
+        if (batch_max_bytes) {
+            config.batch_max_bytes = std::strtoull(batch_max_bytes, nullptr, 10);
+        }
+
+        const char* batch_max_messages = std::getenv("BATCH_MAX_MESSAGES");
+        if (batch_max_messages) {
+            config.batch_max_messages = std::atoi(batch_max_messages);
+        }
+
+        const char* producer_shards = std::getenv("PRODUCER_SHARDS");
+        if (producer_shards) {
+            config.producer_shards = std::atoi(producer_shards);
+        }
+
+        const char* durable_ack = std::getenv("DURABLE_ACK");
+        if (durable_ack) {
+            config.durable_ack = std::strcmp(durable_ack, "true") == 0 || std::strcmp(durable_ack, "1") == 0;
+        }
+
+        const char* retry_after = std::getenv("RETRY_AFTER_SECONDS");
+        if (retry_after) {
+            config.retry_after_seconds = std::atoi(retry_after);
+        }
+
+        const char* partition_key = std::getenv("PARTITION_KEY");
+        if (partition_key) {
+            config.partition_key = partition_key;
+        }
+
+        const char* spill_dir = std::getenv("SPILL_DIR");
+        if (spill_dir) {
+            config.spill_dir = spill_dir;
+        }
+
+        const char* spill_max = std::getenv("SPILL_MAX_MB");
+        if (spill_max) {
+            config.spill_max_mb = std::strtoull(spill_max, nullptr, 10);
+        }
+
+        const char* spill_segment = std::getenv("SPILL_SEGMENT_MB");
+        if (spill_segment) {
+            config.spill_segment_mb = std::strtoull(spill_segment, nullptr, 10);
+        }
+
+        const char* spill_fsync = std::getenv("SPILL_FSYNC");
+        if (spill_fsync) {
+            config.spill_fsync = spill_fsync;
+        }
+
+        const char* spill_fsync_interval = std::getenv("SPILL_FSYNC_INTERVAL_MS");
+        if (spill_fsync_interval) {
+            config.spill_fsync_interval_ms = std::atoi(spill_fsync_interval);
+        }
+
+        const char* grpc_port = std::getenv("GRPC_PORT");
+        if (grpc_port) {
+            config.grpc_port = std::atoi(grpc_port);
+        }
+
+        const char* grpc_streams = std::getenv("GRPC_MAX_CONCURRENT_STREAMS");
+        if (grpc_streams) {
+            config.grpc_max_concurrent_streams = std::atoi(grpc_streams);
+        }
+
         return config;
     }
 };
@@ -70,6 +184,58 @@ struct AppenderConfig {
     int iceberg_retry_base_delay_ms = 100;      // Base backoff delay
     int iceberg_retry_max_delay_ms = 5000;      // Max backoff cap
     int rebalance_timeout_seconds = 30;         // Timeout for worker shutdown during rebalance
+    int partition_max_pending_flushes = 2;      // Sealed buffers allowed to wait on Iceberg per partition
+    int partition_queue_max_messages = 100;     // Queued messages per partition before Kafka is paused
+    size_t partition_queue_max_mb = 64;         // Queued data per partition before Kafka is paused
+    int partition_queue_resume_percent = 50;    // Resume once the queue drains below this share of both limits
+
+    // Process-wide memory budget for worker queues and in-memory buffers
+    // Above memory_flush_percent of the budget the largest (or oldest) buffers
+    // are flushed early; over the budget DuckDB buffers are spilled to
+    // parquet_staging_dir and Kafka is paused until usage drops again
+    size_t memory_budget_mb = 0;                // 0 = memory_budget_percent of the cgroup limit (none without one)
+    int memory_budget_percent = 60;             // Share of the cgroup memory limit used as budget
+    int memory_flush_percent = 75;              // Start flushing early above this share of the budget
+    std::string memory_flush_policy = "largest";  // largest or oldest buffers are flushed first
+    size_t memory_flush_min_mb = 4;             // Active buffers smaller than this are not flushed early
+
+    // Consumer batching
+    int consumer_batch_size = 500;              // Max messages per poll cycle
+    int consumer_poll_timeout_ms = 100;         // Max wait for a poll cycle to fill
+
+    // Decode/transform threads between consumer and workers (0 = decode on the poll thread)
+    int decode_threads = 4;
+
+    // Largest payload after decompressing a passed-through (content_encoding) message
+    size_t max_decompressed_size_mb = 64;
+
+    // Partition buffer sink: "duckdb" stages records in a DuckDB table, "parquet"
+    // streams them into a local Parquet file that is appended to Iceberg as-is
+    std::string buffer_sink = "duckdb";
+    std::string parquet_staging_dir = "/tmp/otel-appender";  // In-progress Parquet files and spilled buffers
+    size_t parquet_row_group_mb = 16;           // Row group size (memory held per partition)
+    std::string parquet_compression = "gzip";   // gzip or none
+
+    // On-disk DuckDB file for the buffer tables (empty = in memory)
+    // Buffers left by a crash or an unfinished shutdown are committed from
+    // disk on the next start instead of being replayed from Kafka
+    std::string buffer_db_path;
+
+    // Iceberg commits: "duckdb" inserts through DuckDB's iceberg extension,
+    // "rest" fast-appends the Parquet buffer files through the REST catalog
+    // directly (needs BUFFER_SINK=parquet)
+    std::string iceberg_commit_mode = "duckdb";
+    std::string iceberg_warehouse;              // Warehouse passed to the catalog's /v1/config
+
+    // REST commits: files sealed by all partitions are coalesced into one
+    // snapshot at most every iceberg_commit_interval_ms (0 = commit as soon as
+    // the previous commit is done), or earlier once iceberg_commit_max_files wait
+    int iceberg_commit_interval_ms = 10000;
+    int iceberg_commit_max_files = 256;
+
+    bool useParquetSink() const { return buffer_sink == "parquet"; }
+    bool usePersistentBuffer() const { return !buffer_db_path.empty() && !useParquetSink(); }
+    bool useRestCommits() const { return iceberg_commit_mode == "rest" && useParquetSink(); }
 
     static AppenderConfig fromEnv() {
         AppenderConfig config;
@@ -168,6 +334,116 @@ struct AppenderConfig {
             config.rebalance_timeout_seconds = std::atoi(rebalance_timeout);
         }
 
+        const char* max_pending_flushes = std::getenv("PARTITION_MAX_PENDING_FLUSHES");
+        if (max_pending_flushes) {
+            config.partition_max_pending_flushes = std::atoi(max_pending_flushes);
+        }
+
+        const char* queue_max_messages = std::getenv("PARTITION_QUEUE_MAX_MESSAGES");
+        if (queue_max_messages) {
+            config.partition_queue_max_messages = std::atoi(queue_max_messages);
+        }
+
+        const char* queue_max_mb = std::getenv("PARTITION_QUEUE_MAX_MB");
+        if (queue_max_mb) {
+            config.partition_queue_max_mb = std::atoi(queue_max_mb);
+        }
+
+        const char* queue_resume_percent = std::getenv("PARTITION_QUEUE_RESUME_PERCENT");
+        if (queue_resume_percent) {
+            config.partition_queue_resume_percent = std::atoi(queue_resume_percent);
+        }
+
+        const char* memory_budget_mb = std::getenv("MEMORY_BUDGET_MB");
+        if (memory_budget_mb) {
+            config.memory_budget_mb = std::atoi(memory_budget_mb);
+        }
+
+        const char* memory_budget_percent = std::getenv("MEMORY_BUDGET_PERCENT");
+        if (memory_budget_percent) {
+            config.memory_budget_percent = std::atoi(memory_budget_percent);
+        }
+
+        const char* memory_flush_percent = std::getenv("MEMORY_FLUSH_PERCENT");
+        if (memory_flush_percent) {
+            config.memory_flush_percent = std::atoi(memory_flush_percent);
+        }
+
+        const char* memory_flush_policy = std::getenv("MEMORY_FLUSH_POLICY");
+        if (memory_flush_policy && strlen(memory_flush_policy) > 0) {
+            config.memory_flush_policy = memory_flush_policy;
+        }
+
+        const char* memory_flush_min = std::getenv("MEMORY_FLUSH_MIN_MB");
+        if (memory_flush_min) {
+            config.memory_flush_min_mb = std::atoi(memory_flush_min);
+        }
+
+        const char* consumer_batch_size = std::getenv("CONSUMER_BATCH_SIZE");
+        if (consumer_batch_size) {
+            config.consumer_batch_size = std::atoi(consumer_batch_size);
+        }
+
+        const char* consumer_poll_timeout = std::getenv("CONSUMER_POLL_TIMEOUT_MS");
+        if (consumer_poll_timeout) {
+            config.consumer_poll_timeout_ms = std::atoi(consumer_poll_timeout);
+        }
+
+        const char* decode_threads = std::getenv("DECODE_THREADS");
+        if (decode_threads) {
+            config.decode_threads = std::atoi(decode_threads);
+        }
+
+        const char* max_decompressed = std::getenv("MAX_DECOMPRESSED_SIZE_MB");
+        if (max_decompressed) {
+            config.max_decompressed_size_mb = std::atoi(max_decompressed);
+        }
+
+        const char* buffer_sink = std::getenv("BUFFER_SINK");
+        if (buffer_sink && strlen(buffer_sink) > 0) {
+            config.buffer_sink = buffer_sink;
+        }
+
+        const char* staging_dir = std::getenv("PARQUET_STAGING_DIR");
+        if (staging_dir && strlen(staging_dir) > 0) {
+            config.parquet_staging_dir = staging_dir;
+        }
+
+        const char* row_group_mb = std::getenv("PARQUET_ROW_GROUP_MB");
+        if (row_group_mb) {
+            config.parquet_row_group_mb = std::atoi(row_group_mb);
+        }
+
+        const char* parquet_compression = std::getenv("PARQUET_COMPRESSION");
+        if (parquet_compression && strlen(parquet_compression) > 0) {
+            config.parquet_compression = parquet_compression;
+        }
+
+        const char* buffer_db_path = std::getenv("BUFFER_DB_PATH");
+        if (buffer_db_path) {
+            config.buffer_db_path = buffer_db_path;
+        }
+
+        const char* commit_mode = std::getenv("ICEBERG_COMMIT_MODE");
+        if (commit_mode && strlen(commit_mode) > 0) {
+            config.iceberg_commit_mode = commit_mode;
+        }
+
+        const char* warehouse = std::getenv("ICEBERG_WAREHOUSE");
+        if (warehouse) {
+            config.iceberg_warehouse = warehouse;
+        }
+
+        const char* commit_interval = std::getenv("ICEBERG_COMMIT_INTERVAL_MS");
+        if (commit_interval) {
+            config.iceberg_commit_interval_ms = std::atoi(commit_interval);
+        }
+
+        const char* commit_max_files = std::getenv("ICEBERG_COMMIT_MAX_FILES");
+        if (commit_max_files) {
+            config.iceberg_commit_max_files = std::atoi(commit_max_files);
+        }
+
         return config;
     }
 };
@@ -0,0 +1,216 @@
+#include "gzip_decompressor.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <zlib.h>
+
+#ifdef OTEL_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+namespace {
+
+// Minimum gzip stream: 10 byte header, empty deflate block, 8 byte trailer
+constexpr size_t kGzipMinSize = 18;
+
+// Deflate cannot expand data by more than about 1032:1
+constexpr size_t kMaxDeflateRatio = 1032;
+
+// Growth step when ISIZE was wrong (multi-member streams, sizes >= 4 GB)
+constexpr size_t kMinGrowth = 64 * 1024;
+
+// Next output capacity: double, but never past max_size + 1, which is
+// enough to detect that the limit was exceeded
+size_t grow(size_t current, size_t max_size) {
+    size_t limit = max_size < SIZE_MAX ? max_size + 1 : max_size;
+    return std::min(limit, std::max(current * 2, current + kMinGrowth));
+}
+
+// Inflate stream reused by every request on a thread
+struct ZlibState {
+    z_stream strm{};
+    bool initialized = false;
+
+    ~ZlibState() {
+        if (initialized) {
+            inflateEnd(&strm);
+        }
+    }
+
+    bool reset() {
+        if (!initialized) {
+            // 16 + MAX_WBITS to enable gzip decoding with automatic header detection
+            if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
+                return false;
+            }
+            initialized = true;
+            return true;
+        }
+        return inflateReset(&strm) == Z_OK;
+    }
+};
+
+GzipResult decompressZlib(std::string_view in, std::string& out, size_t max_size) {
+    thread_local ZlibState state;
+    if (!state.reset()) {
+        return GzipResult::INVALID;
+    }
+    z_stream& strm = state.strm;
+
+    out.resize(std::max<size_t>(GzipDecompressor::expectedSize(in, max_size), 1));
+    size_t produced = 0;
+
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    strm.avail_in = 0;
+    size_t remaining_in = in.size();
+
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        if (produced == out.size()) {
+            if (produced > max_size) {
+                return GzipResult::TOO_LARGE;
+            }
+            out.resize(grow(out.size(), max_size));
+        }
+
+        // avail_in/avail_out are 32-bit; feed large buffers in slices
+        if (strm.avail_in == 0 && remaining_in > 0) {
+            strm.avail_in = static_cast<uInt>(std::min<size_t>(remaining_in, UINT32_MAX));
+            remaining_in -= strm.avail_in;
+        }
+        size_t avail_out = std::min<size_t>(out.size() - produced, UINT32_MAX);
+        strm.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+        strm.avail_out = static_cast<uInt>(avail_out);
+
+        ret = inflate(&strm, Z_NO_FLUSH);
+        produced += avail_out - strm.avail_out;
+
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            // Z_BUF_ERROR with input left would mean no progress; without input it is truncation
+            if (ret != Z_BUF_ERROR || (strm.avail_in == 0 && remaining_in == 0)) {
+                return GzipResult::INVALID;
+            }
+        }
+        if (produced > max_size) {
+            return GzipResult::TOO_LARGE;
+        }
+    }
+
+    out.resize(produced);
+    return GzipResult::SUCCESS;
+}
+
+#ifdef OTEL_HAVE_LIBDEFLATE
+struct LibdeflateState {
+    libdeflate_decompressor* decompressor = nullptr;
+
+    ~LibdeflateState() {
+        if (decompressor) {
+            libdeflate_free_decompressor(decompressor);
+        }
+    }
+};
+
+GzipResult decompressLibdeflate(std::string_view in, std::string& out, size_t max_size) {
+    thread_local LibdeflateState state;
+    if (!state.decompressor) {
+        state.decompressor = libdeflate_alloc_decompressor();
+        if (!state.decompressor) {
+            return GzipResult::INVALID;
+        }
+    }
+
+    // libdeflate needs the whole output buffer up front; retry with a larger
+    // one when ISIZE was wrong
+    out.resize(std::max<size_t>(GzipDecompressor::expectedSize(in, max_size), 1));
+    while (true) {
+        // Passing actual_in lets trailing bytes after the first member through, as zlib does
+        size_t actual_in = 0;
+        size_t actual_out = 0;
+        libdeflate_result result = libdeflate_gzip_decompress_ex(
+            state.decompressor, in.data(), in.size(), &out[0], out.size(), &actual_in, &actual_out);
+
+        if (result == LIBDEFLATE_SUCCESS) {
+            if (actual_out > max_size) {
+                return GzipResult::TOO_LARGE;
+            }
+            out.resize(actual_out);
+            return GzipResult::SUCCESS;
+        }
+        if (result != LIBDEFLATE_INSUFFICIENT_SPACE) {
+            return GzipResult::INVALID;
+        }
+        if (out.size() > max_size) {
+            return GzipResult::TOO_LARGE;
+        }
+        out.resize(grow(out.size(), max_size));
+    }
+}
+#endif
+
+}  // namespace
+
+size_t GzipDecompressor::expectedSize(std::string_view in, size_t max_size) {
+    if (in.size() < kGzipMinSize) {
+        return 0;
+    }
+
+    // ISIZE: uncompressed size mod 2^32, little-endian in the last four bytes
+    const auto* trailer = reinterpret_cast<const uint8_t*>(in.data() + in.size() - 4);
+    size_t isize = static_cast<size_t>(trailer[0]) |
+                   static_cast<size_t>(trailer[1]) << 8 |
+                   static_cast<size_t>(trailer[2]) << 16 |
+                   static_cast<size_t>(trailer[3]) << 24;
+
+    // The trailer is client-controlled; never trust it beyond what the input could produce
+    size_t bound = in.size() <= SIZE_MAX / kMaxDeflateRatio ? in.size() * kMaxDeflateRatio : SIZE_MAX;
+    return std::min({isize, max_size, bound});
+}
+
+bool GzipDecompressor::isGzip(std::string_view in) {
+    if (in.empty()) {
+        return true;
+    }
+    // ID1 ID2 CM: 0x1f 0x8b 0x08 (deflate)
+    return in.size() >= kGzipMinSize &&
+           static_cast<uint8_t>(in[0]) == 0x1f &&
+           static_cast<uint8_t>(in[1]) == 0x8b &&
+           static_cast<uint8_t>(in[2]) == 0x08;
+}
+
+GzipResult GzipDecompressor::decompress(std::string_view in, std::string& out, size_t max_size) {
+    return decompress(in, out, max_size, defaultBackend());
+}
+
+GzipResult GzipDecompressor::decompress(std::string_view in, std::string& out, size_t max_size,
+                                        Backend backend) {
+    if (in.empty()) {
+        out.clear();
+        return GzipResult::SUCCESS;
+    }
+
+#ifdef OTEL_HAVE_LIBDEFLATE
+    if (backend == Backend::LIBDEFLATE) {
+        return decompressLibdeflate(in, out, max_size);
+    }
+#else
+    (void)backend;
+#endif
+    return decompressZlib(in, out, max_size);
+}
+
+GzipDecompressor::Backend GzipDecompressor::defaultBackend() {
+#ifdef OTEL_HAVE_LIBDEFLATE
+    return Backend::LIBDEFLATE;
+#else
+    return Backend::ZLIB;
+#endif
+}
+
+bool GzipDecompressor::isAvailable(Backend backend) {
+#ifdef OTEL_HAVE_LIBDEFLATE
+    (void)backend;
+    return true;
+#else
+    return backend == Backend::ZLIB;
+#endif
+}
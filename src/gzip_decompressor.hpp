@@ -0,0 +1,45 @@
+#ifndef GZIP_DECOMPRESSOR_HPP
+#define GZIP_DECOMPRESSOR_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+enum class GzipResult {
+    SUCCESS,
+    INVALID,    // Not a valid gzip stream - return 400
+    TOO_LARGE   // Decompressed size exceeds the limit - return 413
+};
+
+// Size-bounded gzip decompression for request bodies
+// Output is pre-sized from the gzip ISIZE trailer and decompressor state is
+// kept per thread, so a steady stream of requests does not reallocate it
+class GzipDecompressor {
+public:
+    // Default limit for a decompressed body (MAX_DECOMPRESSED_SIZE_MB)
+    static constexpr size_t kDefaultMaxSize = 64 * 1024 * 1024;
+
+    enum class Backend {
+        ZLIB,
+        LIBDEFLATE  // Only available when built with USE_LIBDEFLATE
+    };
+
+    // Decompress a gzip stream into out, replacing its contents
+    // Fails with TOO_LARGE as soon as more than max_size bytes are produced
+    static GzipResult decompress(std::string_view in, std::string& out, size_t max_size);
+    static GzipResult decompress(std::string_view in, std::string& out, size_t max_size, Backend backend);
+
+    // Cheap header check (magic bytes and deflate method) without decompressing
+    // Empty input counts as gzip, matching decompress()
+    static bool isGzip(std::string_view in);
+
+    // libdeflate when compiled in, zlib otherwise
+    static Backend defaultBackend();
+    static bool isAvailable(Backend backend);
+
+    // Initial output size for a stream: the ISIZE trailer, capped at max_size
+    // and at the largest size the compressed input could expand to
+    static size_t expectedSize(std::string_view in, size_t max_size);
+};
+
+#endif // GZIP_DECOMPRESSOR_HPP
@@ -0,0 +1,106 @@
+#include "admission_controller.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Weight of the newest window in the smoothed acknowledgement rate
+constexpr double kRateSmoothing = 0.2;
+
+}  // namespace
+
+AdmissionController::AdmissionController(Options options)
+    : options_(options)
+    , in_flight_bytes_(0)
+    , limit_bytes_(0)
+    , ack_rate_(0.0)
+    , window_start_ns_(nowNanos())
+    , window_acked_bytes_(0)
+    , window_latency_us_(0)
+    , window_deliveries_(0)
+    , window_failures_(0) {
+    options_.max_bytes = std::max<size_t>(1, options_.max_bytes);
+    options_.min_bytes = std::min(std::max<size_t>(1, options_.min_bytes), options_.max_bytes);
+    limit_bytes_ = options_.max_bytes;
+}
+
+bool AdmissionController::admits(size_t bytes) const {
+    size_t current = in_flight_bytes_.load(std::memory_order_relaxed);
+    return current == 0 || current + bytes <= limit_bytes_.load(std::memory_order_relaxed);
+}
+
+void AdmissionController::acquire(size_t bytes) {
+    in_flight_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AdmissionController::cancel(size_t bytes) {
+    in_flight_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void AdmissionController::release(size_t bytes, int64_t latency_us, bool delivered) {
+    in_flight_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+
+    window_deliveries_.fetch_add(1, std::memory_order_relaxed);
+    window_latency_us_.fetch_add(static_cast<uint64_t>(std::max<int64_t>(0, latency_us)), std::memory_order_relaxed);
+    if (delivered) {
+        window_acked_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    } else {
+        window_failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    maybeAdjust();
+}
+
+void AdmissionController::maybeAdjust() {
+    int64_t now = nowNanos();
+    int64_t start = window_start_ns_.load(std::memory_order_relaxed);
+    int64_t window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.window).count();
+    if (now - start < window_ns || !window_start_ns_.compare_exchange_strong(start, now)) {
+        return;
+    }
+
+    uint64_t acked = window_acked_bytes_.exchange(0);
+    uint64_t latency_us = window_latency_us_.exchange(0);
+    uint64_t deliveries = window_deliveries_.exchange(0);
+    uint64_t failures = window_failures_.exchange(0);
+    if (deliveries == 0) {
+        return;
+    }
+
+    double elapsed = (now - start) / 1e9;
+    if (elapsed > 0) {
+        double rate = acked / elapsed;
+        double previous = ack_rate_.load(std::memory_order_relaxed);
+        ack_rate_.store(previous > 0 ? previous + kRateSmoothing * (rate - previous) : rate,
+                        std::memory_order_relaxed);
+    }
+
+    // Additive increase while Kafka keeps up, multiplicative decrease when it does not
+    auto average_latency = std::chrono::microseconds(latency_us / deliveries);
+    size_t limit = limit_bytes_.load(std::memory_order_relaxed);
+    if (failures > 0 || average_latency > options_.target_latency) {
+        limit = std::max(options_.min_bytes, static_cast<size_t>(limit * options_.decrease_factor));
+    } else {
+        size_t step = std::max<size_t>(1, static_cast<size_t>(options_.max_bytes * options_.increase_fraction));
+        limit = std::min(options_.max_bytes, limit + step);
+    }
+    limit_bytes_.store(limit, std::memory_order_relaxed);
+}
+
+int AdmissionController::retryAfterSeconds() const {
+    size_t in_flight = in_flight_bytes_.load(std::memory_order_relaxed);
+    double rate = ack_rate_.load(std::memory_order_relaxed);
+    if (in_flight == 0) {
+        return 1;
+    }
+    if (rate <= 0) {
+        return options_.max_retry_after_seconds;
+    }
+    double seconds = std::ceil(in_flight / rate);
+    return static_cast<int>(std::clamp(seconds, 1.0, static_cast<double>(options_.max_retry_after_seconds)));
+}
@@ -0,0 +1,67 @@
+#ifndef ADMISSION_CONTROLLER_HPP
+#define ADMISSION_CONTROLLER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Admits produce requests by the bytes they add to librdkafka's queue
+// The byte limit adapts AIMD-style to delivery latency: each window in which
+// acknowledgements come back within target_latency raises it by a fixed step,
+// and a window over target (or with failed deliveries) cuts it by
+// decrease_factor. Requests that do not fit are turned away with a
+// Retry-After estimated from the recent acknowledgement rate.
+class AdmissionController {
+public:
+    struct Options {
+        size_t max_bytes = 256 * 1024 * 1024;
+        size_t min_bytes = 16 * 1024 * 1024;
+        std::chrono::milliseconds target_latency{250};
+        std::chrono::milliseconds window{100};
+        double increase_fraction = 0.02;  // Of max_bytes, per window
+        double decrease_factor = 0.75;
+        int max_retry_after_seconds = 30;
+    };
+
+    explicit AdmissionController(Options options);
+
+    // Whether a request of this many bytes fits under the current limit
+    // A request is always admitted when nothing is in flight, so a single
+    // request larger than the limit can still make progress
+    bool admits(size_t bytes) const;
+
+    // Charge bytes handed to librdkafka
+    void acquire(size_t bytes);
+
+    // Return bytes whose delivery report arrived, with its latency
+    void release(size_t bytes, int64_t latency_us, bool delivered);
+
+    // Return bytes that never reached librdkafka
+    void cancel(size_t bytes);
+
+    bool isSaturated() const { return in_flight_bytes_.load(std::memory_order_relaxed) >= limit_bytes_.load(std::memory_order_relaxed); }
+    size_t getInFlightBytes() const { return in_flight_bytes_.load(std::memory_order_relaxed); }
+    size_t getLimitBytes() const { return limit_bytes_.load(std::memory_order_relaxed); }
+
+    // Seconds until the bytes in flight are likely acknowledged, at least 1
+    int retryAfterSeconds() const;
+
+private:
+    Options options_;
+    std::atomic<size_t> in_flight_bytes_;
+    std::atomic<size_t> limit_bytes_;
+    std::atomic<double> ack_rate_;  // Bytes per second, smoothed across windows
+
+    // Current window
+    std::atomic<int64_t> window_start_ns_;
+    std::atomic<uint64_t> window_acked_bytes_;
+    std::atomic<uint64_t> window_latency_us_;
+    std::atomic<uint64_t> window_deliveries_;
+    std::atomic<uint64_t> window_failures_;
+
+    // Close the window if it has run its length; one caller wins and adjusts
+    void maybeAdjust();
+};
+
+#endif // ADMISSION_CONTROLLER_HPP
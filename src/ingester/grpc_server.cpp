@@ -0,0 +1,231 @@
+#include "grpc_server.hpp"
+#include "queue_producer.hpp"
+#include "telemetry_wrapper.pb.h"
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/generic/async_generic_service.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+
+namespace {
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void appendLengthDelimited(std::string& out, uint32_t field, std::string_view bytes) {
+    appendVarint(out, (field << 3) | 2);
+    appendVarint(out, bytes.size());
+    out.append(bytes.data(), bytes.size());
+}
+
+grpc::Status retryableStatus(grpc::StatusCode code, const std::string& message, int retry_after_seconds) {
+    return grpc::Status(code, message, GrpcServer::retryInfoDetails(code, message, retry_after_seconds));
+}
+
+}  // namespace
+
+// Serves LogsService/Export; every other method gets UNIMPLEMENTED
+class GrpcServer::ExportService : public grpc::CallbackGenericService {
+public:
+    explicit ExportService(const GrpcServer& server) : server_(server) {}
+
+    grpc::ServerGenericBidiReactor* CreateReactor(grpc::GenericCallbackServerContext* context) override {
+        if (context->method() != kExportMethod) {
+            return grpc::CallbackGenericService::CreateReactor(context);
+        }
+        return new ExportReactor(server_, context);
+    }
+
+private:
+    // One Export call: read the request, queue it, finish (possibly from the
+    // delivery report). Deletes itself once gRPC is done with it.
+    class ExportReactor : public grpc::ServerGenericBidiReactor {
+    public:
+        ExportReactor(const GrpcServer& server, grpc::GenericCallbackServerContext* context)
+            : server_(server), context_(context) {
+            StartRead(&request_);
+        }
+
+        void OnReadDone(bool ok) override {
+            if (!ok) {
+                Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Missing ExportLogsServiceRequest"));
+                return;
+            }
+            exportRequest();
+        }
+
+        void OnDone() override {
+            delete this;
+        }
+
+    private:
+        const GrpcServer& server_;
+        grpc::GenericCallbackServerContext* context_;
+        grpc::ByteBuffer request_;
+        grpc::ByteBuffer response_;
+
+        void exportRequest() {
+            // The serialized ExportLogsServiceRequest, contiguous (copied only if it spans slices)
+            grpc::Slice slice;
+            if (!request_.TrySingleSlice(&slice).ok() && !request_.DumpToSingleSlice(&slice).ok()) {
+                Finish(grpc::Status(grpc::StatusCode::INTERNAL, "Failed to read request"));
+                return;
+            }
+            std::string_view body(reinterpret_cast<const char*>(slice.begin()), slice.size());
+
+            const std::shared_ptr<QueueProducer>& queue_producer = server_.queue_producer_;
+            if (!queue_producer) {
+                // Fallback: just log (for testing without queue)
+                std::cout << "Received ExportLogsServiceRequest over gRPC, payload_size=" << body.size() << std::endl;
+                finishExported();
+                return;
+            }
+
+            // RESOURCE_EXHAUSTED with RetryInfo tells OTLP exporters to back off and retry
+            if (queue_producer->isAtCapacity(body.size())) {
+                Finish(retryableStatus(grpc::StatusCode::RESOURCE_EXHAUSTED, "Queue is at capacity",
+                                       queue_producer->retryAfterSeconds()));
+                return;
+            }
+
+            std::string key;
+            if (server_.partition_key_.enabled()) {
+                std::string header_value;
+                if (server_.partition_key_.mode() == PartitionKeyMode::HEADER) {
+                    header_value = metadataValue(server_.partition_key_.headerName());
+                }
+                key = server_.partition_key_.extract("application/x-protobuf", body, header_value);
+            }
+
+            // In durable-ack mode the delivery report finishes the call; once produce()
+            // succeeds this reactor may already be gone, so it is not touched again
+            bool durable = server_.durable_ack_;
+            DeliveryCallback on_delivered;
+            if (durable) {
+                int retry_after_seconds = server_.retry_after_seconds_;
+                on_delivered = [this, retry_after_seconds](bool delivered) {
+                    if (delivered) {
+                        finishExported();
+                    } else {
+                        Finish(retryableStatus(grpc::StatusCode::UNAVAILABLE, "Delivery to queue failed",
+                                               retry_after_seconds));
+                    }
+                };
+            }
+
+            ProduceResult result = queue_producer->produce(
+                "application/x-protobuf", telemetry::v1::OTEL_LOGS, body, {}, on_delivered, key);
+
+            if (result == ProduceResult::SUCCESS) {
+                if (!durable) {
+                    finishExported();
+                }
+            } else if (result == ProduceResult::PERSISTENT_ERROR) {
+                Finish(grpc::Status(grpc::StatusCode::INTERNAL, "Failed to queue message"));
+            } else {
+                Finish(retryableStatus(grpc::StatusCode::UNAVAILABLE, "Queue is full",
+                                       queue_producer->retryAfterSeconds()));
+            }
+        }
+
+        // Empty ExportLogsServiceResponse (no partial_success)
+        void finishExported() {
+            grpc::Slice empty;
+            response_ = grpc::ByteBuffer(&empty, 1);
+            StartWriteAndFinish(&response_, grpc::WriteOptions(), grpc::Status::OK);
+        }
+
+        // gRPC metadata keys are lower case
+        std::string metadataValue(const std::string& name) const {
+            std::string lower(name);
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            const auto& metadata = context_->client_metadata();
+            auto it = metadata.find(lower);
+            if (it == metadata.end()) {
+                return std::string();
+            }
+            return std::string(it->second.data(), it->second.size());
+        }
+    };
+
+    const GrpcServer& server_;
+};
+
+GrpcServer::GrpcServer(std::shared_ptr<QueueProducer> queue_producer, const IngesterConfig& config)
+    : queue_producer_(queue_producer)
+    , max_message_size_(config.max_decompressed_size_mb * 1024 * 1024)
+    , max_concurrent_streams_(config.grpc_max_concurrent_streams)
+    , durable_ack_(config.durable_ack)
+    , retry_after_seconds_(config.retry_after_seconds)
+    , partition_key_(config.partition_key)
+    , port_(0) {}
+
+GrpcServer::~GrpcServer() {
+    shutdown();
+}
+
+bool GrpcServer::start(const std::string& host, int port) {
+    service_ = std::make_unique<ExportService>(*this);
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(host + ":" + std::to_string(port), grpc::InsecureServerCredentials(), &port_);
+    builder.SetMaxReceiveMessageSize(static_cast<int>(std::min<size_t>(max_message_size_, INT32_MAX)));
+    // Exporters keep one connection open and multiplex Export calls over it;
+    // cap the concurrent calls per connection so HTTP/2 flow control pushes back
+    builder.AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS, std::max(1, max_concurrent_streams_));
+    builder.RegisterCallbackGenericService(service_.get());
+
+    server_ = builder.BuildAndStart();
+    if (!server_ || port_ == 0) {
+        std::cerr << "Failed to start gRPC server on " << host << ":" << port << std::endl;
+        server_.reset();
+        return false;
+    }
+
+    std::cout << "Starting OTLP/gRPC server on " << host << ":" << port_ << std::endl;
+    return true;
+}
+
+void GrpcServer::wait() {
+    if (server_) {
+        server_->Wait();
+    }
+}
+
+void GrpcServer::shutdown() {
+    if (server_) {
+        server_->Shutdown();
+        server_.reset();
+    }
+}
+
+std::string GrpcServer::retryInfoDetails(int code, std::string_view message, int retry_after_seconds) {
+    // google.protobuf.Duration { int64 seconds = 1; }
+    std::string duration;
+    appendVarint(duration, 1 << 3);
+    appendVarint(duration, static_cast<uint64_t>(std::max(1, retry_after_seconds)));
+
+    // google.rpc.RetryInfo { Duration retry_delay = 1; }
+    std::string retry_info;
+    appendLengthDelimited(retry_info, 1, duration);
+
+    // google.protobuf.Any { string type_url = 1; bytes value = 2; }
+    std::string any;
+    appendLengthDelimited(any, 1, "type.googleapis.com/google.rpc.RetryInfo");
+    appendLengthDelimited(any, 2, retry_info);
+
+    // google.rpc.Status { int32 code = 1; string message = 2; repeated Any details = 3; }
+    std::string status;
+    appendVarint(status, 1 << 3);
+    appendVarint(status, static_cast<uint64_t>(code));
+    appendLengthDelimited(status, 2, message);
+    appendLengthDelimited(status, 3, any);
+    return status;
+}
@@ -0,0 +1,61 @@
+#ifndef GRPC_SERVER_HPP
+#define GRPC_SERVER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "../config.hpp"
+#include "partition_key.hpp"
+
+namespace grpc {
+class Server;
+class CallbackGenericService;
+}
+
+class QueueProducer;
+
+// OTLP/gRPC logs receiver (LogsService/Export)
+// Requests are served through gRPC's generic callback API, so the serialized
+// ExportLogsServiceRequest is forwarded to the queue exactly like an OTLP/HTTP
+// protobuf body, without being parsed. Handlers never block a gRPC thread:
+// in durable-ack mode the RPC is finished from the delivery report.
+class GrpcServer {
+public:
+    static constexpr const char* kExportMethod = "/opentelemetry.proto.collector.logs.v1.LogsService/Export";
+
+    GrpcServer(std::shared_ptr<QueueProducer> queue_producer, const IngesterConfig& config);
+    ~GrpcServer();
+
+    // Bind and start serving on gRPC's threads; returns false if the address cannot be bound
+    // Port 0 picks a free port, see port()
+    bool start(const std::string& host, int port);
+
+    // Port actually bound by start()
+    int port() const { return port_; }
+
+    // Block until shutdown() is called
+    void wait();
+
+    // Stop accepting RPCs and cancel the ones in progress
+    void shutdown();
+
+    // Serialized google.rpc.Status carrying a google.rpc.RetryInfo, for the
+    // grpc-status-details-bin trailer OTLP exporters read their backoff from
+    static std::string retryInfoDetails(int code, std::string_view message, int retry_after_seconds);
+
+private:
+    class ExportService;
+
+    std::shared_ptr<QueueProducer> queue_producer_;
+    size_t max_message_size_;       // Largest request accepted (MAX_DECOMPRESSED_SIZE_MB)
+    int max_concurrent_streams_;    // HTTP/2 streams per connection
+    bool durable_ack_;              // Finish Export from the delivery report
+    int retry_after_seconds_;       // Retry delay for failed durable-ack deliveries
+    PartitionKeyExtractor partition_key_;
+
+    std::unique_ptr<ExportService> service_;
+    std::unique_ptr<grpc::Server> server_;
+    int port_;
+};
+
+#endif // GRPC_SERVER_HPP
@@ -4,45 +4,36 @@
 #include <iostream>
 #include <algorithm>
 #include <cctype>
-#include <zlib.h>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include "../gzip_decompressor.hpp"
 #include "telemetry_wrapper.pb.h"
 #include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
 
 using opentelemetry::proto::collector::logs::v1::ExportLogsServiceResponse;
 
-static bool decompressGzip(const std::string &in, std::string &out) {
-    if (in.empty()) { out.clear(); return true; }
-    z_stream strm{};
-    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
-    strm.avail_in = static_cast<uInt>(in.size());
-
-    // 16 + MAX_WBITS to enable gzip decoding with automatic header detection
-    if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
-        return false;
-    }
-
-    char buf[4096];
-    int ret;
-    do {
-        strm.next_out = reinterpret_cast<Bytef*>(buf);
-        strm.avail_out = sizeof(buf);
-        ret = inflate(&strm, Z_NO_FLUSH);
-        if (ret != Z_OK && ret != Z_STREAM_END) {
-            inflateEnd(&strm);
-            return false;
-        }
-        size_t have = sizeof(buf) - strm.avail_out;
-        out.append(buf, have);
-    } while (ret != Z_STREAM_END);
-
-    inflateEnd(&strm);
-    return true;
-}
-
-HttpServer::HttpServer() : queue_producer_(nullptr) {}
+HttpServer::HttpServer()
+    : queue_producer_(nullptr)
+    , max_decompressed_size_(GzipDecompressor::kDefaultMaxSize)
+    , passthrough_compression_(false)
+    , durable_ack_(false)
+    , retry_after_seconds_(1) {}
 
 HttpServer::HttpServer(std::shared_ptr<QueueProducer> queue_producer)
-    : queue_producer_(queue_producer) {}
+    : queue_producer_(queue_producer)
+    , max_decompressed_size_(GzipDecompressor::kDefaultMaxSize)
+    , passthrough_compression_(false)
+    , durable_ack_(false)
+    , retry_after_seconds_(1) {}
+
+HttpServer::HttpServer(std::shared_ptr<QueueProducer> queue_producer, const IngesterConfig& config)
+    : queue_producer_(queue_producer)
+    , max_decompressed_size_(config.max_decompressed_size_mb * 1024 * 1024)
+    , passthrough_compression_(config.passthrough_compression)
+    , durable_ack_(config.durable_ack)
+    , retry_after_seconds_(config.retry_after_seconds)
+    , partition_key_(config.partition_key) {}
 
 static inline std::string to_lower_trimmed(const std::string &s) {
     std::string out;
@@ -55,8 +46,76 @@ static inline std::string to_lower_trimmed(const std::string &s) {
     return out.substr(start, end - start + 1);
 }
 
+static crow::response exportLogsResponse() {
+    ExportLogsServiceResponse resp_msg;
+    std::string resp_body;
+    if (!resp_msg.SerializeToString(&resp_body)) {
+        return crow::response(500, "Failed to serialize response");
+    }
+    crow::response res(200, resp_body);
+    res.add_header("Content-Type", "application/x-protobuf");
+    return res;
+}
+
+// 429/503 for a producer that cannot take the request yet, with a Retry-After
+// estimated from how fast Kafka is acknowledging what is already in flight
+static crow::response backpressureResponse(int status, const std::string& message, const QueueProducer& producer) {
+    crow::response res(status, message);
+    res.add_header("Retry-After", std::to_string(producer.retryAfterSeconds()));
+    return res;
+}
+
+// Completes a durable-ack /v1/logs response once its record is delivered
+// The delivery report can arrive before the handler returns, so whichever
+// of the two finishes second ends the Crow response
+class DurableAck {
+public:
+    DurableAck(crow::response& res, int retry_after_seconds)
+        : res_(res), retry_after_seconds_(retry_after_seconds) {}
+
+    // Called from the delivery report (or batcher) thread
+    void delivered(bool ok) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result_ = ok;
+        if (handler_returned_) {
+            finishLocked();
+        }
+    }
+
+    // Called by the request handler after the record was queued
+    void handlerReturned() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handler_returned_ = true;
+        if (result_.has_value()) {
+            finishLocked();
+        }
+    }
+
+private:
+    crow::response& res_;
+    int retry_after_seconds_;
+    std::mutex mutex_;
+    std::optional<bool> result_;
+    bool handler_returned_ = false;
+
+    void finishLocked() {
+        if (*result_) {
+            res_ = exportLogsResponse();
+        } else {
+            res_ = crow::response(503, "Service Unavailable: Delivery to queue failed");
+            res_.add_header("Retry-After", std::to_string(retry_after_seconds_));
+        }
+        res_.end();
+    }
+};
+
 void HttpServer::setupRoutes(crow::SimpleApp& app) {
     auto queue_producer = queue_producer_;  // Capture for lambda
+    size_t max_decompressed_size = max_decompressed_size_;
+    bool passthrough_compression = passthrough_compression_;
+    bool durable_ack = durable_ack_ && queue_producer;
+    int retry_after_seconds = retry_after_seconds_;
+    PartitionKeyExtractor partition_key = partition_key_;
 
     // Health check endpoint for Kubernetes liveness probe
     CROW_ROUTE(app, "/health")
@@ -74,70 +133,137 @@ void HttpServer::setupRoutes(crow::SimpleApp& app) {
             return crow::response(200, "OK");
         });
 
-    CROW_ROUTE(app, "/v1/logs")
-        .methods("POST"_method)
-        ([queue_producer](const crow::request& req){
-            std::string content_type = req.get_header_value("Content-Type");
-            // strip parameters like charset
-            auto semipos = content_type.find(';');
-            if (semipos != std::string::npos) content_type = content_type.substr(0, semipos);
-            content_type = to_lower_trimmed(content_type);
-
-            // Validate content type (but don't parse - defer to consumer)
-            if (content_type != "application/x-protobuf" &&
-                content_type != "application/protobuf" &&
-                content_type != "application/json" &&
-                content_type != "text/json") {
-                return crow::response(415, "Unsupported Media Type");
+    // Producer and spill log statistics
+    CROW_ROUTE(app, "/stats")
+        ([queue_producer](){
+            crow::json::wvalue stats;
+            stats["in_flight"] = queue_producer ? queue_producer->getInFlightCount() : 0;
+            stats["producer_shards"] = queue_producer ? queue_producer->getShardCount() : 0;
+            stats["in_flight_bytes"] = queue_producer ? queue_producer->getInFlightBytes() : 0;
+            stats["in_flight_limit_bytes"] = queue_producer ? queue_producer->getInFlightLimitBytes() : 0;
+
+            SpillLog::Stats spill;
+            bool spill_enabled = queue_producer && queue_producer->getSpillStats(spill);
+            stats["spill_enabled"] = spill_enabled;
+            if (spill_enabled) {
+                stats["spill_records"] = spill.records;
+                stats["spill_pending_bytes"] = spill.pending_bytes;
+                stats["spill_segments"] = spill.segments;
+                stats["spill_disk_bytes"] = spill.disk_bytes;
+                stats["spill_max_bytes"] = spill.max_bytes;
+                stats["spill_appended_total"] = spill.appended_total;
+                stats["spill_drained_total"] = spill.consumed_total;
+                stats["spill_rejected_total"] = spill.rejected_total;
             }
+            return crow::response(200, stats);
+        });
 
-            // Decompress gzip if needed
-            std::string body = req.body;
-            std::string content_encoding = to_lower_trimmed(req.get_header_value("Content-Encoding"));
-            if (content_encoding == "gzip") {
-                std::string decompressed;
-                if (!decompressGzip(req.body, decompressed)) {
-                    return crow::response(400, "Failed to decompress gzip payload");
-                }
-                body.swap(decompressed);
+    // Validates the request and queues it; returns the response to send, or
+    // nullopt once on_delivered owns the response (durable-ack mode)
+    auto accept_logs = [queue_producer, max_decompressed_size, passthrough_compression, partition_key](
+        const crow::request& req, DeliveryCallback on_delivered) -> std::optional<crow::response> {
+        std::string content_type = req.get_header_value("Content-Type");
+        // strip parameters like charset
+        auto semipos = content_type.find(';');
+        if (semipos != std::string::npos) content_type = content_type.substr(0, semipos);
+        content_type = to_lower_trimmed(content_type);
+
+        // Validate content type (but don't parse - defer to consumer)
+        if (content_type != "application/x-protobuf" &&
+            content_type != "application/protobuf" &&
+            content_type != "application/json" &&
+            content_type != "text/json") {
+            return crow::response(415, "Unsupported Media Type");
+        }
+
+        // Decompress gzip if needed; otherwise the request body is framed as-is
+        // In pass-through mode gzip bodies stay compressed and the appender inflates them
+        std::string_view body = req.body;
+        std::string_view payload_encoding;
+        std::string decompressed;
+        std::string content_encoding = to_lower_trimmed(req.get_header_value("Content-Encoding"));
+        if (content_encoding == "gzip" && passthrough_compression) {
+            if (!GzipDecompressor::isGzip(body)) {
+                return crow::response(400, "Failed to decompress gzip payload");
+            }
+            payload_encoding = "gzip";
+        } else if (content_encoding == "gzip") {
+            GzipResult gzip_result = GzipDecompressor::decompress(
+                req.body, decompressed, max_decompressed_size);
+            if (gzip_result == GzipResult::TOO_LARGE) {
+                return crow::response(413, "Payload Too Large: Decompressed body exceeds limit");
+            } else if (gzip_result != GzipResult::SUCCESS) {
+                return crow::response(400, "Failed to decompress gzip payload");
+            }
+            body = decompressed;
+        }
+
+        // Produce to queue if available
+        if (queue_producer) {
+            // Check backpressure before attempting to produce
+            if (queue_producer->isAtCapacity(body.size())) {
+                return backpressureResponse(429, "Too Many Requests: Queue is at capacity", *queue_producer);
             }
 
-            // Create wrapper message with raw (decompressed) payload
-            telemetry::v1::RawTelemetryMessage wrapper;
-            wrapper.set_content_type(content_type);
-            wrapper.set_telemetry_type(telemetry::v1::OTEL_LOGS);
-            wrapper.set_payload(body);
-
-            // Produce to queue if available
-            if (queue_producer) {
-                // Check backpressure before attempting to produce
-                if (queue_producer->isAtCapacity()) {
-                    return crow::response(429, "Too Many Requests: Queue is at capacity");
+            // Key by service/tenant so each partition's records cluster together
+            // Compressed pass-through bodies can only be keyed by header
+            std::string key;
+            if (partition_key.enabled()) {
+                std::string header_value;
+                if (partition_key.mode() == PartitionKeyMode::HEADER) {
+                    header_value = req.get_header_value(partition_key.headerName());
                 }
+                key = partition_key.extract(content_type,
+                                            payload_encoding.empty() ? body : std::string_view(),
+                                            header_value);
+            }
 
-                ProduceResult result = queue_producer->produce(wrapper);
+            // Wrapper framing is written straight around the (decompressed) payload
+            ProduceResult result = queue_producer->produce(
+                content_type, telemetry::v1::OTEL_LOGS, body, payload_encoding, on_delivered, key);
 
-                if (result == ProduceResult::QUEUE_FULL) {
-                    return crow::response(503, "Service Unavailable: Queue is full");
-                } else if (result == ProduceResult::PERSISTENT_ERROR) {
-                    return crow::response(500, "Internal Server Error: Failed to queue message");
-                } else if (result != ProduceResult::SUCCESS) {
-                    return crow::response(503, "Service Unavailable: Queue error");
-                }
-            } else {
-                // Fallback: just log (for testing without queue)
-                std::cout << "Received RawTelemetryMessage with content_type="
-                          << content_type << ", payload_size=" << body.size() << std::endl;
+            if (result == ProduceResult::QUEUE_FULL) {
+                return backpressureResponse(503, "Service Unavailable: Queue is full", *queue_producer);
+            } else if (result == ProduceResult::PERSISTENT_ERROR) {
+                return crow::response(500, "Internal Server Error: Failed to queue message");
+            } else if (result != ProduceResult::SUCCESS) {
+                return backpressureResponse(503, "Service Unavailable: Queue error", *queue_producer);
+            }
+        } else {
+            // Fallback: just log (for testing without queue)
+            std::cout << "Received RawTelemetryMessage with content_type="
+                      << content_type << ", payload_size=" << body.size();
+            if (!payload_encoding.empty()) {
+                std::cout << ", content_encoding=" << payload_encoding;
+            }
+            std::cout << std::endl;
+        }
+
+        if (on_delivered) {
+            return std::nullopt;
+        }
+        return exportLogsResponse();
+    };
+
+    // Handlers take the response so durable-ack mode can finish it later from
+    // the delivery report instead of blocking a Crow worker thread
+    CROW_ROUTE(app, "/v1/logs")
+        .methods("POST"_method)
+        ([accept_logs, durable_ack, retry_after_seconds](const crow::request& req, crow::response& res){
+            std::shared_ptr<DurableAck> ack;
+            DeliveryCallback on_delivered;
+            if (durable_ack) {
+                ack = std::make_shared<DurableAck>(res, retry_after_seconds);
+                on_delivered = [ack](bool delivered) { ack->delivered(delivered); };
             }
 
-            ExportLogsServiceResponse resp_msg;
-            std::string resp_body;
-            if (!resp_msg.SerializeToString(&resp_body)) {
-                return crow::response(500, "Failed to serialize response");
+            std::optional<crow::response> result = accept_logs(req, on_delivered);
+            if (result) {
+                res = std::move(*result);
+                res.end();
+            } else {
+                ack->handlerReturned();
             }
-            crow::response res(200, resp_body);
-            res.add_header("Content-Type", "application/x-protobuf");
-            return res;
         });
 }
 
@@ -4,6 +4,8 @@
 #include <string>
 #include <memory>
 #include "crow.h"
+#include "../config.hpp"
+#include "partition_key.hpp"
 
 class QueueProducer;
 
@@ -11,12 +13,18 @@ class HttpServer {
 public:
     HttpServer();
     HttpServer(std::shared_ptr<QueueProducer> queue_producer);
+    HttpServer(std::shared_ptr<QueueProducer> queue_producer, const IngesterConfig& config);
     void start(const std::string& host, int port);
     // Setup routes on the provided app (for testing)
     void setupRoutes(crow::SimpleApp& app);
     
 private:
     std::shared_ptr<QueueProducer> queue_producer_;
+    size_t max_decompressed_size_;  // Bytes; gzip bodies inflating past this are rejected
+    bool passthrough_compression_;  // Forward gzip bodies without inflating them
+    bool durable_ack_;              // Complete /v1/logs responses from the delivery report
+    int retry_after_seconds_;       // Retry-After for failed durable-ack deliveries
+    PartitionKeyExtractor partition_key_;  // Kafka key for each request
 };
 
 #endif // HTTP_SERVER_HPP
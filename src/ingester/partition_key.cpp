@@ -0,0 +1,285 @@
+#include "partition_key.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t fnv1a(std::string_view bytes) {
+    uint64_t hash = kFnvOffset;
+    for (char c : bytes) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// Minimal non-throwing protobuf field cursor; any malformed input ends the scan
+class FieldScanner {
+public:
+    explicit FieldScanner(std::string_view data)
+        : p_(reinterpret_cast<const uint8_t*>(data.data()))
+        , end_(p_ + data.size()) {}
+
+    // Advance to the next field; returns false at the end or on malformed input
+    // Length-delimited fields are returned in bytes, others are skipped over
+    bool next(uint32_t& field, uint32_t& wire_type, std::string_view& bytes) {
+        uint64_t tag;
+        if (p_ >= end_ || !readVarint(tag) || (tag >> 3) == 0) {
+            return false;
+        }
+        field = static_cast<uint32_t>(tag >> 3);
+        wire_type = static_cast<uint32_t>(tag & 7);
+
+        uint64_t value;
+        switch (wire_type) {
+            case 0:
+                return readVarint(value);
+            case 1:
+                return skip(8);
+            case 2:
+                if (!readVarint(value) || value > static_cast<uint64_t>(end_ - p_)) {
+                    return false;
+                }
+                bytes = std::string_view(reinterpret_cast<const char*>(p_), static_cast<size_t>(value));
+                p_ += value;
+                return true;
+            case 5:
+                return skip(4);
+            default:
+                // Groups are not used by OTLP
+                return false;
+        }
+    }
+
+    // Find the first length-delimited occurrence of field
+    bool find(uint32_t wanted, std::string_view& bytes) {
+        uint32_t field;
+        uint32_t wire_type;
+        std::string_view value;
+        while (next(field, wire_type, value)) {
+            if (field == wanted && wire_type == 2) {
+                bytes = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+
+    bool readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p_ < end_; shift += 7) {
+            uint8_t byte = *p_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool skip(size_t n) {
+        if (static_cast<size_t>(end_ - p_) < n) {
+            return false;
+        }
+        p_ += n;
+        return true;
+    }
+};
+
+// ExportLogsServiceRequest.resource_logs[0].resource
+bool firstProtobufResource(std::string_view payload, std::string_view& resource) {
+    std::string_view resource_logs;
+    if (!FieldScanner(payload).find(1, resource_logs)) {
+        return false;
+    }
+    return FieldScanner(resource_logs).find(1, resource);
+}
+
+size_t skipWhitespace(std::string_view json, size_t pos) {
+    while (pos < json.size() &&
+           (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r')) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Position just past the closing quote of the string starting at pos, or npos
+size_t skipJsonString(std::string_view json, size_t pos) {
+    for (++pos; pos < json.size(); ++pos) {
+        if (json[pos] == '\\') {
+            ++pos;
+        } else if (json[pos] == '"') {
+            return pos + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+// Position of the value following the member name at pos ("name" : value), or npos
+size_t jsonMemberValue(std::string_view json, size_t name_pos) {
+    size_t pos = skipJsonString(json, name_pos);
+    if (pos == std::string_view::npos) {
+        return pos;
+    }
+    pos = skipWhitespace(json, pos);
+    if (pos >= json.size() || json[pos] != ':') {
+        return std::string_view::npos;
+    }
+    return skipWhitespace(json, pos + 1);
+}
+
+}  // namespace
+
+PartitionKeyExtractor::PartitionKeyExtractor(const std::string& spec)
+    : mode_(PartitionKeyMode::NONE) {
+    static const std::string kHeaderPrefix = "header:";
+    if (spec == "service.name") {
+        mode_ = PartitionKeyMode::SERVICE_NAME;
+    } else if (spec == "resource") {
+        mode_ = PartitionKeyMode::RESOURCE_HASH;
+    } else if (spec.compare(0, kHeaderPrefix.size(), kHeaderPrefix) == 0 && spec.size() > kHeaderPrefix.size()) {
+        mode_ = PartitionKeyMode::HEADER;
+        header_name_ = spec.substr(kHeaderPrefix.size());
+    }
+}
+
+std::string PartitionKeyExtractor::extract(std::string_view content_type,
+                                           std::string_view payload,
+                                           std::string_view header_value) const {
+    bool json = content_type == "application/json" || content_type == "text/json";
+    switch (mode_) {
+        case PartitionKeyMode::SERVICE_NAME:
+            return json ? jsonServiceName(payload) : protobufServiceName(payload);
+        case PartitionKeyMode::RESOURCE_HASH: {
+            uint64_t hash = json ? jsonResourceHash(payload) : protobufResourceHash(payload);
+            if (hash == 0) {
+                return {};
+            }
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+            return std::string(hex, 16);
+        }
+        case PartitionKeyMode::HEADER:
+            return std::string(header_value);
+        case PartitionKeyMode::NONE:
+            break;
+    }
+    return {};
+}
+
+std::string PartitionKeyExtractor::protobufServiceName(std::string_view payload) {
+    std::string_view resource;
+    if (!firstProtobufResource(payload, resource)) {
+        return {};
+    }
+
+    // Resource.attributes -> KeyValue{key, value: AnyValue{string_value}}
+    FieldScanner attributes(resource);
+    uint32_t field;
+    uint32_t wire_type;
+    std::string_view attribute;
+    while (attributes.next(field, wire_type, attribute)) {
+        if (field != 1 || wire_type != 2) {
+            continue;
+        }
+        FieldScanner key_value(attribute);
+        std::string_view key;
+        std::string_view value;
+        std::string_view bytes;
+        bool has_value = false;
+        while (key_value.next(field, wire_type, bytes)) {
+            if (field == 1 && wire_type == 2) {
+                key = bytes;
+            } else if (field == 2 && wire_type == 2) {
+                value = bytes;
+                has_value = true;
+            }
+        }
+        if (key != "service.name") {
+            continue;
+        }
+        std::string_view name;
+        if (has_value && FieldScanner(value).find(1, name)) {
+            return std::string(name);
+        }
+        return {};
+    }
+    return {};
+}
+
+uint64_t PartitionKeyExtractor::protobufResourceHash(std::string_view payload) {
+    std::string_view resource;
+    if (!firstProtobufResource(payload, resource)) {
+        return 0;
+    }
+    return fnv1a(resource);
+}
+
+std::string PartitionKeyExtractor::jsonServiceName(std::string_view payload) {
+    // {"key": "service.name", "value": {"stringValue": "..."}}; members may come in any order
+    size_t key_pos = payload.find("\"service.name\"");
+    if (key_pos == std::string_view::npos) {
+        return {};
+    }
+
+    // The value object may precede the key, so look within the enclosing KeyValue
+    size_t begin = payload.rfind('{', key_pos);
+    size_t end = payload.find("\"key\"", key_pos + 1);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    size_t string_pos = payload.find("\"stringValue\"", begin);
+    if (string_pos == std::string_view::npos || (end != std::string_view::npos && string_pos > end)) {
+        return {};
+    }
+
+    size_t value_pos = jsonMemberValue(payload, string_pos);
+    if (value_pos >= payload.size() || payload[value_pos] != '"') {
+        return {};
+    }
+    size_t value_end = skipJsonString(payload, value_pos);
+    if (value_end == std::string_view::npos) {
+        return {};
+    }
+    // Escapes are kept as written; the key only has to be stable
+    return std::string(payload.substr(value_pos + 1, value_end - value_pos - 2));
+}
+
+uint64_t PartitionKeyExtractor::jsonResourceHash(std::string_view payload) {
+    // The quotes keep "resourceLogs" from matching
+    size_t name_pos = payload.find("\"resource\"");
+    if (name_pos == std::string_view::npos) {
+        return 0;
+    }
+    size_t begin = jsonMemberValue(payload, name_pos);
+    if (begin >= payload.size() || payload[begin] != '{') {
+        return 0;
+    }
+
+    // Find the matching brace, skipping over strings
+    int depth = 0;
+    for (size_t pos = begin; pos < payload.size(); ++pos) {
+        char c = payload[pos];
+        if (c == '"') {
+            pos = skipJsonString(payload, pos);
+            if (pos == std::string_view::npos) {
+                return 0;
+            }
+            --pos;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return fnv1a(payload.substr(begin, pos - begin + 1));
+            }
+        }
+    }
+    return 0;
+}
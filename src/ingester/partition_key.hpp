@@ -0,0 +1,50 @@
+#ifndef PARTITION_KEY_HPP
+#define PARTITION_KEY_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// What a record's Kafka key is derived from
+enum class PartitionKeyMode {
+    NONE,           // Unkeyed; librdkafka spreads records over all partitions
+    SERVICE_NAME,   // service.name of the first resource
+    RESOURCE_HASH,  // Hash of the first resource's attributes
+    HEADER          // Value of a request header (e.g. a tenant id)
+};
+
+// Picks the Kafka key for an OTLP logs request so that one service's (or
+// tenant's) records land on the same partition and cluster in its buffer
+// Bodies are scanned in place, without parsing the request; a request with
+// several resources is keyed by the first one
+class PartitionKeyExtractor {
+public:
+    // spec is "" or "none", "service.name", "resource", or "header:<name>"
+    explicit PartitionKeyExtractor(const std::string& spec = {});
+
+    PartitionKeyMode mode() const { return mode_; }
+    bool enabled() const { return mode_ != PartitionKeyMode::NONE; }
+
+    // Header to read in HEADER mode
+    const std::string& headerName() const { return header_name_; }
+
+    // Key for a request, or empty if none was found (the record is then unkeyed)
+    // payload must be uncompressed; header_value is only used in HEADER mode
+    std::string extract(std::string_view content_type,
+                        std::string_view payload,
+                        std::string_view header_value = {}) const;
+
+    // service.name string attribute of the first resource, empty if absent or malformed
+    static std::string protobufServiceName(std::string_view payload);
+    static std::string jsonServiceName(std::string_view payload);
+
+    // FNV-1a of the first resource's encoding, 0 if there is none
+    static uint64_t protobufResourceHash(std::string_view payload);
+    static uint64_t jsonResourceHash(std::string_view payload);
+
+private:
+    PartitionKeyMode mode_;
+    std::string header_name_;
+};
+
+#endif // PARTITION_KEY_HPP
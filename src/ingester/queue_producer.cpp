@@ -1,14 +1,16 @@
 #include "queue_producer.hpp"
 #include "telemetry_wrapper.pb.h"
+#include "wrapper_framing.hpp"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
 #include <librdkafka/rdkafka.h>
 
 QueueProducer::QueueProducer(const IngesterConfig& config)
-    : config_(config), in_flight_count_(0)
-    , producer_(nullptr), topic_(nullptr), delivery_cb_(&in_flight_count_)
+    : config_(config), shard_max_in_flight_(0), draining_(false)
 {
 }
 
@@ -18,146 +20,497 @@ QueueProducer::~QueueProducer() {
 
 bool QueueProducer::initialize() {
     try {
-        char errstr[512];
-        
-        // Create Kafka configuration
-        rd_kafka_conf_t* conf = rd_kafka_conf_new();
-        
-        // Set brokers
-        if (rd_kafka_conf_set(conf, "bootstrap.servers", config_.queue_brokers.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set bootstrap.servers: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set acks
-        std::string acks_str = std::to_string(config_.acks);
-        if (rd_kafka_conf_set(conf, "acks", acks_str.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set acks: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set compression type
-        if (rd_kafka_conf_set(conf, "compression.type", config_.compression_type.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set compression.type: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set retry backoff
-        std::string retry_backoff_str = std::to_string(config_.retry_backoff_ms);
-        if (rd_kafka_conf_set(conf, "retry.backoff.ms", retry_backoff_str.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set retry.backoff.ms: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set queue buffering max messages
-        std::string max_messages_str = std::to_string(config_.max_in_flight);
-        if (rd_kafka_conf_set(conf, "queue.buffering.max.messages", max_messages_str.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set queue.buffering.max.messages: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set queue buffering max kbytes (1GB = 1048576 KB)
-        if (rd_kafka_conf_set(conf, "queue.buffering.max.kbytes", "1048576", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set queue.buffering.max.kbytes: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set batch size
-        if (rd_kafka_conf_set(conf, "batch.num.messages", "1000", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set batch.num.messages: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
-        }
-        
-        // Set linger time
-        if (rd_kafka_conf_set(conf, "linger.ms", "10", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set linger.ms: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
+        if (!config_.spill_dir.empty()) {
+            SpillLog::Options spill_options;
+            spill_options.directory = config_.spill_dir;
+            spill_options.segment_bytes = config_.spill_segment_mb * 1024 * 1024;
+            spill_options.max_bytes = config_.spill_max_mb * 1024 * 1024;
+            spill_options.fsync = SpillLog::parseFsyncPolicy(config_.spill_fsync);
+            spill_options.fsync_interval = std::chrono::milliseconds(config_.spill_fsync_interval_ms);
+            spill_ = std::make_unique<SpillLog>(spill_options);
+            if (!spill_->open()) {
+                spill_.reset();
+                return false;
+            }
         }
-        
-        // Enable idempotence
-        if (rd_kafka_conf_set(conf, "enable.idempotence", "true", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
-            std::cerr << "Failed to set enable.idempotence: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
+
+        size_t shard_count = static_cast<size_t>(std::max(1, config_.producer_shards));
+        // Split the in-flight budget so the shards together stay within max_in_flight
+        shard_max_in_flight_ = std::max(1, static_cast<int>(
+            (config_.max_in_flight + shard_count - 1) / shard_count));
+
+        for (size_t i = 0; i < shard_count; ++i) {
+            auto owned = std::make_unique<ProducerShard>();
+            if (!createShard(*owned, i)) {
+                shutdown();
+                return false;
+            }
+            ProducerShard* shard = owned.get();
+            shards_.push_back(std::move(owned));
+
+            // Coalesce small requests into batch records
+            if (config_.batch_linger_ms > 0) {
+                shard->batcher = std::make_unique<RequestBatcher>(
+                    config_.batch_max_bytes,
+                    static_cast<size_t>(std::max(1, config_.batch_max_messages)),
+                    std::chrono::milliseconds(config_.batch_linger_ms),
+                    [this, shard](std::unique_ptr<RequestBatch> batch) { produceBatch(*shard, std::move(batch)); });
+                shard->batcher->start();
+            }
+
+            shard->polling.store(true);
+            shard->poll_thread = std::thread(&QueueProducer::pollLoop, shard);
         }
-        
-        // Set delivery report callback (using dr_msg_cb for librdkafka 2.x)
-        rd_kafka_conf_set_dr_msg_cb(conf, DeliveryReportCb::dr_cb);
-        rd_kafka_conf_set_opaque(conf, &delivery_cb_);
-        
-        // Create producer
-        producer_ = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
-        if (!producer_) {
-            std::cerr << "Failed to create producer: " << errstr << std::endl;
-            rd_kafka_conf_destroy(conf);
-            return false;
+
+        if (spill_) {
+            draining_.store(true);
+            drain_thread_ = std::thread(&QueueProducer::drainLoop, this);
+            std::cout << "Spilling to " << config_.spill_dir << " when Kafka is unavailable (max "
+                      << config_.spill_max_mb << " MB, fsync " << config_.spill_fsync << ")" << std::endl;
         }
-        
-        // Create topic object
-        rd_kafka_topic_conf_t* topic_conf = rd_kafka_topic_conf_new();
-        topic_ = rd_kafka_topic_new(producer_, config_.queue_topic.c_str(), topic_conf);
-        if (!topic_) {
-            std::cerr << "Failed to create topic object: " << rd_kafka_err2str(rd_kafka_last_error()) << std::endl;
-            rd_kafka_destroy(producer_);
-            producer_ = nullptr;
-            return false;
+
+        if (config_.batch_linger_ms > 0) {
+            std::cout << "Request batching enabled: linger " << config_.batch_linger_ms << "ms, max "
+                      << config_.batch_max_bytes << " bytes / " << config_.batch_max_messages
+                      << " requests" << std::endl;
         }
-        
+
         std::cout << "QueueProducer initialized with brokers: " << config_.queue_brokers 
-                  << ", topic: " << config_.queue_topic << std::endl;
+                  << ", topic: " << config_.queue_topic << ", shards: " << shard_count << std::endl;
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Failed to initialize QueueProducer: " << e.what() << std::endl;
+        shutdown();
         return false;
     }
 }
 
+bool QueueProducer::createShard(ProducerShard& shard, size_t index) {
+    char errstr[512];
+    
+    // Create Kafka configuration
+    rd_kafka_conf_t* conf = rd_kafka_conf_new();
+    
+    // Set brokers
+    if (rd_kafka_conf_set(conf, "bootstrap.servers", config_.queue_brokers.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set bootstrap.servers: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set acks
+    std::string acks_str = std::to_string(config_.acks);
+    if (rd_kafka_conf_set(conf, "acks", acks_str.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set acks: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set compression type
+    if (rd_kafka_conf_set(conf, "compression.type", config_.compression_type.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set compression.type: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set retry backoff
+    std::string retry_backoff_str = std::to_string(config_.retry_backoff_ms);
+    if (rd_kafka_conf_set(conf, "retry.backoff.ms", retry_backoff_str.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set retry.backoff.ms: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set queue buffering max messages (this shard's share of max_in_flight)
+    std::string max_messages_str = std::to_string(shard_max_in_flight_);
+    if (rd_kafka_conf_set(conf, "queue.buffering.max.messages", max_messages_str.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set queue.buffering.max.messages: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set queue buffering max kbytes (1GB = 1048576 KB)
+    if (rd_kafka_conf_set(conf, "queue.buffering.max.kbytes", "1048576", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set queue.buffering.max.kbytes: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set batch size
+    if (rd_kafka_conf_set(conf, "batch.num.messages", "1000", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set batch.num.messages: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Set linger time
+    if (rd_kafka_conf_set(conf, "linger.ms", "10", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set linger.ms: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Enable idempotence
+    if (rd_kafka_conf_set(conf, "enable.idempotence", "true", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set enable.idempotence: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Distinguish shards in broker logs and metrics
+    std::string client_id = "otel-receiver-" + std::to_string(index);
+    if (rd_kafka_conf_set(conf, "client.id", client_id.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+        std::cerr << "Failed to set client.id: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Split the in-flight byte budget across shards like max_in_flight
+    size_t shard_count = static_cast<size_t>(std::max(1, config_.producer_shards));
+    AdmissionController::Options admission_options;
+    admission_options.max_bytes = std::max<size_t>(1, config_.max_in_flight_mb * 1024 * 1024 / shard_count);
+    admission_options.min_bytes = std::max<size_t>(1, config_.min_in_flight_mb * 1024 * 1024 / shard_count);
+    admission_options.target_latency = std::chrono::milliseconds(config_.target_delivery_latency_ms);
+    shard.admission = std::make_unique<AdmissionController>(admission_options);
+
+    // Set delivery report callback (using dr_msg_cb for librdkafka 2.x)
+    rd_kafka_conf_set_dr_msg_cb(conf, DeliveryReportCb::dr_cb);
+    shard.delivery_cb = std::make_unique<DeliveryReportCb>(&shard.in_flight, shard.admission.get());
+    rd_kafka_conf_set_opaque(conf, shard.delivery_cb.get());
+    
+    // Create producer
+    shard.producer = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
+    if (!shard.producer) {
+        std::cerr << "Failed to create producer: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        return false;
+    }
+    
+    // Create topic object
+    rd_kafka_topic_conf_t* topic_conf = rd_kafka_topic_conf_new();
+    shard.topic = rd_kafka_topic_new(shard.producer, config_.queue_topic.c_str(), topic_conf);
+    if (!shard.topic) {
+        std::cerr << "Failed to create topic object: " << rd_kafka_err2str(rd_kafka_last_error()) << std::endl;
+        rd_kafka_destroy(shard.producer);
+        shard.producer = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+QueueProducer::ProducerShard* QueueProducer::currentShard() const {
+    if (shards_.empty()) {
+        return nullptr;
+    }
+    // Each request thread picks a shard once and keeps it
+    static std::atomic<size_t> next_slot{0};
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+    return shards_[slot % shards_.size()].get();
+}
+
+void QueueProducer::pollLoop(ProducerShard* shard) {
+    // Delivery reports (and the in-flight decrements) run here, off the request path
+    while (shard->polling.load(std::memory_order_relaxed)) {
+        rd_kafka_poll(shard->producer, 100);
+    }
+}
+
+int QueueProducer::getInFlightCount() const {
+    int total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->in_flight.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t QueueProducer::getInFlightBytes() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->admission->getInFlightBytes();
+    }
+    return total;
+}
+
+size_t QueueProducer::getInFlightLimitBytes() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->admission->getLimitBytes();
+    }
+    return total;
+}
+
+int QueueProducer::retryAfterSeconds() const {
+    const ProducerShard* shard = currentShard();
+    return shard ? shard->admission->retryAfterSeconds() : 1;
+}
+
 ProduceResult QueueProducer::produce(
     const telemetry::v1::RawTelemetryMessage& message) {
 
     // Check backpressure
-    if (isAtCapacity()) {
+    ProducerShard* shard = currentShard();
+    if (!shard || isShardAtCapacity(*shard, message.ByteSizeLong())) {
         return ProduceResult::QUEUE_FULL;
     }
 
     try {
         // Increment in-flight count before producing
-        in_flight_count_.fetch_add(1);
+        shard->in_flight.fetch_add(1);
 
         // Serialize the message
-        std::string serialized = serializeMessage(message);
+        size_t size = 0;
+        char* serialized = serializeMessage(message, size);
 
         // Produce with retry (will decrement counter on error)
-        ProduceResult result = produceWithRetry(serialized, 0);
+        ProduceResult result = produceWithRetry(*shard, serialized, size, {}, 0);
+        if (result != ProduceResult::SUCCESS) {
+            std::free(serialized);
+        }
 
         return result;
     } catch (const std::exception& e) {
         std::cerr << "Error producing message: " << e.what() << std::endl;
-        in_flight_count_.fetch_sub(1);
+        shard->in_flight.fetch_sub(1);
+        return ProduceResult::PERSISTENT_ERROR;
+    }
+}
+
+ProduceResult QueueProducer::produce(std::string_view content_type,
+                                     telemetry::v1::TelemetryType telemetry_type,
+                                     std::string_view payload,
+                                     std::string_view content_encoding,
+                                     DeliveryCallback on_delivered,
+                                     std::string_view key) {
+    // Check backpressure; over capacity records go to the spill log, if there is one
+    ProducerShard* shard = currentShard();
+    if (!shard) {
+        return ProduceResult::QUEUE_FULL;
+    }
+    bool at_capacity = isShardAtCapacity(*shard, payload.size());
+    if (at_capacity && !spill_) {
+        return ProduceResult::QUEUE_FULL;
+    }
+
+    // Increment in-flight count before producing
+    shard->in_flight.fetch_add(1);
+
+    // Small requests join the open batch; large ones (or after shutdown) go alone
+    // Their bytes count against admission from here on, not only once the batch is produced
+    if (!at_capacity && shard->batcher) {
+        size_t entry_size = WrapperFraming::batchEntrySize(
+            WrapperFraming::framedSize(content_type, telemetry_type, payload.size(), content_encoding));
+        shard->admission->acquire(entry_size);
+        if (shard->batcher->add(content_type, telemetry_type, payload, content_encoding, on_delivered, key)) {
+            return ProduceResult::SUCCESS;
+        }
+        shard->admission->cancel(entry_size);
+    }
+
+    // Frame the wrapper around the payload in a single copy
+    size_t size = 0;
+    char* framed = WrapperFraming::frame(content_type, telemetry_type, payload, content_encoding, size);
+    if (!framed) {
+        std::cerr << "Error producing message: failed to allocate " << size << " bytes" << std::endl;
+        shard->in_flight.fetch_sub(1);
         return ProduceResult::PERSISTENT_ERROR;
     }
+
+    ProduceResult result = ProduceResult::QUEUE_FULL;
+    if (at_capacity || isSpillPending()) {
+        // While spilled records wait to be drained, new ones queue behind them
+        shard->in_flight.fetch_sub(1);
+    } else {
+        // A sender waiting for delivery gets a handle the delivery report completes
+        RequestBatch* handle = nullptr;
+        if (on_delivered) {
+            handle = new RequestBatch();
+            handle->count = 1;
+            handle->callbacks.push_back(std::move(on_delivered));
+        }
+
+        // Produce with retry (will decrement counter on error)
+        result = produceWithRetry(*shard, framed, size, key, 0, handle);
+        if (result == ProduceResult::SUCCESS) {
+            return result;
+        }
+        if (handle) {
+            // The caller (or the spill log) reports this failure itself
+            on_delivered = std::move(handle->callbacks.front());
+            handle->callbacks.clear();
+            delete handle;
+        }
+    }
+
+    if (spillRecord(key, framed, size, static_cast<bool>(on_delivered))) {
+        result = ProduceResult::SUCCESS;
+        if (on_delivered) {
+            on_delivered(true);
+        }
+    }
+    std::free(framed);
+    return result;
 }
 
-ProduceResult QueueProducer::produceWithRetry(const std::string& serialized_data, int retry_count) {
+void QueueProducer::produceBatch(ProducerShard& shard, std::unique_ptr<RequestBatch> batch) {
+    size_t size = batch->size;
+    char* data = batch->release();
+
+    if (!isSpillPending()) {
+        // On success the delivery report callback completes and deletes the batch
+        // Its bytes were charged to admission as each request was added
+        RequestBatch* opaque = batch.release();
+        if (produceWithRetry(shard, data, size, opaque->key, 0, opaque, true) == ProduceResult::SUCCESS) {
+            return;
+        }
+        batch.reset(opaque);
+    } else {
+        // Queued behind spilled records to keep them in order
+        shard.in_flight.fetch_sub(static_cast<int>(batch->count));
+        shard.admission->cancel(size);
+    }
+
+    bool durable = std::any_of(batch->callbacks.begin(), batch->callbacks.end(),
+                               [](const DeliveryCallback& callback) { return static_cast<bool>(callback); });
+    bool spilled = spillRecord(batch->key, data, size, durable);
+    std::free(data);
+    if (spilled) {
+        batch->complete(true);
+    } else {
+        failBatch(batch.release());
+    }
+}
+
+bool QueueProducer::spillRecord(std::string_view key, const char* data, size_t size, bool durable) {
+    // Senders waiting for delivery are only acknowledged from disk when every append is synced
+    if (!spill_ || (durable && !spill_->syncsEveryAppend())) {
+        return false;
+    }
+    if (!spill_->append(key, std::string_view(data, size))) {
+        return false;
+    }
+    drain_cv_.notify_one();
+    return true;
+}
+
+void QueueProducer::drainLoop() {
+    // Shared with delivery callbacks, which may outlive a wait cut short by shutdown
+    struct DrainChunk {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t pending = 0;
+        bool failed = false;
+    };
+
+    ProducerShard* shard = currentShard();
+    std::vector<SpillLog::Record> records;
+    size_t chunk_size = 1;
+    int backoff_ms = config_.retry_backoff_ms;
+
+    while (draining_.load()) {
+        if (spill_->peek(chunk_size, records) == 0) {
+            std::unique_lock<std::mutex> lock(drain_mutex_);
+            drain_cv_.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return !draining_.load() || !spill_->empty();
+            });
+            continue;
+        }
+
+        auto chunk = std::make_shared<DrainChunk>();
+        size_t produced = 0;
+        for (const auto& record : records) {
+            char* data = static_cast<char*>(std::malloc(record.data.size()));
+            if (!data) {
+                chunk->failed = true;
+                break;
+            }
+            std::memcpy(data, record.data.data(), record.data.size());
+
+            auto* handle = new RequestBatch();
+            handle->count = 1;
+            handle->callbacks.push_back([chunk](bool delivered) {
+                std::lock_guard<std::mutex> lock(chunk->mutex);
+                chunk->failed = chunk->failed || !delivered;
+                if (--chunk->pending == 0) {
+                    chunk->cv.notify_all();
+                }
+            });
+
+            {
+                std::lock_guard<std::mutex> lock(chunk->mutex);
+                chunk->pending++;
+            }
+            shard->in_flight.fetch_add(1);
+            if (produceWithRetry(*shard, data, record.data.size(), record.key, 0, handle) != ProduceResult::SUCCESS) {
+                std::free(data);
+                handle->callbacks.clear();
+                delete handle;
+                std::lock_guard<std::mutex> lock(chunk->mutex);
+                chunk->pending--;
+                chunk->failed = true;
+                break;
+            }
+            produced++;
+        }
+
+        // Spilled records are consumed only once Kafka has them
+        bool delivered;
+        {
+            std::unique_lock<std::mutex> lock(chunk->mutex);
+            while (!chunk->cv.wait_for(lock, std::chrono::milliseconds(100), [&] { return chunk->pending == 0; })) {
+                if (!draining_.load()) {
+                    break;
+                }
+            }
+            delivered = chunk->pending == 0 && !chunk->failed && produced == records.size();
+        }
+        if (!draining_.load()) {
+            break;
+        }
+
+        if (delivered) {
+            spill_->consume(produced);
+            chunk_size = std::min(chunk_size * 2, kMaxDrainChunk);
+            backoff_ms = config_.retry_backoff_ms;
+        } else {
+            // Kafka is still unavailable; probe again with a single record
+            // Records of a partly delivered chunk are sent again (at-least-once)
+            chunk_size = 1;
+            std::unique_lock<std::mutex> lock(drain_mutex_);
+            drain_cv_.wait_for(lock, std::chrono::milliseconds(backoff_ms), [this] { return !draining_.load(); });
+            backoff_ms = std::min(backoff_ms * 2, kMaxDrainBackoffMs);
+        }
+    }
+}
+
+bool QueueProducer::getSpillStats(SpillLog::Stats& stats) const {
+    if (!spill_) {
+        return false;
+    }
+    stats = spill_->getStats();
+    return true;
+}
+
+ProduceResult QueueProducer::produceWithRetry(ProducerShard& shard, char* data, size_t size,
+                                              std::string_view key, int retry_count, RequestBatch* batch,
+                                              bool acquired) {
+    int requests = batch ? static_cast<int>(batch->count) : 1;
+    if (retry_count == 0 && !acquired) {
+        // Released by the delivery report, or below if librdkafka refuses the record
+        shard.admission->acquire(size);
+    }
     try {
         // Produce message asynchronously
+        // librdkafka frees the buffer after delivery; on failure it stays the caller's
         int ret = rd_kafka_produce(
-            topic_,
-            RD_KAFKA_PARTITION_UA,  // Unassigned partition (let librdkafka choose)
-            RD_KAFKA_MSG_F_COPY,    // Copy payload
-            const_cast<void*>(static_cast<const void*>(serialized_data.data())),
-            serialized_data.size(),
-            nullptr,  // Key
-            0,        // Key length
-            nullptr   // Opaque (we use the global callback)
+            shard.topic,
+            RD_KAFKA_PARTITION_UA,  // Unassigned partition (librdkafka hashes the key, if any)
+            RD_KAFKA_MSG_F_FREE,    // Take ownership of payload
+            data,
+            size,
+            key.empty() ? nullptr : key.data(),  // Key, copied by librdkafka
+            key.size(),                          // Key length
+            batch     // Per-message opaque for batches and delivery handles, null otherwise
         );
         
         if (ret == -1) {
@@ -165,7 +518,8 @@ ProduceResult QueueProducer::produceWithRetry(const std::string& serialized_data
             
             if (err == RD_KAFKA_RESP_ERR__QUEUE_FULL) {
                 // Don't retry queue full errors - return immediately
-                in_flight_count_.fetch_sub(1);
+                shard.in_flight.fetch_sub(requests);
+                shard.admission->cancel(size);
                 return ProduceResult::QUEUE_FULL;
             }
             
@@ -177,59 +531,111 @@ ProduceResult QueueProducer::produceWithRetry(const std::string& serialized_data
                 // Exponential backoff
                 int backoff_ms = config_.retry_backoff_ms * (1 << retry_count);
                 std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
-                return produceWithRetry(serialized_data, retry_count + 1);
+                return produceWithRetry(shard, data, size, key, retry_count + 1, batch, acquired);
             }
             
             // Non-retryable error or max retries exceeded
             std::cerr << "Kafka error (attempt " << (retry_count + 1) << "/" << (config_.max_retries + 1) 
                       << "): " << rd_kafka_err2str(err) << std::endl;
-            in_flight_count_.fetch_sub(1);
+            shard.in_flight.fetch_sub(requests);
+            shard.admission->cancel(size);
             return ProduceResult::PERSISTENT_ERROR;
         }
         
-        // Message queued successfully - delivery callback will decrement in_flight_count_ on completion
-        // Poll to ensure delivery callbacks are processed
-        rd_kafka_poll(producer_, 0);
-        
+        // Message queued successfully - the shard's poll thread runs the delivery
+        // callback, which decrements the in-flight count on completion
         return ProduceResult::SUCCESS;
     } catch (const std::exception& e) {
         std::cerr << "Unexpected error: " << e.what() << std::endl;
-        in_flight_count_.fetch_sub(1);
+        shard.in_flight.fetch_sub(requests);
+        shard.admission->cancel(size);
         return ProduceResult::PERSISTENT_ERROR;
     }
 }
 
-std::string QueueProducer::serializeMessage(
-    const telemetry::v1::RawTelemetryMessage& message) {
-    std::string serialized;
-    if (!message.SerializeToString(&serialized)) {
+void QueueProducer::failBatch(RequestBatch* batch) {
+    if (batch) {
+        std::cerr << "Dropped request batch of " << batch->count << " request(s)" << std::endl;
+        batch->complete(false);
+        delete batch;
+    }
+}
+
+char* QueueProducer::serializeMessage(
+    const telemetry::v1::RawTelemetryMessage& message, size_t& size) {
+    size = message.ByteSizeLong();
+    char* serialized = static_cast<char*>(std::malloc(size > 0 ? size : 1));
+    if (!serialized) {
+        throw std::runtime_error("Failed to allocate RawTelemetryMessage buffer");
+    }
+    if (!message.SerializeToArray(serialized, static_cast<int>(size))) {
+        std::free(serialized);
         throw std::runtime_error("Failed to serialize RawTelemetryMessage");
     }
     return serialized;
 }
 
 void QueueProducer::shutdown() {
-    if (producer_) {
+    // Stop draining; undrained records stay in the spill log for the next start
+    if (drain_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            draining_.store(false);
+        }
+        drain_cv_.notify_all();
+        drain_thread_.join();
+    }
+
+    // Hand open batches to librdkafka before flushing it
+    for (auto& shard : shards_) {
+        if (shard->batcher) {
+            shard->batcher->stop();
+        }
+    }
+
+    for (auto& shard : shards_) {
+        destroyShard(*shard);
+    }
+    shards_.clear();
+
+    if (spill_) {
+        spill_->close();
+    }
+}
+
+void QueueProducer::destroyShard(ProducerShard& shard) {
+    if (shard.producer) {
         try {
             // Flush any pending messages (wait up to 5 seconds)
-            int remaining = rd_kafka_flush(producer_, 5000);
+            rd_kafka_flush(shard.producer, 5000);
+            int remaining = rd_kafka_outq_len(shard.producer);
             if (remaining > 0) {
                 std::cerr << "Warning: " << remaining << " messages were not delivered during shutdown" << std::endl;
+                // Fail the rest: their delivery reports answer waiting requests
+                // (503 with Retry-After) and free their batches
+                rd_kafka_purge(shard.producer, RD_KAFKA_PURGE_F_QUEUE | RD_KAFKA_PURGE_F_INFLIGHT);
+                rd_kafka_flush(shard.producer, 1000);
             }
-            
-            // Poll to process any remaining delivery callbacks
-            rd_kafka_poll(producer_, 0);
         } catch (const std::exception& e) {
             std::cerr << "Error during producer shutdown: " << e.what() << std::endl;
         }
-        
-        if (topic_) {
-            rd_kafka_topic_destroy(topic_);
-            topic_ = nullptr;
+    }
+
+    shard.polling.store(false);
+    if (shard.poll_thread.joinable()) {
+        shard.poll_thread.join();
+    }
+
+    if (shard.producer) {
+        // Process any remaining delivery callbacks
+        rd_kafka_poll(shard.producer, 0);
+
+        if (shard.topic) {
+            rd_kafka_topic_destroy(shard.topic);
+            shard.topic = nullptr;
         }
         
-        rd_kafka_destroy(producer_);
-        producer_ = nullptr;
+        rd_kafka_destroy(shard.producer);
+        shard.producer = nullptr;
     }
 }
-
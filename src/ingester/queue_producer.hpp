@@ -3,11 +3,17 @@
 
 #include "../config.hpp"
 #include "telemetry_wrapper.pb.h"
+#include "request_batcher.hpp"
+#include "spill_log.hpp"
+#include "admission_controller.hpp"
 #include <librdkafka/rdkafka.h>
 #include <string>
+#include <string_view>
 #include <atomic>
+#include <condition_variable>
 #include <memory>
-#include <mutex>
+#include <thread>
+#include <vector>
 
 enum class ProduceResult {
     SUCCESS,
@@ -19,25 +25,39 @@ enum class ProduceResult {
 // Delivery report callback class
 class DeliveryReportCb {
 public:
-    DeliveryReportCb(std::atomic<int>* in_flight_count) 
-        : in_flight_count_(in_flight_count) {}
+    DeliveryReportCb(std::atomic<int>* in_flight_count, AdmissionController* admission = nullptr)
+        : in_flight_count_(in_flight_count), admission_(admission) {}
 
     // Static callback function for librdkafka
+    // Batched records carry their RequestBatch as the per-message opaque, as do
+    // single records whose sender waits for delivery (a one-request batch without a buffer)
     static void dr_cb(rd_kafka_t* rk, const rd_kafka_message_t* rkmessage, void* opaque) {
         DeliveryReportCb* cb = static_cast<DeliveryReportCb*>(opaque);
+        RequestBatch* batch = static_cast<RequestBatch*>(rkmessage->_private);
+        int requests = batch ? static_cast<int>(batch->count) : 1;
         if (cb && cb->in_flight_count_) {
             if (rkmessage->err == RD_KAFKA_RESP_ERR_NO_ERROR) {
                 // Success - decrement in-flight count
-                cb->in_flight_count_->fetch_sub(1);
+                cb->in_flight_count_->fetch_sub(requests);
             } else {
                 // Failure - decrement in-flight count
-                cb->in_flight_count_->fetch_sub(1);
+                cb->in_flight_count_->fetch_sub(requests);
             }
         }
+        if (cb && cb->admission_) {
+            // Queue-to-acknowledgement latency drives the admission limit
+            cb->admission_->release(rkmessage->len, rd_kafka_message_latency(rkmessage),
+                                    rkmessage->err == RD_KAFKA_RESP_ERR_NO_ERROR);
+        }
+        if (batch) {
+            batch->complete(rkmessage->err == RD_KAFKA_RESP_ERR_NO_ERROR);
+            delete batch;
+        }
     }
 
 private:
     std::atomic<int>* in_flight_count_;
+    AdmissionController* admission_;
 };
 
 class QueueProducer {
@@ -52,33 +72,142 @@ public:
     // Returns SUCCESS if message was successfully queued
     ProduceResult produce(const telemetry::v1::RawTelemetryMessage& message);
 
-    // Get current number of in-flight messages
-    int getInFlightCount() const { return in_flight_count_.load(); }
-
-    // Check if we're at capacity (for backpressure)
-    bool isAtCapacity() const {
-        return in_flight_count_.load() >= config_.max_in_flight;
+    // Produce a payload framed as a RawTelemetryMessage without building one
+    // The payload is copied once, into a buffer librdkafka takes ownership of
+    // content_encoding is set when payload is still compressed (pass-through)
+    // With batching enabled the payload joins the open RawTelemetryBatch and
+    // SUCCESS means it was accepted into the batch
+    // on_delivered, if set, runs once the record is acknowledged by Kafka (or
+    // failed); it is only called when SUCCESS is returned
+    // With a spill log, records Kafka cannot take are written to disk instead
+    // and SUCCESS means they were spilled
+    // key, if set, is the Kafka message key and picks the partition
+    ProduceResult produce(std::string_view content_type,
+                          telemetry::v1::TelemetryType telemetry_type,
+                          std::string_view payload,
+                          std::string_view content_encoding = {},
+                          DeliveryCallback on_delivered = nullptr,
+                          std::string_view key = {});
+
+    // Get current number of in-flight requests (batched requests count individually)
+    // Sums the per-shard counters; meant for stats, not the request path
+    int getInFlightCount() const;
+
+    // Check if the calling thread's shard is at capacity (for backpressure)
+    // Each shard gets an even share of max_in_flight and of the in-flight byte
+    // limit; bytes is the size of the request about to be produced. With a
+    // spill log the producer is only at capacity once the spill log is full too
+    bool isAtCapacity(size_t bytes = 0) const {
+        const ProducerShard* shard = currentShard();
+        if (!shard) {
+            return true;
+        }
+        return isShardAtCapacity(*shard, bytes) && (!spill_ || spill_->isFull());
     }
 
+    // Seconds a client turned away by backpressure should wait before retrying,
+    // estimated from the calling thread's shard
+    int retryAfterSeconds() const;
+
+    // Bytes handed to librdkafka and not yet acknowledged, and the current
+    // adaptive limit on them, summed over shards
+    size_t getInFlightBytes() const;
+    size_t getInFlightLimitBytes() const;
+
+    // Spill log statistics; returns false if spilling is disabled
+    bool getSpillStats(SpillLog::Stats& stats) const;
+
     // Check if the producer is initialized and ready to accept messages
     bool isReady() const {
-        return producer_ != nullptr && topic_ != nullptr;
+        return !shards_.empty();
     }
 
+    // Number of producer shards created by initialize()
+    size_t getShardCount() const { return shards_.size(); }
+
     // Shutdown gracefully
     void shutdown();
 
 private:
+    // One librdkafka producer with its own delivery report thread
+    // Request threads stick to one shard, so the in-flight counter is only
+    // contended by that shard's producers and its poll thread
+    struct ProducerShard {
+        alignas(64) std::atomic<int> in_flight{0};
+        rd_kafka_t* producer = nullptr;
+        rd_kafka_topic_t* topic = nullptr;
+        std::unique_ptr<DeliveryReportCb> delivery_cb;
+
+        // In-flight byte limit, adapted to this shard's delivery latency
+        std::unique_ptr<AdmissionController> admission;
+
+        // Coalesces small requests when batch_linger_ms > 0
+        std::unique_ptr<RequestBatcher> batcher;
+
+        std::thread poll_thread;
+        std::atomic<bool> polling{false};
+    };
+
+    // Records drained from the spill log per round trip, grown while Kafka keeps up
+    static constexpr size_t kMaxDrainChunk = 1000;
+    static constexpr int kMaxDrainBackoffMs = 5000;
+
     IngesterConfig config_;
-    std::atomic<int> in_flight_count_;
-    std::mutex produce_mutex_;
+    int shard_max_in_flight_;
+    std::vector<std::unique_ptr<ProducerShard>> shards_;
+
+    // Disk spill for outages (spill_dir set); drained in order by drain_thread_
+    std::unique_ptr<SpillLog> spill_;
+    std::thread drain_thread_;
+    std::atomic<bool> draining_;
+    std::mutex drain_mutex_;
+    std::condition_variable drain_cv_;
+
+    // Shard used by the calling thread (threads are assigned round-robin on first use)
+    ProducerShard* currentShard() const;
+
+    // Whether a request of this many bytes would exceed the shard's request
+    // count or byte limit
+    bool isShardAtCapacity(const ProducerShard& shard, size_t bytes) const {
+        return shard.in_flight.load(std::memory_order_relaxed) >= shard_max_in_flight_ ||
+               !shard.admission->admits(bytes);
+    }
+
+    // Create a producer and topic handle for one shard
+    bool createShard(ProducerShard& shard, size_t index);
+
+    // Serve delivery reports until shard.polling is cleared
+    static void pollLoop(ProducerShard* shard);
+
+    // Flush, stop polling and destroy one shard's handles
+    void destroyShard(ProducerShard& shard);
+
+    // Produce a malloc'd buffer; ownership passes to librdkafka (RD_KAFKA_MSG_F_FREE)
+    // on success and stays with the caller on failure
+    // batch, if given, is the delivery report opaque; on failure it is left to the caller
+    // An empty key leaves the partition to librdkafka's default spreading
+    // size is charged to admission here unless acquired says the caller already did;
+    // either way it is cancelled on failure
+    ProduceResult produceWithRetry(ProducerShard& shard, char* data, size_t size, std::string_view key,
+                                   int retry_count = 0, RequestBatch* batch = nullptr,
+                                   bool acquired = false);
+
+    // Flush function for a shard's batcher, runs on the batcher thread
+    void produceBatch(ProducerShard& shard, std::unique_ptr<RequestBatch> batch);
+
+    // Report a batch that never reached librdkafka as failed and delete it
+    void failBatch(RequestBatch* batch);
+
+    // New records go to the spill log while older ones are still in it
+    bool isSpillPending() const { return spill_ && !spill_->empty(); }
 
-    rd_kafka_t* producer_;
-    rd_kafka_topic_t* topic_;
-    DeliveryReportCb delivery_cb_;
+    // Append a framed record to the spill log; durable is set when its sender
+    // waits for delivery, which the spill log only stands in for with fsync=always
+    bool spillRecord(std::string_view key, const char* data, size_t size, bool durable);
 
-    ProduceResult produceWithRetry(const std::string& serialized_data, int retry_count = 0);
-    std::string serializeMessage(const telemetry::v1::RawTelemetryMessage& message);
+    // Produce spilled records in order, consuming them once delivered
+    void drainLoop();
+    char* serializeMessage(const telemetry::v1::RawTelemetryMessage& message, size_t& size);
 };
 
 #endif // QUEUE_PRODUCER_HPP
@@ -0,0 +1,193 @@
+#include "request_batcher.hpp"
+#include "wrapper_framing.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace {
+
+// First allocation of a batch buffer; grows by doubling up to max_bytes
+constexpr size_t kInitialBatchCapacity = 64 * 1024;
+
+}  // namespace
+
+RequestBatch::~RequestBatch() {
+    // Requests that were never completed did not reach the queue
+    complete(false);
+    std::free(data);
+}
+
+char* RequestBatch::release() {
+    char* released = data;
+    data = nullptr;
+    size = 0;
+    capacity = 0;
+    return released;
+}
+
+void RequestBatch::complete(bool delivered) {
+    for (auto& callback : callbacks) {
+        if (callback) {
+            callback(delivered);
+        }
+    }
+    callbacks.clear();
+}
+
+RequestBatcher::RequestBatcher(size_t max_bytes, size_t max_messages,
+                               std::chrono::milliseconds linger, FlushFunction flush)
+    : max_bytes_(max_bytes)
+    , max_messages_(std::max<size_t>(1, max_messages))
+    , linger_(linger)
+    , flush_(std::move(flush))
+    , pending_bytes_(0)
+    , running_(false)
+    , stop_requested_(false) {
+}
+
+RequestBatcher::~RequestBatcher() {
+    stop();
+}
+
+void RequestBatcher::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    stop_requested_ = false;
+    thread_ = std::thread(&RequestBatcher::run, this);
+}
+
+void RequestBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        stop_requested_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool RequestBatcher::add(std::string_view content_type,
+                         telemetry::v1::TelemetryType telemetry_type,
+                         std::string_view payload,
+                         std::string_view content_encoding,
+                         DeliveryCallback on_delivered,
+                         std::string_view key) {
+    size_t framed_size = WrapperFraming::framedSize(content_type, telemetry_type, payload.size(),
+                                                    content_encoding);
+    size_t entry_size = WrapperFraming::batchEntrySize(framed_size);
+    if (entry_size > max_bytes_) {
+        return false;
+    }
+
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || stop_requested_) {
+            return false;
+        }
+
+        auto it = open_.find(std::string(key));
+        if (it != open_.end() && it->second.batch->size + entry_size > max_bytes_) {
+            sealOpenLocked(it);
+            it = open_.end();
+            notify = true;
+        }
+        if (it == open_.end()) {
+            OpenBatch open{std::make_unique<RequestBatch>(), std::chrono::steady_clock::now() + linger_};
+            open.batch->key = std::string(key);
+            it = open_.emplace(open.batch->key, std::move(open)).first;
+            notify = true;  // Flush thread waits for the new deadline
+        }
+
+        RequestBatch& batch = *it->second.batch;
+        if (batch.size + entry_size > batch.capacity) {
+            size_t capacity = std::max(batch.capacity * 2, kInitialBatchCapacity);
+            capacity = std::min(std::max(capacity, batch.size + entry_size), max_bytes_);
+            char* grown = static_cast<char*>(std::realloc(batch.data, capacity));
+            if (!grown) {
+                return false;
+            }
+            batch.data = grown;
+            batch.capacity = capacity;
+        }
+
+        auto* out = reinterpret_cast<uint8_t*>(batch.data + batch.size);
+        out = WrapperFraming::writeBatchEntryHeader(framed_size, out);
+        WrapperFraming::write(content_type, telemetry_type, payload, content_encoding, out);
+        batch.size += entry_size;
+        batch.count++;
+        batch.callbacks.push_back(std::move(on_delivered));
+        pending_bytes_ += entry_size;
+
+        if (batch.count >= max_messages_ || batch.size == max_bytes_) {
+            sealOpenLocked(it);
+            notify = true;
+        }
+    }
+
+    if (notify) {
+        cv_.notify_one();
+    }
+    return true;
+}
+
+void RequestBatcher::sealOpenLocked(std::unordered_map<std::string, OpenBatch>::iterator it) {
+    ready_.push_back(std::move(it->second.batch));
+    open_.erase(it);
+}
+
+void RequestBatcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Wait for a full batch, the earliest linger deadline, or stop
+        if (ready_.empty() && !stop_requested_) {
+            if (!open_.empty()) {
+                auto deadline = open_.begin()->second.deadline;
+                for (const auto& entry : open_) {
+                    deadline = std::min(deadline, entry.second.deadline);
+                }
+                cv_.wait_until(lock, deadline);
+            } else {
+                cv_.wait(lock);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = open_.begin(); it != open_.end();) {
+            auto current = it++;
+            if (stop_requested_ || now >= current->second.deadline) {
+                sealOpenLocked(current);
+            }
+        }
+
+        if (ready_.empty()) {
+            if (stop_requested_) {
+                break;
+            }
+            continue;
+        }
+
+        std::unique_ptr<RequestBatch> batch = std::move(ready_.front());
+        ready_.pop_front();
+        pending_bytes_ -= batch->size;
+        lock.unlock();
+
+        try {
+            flush_(std::move(batch));
+        } catch (const std::exception& e) {
+            std::cerr << "Error flushing request batch: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+    }
+
+    running_ = false;
+}
@@ -0,0 +1,104 @@
+#ifndef REQUEST_BATCHER_HPP
+#define REQUEST_BATCHER_HPP
+
+#include "telemetry_wrapper.pb.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Called once per request with whether its batch reached the queue
+using DeliveryCallback = std::function<void(bool delivered)>;
+
+// A serialized RawTelemetryBatch in a malloc'd buffer plus its requests' callbacks
+// The buffer can be handed to librdkafka with RD_KAFKA_MSG_F_FREE via release()
+struct RequestBatch {
+    char* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    size_t count = 0;  // Requests in this batch
+    std::string key;   // Kafka key shared by every request in the batch (empty = unkeyed)
+    std::vector<DeliveryCallback> callbacks;
+
+    RequestBatch() = default;
+    RequestBatch(const RequestBatch&) = delete;
+    RequestBatch& operator=(const RequestBatch&) = delete;
+    ~RequestBatch();
+
+    // Give up ownership of the buffer
+    char* release();
+
+    // Run every request's callback; a batch destroyed without completing
+    // reports its requests as not delivered
+    void complete(bool delivered);
+};
+
+// Coalesces small requests into RawTelemetryBatch records
+// A batch is flushed once it reaches max_bytes or max_messages, or linger
+// after its first request arrived. Flushes run on the batcher's own thread,
+// in order, so request threads only copy their payload into the open batch.
+// Requests with different Kafka keys never share a batch; each key has its
+// own open batch.
+class RequestBatcher {
+public:
+    using FlushFunction = std::function<void(std::unique_ptr<RequestBatch>)>;
+
+    RequestBatcher(size_t max_bytes, size_t max_messages,
+                   std::chrono::milliseconds linger, FlushFunction flush);
+    ~RequestBatcher();
+
+    void start();
+
+    // Flush everything added so far and stop the flush thread
+    void stop();
+
+    // Append a request to the open batch for key
+    // Returns false if the batcher is not running or the request alone exceeds
+    // max_bytes; the caller should then produce it on its own
+    bool add(std::string_view content_type,
+             telemetry::v1::TelemetryType telemetry_type,
+             std::string_view payload,
+             std::string_view content_encoding,
+             DeliveryCallback on_delivered = nullptr,
+             std::string_view key = {});
+
+    // Bytes added but not yet handed to the flush function
+    size_t getPendingBytes() const { return pending_bytes_.load(); }
+
+private:
+    const size_t max_bytes_;
+    const size_t max_messages_;
+    const std::chrono::milliseconds linger_;
+    FlushFunction flush_;
+
+    struct OpenBatch {
+        std::unique_ptr<RequestBatch> batch;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    std::unordered_map<std::string, OpenBatch> open_;  // By Kafka key
+    std::deque<std::unique_ptr<RequestBatch>> ready_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<size_t> pending_bytes_;
+
+    std::thread thread_;
+    bool running_;
+    bool stop_requested_;
+
+    void run();
+
+    // Move an open batch to the ready queue (mutex_ must be held)
+    void sealOpenLocked(std::unordered_map<std::string, OpenBatch>::iterator it);
+};
+
+#endif // REQUEST_BATCHER_HPP
@@ -0,0 +1,456 @@
+#include "spill_log.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Record layout, host byte order (the log never leaves this machine):
+//   [u32 data length][u16 key length][u16 flags][u32 crc32 of key + data][key][data]
+// The header is written after the body, so a record torn by a crash has a
+// zero or mismatching header and ends recovery of its segment. Consuming a
+// record sets its consumed flag in place, which the checksum does not cover,
+// so recovery resumes after the last consumed record
+constexpr size_t kRecordHeaderSize = 12;
+constexpr size_t kFlagsOffset = 6;
+constexpr uint16_t kConsumedFlag = 1;
+constexpr size_t kMaxKeySize = 0xFFFF;
+
+const char kSegmentPrefix[] = "spill-";
+const char kSegmentSuffix[] = ".log";
+
+uint32_t recordChecksum(std::string_view key, std::string_view data) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(key.data()), static_cast<uInt>(key.size()));
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size()));
+    return static_cast<uint32_t>(crc);
+}
+
+size_t recordSize(size_t key_size, size_t data_size) {
+    return kRecordHeaderSize + key_size + data_size;
+}
+
+// Parse the record at pos; returns false at the end of valid data
+bool readRecord(const char* base, size_t capacity, size_t pos, SpillLog::Record& record, size_t& size) {
+    if (pos + kRecordHeaderSize > capacity) {
+        return false;
+    }
+    uint32_t data_size;
+    uint16_t key_size;
+    uint32_t checksum;
+    std::memcpy(&data_size, base + pos, 4);
+    std::memcpy(&key_size, base + pos + 4, 2);
+    std::memcpy(&checksum, base + pos + 8, 4);
+    if (data_size == 0 || recordSize(key_size, data_size) > capacity - pos) {
+        return false;
+    }
+
+    const char* body = base + pos + kRecordHeaderSize;
+    record.key = std::string_view(body, key_size);
+    record.data = std::string_view(body + key_size, data_size);
+    if (recordChecksum(record.key, record.data) != checksum) {
+        return false;
+    }
+    size = recordSize(key_size, data_size);
+    return true;
+}
+
+bool isConsumed(const char* base, size_t pos) {
+    uint16_t flags;
+    std::memcpy(&flags, base + pos + kFlagsOffset, 2);
+    return (flags & kConsumedFlag) != 0;
+}
+
+}  // namespace
+
+SpillLog::SpillLog(Options options)
+    : options_(std::move(options))
+    , next_sequence_(0)
+    , disk_bytes_(0)
+    , pending_bytes_(0)
+    , appended_total_(0)
+    , consumed_total_(0)
+    , rejected_total_(0)
+    , records_(0)
+    , full_(false)
+    , open_(false)
+    , dirty_(false)
+    , stop_sync_(false) {
+    options_.segment_bytes = std::max<size_t>(1, std::min(options_.segment_bytes, options_.max_bytes));
+}
+
+SpillLog::~SpillLog() {
+    close();
+}
+
+SpillLog::FsyncPolicy SpillLog::parseFsyncPolicy(const std::string& name) {
+    if (name == "none") {
+        return FsyncPolicy::NONE;
+    }
+    if (name == "always") {
+        return FsyncPolicy::ALWAYS;
+    }
+    return FsyncPolicy::INTERVAL;
+}
+
+std::string SpillLog::segmentPath(uint64_t sequence) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020llu%s", kSegmentPrefix,
+                  static_cast<unsigned long long>(sequence), kSegmentSuffix);
+    return (fs::path(options_.directory) / name).string();
+}
+
+bool SpillLog::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (open_) {
+        return true;
+    }
+
+    std::error_code ec;
+    fs::create_directories(options_.directory, ec);
+    if (ec) {
+        std::cerr << "Failed to create spill directory " << options_.directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // Segment names sort by sequence number
+    std::vector<std::pair<uint64_t, std::string>> existing;
+    for (const auto& entry : fs::directory_iterator(options_.directory, ec)) {
+        std::string name = entry.path().filename().string();
+        size_t prefix = sizeof(kSegmentPrefix) - 1;
+        size_t suffix = sizeof(kSegmentSuffix) - 1;
+        if (name.size() <= prefix + suffix || name.compare(0, prefix, kSegmentPrefix) != 0 ||
+            name.compare(name.size() - suffix, suffix, kSegmentSuffix) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+        if (digits.find_first_not_of("0123456789") != std::string::npos) {
+            continue;
+        }
+        existing.emplace_back(std::stoull(digits), entry.path().string());
+    }
+    if (ec) {
+        std::cerr << "Failed to list spill directory " << options_.directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    std::sort(existing.begin(), existing.end());
+
+    for (const auto& [sequence, path] : existing) {
+        if (!recoverSegment(sequence, path)) {
+            std::cerr << "Skipping unreadable spill segment " << path << std::endl;
+        }
+        next_sequence_ = sequence + 1;
+    }
+
+    if (!segments_.empty()) {
+        std::cout << "Recovered " << records_.load() << " spilled record(s) from "
+                  << segments_.size() << " segment(s) in " << options_.directory << std::endl;
+    }
+
+    open_ = true;
+    stop_sync_ = false;
+    if (options_.fsync == FsyncPolicy::INTERVAL) {
+        sync_thread_ = std::thread(&SpillLog::syncLoop, this);
+    }
+    return true;
+}
+
+bool SpillLog::recoverSegment(uint64_t sequence, const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        // Created but never sized
+        ::close(fd);
+        ::unlink(path.c_str());
+        return true;
+    }
+
+    size_t capacity = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    auto segment = std::make_unique<Segment>();
+    segment->sequence = sequence;
+    segment->path = path;
+    segment->fd = fd;
+    segment->base = static_cast<char*>(mapped);
+    segment->capacity = capacity;
+
+    // Records are consumed in order, so only a leading run can be marked
+    Record record;
+    size_t size = 0;
+    while (readRecord(segment->base, capacity, segment->write_pos, record, size)) {
+        if (segment->unread_records == 0 && isConsumed(segment->base, segment->write_pos)) {
+            segment->read_pos += size;
+        } else {
+            segment->unread_records++;
+            segment->unread_bytes += size;
+        }
+        segment->write_pos += size;
+    }
+    segment->synced_pos = segment->write_pos;
+
+    if (segment->unread_records == 0) {
+        releaseSegment(*segment, true);
+        return true;
+    }
+
+    disk_bytes_ += capacity;
+    pending_bytes_ += segment->unread_bytes;
+    records_ += segment->unread_records;
+    segments_.push_back(std::move(segment));
+    return true;
+}
+
+void SpillLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_) {
+            return;
+        }
+        open_ = false;
+        stop_sync_ = true;
+    }
+    sync_cv_.notify_all();
+    if (sync_thread_.joinable()) {
+        sync_thread_.join();
+    }
+
+    // Unconsumed records stay on disk for the next open()
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& segment : segments_) {
+        if (options_.fsync != FsyncPolicy::NONE) {
+            syncSegment(*segment, segment->synced_pos, segment->write_pos);
+        }
+        releaseSegment(*segment, false);
+    }
+    segments_.clear();
+    disk_bytes_ = 0;
+    pending_bytes_ = 0;
+    records_ = 0;
+}
+
+SpillLog::Segment* SpillLog::createSegmentLocked(size_t min_bytes) {
+    size_t capacity = std::max(options_.segment_bytes, min_bytes);
+    if (disk_bytes_ + capacity > options_.max_bytes) {
+        return nullptr;
+    }
+
+    // Finish the segment being replaced before writing elsewhere
+    if (!segments_.empty() && options_.fsync != FsyncPolicy::NONE) {
+        Segment& previous = *segments_.back();
+        syncSegment(previous, previous.synced_pos, previous.write_pos);
+    }
+
+    auto segment = std::make_unique<Segment>();
+    segment->sequence = next_sequence_++;
+    segment->path = segmentPath(segment->sequence);
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (segment->fd < 0) {
+        std::cerr << "Failed to create spill segment " << segment->path << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    if (ftruncate(segment->fd, static_cast<off_t>(capacity)) != 0) {
+        std::cerr << "Failed to size spill segment " << segment->path << ": " << std::strerror(errno) << std::endl;
+        releaseSegment(*segment, true);
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map spill segment " << segment->path << ": " << std::strerror(errno) << std::endl;
+        releaseSegment(*segment, true);
+        return nullptr;
+    }
+    segment->base = static_cast<char*>(mapped);
+    segment->capacity = capacity;
+
+    disk_bytes_ += capacity;
+    segments_.push_back(std::move(segment));
+    return segments_.back().get();
+}
+
+bool SpillLog::append(std::string_view key, std::string_view data) {
+    if (data.empty() || key.size() > kMaxKeySize || data.size() > 0xFFFFFFFFu) {
+        return false;
+    }
+    size_t size = recordSize(key.size(), data.size());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) {
+        return false;
+    }
+
+    Segment* segment = segments_.empty() ? nullptr : segments_.back().get();
+    if (!segment || segment->capacity - segment->write_pos < size) {
+        segment = createSegmentLocked(size);
+        if (!segment) {
+            rejected_total_++;
+            full_ = true;
+            return false;
+        }
+    }
+
+    // Body first, header last
+    char* out = segment->base + segment->write_pos;
+    std::memcpy(out + kRecordHeaderSize, key.data(), key.size());
+    std::memcpy(out + kRecordHeaderSize + key.size(), data.data(), data.size());
+    uint32_t data_size = static_cast<uint32_t>(data.size());
+    uint16_t key_size = static_cast<uint16_t>(key.size());
+    uint16_t flags = 0;
+    uint32_t checksum = recordChecksum(key, data);
+    std::memcpy(out + 4, &key_size, 2);
+    std::memcpy(out + kFlagsOffset, &flags, 2);
+    std::memcpy(out + 8, &checksum, 4);
+    std::memcpy(out, &data_size, 4);
+
+    segment->write_pos += size;
+    segment->unread_records++;
+    segment->unread_bytes += size;
+    pending_bytes_ += size;
+    appended_total_++;
+    records_++;
+
+    if (options_.fsync == FsyncPolicy::ALWAYS) {
+        syncSegment(*segment, segment->synced_pos, segment->write_pos);
+    } else {
+        dirty_ = true;
+    }
+    return true;
+}
+
+size_t SpillLog::peek(size_t max, std::vector<Record>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& segment : segments_) {
+        size_t pos = segment->read_pos;
+        for (size_t i = 0; i < segment->unread_records && out.size() < max; ++i) {
+            Record record;
+            size_t size = 0;
+            if (!readRecord(segment->base, segment->write_pos, pos, record, size)) {
+                break;
+            }
+            out.push_back(record);
+            pos += size;
+        }
+        if (out.size() >= max) {
+            break;
+        }
+    }
+    return out.size();
+}
+
+void SpillLog::consume(size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (n > 0 && !segments_.empty()) {
+        Segment& segment = *segments_.front();
+        size_t consumed_from = segment.read_pos;
+        while (n > 0 && segment.unread_records > 0) {
+            Record record;
+            size_t size = 0;
+            if (!readRecord(segment.base, segment.write_pos, segment.read_pos, record, size)) {
+                break;
+            }
+            std::memcpy(segment.base + segment.read_pos + kFlagsOffset, &kConsumedFlag, 2);
+            segment.read_pos += size;
+            segment.unread_records--;
+            segment.unread_bytes -= size;
+            pending_bytes_ -= size;
+            consumed_total_++;
+            records_--;
+            n--;
+        }
+        if (segment.unread_records > 0) {
+            // The marks survive a process crash in the page cache; synced, a power loss too
+            if (options_.fsync != FsyncPolicy::NONE) {
+                syncRange(segment, consumed_from, segment.read_pos);
+            }
+            break;
+        }
+
+        // Fully drained; the next append starts a fresh segment
+        disk_bytes_ -= segment.capacity;
+        releaseSegment(segment, true);
+        segments_.pop_front();
+    }
+    full_ = false;
+}
+
+SpillLog::Stats SpillLog::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.segments = segments_.size();
+    stats.records = records_.load();
+    stats.pending_bytes = pending_bytes_;
+    stats.disk_bytes = disk_bytes_;
+    stats.max_bytes = options_.max_bytes;
+    stats.appended_total = appended_total_;
+    stats.consumed_total = consumed_total_;
+    stats.rejected_total = rejected_total_;
+    return stats;
+}
+
+void SpillLog::syncSegment(Segment& segment, size_t from, size_t to) {
+    if (syncRange(segment, from, to)) {
+        segment.synced_pos = std::max(segment.synced_pos, to);
+    }
+}
+
+bool SpillLog::syncRange(Segment& segment, size_t from, size_t to) {
+    if (!segment.base || to <= from) {
+        return false;
+    }
+    // msync needs a page-aligned start
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t aligned = from - from % page;
+    if (msync(segment.base + aligned, to - aligned, MS_SYNC) != 0) {
+        std::cerr << "Failed to sync spill segment " << segment.path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SpillLog::releaseSegment(Segment& segment, bool remove_file) {
+    if (segment.base) {
+        munmap(segment.base, segment.capacity);
+        segment.base = nullptr;
+    }
+    if (segment.fd >= 0) {
+        ::close(segment.fd);
+        segment.fd = -1;
+    }
+    if (remove_file) {
+        ::unlink(segment.path.c_str());
+    }
+}
+
+void SpillLog::syncLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_sync_) {
+        sync_cv_.wait_for(lock, options_.fsync_interval, [this] { return stop_sync_; });
+        if (dirty_ && !segments_.empty()) {
+            Segment& segment = *segments_.back();
+            syncSegment(segment, segment.synced_pos, segment.write_pos);
+            dirty_ = false;
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef SPILL_LOG_HPP
+#define SPILL_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Local write-ahead log for Kafka records the ingester could not produce
+// Records are appended to memory-mapped segment files of a fixed size and
+// read back in append order; a segment file is deleted once every record in
+// it has been consumed. Segments left behind by a crash are recovered on
+// open(), from the first record not yet consumed up to the last record whose
+// checksum verifies.
+class SpillLog {
+public:
+    enum class FsyncPolicy {
+        NONE,      // Leave write-back to the OS
+        INTERVAL,  // msync the active segment every fsync_interval
+        ALWAYS     // msync every append before it returns
+    };
+
+    struct Options {
+        std::string directory;
+        size_t segment_bytes = 64 * 1024 * 1024;
+        size_t max_bytes = 1024 * 1024 * 1024;  // Disk budget across all segments
+        FsyncPolicy fsync = FsyncPolicy::INTERVAL;
+        std::chrono::milliseconds fsync_interval{1000};
+    };
+
+    struct Stats {
+        size_t segments = 0;
+        size_t records = 0;         // Spilled and not yet consumed
+        size_t pending_bytes = 0;   // Size of those records
+        size_t disk_bytes = 0;      // Segment files on disk
+        size_t max_bytes = 0;
+        uint64_t appended_total = 0;
+        uint64_t consumed_total = 0;
+        uint64_t rejected_total = 0;  // Appends refused for lack of space or I/O errors
+    };
+
+    // One spilled record; the views stay valid until it is consumed
+    struct Record {
+        std::string_view key;
+        std::string_view data;
+    };
+
+    explicit SpillLog(Options options);
+    ~SpillLog();
+
+    SpillLog(const SpillLog&) = delete;
+    SpillLog& operator=(const SpillLog&) = delete;
+
+    // Create the directory if needed and recover existing segments
+    bool open();
+    void close();
+
+    // Append a record; returns false if the disk budget is exhausted or on I/O error
+    bool append(std::string_view key, std::string_view data);
+
+    // Copy views of up to max of the oldest unconsumed records into out
+    size_t peek(size_t max, std::vector<Record>& out);
+
+    // Drop the n oldest records (after they reached Kafka)
+    // Each is marked consumed on disk, so a restart does not send it again
+    void consume(size_t n);
+
+    bool empty() const { return records_.load() == 0; }
+    size_t size() const { return records_.load(); }
+
+    // Whether the last append was refused for lack of space
+    bool isFull() const { return full_.load(); }
+
+    bool syncsEveryAppend() const { return options_.fsync == FsyncPolicy::ALWAYS; }
+
+    Stats getStats() const;
+
+    // "none", "interval" or "always"; anything else is INTERVAL
+    static FsyncPolicy parseFsyncPolicy(const std::string& name);
+
+private:
+    struct Segment {
+        uint64_t sequence = 0;
+        std::string path;
+        int fd = -1;
+        char* base = nullptr;
+        size_t capacity = 0;
+        size_t write_pos = 0;
+        size_t read_pos = 0;
+        size_t synced_pos = 0;
+        size_t unread_records = 0;
+        size_t unread_bytes = 0;
+    };
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Segment>> segments_;  // Oldest first; the back one is written to
+    uint64_t next_sequence_;
+    size_t disk_bytes_;
+    size_t pending_bytes_;
+    uint64_t appended_total_;
+    uint64_t consumed_total_;
+    uint64_t rejected_total_;
+    std::atomic<size_t> records_;
+    std::atomic<bool> full_;
+    bool open_;
+    bool dirty_;  // Unsynced appends (INTERVAL)
+
+    std::thread sync_thread_;
+    std::condition_variable sync_cv_;
+    bool stop_sync_;
+
+    std::string segmentPath(uint64_t sequence) const;
+
+    // Map a new segment of at least min_bytes (mutex_ must be held)
+    Segment* createSegmentLocked(size_t min_bytes);
+
+    // Map an existing segment file and find its last valid record
+    bool recoverSegment(uint64_t sequence, const std::string& path);
+
+    // msync [from, to); syncSegment also advances synced_pos for appends
+    void syncSegment(Segment& segment, size_t from, size_t to);
+    bool syncRange(Segment& segment, size_t from, size_t to);
+    void releaseSegment(Segment& segment, bool remove_file);
+    void syncLoop();
+};
+
+#endif // SPILL_LOG_HPP
@@ -0,0 +1,105 @@
+#include "wrapper_framing.hpp"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <cstdlib>
+#include <cstring>
+
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::internal::WireFormatLite;
+using telemetry::v1::RawTelemetryBatch;
+using telemetry::v1::RawTelemetryMessage;
+
+namespace {
+
+// Fields are emitted in field-number order and proto3 defaults are omitted,
+// matching the generated serializer
+size_t lengthDelimitedSize(size_t size) {
+    return 1 + CodedOutputStream::VarintSize64(size) + size;
+}
+
+uint8_t* writeLengthDelimited(int field_number, const void* data, size_t size, uint8_t* out) {
+    out = CodedOutputStream::WriteTagToArray(
+        WireFormatLite::MakeTag(field_number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED), out);
+    out = CodedOutputStream::WriteVarint64ToArray(size, out);
+    if (size > 0) {
+        std::memcpy(out, data, size);
+    }
+    return out + size;
+}
+
+}  // namespace
+
+size_t WrapperFraming::framedSize(std::string_view content_type,
+                                  telemetry::v1::TelemetryType telemetry_type,
+                                  size_t payload_size,
+                                  std::string_view content_encoding) {
+    size_t size = 0;
+    if (!content_type.empty()) {
+        size += lengthDelimitedSize(content_type.size());
+    }
+    if (telemetry_type != 0) {
+        size += 1 + CodedOutputStream::VarintSize32SignExtended(telemetry_type);
+    }
+    if (payload_size > 0) {
+        size += lengthDelimitedSize(payload_size);
+    }
+    if (!content_encoding.empty()) {
+        size += lengthDelimitedSize(content_encoding.size());
+    }
+    return size;
+}
+
+uint8_t* WrapperFraming::write(std::string_view content_type,
+                               telemetry::v1::TelemetryType telemetry_type,
+                               std::string_view payload,
+                               std::string_view content_encoding,
+                               uint8_t* out) {
+    if (!content_type.empty()) {
+        out = writeLengthDelimited(RawTelemetryMessage::kContentTypeFieldNumber,
+                                   content_type.data(), content_type.size(), out);
+    }
+    if (telemetry_type != 0) {
+        out = CodedOutputStream::WriteTagToArray(
+            WireFormatLite::MakeTag(RawTelemetryMessage::kTelemetryTypeFieldNumber,
+                                    WireFormatLite::WIRETYPE_VARINT), out);
+        out = CodedOutputStream::WriteVarint32SignExtendedToArray(telemetry_type, out);
+    }
+    if (!payload.empty()) {
+        out = writeLengthDelimited(RawTelemetryMessage::kPayloadFieldNumber,
+                                   payload.data(), payload.size(), out);
+    }
+    if (!content_encoding.empty()) {
+        out = writeLengthDelimited(RawTelemetryMessage::kContentEncodingFieldNumber,
+                                   content_encoding.data(), content_encoding.size(), out);
+    }
+    return out;
+}
+
+char* WrapperFraming::frame(std::string_view content_type,
+                            telemetry::v1::TelemetryType telemetry_type,
+                            std::string_view payload,
+                            std::string_view content_encoding,
+                            size_t& framed_size) {
+    framed_size = framedSize(content_type, telemetry_type, payload.size(), content_encoding);
+    // malloc(0) may return nullptr; always allocate at least one byte
+    char* buffer = static_cast<char*>(std::malloc(framed_size > 0 ? framed_size : 1));
+    if (!buffer) {
+        return nullptr;
+    }
+    write(content_type, telemetry_type, payload, content_encoding, reinterpret_cast<uint8_t*>(buffer));
+    return buffer;
+}
+
+size_t WrapperFraming::batchEntrySize(size_t framed_size) {
+    return CodedOutputStream::VarintSize32(
+               WireFormatLite::MakeTag(RawTelemetryBatch::kMessagesFieldNumber,
+                                       WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) +
+           CodedOutputStream::VarintSize64(framed_size) + framed_size;
+}
+
+uint8_t* WrapperFraming::writeBatchEntryHeader(size_t framed_size, uint8_t* out) {
+    out = CodedOutputStream::WriteTagToArray(
+        WireFormatLite::MakeTag(RawTelemetryBatch::kMessagesFieldNumber,
+                                WireFormatLite::WIRETYPE_LENGTH_DELIMITED), out);
+    return CodedOutputStream::WriteVarint64ToArray(framed_size, out);
+}
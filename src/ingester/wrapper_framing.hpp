@@ -0,0 +1,45 @@
+#ifndef WRAPPER_FRAMING_HPP
+#define WRAPPER_FRAMING_HPP
+
+#include "telemetry_wrapper.pb.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Encodes the RawTelemetryMessage wire format around an existing payload
+// without building the message, so the payload is copied exactly once
+// The output is byte-identical to RawTelemetryMessage::SerializeToString
+class WrapperFraming {
+public:
+    // Bytes needed to frame a payload of payload_size bytes
+    static size_t framedSize(std::string_view content_type,
+                             telemetry::v1::TelemetryType telemetry_type,
+                             size_t payload_size,
+                             std::string_view content_encoding = {});
+
+    // Write the framed message to out, which must hold framedSize() bytes
+    // Returns a pointer one past the last byte written
+    static uint8_t* write(std::string_view content_type,
+                          telemetry::v1::TelemetryType telemetry_type,
+                          std::string_view payload,
+                          std::string_view content_encoding,
+                          uint8_t* out);
+
+    // Frame payload into a malloc'd buffer the caller must free()
+    // Suitable for handing to librdkafka with RD_KAFKA_MSG_F_FREE
+    // Returns nullptr if the allocation fails
+    static char* frame(std::string_view content_type,
+                       telemetry::v1::TelemetryType telemetry_type,
+                       std::string_view payload,
+                       std::string_view content_encoding,
+                       size_t& framed_size);
+
+    // Bytes a framed message of framed_size takes as a RawTelemetryBatch entry
+    static size_t batchEntrySize(size_t framed_size);
+
+    // Write the tag and length prefix of a RawTelemetryBatch entry
+    // The framed message (write()) must follow immediately
+    static uint8_t* writeBatchEntryHeader(size_t framed_size, uint8_t* out);
+};
+
+#endif // WRAPPER_FRAMING_HPP
@@ -1,5 +1,8 @@
 #include "ingester/http_server.hpp"
 #include "ingester/queue_producer.hpp"
+#ifdef OTEL_HAVE_GRPC
+#include "ingester/grpc_server.hpp"
+#endif
 #include "config.hpp"
 #include <iostream>
 #include <memory>
@@ -15,10 +18,31 @@ int main() {
             std::cerr << "Warning: Failed to initialize queue producer. Continuing without queue support." << std::endl;
             queue_producer.reset();
         }
+
+#ifdef OTEL_HAVE_GRPC
+        // OTLP/gRPC runs on gRPC's own threads next to the HTTP server
+        std::unique_ptr<GrpcServer> grpc_server;
+        if (config.grpc_port > 0) {
+            grpc_server = std::make_unique<GrpcServer>(queue_producer, config);
+            if (!grpc_server->start("0.0.0.0", config.grpc_port)) {
+                return 1;
+            }
+        }
+#endif
         
         // Create HTTP server with queue producer
-        HttpServer server(queue_producer);
+        HttpServer server(queue_producer, config);
         server.start("0.0.0.0", 4318);
+
+#ifdef OTEL_HAVE_GRPC
+        // Flush first so durable-ack calls waiting on delivery reports can finish
+        if (queue_producer) {
+            queue_producer->shutdown();
+        }
+        if (grpc_server) {
+            grpc_server->shutdown();
+        }
+#endif
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
         std::cerr << "Please set required environment variables:" << std::endl;
@@ -0,0 +1,124 @@
+#ifndef OTLP_TEST_HELPERS_HPP
+#define OTLP_TEST_HELPERS_HPP
+
+#include <gtest/gtest.h>
+#include "../src/appender/log_transformer.hpp"
+#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
+#include "opentelemetry/proto/logs/v1/logs.pb.h"
+#include "opentelemetry/proto/resource/v1/resource.pb.h"
+#include "opentelemetry/proto/common/v1/common.pb.h"
+#include <string>
+
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
+
+// Shared by the OTLP decoder tests, which compare each decoder against LogTransformer
+
+inline void expectSameRecords(const LogRecordBatch& expected, const LogRecordBatch& actual) {
+    auto expected_records = expected.toRecords();
+    auto actual_records = actual.toRecords();
+    ASSERT_EQ(expected_records.size(), actual_records.size());
+    EXPECT_EQ(expected.resourceCount(), actual.resourceCount());
+
+    for (size_t i = 0; i < expected_records.size(); ++i) {
+        const auto& e = expected_records[i];
+        const auto& a = actual_records[i];
+        EXPECT_EQ(e.kafka_topic, a.kafka_topic);
+        EXPECT_EQ(e.kafka_partition, a.kafka_partition);
+        EXPECT_EQ(e.kafka_offset, a.kafka_offset);
+        EXPECT_EQ(e.timestamp, a.timestamp);
+        EXPECT_EQ(e.severity, a.severity);
+        EXPECT_EQ(e.body, a.body);
+        EXPECT_EQ(e.trace_id, a.trace_id);
+        EXPECT_EQ(e.span_id, a.span_id);
+        EXPECT_EQ(e.service_name, a.service_name);
+        EXPECT_EQ(e.deployment_environment, a.deployment_environment);
+        EXPECT_EQ(e.host_name, a.host_name);
+        EXPECT_EQ(e.attributes, a.attributes);
+    }
+}
+
+inline void addStringAttribute(google::protobuf::RepeatedPtrField<opentelemetry::proto::common::v1::KeyValue>* attributes,
+                        const std::string& key, const std::string& value) {
+    auto* attr = attributes->Add();
+    attr->set_key(key);
+    attr->mutable_value()->set_string_value(value);
+}
+
+// Request exercising every value type plus duplicate keys, empty values,
+// non-ASCII and escaped strings, a resource without records and an empty scope
+inline ExportLogsServiceRequest buildRichRequest() {
+    ExportLogsServiceRequest request;
+
+    auto* resource_logs = request.add_resource_logs();
+    auto* resource = resource_logs->mutable_resource();
+    addStringAttribute(resource->mutable_attributes(), "service.name", "first");
+    addStringAttribute(resource->mutable_attributes(), "host.name", "host-1");
+    addStringAttribute(resource->mutable_attributes(), "service.name", "checkout");
+    auto* attr = resource->add_attributes();
+    attr->set_key("deployment.environment");
+    attr->mutable_value()->set_int_value(3);
+    addStringAttribute(resource->mutable_attributes(), "k8s.pod.uid", "pod-\"quoted\"\n\xC3\xA9");
+    resource_logs->set_schema_url("https://opentelemetry.io/schemas/1.21.0");
+
+    auto* scope_logs = resource_logs->add_scope_logs();
+    scope_logs->mutable_scope()->set_name("io.opentelemetry.test");
+    addStringAttribute(scope_logs->mutable_scope()->mutable_attributes(), "scope.attr", "ignored");
+
+    auto* record = scope_logs->add_log_records();
+    record->set_time_unix_nano(1672531200123456789ULL);
+    record->set_severity_number(opentelemetry::proto::logs::v1::SEVERITY_NUMBER_WARN);
+    record->set_flags(1);
+    record->set_dropped_attributes_count(2);
+    record->mutable_body()->set_string_value("disk almost full");
+    record->set_trace_id(std::string("\x01\x23\x45\x67\x89\xab\xcd\xef\x01\x23\x45\x67\x89\xab\xcd\xef", 16));
+    record->set_span_id(std::string("\xfe\xdc\xba\x98\x76\x54\x32\x10", 8));
+    attr = record->add_attributes();
+    attr->set_key("int");
+    attr->mutable_value()->set_int_value(-9007199254740993LL);
+    attr = record->add_attributes();
+    attr->set_key("double");
+    attr->mutable_value()->set_double_value(-0.125);
+    attr = record->add_attributes();
+    attr->set_key("bool");
+    attr->mutable_value()->set_bool_value(true);
+    attr = record->add_attributes();
+    attr->set_key("bytes");
+    attr->mutable_value()->set_bytes_value(std::string("\x00\xff\x10", 3));
+    attr = record->add_attributes();
+    attr->set_key("array");
+    auto* array = attr->mutable_value()->mutable_array_value();
+    array->add_values()->set_string_value("a");
+    array->add_values()->set_int_value(2);
+    array->add_values();
+    array->add_values()->mutable_kvlist_value()->add_values()->set_key("nested");
+    attr = record->add_attributes();
+    attr->set_key("kvlist");
+    auto* kv = attr->mutable_value()->mutable_kvlist_value()->add_values();
+    kv->set_key("inner");
+    kv->mutable_value()->set_bool_value(false);
+    attr = record->add_attributes();
+    attr->set_key("no.value");
+    attr = record->add_attributes();
+    attr->set_key("int");
+    attr->mutable_value()->set_int_value(7);
+
+    record = scope_logs->add_log_records();
+    record->set_observed_time_unix_nano(1672531201000000000ULL);
+    record->set_severity_text("error");
+    record->set_severity_number(opentelemetry::proto::logs::v1::SEVERITY_NUMBER_INFO);
+    record->mutable_body()->mutable_kvlist_value()->add_values()->set_key("empty");
+
+    // Resource without records is skipped
+    addStringAttribute(request.add_resource_logs()->mutable_resource()->mutable_attributes(), "orphan", "x");
+
+    auto* second = request.add_resource_logs();
+    addStringAttribute(second->mutable_resource()->mutable_attributes(), "service.name", "payments");
+    second->add_scope_logs();
+    record = second->add_scope_logs()->add_log_records();
+    record->set_time_unix_nano(1672531202000000000ULL);
+    record->mutable_body()->set_string_value("second resource");
+
+    return request;
+}
+
+#endif // OTLP_TEST_HELPERS_HPP
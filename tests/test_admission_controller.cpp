@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "ingester/admission_controller.hpp"
+#include <chrono>
+#include <thread>
+
+namespace {
+
+constexpr size_t kMB = 1024 * 1024;
+
+// Adjust on every delivery report so tests need not wait out a window
+AdmissionController::Options testOptions() {
+    AdmissionController::Options options;
+    options.max_bytes = 100 * kMB;
+    options.min_bytes = 10 * kMB;
+    options.target_latency = std::chrono::milliseconds(100);
+    options.window = std::chrono::milliseconds(0);
+    options.increase_fraction = 0.1;
+    options.decrease_factor = 0.5;
+    options.max_retry_after_seconds = 30;
+    return options;
+}
+
+}  // namespace
+
+TEST(AdmissionControllerTest, AdmitsUpToLimit) {
+    AdmissionController admission(testOptions());
+    EXPECT_EQ(admission.getLimitBytes(), 100 * kMB);
+    EXPECT_FALSE(admission.isSaturated());
+
+    EXPECT_TRUE(admission.admits(60 * kMB));
+    admission.acquire(60 * kMB);
+    EXPECT_TRUE(admission.admits(40 * kMB));
+    EXPECT_FALSE(admission.admits(41 * kMB));
+
+    admission.acquire(40 * kMB);
+    EXPECT_TRUE(admission.isSaturated());
+    EXPECT_EQ(admission.getInFlightBytes(), 100 * kMB);
+
+    // Bytes that never reached Kafka do not count as deliveries
+    admission.cancel(40 * kMB);
+    EXPECT_EQ(admission.getInFlightBytes(), 60 * kMB);
+    EXPECT_EQ(admission.getLimitBytes(), 100 * kMB);
+}
+
+TEST(AdmissionControllerTest, AlwaysAdmitsWhenIdle) {
+    AdmissionController admission(testOptions());
+    // A request larger than the limit still goes through on its own
+    EXPECT_TRUE(admission.admits(500 * kMB));
+    admission.acquire(500 * kMB);
+    EXPECT_FALSE(admission.admits(1));
+}
+
+TEST(AdmissionControllerTest, DecreasesOnSlowDeliveries) {
+    AdmissionController admission(testOptions());
+
+    admission.acquire(kMB);
+    admission.release(kMB, 200000, true);
+    EXPECT_EQ(admission.getLimitBytes(), 50 * kMB);
+
+    admission.acquire(kMB);
+    admission.release(kMB, 200000, true);
+    EXPECT_EQ(admission.getLimitBytes(), 25 * kMB);
+
+    // Never below min_bytes
+    for (int i = 0; i < 10; ++i) {
+        admission.acquire(kMB);
+        admission.release(kMB, 200000, true);
+    }
+    EXPECT_EQ(admission.getLimitBytes(), 10 * kMB);
+    EXPECT_EQ(admission.getInFlightBytes(), 0u);
+}
+
+TEST(AdmissionControllerTest, DecreasesOnFailedDeliveries) {
+    AdmissionController admission(testOptions());
+    admission.acquire(kMB);
+    admission.release(kMB, 1000, false);
+    EXPECT_EQ(admission.getLimitBytes(), 50 * kMB);
+}
+
+TEST(AdmissionControllerTest, IncreasesAdditivelyWhenFast) {
+    AdmissionController admission(testOptions());
+    admission.acquire(kMB);
+    admission.release(kMB, 500000, true);
+    ASSERT_EQ(admission.getLimitBytes(), 50 * kMB);
+
+    // Each fast window adds 10% of max_bytes
+    admission.acquire(kMB);
+    admission.release(kMB, 1000, true);
+    EXPECT_EQ(admission.getLimitBytes(), 60 * kMB);
+
+    // Never above max_bytes
+    for (int i = 0; i < 10; ++i) {
+        admission.acquire(kMB);
+        admission.release(kMB, 1000, true);
+    }
+    EXPECT_EQ(admission.getLimitBytes(), 100 * kMB);
+}
+
+TEST(AdmissionControllerTest, AdjustsOncePerWindow) {
+    auto options = testOptions();
+    options.window = std::chrono::milliseconds(50);
+    AdmissionController admission(options);
+
+    // Reports within a window are averaged into one adjustment
+    for (int i = 0; i < 5; ++i) {
+        admission.acquire(kMB);
+        admission.release(kMB, 200000, true);
+    }
+    EXPECT_EQ(admission.getLimitBytes(), 100 * kMB);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    admission.acquire(kMB);
+    admission.release(kMB, 200000, true);
+    EXPECT_EQ(admission.getLimitBytes(), 50 * kMB);
+}
+
+TEST(AdmissionControllerTest, RetryAfterFollowsAckRate) {
+    auto options = testOptions();
+    options.window = std::chrono::milliseconds(20);
+    AdmissionController admission(options);
+
+    // Nothing in flight: retry right away
+    EXPECT_EQ(admission.retryAfterSeconds(), 1);
+
+    // No acknowledgements seen yet: the longest wait
+    admission.acquire(50 * kMB);
+    EXPECT_EQ(admission.retryAfterSeconds(), 30);
+
+    // About 1MB acknowledged in a ~20ms window is tens of MB/s, so 50MB
+    // in flight drains within a few seconds
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    admission.acquire(kMB);
+    admission.release(kMB, 1000, true);
+    int retry_after = admission.retryAfterSeconds();
+    EXPECT_GE(retry_after, 1);
+    EXPECT_LT(retry_after, 30);
+}
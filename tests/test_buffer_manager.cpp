@@ -2,6 +2,9 @@
 #include "../src/appender/buffer_manager.hpp"
 #include <thread>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
 
 TEST(BufferManagerTest, SizeThreshold) {
     BufferManager manager(1024, 60); // 1KB or 60 seconds
@@ -47,3 +50,99 @@ TEST(BufferManagerTest, TimeSinceReset) {
     EXPECT_GE(time2.count(), time1.count());
 }
 
+TEST(BufferManagerTest, TracksUsagePerConsumer) {
+    BufferManager budget(1000, 60);
+    auto now = std::chrono::system_clock::now();
+
+    budget.setUsage(0, 300, 300, now);
+    budget.setUsage(1, 500, 500, now);
+    EXPECT_EQ(budget.getCurrentSize(), 800u);
+
+    // A new report replaces the previous one
+    budget.setUsage(0, 100, 100, now);
+    EXPECT_EQ(budget.getCurrentSize(), 600u);
+    EXPECT_EQ(budget.getUsage(0), 100u);
+
+    budget.removeUsage(1);
+    EXPECT_EQ(budget.getCurrentSize(), 100u);
+    EXPECT_EQ(budget.getUsage(1), 0u);
+
+    budget.reset();
+    EXPECT_EQ(budget.getCurrentSize(), 0u);
+    EXPECT_EQ(budget.getUsage(0), 0u);
+}
+
+TEST(BufferManagerTest, SelectsLargestBuffersFirst) {
+    BufferManager budget(1000, 60);
+    auto now = std::chrono::system_clock::now();
+    budget.setUsage(0, 100, 100, now - std::chrono::seconds(30));
+    budget.setUsage(1, 400, 400, now);
+    budget.setUsage(2, 250, 250, now - std::chrono::seconds(10));
+    budget.setUsage(3, 0, 0, now - std::chrono::seconds(60));  // Nothing to flush
+
+    auto targets = budget.selectFlushTargets(500, BufferManager::FlushPolicy::LARGEST);
+    EXPECT_EQ(targets, (std::vector<int32_t>{1, 2}));
+
+    targets = budget.selectFlushTargets(10000, BufferManager::FlushPolicy::LARGEST);
+    EXPECT_EQ(targets, (std::vector<int32_t>{1, 2, 0}));
+
+    EXPECT_TRUE(budget.selectFlushTargets(0, BufferManager::FlushPolicy::LARGEST).empty());
+}
+
+TEST(BufferManagerTest, SelectsOldestBuffersFirst) {
+    BufferManager budget(1000, 60);
+    auto now = std::chrono::system_clock::now();
+    budget.setUsage(0, 100, 100, now - std::chrono::seconds(30));
+    budget.setUsage(1, 400, 400, now);
+    budget.setUsage(2, 250, 250, now - std::chrono::seconds(10));
+
+    auto targets = budget.selectFlushTargets(300, BufferManager::FlushPolicy::OLDEST);
+    EXPECT_EQ(targets, (std::vector<int32_t>{0, 2}));
+
+    EXPECT_EQ(BufferManager::parseFlushPolicy("oldest"), BufferManager::FlushPolicy::OLDEST);
+    EXPECT_EQ(BufferManager::parseFlushPolicy("largest"), BufferManager::FlushPolicy::LARGEST);
+    EXPECT_EQ(BufferManager::parseFlushPolicy(""), BufferManager::FlushPolicy::LARGEST);
+}
+
+TEST(BufferManagerTest, SelectsByFlushableBytes) {
+    BufferManager budget(1000, 60);
+    auto now = std::chrono::system_clock::now();
+    budget.setUsage(0, 600, 50, now);   // Mostly queued or waiting on Iceberg
+    budget.setUsage(1, 300, 200, now);
+    budget.setUsage(2, 100, 5, now);    // Active buffer just started
+    EXPECT_EQ(budget.getCurrentSize(), 1000u);
+
+    auto targets = budget.selectFlushTargets(220, BufferManager::FlushPolicy::LARGEST);
+    EXPECT_EQ(targets, (std::vector<int32_t>{1, 0}));
+
+    // Small active buffers are left to fill up
+    targets = budget.selectFlushTargets(10000, BufferManager::FlushPolicy::LARGEST, 10);
+    EXPECT_EQ(targets, (std::vector<int32_t>{1, 0}));
+    EXPECT_TRUE(budget.selectFlushTargets(10000, BufferManager::FlushPolicy::OLDEST, 500).empty());
+}
+
+TEST(BufferManagerTest, ReadsCgroupMemoryLimit) {
+    std::string root = "/tmp/buffer_manager_test_cgroup_" + std::to_string(getpid());
+    std::filesystem::create_directories(root + "/memory");
+    auto write = [](const std::string& path, const std::string& value) {
+        std::ofstream out(path, std::ios::trunc);
+        out << value << "\n";
+    };
+
+    // Nothing to read
+    EXPECT_EQ(BufferManager::readCgroupMemoryLimit(root), 0u);
+
+    // cgroup v1, unlimited is reported as a huge page-rounded value
+    write(root + "/memory/memory.limit_in_bytes", "9223372036854771712");
+    EXPECT_EQ(BufferManager::readCgroupMemoryLimit(root), 0u);
+    write(root + "/memory/memory.limit_in_bytes", "2147483648");
+    EXPECT_EQ(BufferManager::readCgroupMemoryLimit(root), 2147483648u);
+
+    // cgroup v2 takes precedence
+    write(root + "/memory.max", "1073741824");
+    EXPECT_EQ(BufferManager::readCgroupMemoryLimit(root), 1073741824u);
+    write(root + "/memory.max", "max");
+    EXPECT_EQ(BufferManager::readCgroupMemoryLimit(root), 0u);
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "../src/appender/commit_aggregator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Records every commit made through the aggregator
+struct RecordingCommitter {
+    std::mutex mutex;
+    std::vector<std::vector<IcebergDataFile>> files;
+    std::vector<std::map<int32_t, int64_t>> offsets;
+    std::atomic<bool> fail{false};
+
+    CommitAggregator::CommitFunction function() {
+        return [this](const std::vector<IcebergDataFile>& batch_files, const std::map<int32_t, int64_t>& batch_offsets) {
+            std::lock_guard<std::mutex> lock(mutex);
+            files.push_back(batch_files);
+            offsets.push_back(batch_offsets);
+            return !fail.load();
+        };
+    }
+
+    size_t commits() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return files.size();
+    }
+};
+
+IcebergDataFile dataFile(int32_t partition) {
+    IcebergDataFile file;
+    file.file_path = "s3://bucket/logs/data/" + std::to_string(partition) + ".parquet";
+    file.record_count = 10;
+    return file;
+}
+
+// Submit one file per partition from concurrent flush threads
+// Returns how many submissions were committed
+int submitAll(CommitAggregator& aggregator, int partitions) {
+    std::atomic<int> committed{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < partitions; ++p) {
+        threads.emplace_back([&, p]() {
+            if (aggregator.submit(p, dataFile(p), 100 + p, false)) {
+                committed++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return committed.load();
+}
+
+}  // namespace
+
+TEST(CommitAggregatorTest, CoalescesPartitionsIntoOneSnapshot) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 300;
+    RecordingCommitter committer;
+    CommitAggregator aggregator(config, committer.function());
+    aggregator.start();
+
+    EXPECT_EQ(submitAll(aggregator, 8), 8);
+
+    ASSERT_EQ(committer.commits(), 1u);
+    EXPECT_EQ(committer.files[0].size(), 8u);
+    ASSERT_EQ(committer.offsets[0].size(), 8u);
+    EXPECT_EQ(committer.offsets[0].at(3), 103);
+    EXPECT_EQ(aggregator.getCommitCount(), 1u);
+    EXPECT_EQ(aggregator.getCommittedFileCount(), 8u);
+}
+
+TEST(CommitAggregatorTest, KeepsHighestOffsetPerPartition) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 300;
+    RecordingCommitter committer;
+    CommitAggregator aggregator(config, committer.function());
+    aggregator.start();
+
+    std::thread low([&]() { EXPECT_TRUE(aggregator.submit(0, dataFile(0), 5, false)); });
+    std::thread high([&]() { EXPECT_TRUE(aggregator.submit(0, dataFile(0), 9, false)); });
+    std::thread none([&]() { EXPECT_TRUE(aggregator.submit(1, dataFile(1), -1, false)); });
+    low.join();
+    high.join();
+    none.join();
+
+    ASSERT_EQ(committer.commits(), 1u);
+    EXPECT_EQ(committer.files[0].size(), 3u);
+    ASSERT_EQ(committer.offsets[0].size(), 1u);
+    EXPECT_EQ(committer.offsets[0].at(0), 9);
+}
+
+TEST(CommitAggregatorTest, ForcedFlushDoesNotWaitForInterval) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 60000;
+    RecordingCommitter committer;
+    CommitAggregator aggregator(config, committer.function());
+    aggregator.start();
+
+    auto started = std::chrono::steady_clock::now();
+    EXPECT_TRUE(aggregator.submit(0, dataFile(0), 1, true));
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(5));
+    EXPECT_EQ(committer.commits(), 1u);
+}
+
+TEST(CommitAggregatorTest, CommitsEarlyAtMaxFiles) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 60000;
+    config.iceberg_commit_max_files = 4;
+    RecordingCommitter committer;
+    CommitAggregator aggregator(config, committer.function());
+    aggregator.start();
+
+    EXPECT_EQ(submitAll(aggregator, 4), 4);
+    ASSERT_EQ(committer.commits(), 1u);
+    EXPECT_EQ(committer.files[0].size(), 4u);
+}
+
+TEST(CommitAggregatorTest, FailedCommitFailsEveryWaiter) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 200;
+    RecordingCommitter committer;
+    committer.fail = true;
+    CommitAggregator aggregator(config, committer.function());
+    aggregator.start();
+
+    EXPECT_EQ(submitAll(aggregator, 3), 0);
+    EXPECT_EQ(aggregator.getCommitCount(), 0u);
+    size_t attempts = committer.commits();
+    EXPECT_GT(attempts, 1u);  // Split and retried before giving up
+
+    // Resubmitted files go into the next snapshot
+    committer.fail = false;
+    EXPECT_EQ(submitAll(aggregator, 3), 3);
+    ASSERT_EQ(committer.commits(), attempts + 1);
+    EXPECT_EQ(committer.files[attempts].size(), 3u);
+    EXPECT_EQ(aggregator.getCommitCount(), 1u);
+}
+
+TEST(CommitAggregatorTest, RejectedFileHoldsBackOnlyItsPartition) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 200;
+    CommitAggregator aggregator(config, [](const std::vector<IcebergDataFile>& files,
+                                           const std::map<int32_t, int64_t>&) {
+        // The catalog refuses any snapshot with partition 5's file in it
+        return std::none_of(files.begin(), files.end(), [](const IcebergDataFile& file) {
+            return file.file_path == dataFile(5).file_path;
+        });
+    });
+    aggregator.start();
+
+    std::vector<int> results(8, 0);  // Not vector<bool>: written from several threads
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 8; ++p) {
+        threads.emplace_back([&, p]() { results[p] = aggregator.submit(p, dataFile(p), 100 + p, false); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int p = 0; p < 8; ++p) {
+        EXPECT_EQ(results[p] != 0, p != 5) << "partition " << p;
+    }
+    EXPECT_EQ(aggregator.getCommittedFileCount(), 7u);
+    EXPECT_LE(aggregator.getCommitCount(), 3u);  // The others still share snapshots
+}
+
+TEST(CommitAggregatorTest, StopCommitsPendingFiles) {
+    AppenderConfig config;
+    config.iceberg_commit_interval_ms = 60000;
+    RecordingCommitter committer;
+    CommitAggregator aggregator(config, committer.function());
+    aggregator.start();
+
+    std::atomic<bool> result{false};
+    std::thread flush([&]() { result = aggregator.submit(0, dataFile(0), 7, false); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    aggregator.stop();
+    flush.join();
+    EXPECT_TRUE(result);
+
+    // Without the commit thread each submission commits on its own
+    EXPECT_TRUE(aggregator.submit(1, dataFile(1), 8, false));
+    ASSERT_EQ(committer.commits(), 2u);
+    EXPECT_EQ(committer.offsets[1].at(1), 8);
+}
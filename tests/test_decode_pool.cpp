@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "../src/appender/decode_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(DecodePoolTest, PreservesOrderPerPartition) {
+    DecodePool pool(4);
+    pool.start();
+
+    std::mutex mutex;
+    std::map<int32_t, std::vector<int>> seen;
+
+    for (int i = 0; i < 200; ++i) {
+        for (int32_t partition = 0; partition < 8; ++partition) {
+            pool.submit(partition, [&, partition, i]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen[partition].push_back(i);
+            });
+        }
+    }
+
+    pool.waitIdle();
+    pool.stop();
+
+    ASSERT_EQ(seen.size(), 8u);
+    for (const auto& kv : seen) {
+        ASSERT_EQ(kv.second.size(), 200u);
+        for (int i = 0; i < 200; ++i) {
+            EXPECT_EQ(kv.second[i], i) << "partition " << kv.first;
+        }
+    }
+}
+
+TEST(DecodePoolTest, PartitionsRunInParallel) {
+    DecodePool pool(2);
+    pool.start();
+
+    // Partition 0 blocks until partition 1 has run; deadlocks if both share a thread
+    std::atomic<bool> other_ran{false};
+    pool.submit(0, [&]() {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!other_ran && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    pool.submit(1, [&]() { other_ran = true; });
+
+    pool.waitIdle();
+    pool.stop();
+
+    EXPECT_TRUE(other_ran);
+}
+
+TEST(DecodePoolTest, StopDrainsQueuedTasks) {
+    DecodePool pool(2);
+    pool.start();
+
+    std::atomic<int> completed{0};
+    for (int i = 0; i < 100; ++i) {
+        pool.submit(i, [&]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            completed++;
+        });
+    }
+
+    pool.stop();
+
+    EXPECT_EQ(completed.load(), 100);
+    EXPECT_EQ(pool.getPendingTaskCount(), 0u);
+}
+
+TEST(DecodePoolTest, TaskExceptionDoesNotStopPool) {
+    DecodePool pool(1);
+    pool.start();
+
+    std::atomic<bool> ran{false};
+    pool.submit(0, []() { throw std::runtime_error("bad message"); });
+    pool.submit(0, [&]() { ran = true; });
+
+    pool.waitIdle();
+    pool.stop();
+
+    EXPECT_TRUE(ran);
+}
+
+TEST(DecodePoolTest, ZeroThreadsUsesOne) {
+    DecodePool pool(0);
+    EXPECT_EQ(pool.getThreadCount(), 1u);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "ingester/grpc_server.hpp"
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <future>
+#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
+
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceResponse;
+
+// Test fixture for gRPC server tests (no queue producer)
+class GrpcServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        IngesterConfig config;
+        config.max_decompressed_size_mb = 1;
+        server = std::make_unique<GrpcServer>(nullptr, config);
+        ASSERT_TRUE(server->start("127.0.0.1", 0));
+        ASSERT_GT(server->port(), 0);
+
+        channel = grpc::CreateChannel("127.0.0.1:" + std::to_string(server->port()),
+                                      grpc::InsecureChannelCredentials());
+        stub = std::make_unique<grpc::GenericStub>(channel);
+    }
+
+    void TearDown() override {
+        server->shutdown();
+    }
+
+    grpc::Status call(const std::string& method, const std::string& body, std::string& response) {
+        grpc::Slice slice(body);
+        grpc::ByteBuffer request(&slice, 1);
+        grpc::ByteBuffer reply;
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+
+        std::promise<grpc::Status> done;
+        stub->UnaryCall(&context, method, grpc::StubOptions(), &request, &reply,
+                        [&done](grpc::Status status) { done.set_value(status); });
+        grpc::Status status = done.get_future().get();
+
+        response.clear();
+        std::vector<grpc::Slice> slices;
+        if (status.ok() && reply.Dump(&slices).ok()) {
+            for (const auto& s : slices) {
+                response.append(reinterpret_cast<const char*>(s.begin()), s.size());
+            }
+        }
+        return status;
+    }
+
+    std::unique_ptr<GrpcServer> server;
+    std::shared_ptr<grpc::Channel> channel;
+    std::unique_ptr<grpc::GenericStub> stub;
+};
+
+TEST_F(GrpcServerTest, ExportsLogs) {
+    ExportLogsServiceRequest request;
+    auto* log_record = request.add_resource_logs()->add_scope_logs()->add_log_records();
+    log_record->set_time_unix_nano(1234567890);
+    log_record->mutable_body()->set_string_value("Test log message");
+
+    std::string response;
+    grpc::Status status = call(GrpcServer::kExportMethod, request.SerializeAsString(), response);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+
+    ExportLogsServiceResponse resp_msg;
+    EXPECT_TRUE(resp_msg.ParseFromString(response));
+    EXPECT_FALSE(resp_msg.has_partial_success());
+}
+
+TEST_F(GrpcServerTest, RejectsUnknownMethod) {
+    std::string response;
+    grpc::Status status = call("/opentelemetry.proto.collector.trace.v1.TraceService/Export", "", response);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::UNIMPLEMENTED);
+}
+
+TEST_F(GrpcServerTest, RejectsOversizedRequest) {
+    std::string response;
+    grpc::Status status = call(GrpcServer::kExportMethod, std::string(2 * 1024 * 1024, 'x'), response);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+}
+
+TEST(GrpcServerRetryInfoTest, EncodesStatusWithRetryInfo) {
+    std::string details = GrpcServer::retryInfoDetails(8, "Queue is at capacity", 7);
+
+    // google.rpc.Status
+    google::protobuf::UnknownFieldSet status;
+    ASSERT_TRUE(status.ParseFromString(details));
+    ASSERT_EQ(status.field_count(), 3);
+    EXPECT_EQ(status.field(0).number(), 1);
+    EXPECT_EQ(status.field(0).varint(), 8u);
+    EXPECT_EQ(status.field(1).length_delimited(), "Queue is at capacity");
+
+    // google.protobuf.Any
+    google::protobuf::UnknownFieldSet any;
+    ASSERT_TRUE(any.ParseFromString(status.field(2).length_delimited()));
+    ASSERT_EQ(any.field_count(), 2);
+    EXPECT_EQ(any.field(0).length_delimited(), "type.googleapis.com/google.rpc.RetryInfo");
+
+    // google.rpc.RetryInfo.retry_delay.seconds
+    google::protobuf::UnknownFieldSet retry_info;
+    ASSERT_TRUE(retry_info.ParseFromString(any.field(1).length_delimited()));
+    google::protobuf::UnknownFieldSet duration;
+    ASSERT_TRUE(duration.ParseFromString(retry_info.field(0).length_delimited()));
+    EXPECT_EQ(duration.field(0).number(), 1);
+    EXPECT_EQ(duration.field(0).varint(), 7u);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "gzip_decompressor.hpp"
+#include <zlib.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string compressGzip(const std::string& in) {
+    z_stream strm{};
+    // 16 + MAX_WBITS to enable gzip encoding
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::string();
+    }
+
+    std::string out(deflateBound(&strm, in.size()), '\0');
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    strm.avail_in = static_cast<uInt>(in.size());
+    strm.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    strm.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&strm, Z_FINISH);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+    return ret == Z_STREAM_END ? out : std::string();
+}
+
+std::string randomText(size_t size) {
+    std::mt19937 rng(42);
+    std::string text(size, ' ');
+    for (auto& c : text) {
+        c = static_cast<char>('a' + rng() % 16);
+    }
+    return text;
+}
+
+std::vector<GzipDecompressor::Backend> availableBackends() {
+    std::vector<GzipDecompressor::Backend> backends;
+    for (auto backend : {GzipDecompressor::Backend::ZLIB, GzipDecompressor::Backend::LIBDEFLATE}) {
+        if (GzipDecompressor::isAvailable(backend)) {
+            backends.push_back(backend);
+        }
+    }
+    return backends;
+}
+
+}  // namespace
+
+TEST(GzipDecompressorTest, RoundTrip) {
+    for (auto backend : availableBackends()) {
+        for (size_t size : {0u, 1u, 4096u, 100000u, 3u << 20}) {
+            std::string original = randomText(size);
+            std::string out = "stale";
+            EXPECT_EQ(GzipDecompressor::decompress(compressGzip(original), out, 64 << 20, backend),
+                      GzipResult::SUCCESS) << size;
+            EXPECT_EQ(out, original) << size;
+        }
+    }
+}
+
+TEST(GzipDecompressorTest, EmptyInput) {
+    std::string out = "stale";
+    EXPECT_EQ(GzipDecompressor::decompress("", out, 1024), GzipResult::SUCCESS);
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(GzipDecompressorTest, EnforcesMaxSize) {
+    // Highly compressible: 8 MB of zeros is a few KB of gzip
+    std::string bomb = compressGzip(std::string(8 << 20, '\0'));
+
+    for (auto backend : availableBackends()) {
+        std::string out;
+        EXPECT_EQ(GzipDecompressor::decompress(bomb, out, 1 << 20, backend), GzipResult::TOO_LARGE);
+
+        // Exactly at the limit is allowed, one byte over is not
+        EXPECT_EQ(GzipDecompressor::decompress(bomb, out, 8 << 20, backend), GzipResult::SUCCESS);
+        EXPECT_EQ(out.size(), 8u << 20);
+        EXPECT_EQ(GzipDecompressor::decompress(bomb, out, (8 << 20) - 1, backend), GzipResult::TOO_LARGE);
+    }
+}
+
+TEST(GzipDecompressorTest, WrongIsizeTrailer) {
+    std::string original = randomText(200000);
+    std::string compressed = compressGzip(original);
+
+    // Trailer claims 16 bytes: ISIZE is only a hint, output still grows
+    std::string lying = compressed;
+    lying[lying.size() - 4] = 16;
+    lying[lying.size() - 3] = 0;
+    lying[lying.size() - 2] = 0;
+    lying[lying.size() - 1] = 0;
+    EXPECT_EQ(GzipDecompressor::expectedSize(lying, 1 << 20), 16u);
+
+    for (auto backend : availableBackends()) {
+        std::string out;
+        // The decompressed data does not match the trailer, so the stream is rejected
+        EXPECT_EQ(GzipDecompressor::decompress(lying, out, 1 << 20, backend), GzipResult::INVALID);
+        EXPECT_EQ(GzipDecompressor::decompress(compressed, out, 1 << 20, backend), GzipResult::SUCCESS);
+        EXPECT_EQ(out, original);
+    }
+}
+
+TEST(GzipDecompressorTest, ExpectedSizeIsBounded) {
+    std::string compressed = compressGzip(randomText(1000));
+    compressed[compressed.size() - 1] = static_cast<char>(0xff);
+
+    // Trailer claims ~4 GB: capped by max_size and by the deflate expansion bound
+    EXPECT_EQ(GzipDecompressor::expectedSize(compressed, 100000), 100000u);
+    EXPECT_EQ(GzipDecompressor::expectedSize(compressed, SIZE_MAX), compressed.size() * 1032);
+    EXPECT_EQ(GzipDecompressor::expectedSize("short", 1 << 20), 0u);
+}
+
+TEST(GzipDecompressorTest, RejectsInvalidInput) {
+    std::string compressed = compressGzip(randomText(10000));
+
+    for (auto backend : availableBackends()) {
+        std::string out;
+        EXPECT_EQ(GzipDecompressor::decompress("invalid gzip data", out, 1 << 20, backend), GzipResult::INVALID);
+        EXPECT_EQ(GzipDecompressor::decompress(compressed.substr(0, compressed.size() / 2), out, 1 << 20, backend),
+                  GzipResult::INVALID);
+
+        std::string corrupt = compressed;
+        corrupt[compressed.size() / 2] ^= 0x55;
+        EXPECT_NE(GzipDecompressor::decompress(corrupt, out, 1 << 20, backend), GzipResult::SUCCESS);
+
+        // State is reset between calls
+        EXPECT_EQ(GzipDecompressor::decompress(compressed, out, 1 << 20, backend), GzipResult::SUCCESS);
+    }
+}
@@ -283,6 +283,23 @@ TEST_F(HttpServerTest, RejectsUnsupportedMediaType) {
     EXPECT_EQ(res.code, 415);
 }
 
+// Test stats endpoint without a queue producer
+TEST_F(HttpServerTest, StatsWithoutProducer) {
+    crow::request req;
+    req.url = "/stats";
+    req.method = "GET"_method;
+
+    crow::response res;
+    app.handle_full(req, res);
+
+    EXPECT_EQ(res.code, 200);
+    auto stats = crow::json::load(res.body);
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats["in_flight"].i(), 0);
+    EXPECT_EQ(stats["in_flight_bytes"].i(), 0);
+    EXPECT_FALSE(stats["spill_enabled"].b());
+}
+
 // Test invalid protobuf payload - now accepted (validation deferred to consumer)
 TEST_F(HttpServerTest, AcceptsInvalidProtobufPayload) {
     crow::request req;
@@ -355,6 +372,78 @@ TEST_F(HttpServerTest, HandlesEmptyGzipPayload) {
     EXPECT_EQ(res.code, 200);
 }
 
+// Test gzip payloads that inflate past the configured limit are rejected
+TEST(HttpServerLimitTest, RejectsOversizedGzipPayload) {
+    IngesterConfig config;
+    config.max_decompressed_size_mb = 1;
+    HttpServer server(nullptr, config);
+    crow::SimpleApp app;
+    server.setupRoutes(app);
+    app.validate();
+
+    crow::request req;
+    req.url = "/v1/logs";
+    req.method = "POST"_method;
+    req.body = compressGzip(std::string(2 * 1024 * 1024, 'a'));
+    req.add_header("Content-Type", "application/json");
+    req.add_header("Content-Encoding", "gzip");
+
+    crow::response res;
+    app.handle_full(req, res);
+
+    EXPECT_EQ(res.code, 413);
+
+    // Within the limit is accepted
+    crow::request small_req;
+    small_req.url = "/v1/logs";
+    small_req.method = "POST"_method;
+    small_req.body = compressGzip(std::string(1024 * 1024, 'a'));
+    small_req.add_header("Content-Type", "application/json");
+    small_req.add_header("Content-Encoding", "gzip");
+
+    crow::response small_res;
+    app.handle_full(small_req, small_res);
+
+    EXPECT_EQ(small_res.code, 200);
+}
+
+// Test pass-through mode forwards gzip bodies without inflating them
+TEST(HttpServerLimitTest, PassthroughSkipsDecompression) {
+    IngesterConfig config;
+    config.max_decompressed_size_mb = 1;
+    config.passthrough_compression = true;
+    HttpServer server(nullptr, config);
+    crow::SimpleApp app;
+    server.setupRoutes(app);
+    app.validate();
+
+    // Over the limit once inflated, but the ingester never inflates it
+    crow::request req;
+    req.url = "/v1/logs";
+    req.method = "POST"_method;
+    req.body = compressGzip(std::string(2 * 1024 * 1024, 'a'));
+    req.add_header("Content-Type", "application/json");
+    req.add_header("Content-Encoding", "gzip");
+
+    crow::response res;
+    app.handle_full(req, res);
+
+    EXPECT_EQ(res.code, 200);
+
+    // Bodies that are not gzip at all are still rejected up front
+    crow::request bad_req;
+    bad_req.url = "/v1/logs";
+    bad_req.method = "POST"_method;
+    bad_req.body = "invalid gzip data";
+    bad_req.add_header("Content-Type", "application/json");
+    bad_req.add_header("Content-Encoding", "gzip");
+
+    crow::response bad_res;
+    app.handle_full(bad_req, bad_res);
+
+    EXPECT_EQ(bad_res.code, 400);
+}
+
 // Test Content-Encoding case insensitivity
 TEST_F(HttpServerTest, HandlesCaseInsensitiveContentEncoding) {
     ExportLogsServiceRequest request;
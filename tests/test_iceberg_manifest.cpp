@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include "appender/avro.hpp"
+#include "appender/iceberg_manifest.hpp"
+#include "appender/json_value.hpp"
+#include <zlib.h>
+#include <stdexcept>
+
+namespace {
+
+const char* kTableSchema = R"({"type":"struct","schema-id":0,"fields":[
+{"id":1,"name":"_kafka_topic","required":false,"type":"string"},
+{"id":3,"name":"_kafka_offset","required":false,"type":"long"}]})";
+
+std::string deflateRaw(const std::string& data) {
+    z_stream stream{};
+    EXPECT_EQ(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Z_OK);
+    std::string out(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    EXPECT_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+}  // namespace
+
+TEST(JsonValueTest, ParsesAndDumps) {
+    JsonValue doc = JsonValue::parse(
+        R"({"id": 9223372036854775807, "neg": -5, "pi": 2.5, "ok": true, "none": null,
+            "name": "a\"b\\cé\n", "list": [1, "two", {}], "empty": []})");
+
+    EXPECT_EQ(doc["id"].asInt(), INT64_MAX);
+    EXPECT_EQ(doc["neg"].asInt(), -5);
+    EXPECT_DOUBLE_EQ(doc["pi"].asDouble(), 2.5);
+    EXPECT_TRUE(doc["ok"].asBool());
+    EXPECT_TRUE(doc["none"].isNull());
+    EXPECT_EQ(doc["name"].asString(), "a\"b\\c\xc3\xa9\n");
+    ASSERT_EQ(doc["list"].size(), 3u);
+    EXPECT_EQ(doc["list"].items()[1].asString(), "two");
+    EXPECT_TRUE(doc["missing"]["nested"].isNull());
+    EXPECT_EQ(doc["missing"].asInt(-1), -1);
+
+    // Member order survives a round trip
+    JsonValue again = JsonValue::parse(doc.dump());
+    EXPECT_EQ(again.dump(), doc.dump());
+    EXPECT_EQ(again.members().front().first, "id");
+    EXPECT_EQ(again["id"].asInt(), INT64_MAX);
+}
+
+TEST(JsonValueTest, SetReplacesMembers) {
+    JsonValue object = JsonValue::object();
+    object.set("a", 1);
+    object.set("b", "x");
+    object.set("a", 2);
+    EXPECT_EQ(object.dump(), R"({"a":2,"b":"x"})");
+    EXPECT_EQ(JsonValue("42").asInt(), 42);  // Summary values are strings
+}
+
+TEST(JsonValueTest, RejectsMalformedInput) {
+    EXPECT_THROW(JsonValue::parse("{"), std::runtime_error);
+    EXPECT_THROW(JsonValue::parse("[1,]"), std::runtime_error);
+    EXPECT_THROW(JsonValue::parse(R"({"a":1} x)"), std::runtime_error);
+    EXPECT_THROW(JsonValue::parse(R"("\x")"), std::runtime_error);
+}
+
+TEST(AvroTest, RoundTripsRecords) {
+    // "again" refers to the record type defined inside "a"
+    JsonValue schema = JsonValue::parse(R"({"type":"record","name":"r","fields":[
+        {"name":"n","type":"long"},
+        {"name":"s","type":"string"},
+        {"name":"o","type":["null","int"]},
+        {"name":"a","type":{"type":"array","items":{"type":"record","name":"item","fields":[
+            {"name":"k","type":"int"}]}}},
+        {"name":"again","type":["null","item"]},
+        {"name":"b","type":"boolean"}]})");
+
+    AvroEncoder records;
+    for (int i = 0; i < 2; ++i) {
+        records.writeLong(i == 0 ? -1234567890123LL : 7);
+        records.writeString(i == 0 ? "first" : "");
+        if (i == 0) {
+            records.writeUnionIndex(1);
+            records.writeInt(-3);
+        } else {
+            records.writeUnionIndex(0);
+        }
+        records.arrayStart(2);
+        records.writeInt(10);
+        records.writeInt(20);
+        records.arrayEnd();
+        records.writeUnionIndex(1);
+        records.writeInt(30);
+        records.writeBool(i == 0);
+    }
+
+    std::string data = AvroContainer::write(schema, {{"format-version", "2"}}, records, 2);
+    AvroFile file = AvroContainer::read(data);
+    EXPECT_EQ(file.metadataValue("format-version"), "2");
+    EXPECT_EQ(file.metadataValue("absent"), "");
+    ASSERT_EQ(file.records.size(), 2u);
+    EXPECT_EQ(file.records[0]["n"].asInt(), -1234567890123LL);
+    EXPECT_EQ(file.records[0]["s"].asString(), "first");
+    EXPECT_EQ(file.records[0]["o"].asInt(), -3);
+    ASSERT_EQ(file.records[0]["a"].size(), 2u);
+    EXPECT_EQ(file.records[0]["a"].items()[1]["k"].asInt(), 20);
+    EXPECT_EQ(file.records[0]["again"]["k"].asInt(), 30);
+    EXPECT_TRUE(file.records[0]["b"].asBool());
+    EXPECT_TRUE(file.records[1]["o"].isNull());
+    EXPECT_FALSE(file.records[1]["b"].asBool());
+}
+
+TEST(AvroTest, ReadsDeflateBlocks) {
+    JsonValue schema = JsonValue::parse(R"({"type":"record","name":"r","fields":[{"name":"s","type":"string"}]})");
+
+    AvroEncoder header;
+    header.arrayStart(2);
+    header.writeString("avro.schema");
+    header.writeBytes(schema.dump());
+    header.writeString("avro.codec");
+    header.writeBytes("deflate");
+    header.arrayEnd();
+
+    AvroEncoder records;
+    for (int i = 0; i < 100; ++i) {
+        records.writeString("value " + std::to_string(i));
+    }
+    std::string compressed = deflateRaw(records.data());
+    AvroEncoder block;
+    block.writeLong(100);
+    block.writeLong(static_cast<int64_t>(compressed.size()));
+
+    std::string sync(16, '\x5a');
+    std::string data = std::string("Obj\x01", 4) + header.data() + sync + block.data() + compressed + sync;
+
+    AvroFile file = AvroContainer::read(data);
+    ASSERT_EQ(file.records.size(), 100u);
+    EXPECT_EQ(file.records[99]["s"].asString(), "value 99");
+
+    // Corrupt sync marker
+    data[data.size() - 1] = 'x';
+    EXPECT_THROW(AvroContainer::read(data), std::runtime_error);
+}
+
+TEST(AvroTest, RejectsGarbage) {
+    EXPECT_THROW(AvroContainer::read("not avro"), std::runtime_error);
+    EXPECT_THROW(AvroContainer::read(std::string("Obj\x01", 4)), std::runtime_error);
+}
+
+TEST(IcebergManifestTest, RoundTripsManifest) {
+    IcebergDataFile file;
+    file.file_path = "s3://bucket/logs/data/a.parquet";
+    file.record_count = 42;
+    file.file_size_in_bytes = 4096;
+    file.value_counts[3] = 42;
+    file.null_value_counts[3] = 0;
+    file.lower_bounds[3] = IcebergManifest::longBound(100);
+    file.upper_bounds[3] = IcebergManifest::longBound(141);
+
+    std::string data = IcebergManifest::writeManifest({file}, JsonValue::parse(kTableSchema), 0);
+
+    AvroFile avro = AvroContainer::read(data);
+    EXPECT_EQ(avro.metadataValue("format-version"), "2");
+    EXPECT_EQ(avro.metadataValue("content"), "data");
+    EXPECT_EQ(avro.metadataValue("partition-spec"), "[]");
+    EXPECT_EQ(JsonValue::parse(avro.metadataValue("schema"))["fields"].size(), 2u);
+    ASSERT_EQ(avro.records.size(), 1u);
+    EXPECT_EQ(avro.records[0]["status"].asInt(), 1);             // ADDED
+    EXPECT_TRUE(avro.records[0]["snapshot_id"].isNull());        // Inherited
+    EXPECT_TRUE(avro.records[0]["sequence_number"].isNull());
+    EXPECT_EQ(avro.records[0]["data_file"]["file_format"].asString(), "PARQUET");
+
+    std::vector<IcebergDataFile> files = IcebergManifest::readManifest(data);
+    ASSERT_EQ(files.size(), 1u);
+    EXPECT_EQ(files[0].file_path, file.file_path);
+    EXPECT_EQ(files[0].record_count, 42);
+    EXPECT_EQ(files[0].file_size_in_bytes, 4096);
+    EXPECT_EQ(files[0].value_counts.at(3), 42);
+    EXPECT_EQ(IcebergManifest::parseLongBound(files[0].lower_bounds.at(3)), 100);
+    EXPECT_EQ(IcebergManifest::parseLongBound(files[0].upper_bounds.at(3)), 141);
+}
+
+TEST(IcebergManifestTest, RoundTripsManifestList) {
+    IcebergManifestFile ours;
+    ours.manifest_path = "s3://bucket/logs/metadata/new-m0.avro";
+    ours.manifest_length = 1234;
+    ours.sequence_number = 8;
+    ours.min_sequence_number = 8;
+    ours.added_snapshot_id = 5000000000000000001LL;
+    ours.added_files_count = 2;
+    ours.added_rows_count = 100;
+    ours.partitions = JsonValue::array();
+
+    IcebergManifestFile parent;
+    parent.manifest_path = "s3://bucket/logs/metadata/old-m0.avro";
+    parent.manifest_length = 999;
+    parent.sequence_number = 3;
+    parent.min_sequence_number = 1;
+    parent.added_snapshot_id = 77;
+    parent.existing_files_count = 5;
+    parent.existing_rows_count = 500;
+
+    std::string data = IcebergManifest::writeManifestList({ours, parent}, ours.added_snapshot_id, 77, 8);
+    AvroFile avro = AvroContainer::read(data);
+    EXPECT_EQ(avro.metadataValue("snapshot-id"), "5000000000000000001");
+    EXPECT_EQ(avro.metadataValue("parent-snapshot-id"), "77");
+    EXPECT_EQ(avro.metadataValue("sequence-number"), "8");
+
+    std::vector<IcebergManifestFile> manifests = IcebergManifest::readManifestList(data);
+    ASSERT_EQ(manifests.size(), 2u);
+    EXPECT_EQ(manifests[0].manifest_path, ours.manifest_path);
+    EXPECT_EQ(manifests[0].added_snapshot_id, ours.added_snapshot_id);
+    EXPECT_EQ(manifests[0].added_files_count, 2);
+    EXPECT_TRUE(manifests[0].partitions.isArray());
+    EXPECT_EQ(manifests[1].sequence_number, 3);
+    EXPECT_EQ(manifests[1].min_sequence_number, 1);
+    EXPECT_EQ(manifests[1].existing_rows_count, 500);
+    EXPECT_TRUE(manifests[1].partitions.isNull());
+
+    // A list without a parent says so
+    data = IcebergManifest::writeManifestList({ours}, 1, -1, 1);
+    EXPECT_EQ(AvroContainer::read(data).metadataValue("parent-snapshot-id"), "null");
+}
+
+TEST(IcebergManifestTest, SerializesBounds) {
+    EXPECT_EQ(IcebergManifest::longBound(1), std::string("\x01\0\0\0\0\0\0\0", 8));
+    EXPECT_EQ(IcebergManifest::intBound(-1), std::string("\xff\xff\xff\xff", 4));
+    EXPECT_EQ(IcebergManifest::parseLongBound(IcebergManifest::longBound(-42)), -42);
+}
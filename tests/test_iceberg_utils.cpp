@@ -241,3 +241,156 @@ TEST(IcebergUtilsTest, BuildInsertSQL_MultipleRecords) {
     EXPECT_TRUE(sql.find("'body1'") != std::string::npos);
     EXPECT_TRUE(sql.find("'body2'") != std::string::npos);
 }
+
+// Test appendRecords (DuckDB Appender path)
+static TransformedLogRecord makeAppendRecord(int64_t offset) {
+    TransformedLogRecord record;
+    record.kafka_topic = "test-topic";
+    record.kafka_partition = 3;
+    record.kafka_offset = offset;
+    record.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(1705314645123LL));
+    record.body = "body " + std::to_string(offset);
+    record.severity = "INFO";
+    record.service_name = "service1";
+    record.deployment_environment = "prod";
+    record.host_name = "host1";
+    record.trace_id = "trace123";
+    record.span_id = "span456";
+    record.attributes = {{"key1", "value1"}};
+    return record;
+}
+
+TEST(IcebergUtilsTest, AppendRecords_RoundTrip) {
+    DuckDB db(nullptr);
+    Connection conn(db);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "append"));
+
+    TransformedLogRecord record = makeAppendRecord(42);
+    record.body = "it's a 'path\\test'";
+    record.attributes = {{"a", "1"}, {"b", "x'y"}};
+
+    ASSERT_TRUE(IcebergUtils::appendRecords(conn, "local_buffer_append", {record}));
+
+    auto result = conn.Query(
+        "SELECT _kafka_topic, _kafka_partition, _kafka_offset, epoch_ms(timestamp), "
+        "body, attributes::VARCHAR FROM local_buffer_append");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    ASSERT_EQ(result->RowCount(), 1u);
+
+    EXPECT_EQ(result->GetValue(0, 0).ToString(), "test-topic");
+    EXPECT_EQ(result->GetValue(1, 0).GetValue<int32_t>(), 3);
+    EXPECT_EQ(result->GetValue(2, 0).GetValue<int64_t>(), 42);
+    EXPECT_EQ(result->GetValue(3, 0).GetValue<int64_t>(), 1705314645123LL);
+    // Values are stored verbatim, no SQL escaping involved
+    EXPECT_EQ(result->GetValue(4, 0).ToString(), "it's a 'path\\test'");
+    EXPECT_EQ(result->GetValue(5, 0).ToString(), "{a=1, b=x'y}");
+}
+
+TEST(IcebergUtilsTest, AppendRecords_EmptyAttributes) {
+    DuckDB db(nullptr);
+    Connection conn(db);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "append_empty"));
+
+    TransformedLogRecord record = makeAppendRecord(1);
+    record.attributes.clear();
+
+    ASSERT_TRUE(IcebergUtils::appendRecords(conn, "local_buffer_append_empty", {record}));
+
+    auto result = conn.Query("SELECT cardinality(attributes) FROM local_buffer_append_empty");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    EXPECT_EQ(result->GetValue(0, 0).GetValue<int64_t>(), 0);
+}
+
+TEST(IcebergUtilsTest, AppendRecords_SpansMultipleChunks) {
+    DuckDB db(nullptr);
+    Connection conn(db);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "append_many"));
+
+    // More rows than fit in a single DataChunk
+    std::vector<TransformedLogRecord> records;
+    for (int64_t i = 0; i < 5000; ++i) {
+        records.push_back(makeAppendRecord(i));
+    }
+
+    ASSERT_TRUE(IcebergUtils::appendRecords(conn, "local_buffer_append_many", records));
+
+    auto result = conn.Query(
+        "SELECT COUNT(*), SUM(_kafka_offset), SUM(cardinality(attributes)) "
+        "FROM local_buffer_append_many");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    EXPECT_EQ(result->GetValue(0, 0).GetValue<int64_t>(), 5000);
+    EXPECT_EQ(result->GetValue(1, 0).GetValue<int64_t>(), 5000LL * 4999 / 2);
+    EXPECT_EQ(result->GetValue(2, 0).GetValue<int64_t>(), 5000);
+}
+
+TEST(IcebergUtilsTest, AppendRecords_MissingTableFails) {
+    DuckDB db(nullptr);
+    Connection conn(db);
+
+    EXPECT_FALSE(IcebergUtils::appendRecords(conn, "no_such_table", {makeAppendRecord(1)}));
+}
+
+TEST(IcebergUtilsTest, AppendBatch_MergesResourceAndRecordAttributes) {
+    DuckDB db(nullptr);
+    Connection conn(db);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "append_batch"));
+
+    LogRecordBatch batch;
+    batch.kafka_topic = "test-topic";
+    batch.kafka_partition = 1;
+    batch.service_name.append("service1");
+    batch.deployment_environment.append("prod");
+    batch.host_name.append("host1");
+    batch.resource_attr_keys.append("region");
+    batch.resource_attr_values.append("us-east-1");
+    batch.resource_attr_keys.append("team");
+    batch.resource_attr_values.append("payments");
+    batch.resource_attr_offsets.push_back(2);
+
+    batch.kafka_offset.push_back(7);
+    batch.timestamp.push_back(std::chrono::system_clock::time_point(std::chrono::seconds(1705314645)));
+    batch.severity.append("WARN");
+    batch.body.append("record body");
+    batch.trace_id.append("");
+    batch.span_id.append("");
+    batch.resource_index.push_back(0);
+    batch.attr_keys.append("region");
+    batch.attr_values.append("eu-west-1");
+    batch.attr_offsets.push_back(1);
+
+    ASSERT_TRUE(IcebergUtils::appendBatch(conn, "local_buffer_append_batch", batch));
+
+    auto result = conn.Query(
+        "SELECT _kafka_partition, _kafka_offset, service_name, body, cardinality(attributes), "
+        "map_extract(attributes, 'region')[1], map_extract(attributes, 'team')[1] "
+        "FROM local_buffer_append_batch");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    ASSERT_EQ(result->RowCount(), 1u);
+    EXPECT_EQ(result->GetValue(0, 0).GetValue<int32_t>(), 1);
+    EXPECT_EQ(result->GetValue(1, 0).GetValue<int64_t>(), 7);
+    EXPECT_EQ(result->GetValue(2, 0).ToString(), "service1");
+    EXPECT_EQ(result->GetValue(3, 0).ToString(), "record body");
+    EXPECT_EQ(result->GetValue(4, 0).GetValue<int64_t>(), 2);
+    EXPECT_EQ(result->GetValue(5, 0).ToString(), "eu-west-1");
+    EXPECT_EQ(result->GetValue(6, 0).ToString(), "payments");
+}
+
+TEST(IcebergUtilsTest, EstimateBatchSize_MatchesRecordEstimate) {
+    TransformedLogRecord record;
+    record.kafka_topic = "test-topic";
+    record.body = "test message body";
+    record.severity = "INFO";
+    record.service_name = "test-service";
+    record.deployment_environment = "production";
+    record.host_name = "host1";
+    record.trace_id = "abc123";
+    record.span_id = "def456";
+    record.attributes = {{"key1", "value1"}};
+
+    LogRecordBatch batch;
+    batch.append(record);
+    batch.append(record);
+
+    EXPECT_EQ(IcebergUtils::estimateBatchSize(batch),
+              IcebergUtils::estimateRecordsSize({record, record}));
+}
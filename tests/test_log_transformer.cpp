@@ -105,3 +105,139 @@ TEST(LogTransformerTest, SeverityFromNumber) {
     EXPECT_EQ(transformed[0].severity, "ERROR");
 }
 
+
+TEST(LogTransformerTest, BatchStoresResourceColumnsOnce) {
+    opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest request;
+
+    auto* resource_logs = request.add_resource_logs();
+    auto* resource = resource_logs->mutable_resource();
+    auto* attr = resource->add_attributes();
+    attr->set_key("service.name");
+    attr->mutable_value()->set_string_value("batch-service");
+    attr = resource->add_attributes();
+    attr->set_key("k8s.pod.name");
+    attr->mutable_value()->set_string_value("pod-1");
+
+    auto* scope_logs = resource_logs->add_scope_logs();
+    for (int i = 0; i < 3; ++i) {
+        auto* log_record = scope_logs->add_log_records();
+        log_record->set_time_unix_nano(1672531200000000000ULL + i);
+        log_record->mutable_body()->set_string_value("message " + std::to_string(i));
+    }
+
+    LogRecordBatch batch;
+    size_t appended = LogTransformer::transformToBatch(request, "otel-logs", 2, 77, batch);
+
+    ASSERT_EQ(appended, 3u);
+    ASSERT_EQ(batch.size(), 3u);
+    EXPECT_EQ(batch.resourceCount(), 1u);
+    EXPECT_EQ(batch.kafka_topic, "otel-logs");
+    EXPECT_EQ(batch.kafka_partition, 2);
+    EXPECT_EQ(batch.kafka_offset[2], 77);
+    EXPECT_EQ(batch.service_name.get(0), "batch-service");
+    EXPECT_EQ(batch.resource_attr_keys.size(), 1u);
+    EXPECT_EQ(batch.body.get(1), "message 1");
+    EXPECT_EQ(batch.resource_index[2], 0u);
+}
+
+TEST(LogTransformerTest, BatchRecordAttributesOverrideResource) {
+    opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest request;
+
+    auto* resource_logs = request.add_resource_logs();
+    auto* attr = resource_logs->mutable_resource()->add_attributes();
+    attr->set_key("region");
+    attr->mutable_value()->set_string_value("us-east-1");
+    attr = resource_logs->mutable_resource()->add_attributes();
+    attr->set_key("team");
+    attr->mutable_value()->set_string_value("payments");
+
+    auto* log_record = resource_logs->add_scope_logs()->add_log_records();
+    log_record->set_time_unix_nano(1672531200000000000ULL);
+    attr = log_record->add_attributes();
+    attr->set_key("region");
+    attr->mutable_value()->set_string_value("eu-west-1");
+    attr = log_record->add_attributes();
+    attr->set_key("http.status_code");
+    attr->mutable_value()->set_int_value(503);
+
+    auto transformed = LogTransformer::transform(request);
+
+    ASSERT_EQ(transformed.size(), 1u);
+    ASSERT_EQ(transformed[0].attributes.size(), 3u);
+    EXPECT_EQ(transformed[0].attributes["region"], "eu-west-1");
+    EXPECT_EQ(transformed[0].attributes["team"], "payments");
+    EXPECT_EQ(transformed[0].attributes["http.status_code"], "503");
+}
+
+TEST(LogTransformerTest, BatchAppendBatchRebasesOffsets) {
+    opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest request;
+
+    for (int r = 0; r < 2; ++r) {
+        auto* resource_logs = request.add_resource_logs();
+        auto* attr = resource_logs->mutable_resource()->add_attributes();
+        attr->set_key("service.name");
+        attr->mutable_value()->set_string_value("service-" + std::to_string(r));
+        attr = resource_logs->mutable_resource()->add_attributes();
+        attr->set_key("resource.idx");
+        attr->mutable_value()->set_int_value(r);
+
+        auto* log_record = resource_logs->add_scope_logs()->add_log_records();
+        log_record->set_time_unix_nano(1672531200000000000ULL);
+        attr = log_record->add_attributes();
+        attr->set_key("record.idx");
+        attr->mutable_value()->set_int_value(r);
+    }
+
+    LogRecordBatch first;
+    LogRecordBatch second;
+    LogTransformer::transformToBatch(request, "otel-logs", 0, 10, first);
+    LogTransformer::transformToBatch(request, "otel-logs", 0, 11, second);
+
+    LogRecordBatch merged;
+    merged.appendBatch(first);
+    merged.appendBatch(second);
+
+    ASSERT_EQ(merged.size(), 4u);
+    EXPECT_EQ(merged.resourceCount(), 4u);
+
+    auto records = merged.toRecords();
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[3].kafka_offset, 11);
+    EXPECT_EQ(records[3].service_name, "service-1");
+    EXPECT_EQ(records[3].attributes["resource.idx"], "1");
+    EXPECT_EQ(records[3].attributes["record.idx"], "1");
+    EXPECT_EQ(records[2].service_name, "service-0");
+    EXPECT_EQ(records[2].attributes["record.idx"], "0");
+}
+
+TEST(LogTransformerTest, BatchRoundTripsRowRecords) {
+    TransformedLogRecord record;
+    record.kafka_topic = "otel-logs";
+    record.kafka_partition = 4;
+    record.kafka_offset = 9;
+    record.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(1672531200));
+    record.severity = "WARN";
+    record.body = "disk almost full";
+    record.trace_id = "0102";
+    record.span_id = "0304";
+    record.service_name = "storage";
+    record.deployment_environment = "staging";
+    record.host_name = "node-7";
+    record.attributes = {{"disk", "/dev/sda1"}, {"usage", "91%"}};
+
+    LogRecordBatch batch;
+    batch.append(record);
+    batch.append(record);
+
+    EXPECT_EQ(batch.resourceCount(), 1u);
+
+    auto records = batch.toRecords();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].kafka_topic, "otel-logs");
+    EXPECT_EQ(records[1].kafka_partition, 4);
+    EXPECT_EQ(records[1].timestamp, record.timestamp);
+    EXPECT_EQ(records[1].severity, "WARN");
+    EXPECT_EQ(records[1].body, "disk almost full");
+    EXPECT_EQ(records[1].host_name, "node-7");
+    EXPECT_EQ(records[1].attributes, record.attributes);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "../src/appender/otlp_json_decoder.hpp"
+#include "otlp_test_helpers.hpp"
+#include <google/protobuf/util/json_util.h>
+
+TEST(OtlpJsonDecoderTest, MatchesProtobufJsonMapping) {
+    ExportLogsServiceRequest request = buildRichRequest();
+
+    // Field names as emitted by the generic mapping (lowerCamelCase, base64 ids, string int64)
+    std::string json;
+    ASSERT_TRUE(google::protobuf::util::MessageToJsonString(request, &json).ok());
+
+    LogRecordBatch expected;
+    LogTransformer::transformToBatch(request, "otel-logs", 3, 42, expected);
+
+    LogRecordBatch actual;
+    size_t appended = OtlpJsonDecoder::decode(json, "otel-logs", 3, 42, actual);
+
+    EXPECT_EQ(appended, 3u);
+    EXPECT_EQ(actual.resourceCount(), 2u);
+    expectSameRecords(expected, actual);
+}
+
+TEST(OtlpJsonDecoderTest, AcceptsOriginalFieldNames) {
+    ExportLogsServiceRequest request = buildRichRequest();
+
+    std::string json;
+    google::protobuf::util::JsonPrintOptions options;
+    options.preserve_proto_field_names = true;
+    ASSERT_TRUE(google::protobuf::util::MessageToJsonString(request, &json, options).ok());
+
+    LogRecordBatch expected;
+    LogTransformer::transformToBatch(request, "otel-logs", 0, 7, expected);
+
+    LogRecordBatch actual;
+    OtlpJsonDecoder::decode(json, "otel-logs", 0, 7, actual);
+
+    expectSameRecords(expected, actual);
+}
+
+TEST(OtlpJsonDecoderTest, OtlpJsonQuirks) {
+    // Hex ids, numeric and string int64, enum names, members in any order
+    const std::string json = R"({
+      "resourceLogs": [{
+        "scopeLogs": [{
+          "logRecords": [{
+            "attributes": [
+              {"value": {"intValue": 12}, "key": "numeric"},
+              {"key": "string", "value": {"intValue": "-5"}}
+            ],
+            "spanId": "FEDCBA9876543210",
+            "traceId": "0123456789abcdef0123456789abcdef",
+            "severityNumber": "SEVERITY_NUMBER_ERROR",
+            "timeUnixNano": 1672531200000000000,
+            "body": {"stringValue": "café 😀 \"quoted\"\\"}
+          }]
+        }],
+        "resource": {"attributes": [{"key": "service.name", "value": {"stringValue": "svc"}}]}
+      }]
+    })";
+
+    LogRecordBatch batch;
+    ASSERT_EQ(OtlpJsonDecoder::decode(json, "t", 1, 9, batch), 1u);
+
+    auto records = batch.toRecords();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].trace_id, "0123456789abcdef0123456789abcdef");
+    EXPECT_EQ(records[0].span_id, "fedcba9876543210");
+    EXPECT_EQ(records[0].severity, "ERROR");
+    EXPECT_EQ(records[0].body, "caf\xC3\xA9 \xF0\x9F\x98\x80 \"quoted\"\\");
+    EXPECT_EQ(records[0].service_name, "svc");
+    EXPECT_EQ(records[0].attributes.at("numeric"), "12");
+    EXPECT_EQ(records[0].attributes.at("string"), "-5");
+    EXPECT_EQ(records[0].timestamp, LogTransformer::nanosToTimePoint(1672531200000000000ULL));
+    EXPECT_EQ(records[0].kafka_offset, 9);
+}
+
+TEST(OtlpJsonDecoderTest, NullsAndUnknownFieldsAreIgnored) {
+    const std::string json = R"({
+      "resourceLogs": [{
+        "resource": null,
+        "schemaUrl": "https://example.com",
+        "scopeLogs": [{
+          "scope": {"name": "lib", "attributes": [{"key": "x", "value": {"arrayValue": {"values": [[1], {"a": true}]}}}]},
+          "logRecords": [{"timeUnixNano": "1672531200000000000", "body": null, "traceId": null,
+                          "flags": 1, "eventName": "e", "futureField": {"nested": [null, 1.5e3]}}]
+        }]
+      }]
+    })";
+
+    LogRecordBatch batch;
+    ASSERT_EQ(OtlpJsonDecoder::decode(json, "t", 0, 1, batch), 1u);
+
+    auto records = batch.toRecords();
+    EXPECT_EQ(records[0].body, "");
+    EXPECT_EQ(records[0].trace_id, "");
+    EXPECT_EQ(records[0].severity, "UNSPECIFIED");
+    EXPECT_TRUE(records[0].attributes.empty());
+}
+
+TEST(OtlpJsonDecoderTest, MalformedInputLeavesBatchUnchanged) {
+    LogRecordBatch batch;
+    const std::string good = R"({"resourceLogs":[{"resource":{"attributes":[{"key":"service.name","value":{"stringValue":"svc"}}]},"scopeLogs":[{"logRecords":[{"timeUnixNano":"1","body":{"stringValue":"ok"}}]}]}]})";
+    ASSERT_EQ(OtlpJsonDecoder::decode(good, "t", 0, 1, batch), 1u);
+
+    const std::vector<std::string> malformed = {
+        "",
+        "{",
+        R"({"resourceLogs":[{"scopeLogs":[{"logRecords":[{"body":{"stringValue":"unterminated}}]}]}]})",
+        R"({"resourceLogs":[{"resource":{"attributes":[{"key":"a","value":{"stringValue":"b"}}]},"scopeLogs":[{"logRecords":[{"body":{"stringValue":"x"}},{"timeUnixNano":"abc"}]}]}]})",
+        R"({"resourceLogs":[{"scopeLogs":[{"logRecords":[{"traceId":"not base64!"}]}]}]})",
+        R"({"resourceLogs":[]} trailing)",
+        R"({"resourceLogs":[{"scopeLogs":[{"logRecords":[{"body":{"stringValue":"\ud800"}}]}]}]})",
+    };
+
+    for (const auto& json : malformed) {
+        EXPECT_THROW(OtlpJsonDecoder::decode(json, "t", 0, 2, batch), std::runtime_error) << json;
+        EXPECT_EQ(batch.size(), 1u);
+        EXPECT_EQ(batch.resourceCount(), 1u);
+        EXPECT_EQ(batch.attr_keys.size(), 0u);
+        EXPECT_EQ(batch.resource_attr_keys.size(), 0u);
+        EXPECT_EQ(batch.body.byteSize(), 2u);
+    }
+
+    // The batch is still usable after a failed decode
+    ASSERT_EQ(OtlpJsonDecoder::decode(good, "t", 0, 3, batch), 1u);
+    auto records = batch.toRecords();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].body, "ok");
+    EXPECT_EQ(records[1].kafka_offset, 3);
+}
+
+TEST(OtlpJsonDecoderTest, RejectsDeepNesting) {
+    std::string json = R"({"resourceLogs":[{"scopeLogs":[{"logRecords":[{"body":)";
+    for (int i = 0; i < 100; ++i) json += R"({"arrayValue":{"values":[)";
+    for (int i = 0; i < 100; ++i) json += "]}}";
+    json += "}]}]}]}";
+
+    LogRecordBatch batch;
+    EXPECT_THROW(OtlpJsonDecoder::decode(json, "t", 0, 1, batch), std::runtime_error);
+    EXPECT_TRUE(batch.empty());
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "../src/appender/otlp_proto_decoder.hpp"
+#include "otlp_test_helpers.hpp"
+#include <google/protobuf/unknown_field_set.h>
+
+namespace {
+
+// Decode the serialized request both ways and compare
+LogRecordBatch expectMatchesTransform(const ExportLogsServiceRequest& request) {
+    std::string payload = request.SerializeAsString();
+
+    ExportLogsServiceRequest parsed;
+    EXPECT_TRUE(parsed.ParseFromString(payload));
+    LogRecordBatch expected;
+    LogTransformer::transformToBatch(parsed, "otel-logs", 5, 100, expected);
+
+    LogRecordBatch actual;
+    size_t appended = OtlpProtoDecoder::decode(payload, "otel-logs", 5, 100, actual);
+    EXPECT_EQ(appended, expected.size());
+    expectSameRecords(expected, actual);
+    return actual;
+}
+
+}  // namespace
+
+// The cases below mirror log_transformer_test
+
+TEST(OtlpProtoDecoderTest, BasicTransformation) {
+    ExportLogsServiceRequest request;
+    auto* resource_logs = request.add_resource_logs();
+    addStringAttribute(resource_logs->mutable_resource()->mutable_attributes(), "service.name", "test-service");
+    auto* log_record = resource_logs->add_scope_logs()->add_log_records();
+    log_record->set_time_unix_nano(1672531200000000000ULL);
+    log_record->set_severity_text("INFO");
+    log_record->mutable_body()->set_string_value("Test log message");
+
+    auto batch = expectMatchesTransform(request);
+    auto records = batch.toRecords();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].severity, "INFO");
+    EXPECT_EQ(records[0].body, "Test log message");
+    EXPECT_EQ(records[0].service_name, "test-service");
+}
+
+TEST(OtlpProtoDecoderTest, WellKnownAttributes) {
+    ExportLogsServiceRequest request;
+    auto* resource_logs = request.add_resource_logs();
+    auto* attributes = resource_logs->mutable_resource()->mutable_attributes();
+    addStringAttribute(attributes, "service.name", "my-service");
+    addStringAttribute(attributes, "deployment.environment", "production");
+    addStringAttribute(attributes, "host.name", "host-123");
+    addStringAttribute(attributes, "custom.attr", "custom-value");
+    resource_logs->add_scope_logs()->add_log_records()->set_time_unix_nano(1672531200000000000ULL);
+
+    auto batch = expectMatchesTransform(request);
+    auto records = batch.toRecords();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].service_name, "my-service");
+    EXPECT_EQ(records[0].deployment_environment, "production");
+    EXPECT_EQ(records[0].host_name, "host-123");
+    EXPECT_EQ(records[0].attributes["custom.attr"], "custom-value");
+}
+
+TEST(OtlpProtoDecoderTest, TraceIdSpanId) {
+    ExportLogsServiceRequest request;
+    auto* log_record = request.add_resource_logs()->add_scope_logs()->add_log_records();
+    log_record->set_time_unix_nano(1672531200000000000ULL);
+    log_record->set_trace_id("\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10");
+    log_record->set_span_id("\x01\x02\x03\x04\x05\x06\x07\x08");
+
+    auto batch = expectMatchesTransform(request);
+    EXPECT_EQ(batch.trace_id.get(0), "0102030405060708090a0b0c0d0e0f10");
+    EXPECT_EQ(batch.span_id.get(0), "0102030405060708");
+}
+
+TEST(OtlpProtoDecoderTest, SeverityFromNumber) {
+    ExportLogsServiceRequest request;
+    auto* log_record = request.add_resource_logs()->add_scope_logs()->add_log_records();
+    log_record->set_time_unix_nano(1672531200000000000ULL);
+    log_record->set_severity_number(opentelemetry::proto::logs::v1::SEVERITY_NUMBER_ERROR);
+
+    auto batch = expectMatchesTransform(request);
+    EXPECT_EQ(batch.severity.get(0), "ERROR");
+}
+
+TEST(OtlpProtoDecoderTest, BatchRecordAttributesOverrideResource) {
+    ExportLogsServiceRequest request;
+    auto* resource_logs = request.add_resource_logs();
+    addStringAttribute(resource_logs->mutable_resource()->mutable_attributes(), "region", "us-east-1");
+    addStringAttribute(resource_logs->mutable_resource()->mutable_attributes(), "team", "payments");
+    auto* log_record = resource_logs->add_scope_logs()->add_log_records();
+    log_record->set_time_unix_nano(1672531200000000000ULL);
+    addStringAttribute(log_record->mutable_attributes(), "region", "eu-west-1");
+    auto* attr = log_record->add_attributes();
+    attr->set_key("http.status_code");
+    attr->mutable_value()->set_int_value(503);
+
+    auto batch = expectMatchesTransform(request);
+    auto records = batch.toRecords();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].attributes["region"], "eu-west-1");
+    EXPECT_EQ(records[0].attributes["team"], "payments");
+    EXPECT_EQ(records[0].attributes["http.status_code"], "503");
+}
+
+TEST(OtlpProtoDecoderTest, MatchesTransformOnRichRequest) {
+    auto batch = expectMatchesTransform(buildRichRequest());
+    EXPECT_EQ(batch.size(), 3u);
+    EXPECT_EQ(batch.resourceCount(), 2u);
+}
+
+TEST(OtlpProtoDecoderTest, SkipsUnknownFields) {
+    ExportLogsServiceRequest request = buildRichRequest();
+
+    auto addUnknown = [](google::protobuf::Message* message) {
+        auto* unknown = message->GetReflection()->MutableUnknownFields(message);
+        unknown->AddVarint(90, 12345);
+        unknown->AddFixed32(91, 7);
+        unknown->AddFixed64(92, 8);
+        unknown->AddLengthDelimited(93, "future");
+        unknown->AddGroup(94)->AddVarint(1, 1);
+    };
+    addUnknown(&request);
+    addUnknown(request.mutable_resource_logs(0));
+    addUnknown(request.mutable_resource_logs(0)->mutable_resource());
+    addUnknown(request.mutable_resource_logs(0)->mutable_scope_logs(0));
+    addUnknown(request.mutable_resource_logs(0)->mutable_scope_logs(0)->mutable_log_records(0));
+    addUnknown(request.mutable_resource_logs(0)->mutable_scope_logs(0)->mutable_log_records(0)->mutable_body());
+    addUnknown(request.mutable_resource_logs(0)->mutable_scope_logs(0)->mutable_log_records(0)->mutable_attributes(0));
+
+    expectMatchesTransform(request);
+}
+
+TEST(OtlpProtoDecoderTest, WrongWireTypeIsTreatedAsUnknown) {
+    ExportLogsServiceRequest request = buildRichRequest();
+    auto* record = request.mutable_resource_logs(0)->mutable_scope_logs(0)->mutable_log_records(0);
+    auto* unknown = record->GetReflection()->MutableUnknownFields(record);
+    unknown->AddVarint(opentelemetry::proto::logs::v1::LogRecord::kBodyFieldNumber, 1);
+    unknown->AddLengthDelimited(opentelemetry::proto::logs::v1::LogRecord::kTimeUnixNanoFieldNumber, "x");
+
+    expectMatchesTransform(request);
+}
+
+TEST(OtlpProtoDecoderTest, TruncatedPayloadsMatchParserOrLeaveBatchUnchanged) {
+    std::string payload = buildRichRequest().SerializeAsString();
+
+    for (size_t length = 0; length < payload.size(); ++length) {
+        std::string_view prefix(payload.data(), length);
+
+        ExportLogsServiceRequest parsed;
+        bool parsed_ok = parsed.ParseFromArray(prefix.data(), static_cast<int>(prefix.size()));
+
+        LogRecordBatch batch;
+        ASSERT_EQ(OtlpProtoDecoder::decode(payload, "t", 0, 1, batch), 3u);
+
+        if (parsed_ok) {
+            LogRecordBatch expected;
+            expected.appendBatch(batch);
+            LogTransformer::transformToBatch(parsed, "t", 0, 2, expected);
+            ASSERT_NO_THROW(OtlpProtoDecoder::decode(prefix, "t", 0, 2, batch)) << "length " << length;
+            expectSameRecords(expected, batch);
+        } else {
+            EXPECT_THROW(OtlpProtoDecoder::decode(prefix, "t", 0, 2, batch), std::runtime_error)
+                << "length " << length;
+            EXPECT_EQ(batch.size(), 3u);
+            EXPECT_EQ(batch.resourceCount(), 2u);
+            EXPECT_EQ(batch.attr_offsets.back(), batch.attr_keys.size());
+            EXPECT_EQ(batch.resource_attr_offsets.back(), batch.resource_attr_keys.size());
+            EXPECT_EQ(batch.body.offsets.back(), batch.body.data.size());
+        }
+    }
+}
+
+TEST(OtlpProtoDecoderTest, RejectsMalformedWireData) {
+    const std::vector<std::string> malformed = {
+        std::string("\x0a\x05\x0a", 3),                       // length past end
+        std::string("\x08\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 12),  // overlong varint
+        std::string("\x00\x01", 2),                           // field number 0
+        std::string("\x0c", 1),                               // stray end group
+        std::string("\x0b\x08\x01", 3),                       // unterminated group
+        std::string("\x0f", 1),                               // invalid wire type 7
+    };
+
+    for (const auto& payload : malformed) {
+        LogRecordBatch batch;
+        EXPECT_THROW(OtlpProtoDecoder::decode(payload, "t", 0, 1, batch), std::runtime_error);
+        EXPECT_TRUE(batch.empty());
+    }
+}
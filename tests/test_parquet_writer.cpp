@@ -0,0 +1,369 @@
+#include <gtest/gtest.h>
+#include "appender/parquet_writer.hpp"
+#include <zlib.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+// Minimal Thrift compact protocol reader to inspect what the writer produced
+struct ThriftValue {
+    int64_t i = 0;
+    std::string bin;
+    std::vector<ThriftValue> list;
+    std::map<int16_t, ThriftValue> fields;
+
+    const ThriftValue& operator[](int16_t id) const { return fields.at(id); }
+    bool has(int16_t id) const { return fields.count(id) > 0; }
+};
+
+class CompactReader {
+public:
+    CompactReader(const std::string& data, size_t pos) : data_(data), pos_(pos) {}
+
+    ThriftValue readStruct() {
+        ThriftValue value;
+        int16_t last = 0;
+        while (true) {
+            uint8_t header = byte();
+            if (header == 0) {
+                break;
+            }
+            uint8_t type = header & 0x0F;
+            int16_t id = (header >> 4) ? static_cast<int16_t>(last + (header >> 4))
+                                       : static_cast<int16_t>(unzigzag(varint()));
+            value.fields[id] = readValue(type);
+            last = id;
+        }
+        return value;
+    }
+
+    size_t pos() const { return pos_; }
+
+private:
+    const std::string& data_;
+    size_t pos_;
+
+    uint8_t byte() { return static_cast<uint8_t>(data_.at(pos_++)); }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    static int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+    ThriftValue readValue(uint8_t type) {
+        ThriftValue value;
+        switch (type) {
+            case 1: value.i = 1; break;
+            case 2: value.i = 0; break;
+            case 3: value.i = static_cast<int8_t>(byte()); break;
+            case 4: case 5: case 6: value.i = unzigzag(varint()); break;
+            case 8: {
+                size_t size = varint();
+                value.bin = data_.substr(pos_, size);
+                pos_ += size;
+                break;
+            }
+            case 9: {
+                uint8_t header = byte();
+                size_t size = header >> 4;
+                if (size == 15) {
+                    size = varint();
+                }
+                for (size_t n = 0; n < size; ++n) {
+                    value.list.push_back(readValue(header & 0x0F));
+                }
+                break;
+            }
+            case 12: value = readStruct(); break;
+            default: ADD_FAILURE() << "Unexpected thrift type " << int(type);
+        }
+        return value;
+    }
+};
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+}
+
+uint32_t readLE32(const std::string& data, size_t pos) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+ThriftValue readFooter(const std::string& file) {
+    uint32_t length = readLE32(file, file.size() - 8);
+    CompactReader reader(file, file.size() - 8 - length);
+    return reader.readStruct();
+}
+
+// Uncompressed body of the (single) data page of a column chunk
+std::string readPage(const std::string& file, const ThriftValue& column_meta) {
+    CompactReader reader(file, static_cast<size_t>(column_meta[9].i));
+    ThriftValue header = reader.readStruct();
+    EXPECT_EQ(header[1].i, 0);  // DATA_PAGE
+    std::string body = file.substr(reader.pos(), static_cast<size_t>(header[3].i));
+    if (column_meta[4].i == 0) {
+        return body;
+    }
+
+    std::string page(static_cast<size_t>(header[2].i), '\0');
+    z_stream stream{};
+    EXPECT_EQ(inflateInit2(&stream, 16 + MAX_WBITS), Z_OK);
+    stream.next_in = reinterpret_cast<Bytef*>(body.data());
+    stream.avail_in = static_cast<uInt>(body.size());
+    stream.next_out = reinterpret_cast<Bytef*>(page.data());
+    stream.avail_out = static_cast<uInt>(page.size());
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    EXPECT_EQ(stream.total_out, page.size());
+    inflateEnd(&stream);
+    return page;
+}
+
+// Expand a length-prefixed, RLE-only level block
+std::vector<int> readLevels(const std::string& page, size_t& pos) {
+    uint32_t length = readLE32(page, pos);
+    size_t end = pos + 4 + length;
+    pos += 4;
+    std::vector<int> levels;
+    while (pos < end) {
+        uint64_t header = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t b = static_cast<uint8_t>(page[pos++]);
+            header |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+        EXPECT_EQ(header & 1, 0u) << "bit-packed run";
+        levels.insert(levels.end(), header >> 1, static_cast<uint8_t>(page[pos++]));
+    }
+    return levels;
+}
+
+LogRecordBatch makeBatch(int64_t first_offset, size_t rows) {
+    LogRecordBatch batch;
+    for (size_t i = 0; i < rows; ++i) {
+        TransformedLogRecord record;
+        record.kafka_topic = "otel-logs";
+        record.kafka_partition = 3;
+        record.kafka_offset = first_offset + static_cast<int64_t>(i);
+        record.timestamp = std::chrono::system_clock::time_point(
+            std::chrono::microseconds(1700000000000000LL + static_cast<int64_t>(i)));
+        record.severity = "INFO";
+        record.body = "message " + std::to_string(i);
+        record.service_name = "checkout";
+        if (i % 2 == 0) {
+            record.attributes["http.method"] = "GET";
+            record.attributes["http.status_code"] = std::to_string(200 + i);
+        }
+        batch.append(record);
+    }
+    return batch;
+}
+
+}  // namespace
+
+class ParquetWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = "/tmp/parquet_writer_test_" + std::to_string(getpid()) + ".parquet";
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+TEST_F(ParquetWriterTest, WritesSchemaAndFooter) {
+    ParquetWriter::Options options;
+    options.codec = ParquetWriter::Codec::UNCOMPRESSED;
+    ParquetWriter writer(options);
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.append(makeBatch(100, 3)));
+    ASSERT_TRUE(writer.close());
+
+    std::string file = readFile(path);
+    ASSERT_GT(file.size(), 12u);
+    EXPECT_EQ(file.substr(0, 4), "PAR1");
+    EXPECT_EQ(file.substr(file.size() - 4), "PAR1");
+    EXPECT_EQ(writer.stats().file_bytes, file.size());
+
+    ThriftValue meta = readFooter(file);
+    EXPECT_EQ(meta[1].i, 1);
+    EXPECT_EQ(meta[3].i, 3);
+
+    const auto& schema = meta[2].list;
+    ASSERT_EQ(schema.size(), 16u);
+    EXPECT_EQ(schema[0][5].i, 12);
+    EXPECT_EQ(schema[1][4].bin, "_kafka_topic");
+    EXPECT_EQ(schema[1][9].i, 1);
+    EXPECT_EQ(schema[4][4].bin, "timestamp");
+    EXPECT_TRUE(schema[4][10].has(8));     // TIMESTAMP logical type
+    EXPECT_EQ(schema[12][4].bin, "attributes");
+    EXPECT_EQ(schema[12][6].i, 1);         // MAP
+    EXPECT_EQ(schema[13][3].i, 2);         // key_value is repeated
+    EXPECT_EQ(schema[14][4].bin, "key");
+    EXPECT_EQ(schema[14][3].i, 0);         // required
+    EXPECT_EQ(schema[15][9].i, 14);
+
+    ASSERT_EQ(meta[4].list.size(), 1u);
+    const auto& group = meta[4].list[0];
+    EXPECT_EQ(group[3].i, 3);
+    ASSERT_EQ(group[1].list.size(), 13u);
+
+    // _kafka_offset statistics
+    const auto& offset_meta = group[1].list[2][3];
+    EXPECT_EQ(offset_meta[3].list[0].bin, "_kafka_offset");
+    EXPECT_EQ(readLE32(offset_meta[12][6].bin, 0), 100u);
+    EXPECT_EQ(readLE32(offset_meta[12][5].bin, 0), 102u);
+    EXPECT_EQ(writer.stats().min_offset, 100);
+    EXPECT_EQ(writer.stats().max_offset, 102);
+    EXPECT_EQ(writer.stats().rows, 3u);
+}
+
+TEST_F(ParquetWriterTest, UsesTableFieldIds) {
+    ParquetWriter::Options options;
+    options.codec = ParquetWriter::Codec::UNCOMPRESSED;
+    options.field_ids = {{"_kafka_topic", 21}, {"attributes", 32}, {"attributes.key", 33}};
+    ParquetWriter writer(options);
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.append(makeBatch(0, 1)));
+    ASSERT_TRUE(writer.close());
+
+    ThriftValue meta = readFooter(readFile(path));
+    const auto& schema = meta[2].list;
+    ASSERT_EQ(schema.size(), 16u);
+    EXPECT_EQ(schema[1][9].i, 21);
+    EXPECT_EQ(schema[2][9].i, 2);          // Not listed: default id
+    EXPECT_EQ(schema[12][9].i, 32);
+    EXPECT_EQ(schema[14][9].i, 33);
+    EXPECT_EQ(schema[15][9].i, 14);
+}
+
+TEST_F(ParquetWriterTest, EncodesValuesAndMapLevels) {
+    ParquetWriter::Options options;
+    options.codec = ParquetWriter::Codec::UNCOMPRESSED;
+    ParquetWriter writer(options);
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.append(makeBatch(7, 3)));
+    ASSERT_TRUE(writer.close());
+
+    std::string file = readFile(path);
+    ThriftValue meta = readFooter(file);
+    const auto& columns = meta[4].list[0][1].list;
+
+    // _kafka_offset: definition levels, then PLAIN int64 values
+    std::string page = readPage(file, columns[2][3]);
+    size_t pos = 0;
+    EXPECT_EQ(readLevels(page, pos), std::vector<int>({1, 1, 1}));
+    ASSERT_EQ(page.size() - pos, 3 * 8u);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(readLE32(page, pos + 8 * i), 7u + i);
+    }
+
+    // body: length-prefixed strings
+    page = readPage(file, columns[5][3]);
+    pos = 0;
+    readLevels(page, pos);
+    EXPECT_EQ(readLE32(page, pos), 9u);
+    EXPECT_EQ(page.substr(pos + 4, 9), "message 0");
+
+    // attributes key: rows 0 and 2 have two entries, row 1 has an empty map
+    const auto& key_meta = columns[11][3];
+    EXPECT_EQ(key_meta[3].list.size(), 3u);
+    EXPECT_EQ(key_meta[5].i, 5);
+    page = readPage(file, key_meta);
+    pos = 0;
+    EXPECT_EQ(readLevels(page, pos), std::vector<int>({0, 1, 0, 0, 1}));
+    EXPECT_EQ(readLevels(page, pos), std::vector<int>({2, 2, 1, 2, 2}));
+    EXPECT_EQ(readLE32(page, pos), 11u);
+    EXPECT_EQ(page.substr(pos + 4, 11), "http.method");
+
+    page = readPage(file, columns[12][3]);
+    pos = 0;
+    readLevels(page, pos);
+    EXPECT_EQ(readLevels(page, pos), std::vector<int>({3, 3, 1, 3, 3}));
+}
+
+TEST_F(ParquetWriterTest, FlushesRowGroupsAsTheyFill) {
+    ParquetWriter::Options options;
+    options.row_group_bytes = 1024;
+    ParquetWriter writer(options);
+    ASSERT_TRUE(writer.open(path));
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(writer.append(makeBatch(i * 20, 20)));
+        EXPECT_LT(writer.bufferedBytes(), options.row_group_bytes);
+    }
+    ASSERT_TRUE(writer.close());
+
+    std::string file = readFile(path);
+    ThriftValue meta = readFooter(file);
+    EXPECT_EQ(meta[3].i, 200);
+    ASSERT_EQ(meta[4].list.size(), 10u);
+
+    int64_t rows = 0;
+    for (const auto& group : meta[4].list) {
+        rows += group[3].i;
+        EXPECT_EQ(group[1].list[0][3][4].i, 2);  // GZIP
+    }
+    EXPECT_EQ(rows, 200);
+
+    // Last row group holds offsets 180..199
+    std::string page = readPage(file, meta[4].list[9][1].list[2][3]);
+    size_t pos = 0;
+    readLevels(page, pos);
+    EXPECT_EQ(readLE32(page, pos), 180u);
+    EXPECT_EQ(writer.stats().max_offset, 199);
+}
+
+TEST_F(ParquetWriterTest, WritesEmptyFile) {
+    ParquetWriter writer(ParquetWriter::Options{});
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.close());
+
+    ThriftValue meta = readFooter(readFile(path));
+    EXPECT_EQ(meta[3].i, 0);
+    EXPECT_TRUE(meta[4].list.empty());
+}
+
+TEST_F(ParquetWriterTest, AbortRemovesFile) {
+    ParquetWriter writer(ParquetWriter::Options{});
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.append(makeBatch(0, 5)));
+    writer.abort();
+    EXPECT_FALSE(writer.isOpen());
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+}
+
+TEST_F(ParquetWriterTest, FailsOnUnwritablePath) {
+    ParquetWriter writer(ParquetWriter::Options{});
+    EXPECT_FALSE(writer.open("/nonexistent-dir/file.parquet"));
+    EXPECT_FALSE(writer.append(makeBatch(0, 1)));
+}
+
+TEST(ParquetWriterCodecTest, ParsesCodecNames) {
+    EXPECT_EQ(ParquetWriter::parseCodec("none"), ParquetWriter::Codec::UNCOMPRESSED);
+    EXPECT_EQ(ParquetWriter::parseCodec("uncompressed"), ParquetWriter::Codec::UNCOMPRESSED);
+    EXPECT_EQ(ParquetWriter::parseCodec("gzip"), ParquetWriter::Codec::GZIP);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "ingester/partition_key.hpp"
+#include "opentelemetry/proto/collector/logs/v1/logs_service.pb.h"
+#include <google/protobuf/util/json_util.h>
+
+using opentelemetry::proto::collector::logs::v1::ExportLogsServiceRequest;
+
+namespace {
+
+ExportLogsServiceRequest buildRequest(const std::string& service, const std::string& host) {
+    ExportLogsServiceRequest request;
+    auto* resource_logs = request.add_resource_logs();
+    auto* resource = resource_logs->mutable_resource();
+    auto* attr = resource->add_attributes();
+    attr->set_key("host.name");
+    attr->mutable_value()->set_string_value(host);
+    attr = resource->add_attributes();
+    attr->set_key("service.name");
+    attr->mutable_value()->set_string_value(service);
+    resource_logs->add_scope_logs()->add_log_records()->mutable_body()->set_string_value("hello");
+
+    // Later resources do not affect the key
+    auto* other = request.add_resource_logs()->mutable_resource()->add_attributes();
+    other->set_key("service.name");
+    other->mutable_value()->set_string_value("other");
+    return request;
+}
+
+std::string toProtobuf(const ExportLogsServiceRequest& request) {
+    std::string out;
+    EXPECT_TRUE(request.SerializeToString(&out));
+    return out;
+}
+
+std::string toJson(const ExportLogsServiceRequest& request) {
+    std::string out;
+    EXPECT_TRUE(google::protobuf::util::MessageToJsonString(request, &out).ok());
+    return out;
+}
+
+}  // namespace
+
+TEST(PartitionKeyTest, ParsesSpec) {
+    EXPECT_EQ(PartitionKeyExtractor("").mode(), PartitionKeyMode::NONE);
+    EXPECT_EQ(PartitionKeyExtractor("none").mode(), PartitionKeyMode::NONE);
+    EXPECT_EQ(PartitionKeyExtractor("service.name").mode(), PartitionKeyMode::SERVICE_NAME);
+    EXPECT_EQ(PartitionKeyExtractor("resource").mode(), PartitionKeyMode::RESOURCE_HASH);
+    EXPECT_EQ(PartitionKeyExtractor("header:").mode(), PartitionKeyMode::NONE);
+
+    PartitionKeyExtractor header("header:X-Scope-OrgID");
+    EXPECT_EQ(header.mode(), PartitionKeyMode::HEADER);
+    EXPECT_EQ(header.headerName(), "X-Scope-OrgID");
+    EXPECT_EQ(header.extract("application/x-protobuf", "", "tenant-a"), "tenant-a");
+    EXPECT_FALSE(PartitionKeyExtractor().enabled());
+}
+
+TEST(PartitionKeyTest, ServiceNameFromProtobuf) {
+    std::string payload = toProtobuf(buildRequest("checkout", "host-1"));
+    EXPECT_EQ(PartitionKeyExtractor::protobufServiceName(payload), "checkout");
+
+    PartitionKeyExtractor extractor("service.name");
+    EXPECT_EQ(extractor.extract("application/x-protobuf", payload), "checkout");
+
+    // No service.name, truncated and garbage input leave the record unkeyed
+    ExportLogsServiceRequest anonymous;
+    anonymous.add_resource_logs()->mutable_resource()->add_attributes()->set_key("host.name");
+    EXPECT_EQ(PartitionKeyExtractor::protobufServiceName(toProtobuf(anonymous)), "");
+    EXPECT_EQ(PartitionKeyExtractor::protobufServiceName(payload.substr(0, payload.size() / 2)), "");
+    EXPECT_EQ(PartitionKeyExtractor::protobufServiceName("\xff\xff\xff"), "");
+    EXPECT_EQ(PartitionKeyExtractor::protobufServiceName(""), "");
+}
+
+TEST(PartitionKeyTest, ServiceNameFromJson) {
+    std::string payload = toJson(buildRequest("checkout", "host-1"));
+    EXPECT_EQ(PartitionKeyExtractor::jsonServiceName(payload), "checkout");
+
+    // Members in any order and with whitespace
+    const std::string reordered = R"({"resourceLogs": [{"resource": {"attributes": [
+        {"value": {"stringValue" : "payments"}, "key": "service.name"}]}}]})";
+    EXPECT_EQ(PartitionKeyExtractor::jsonServiceName(reordered), "payments");
+
+    PartitionKeyExtractor extractor("service.name");
+    EXPECT_EQ(extractor.extract("application/json", payload), "checkout");
+    EXPECT_EQ(extractor.extract("text/json", reordered), "payments");
+
+    EXPECT_EQ(PartitionKeyExtractor::jsonServiceName(R"({"resourceLogs":[]})"), "");
+    EXPECT_EQ(PartitionKeyExtractor::jsonServiceName(
+        R"({"key":"service.name","value":{"intValue":"1"}},{"key":"x","value":{"stringValue":"y"}})"), "");
+    EXPECT_EQ(PartitionKeyExtractor::jsonServiceName(R"({"key":"service.name","value":{"stringValue":"unterminated)"), "");
+}
+
+TEST(PartitionKeyTest, ResourceHash) {
+    std::string a = toProtobuf(buildRequest("checkout", "host-1"));
+    std::string a_again = toProtobuf(buildRequest("checkout", "host-1"));
+    std::string b = toProtobuf(buildRequest("checkout", "host-2"));
+
+    uint64_t hash_a = PartitionKeyExtractor::protobufResourceHash(a);
+    EXPECT_NE(hash_a, 0u);
+    EXPECT_EQ(hash_a, PartitionKeyExtractor::protobufResourceHash(a_again));
+    EXPECT_NE(hash_a, PartitionKeyExtractor::protobufResourceHash(b));
+    EXPECT_EQ(PartitionKeyExtractor::protobufResourceHash(""), 0u);
+
+    std::string json_a = toJson(buildRequest("checkout", "host-1"));
+    std::string json_b = toJson(buildRequest("checkout", "host-2"));
+    uint64_t json_hash_a = PartitionKeyExtractor::jsonResourceHash(json_a);
+    EXPECT_NE(json_hash_a, 0u);
+    EXPECT_NE(json_hash_a, PartitionKeyExtractor::jsonResourceHash(json_b));
+    EXPECT_EQ(PartitionKeyExtractor::jsonResourceHash(R"({"resourceLogs":[{"scopeLogs":[]}]})"), 0u);
+    EXPECT_EQ(PartitionKeyExtractor::jsonResourceHash(R"({"resource":{"attributes":[)"), 0u);
+
+    PartitionKeyExtractor extractor("resource");
+    std::string key = extractor.extract("application/x-protobuf", a);
+    EXPECT_EQ(key.size(), 16u);
+    EXPECT_EQ(key, extractor.extract("application/x-protobuf", a_again));
+    EXPECT_EQ(extractor.extract("application/x-protobuf", ""), "");
+}
@@ -6,6 +6,9 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
 
 using duckdb::DuckDB;
 using duckdb::Connection;
@@ -99,7 +102,7 @@ TEST_F(PartitionWorkerTest, EnqueueIncreasesBufferStats) {
 
     // Enqueue a message
     PartitionMessage msg;
-    msg.records.push_back(createTestRecord(100));
+    msg.batch.append(createTestRecord(100));
     msg.max_offset = 100;
     worker.enqueue(std::move(msg));
 
@@ -129,7 +132,7 @@ TEST_F(PartitionWorkerTest, MultipleMessagesAccumulate) {
     // Enqueue multiple messages
     for (int i = 0; i < 5; ++i) {
         PartitionMessage msg;
-        msg.records.push_back(createTestRecord(i));
+        msg.batch.append(createTestRecord(i));
         msg.max_offset = i;
         worker.enqueue(std::move(msg));
     }
@@ -159,7 +162,7 @@ TEST_F(PartitionWorkerTest, BatchRecordsInSingleMessage) {
     // Enqueue a batch of records in one message
     PartitionMessage msg;
     for (int i = 0; i < 10; ++i) {
-        msg.records.push_back(createTestRecord(i));
+        msg.batch.append(createTestRecord(i));
     }
     msg.max_offset = 9;
     worker.enqueue(std::move(msg));
@@ -187,7 +190,7 @@ TEST_F(PartitionWorkerTest, GracefulStopWithData) {
 
     // Add some data
     PartitionMessage msg;
-    msg.records.push_back(createTestRecord(100));
+    msg.batch.append(createTestRecord(100));
     msg.max_offset = 100;
     worker.enqueue(std::move(msg));
 
@@ -270,7 +273,7 @@ TEST_F(PartitionWorkerTest, ForceFlush) {
 
     // Add some data
     PartitionMessage msg;
-    msg.records.push_back(createTestRecord(100));
+    msg.batch.append(createTestRecord(100));
     msg.max_offset = 100;
     worker.enqueue(std::move(msg));
 
@@ -309,7 +312,7 @@ TEST_F(PartitionWorkerTest, ConcurrentEnqueue) {
         threads.emplace_back([&worker, t, messages_per_thread, this]() {
             for (int i = 0; i < messages_per_thread; ++i) {
                 PartitionMessage msg;
-                msg.records.push_back(createTestRecord(t * 100 + i));
+                msg.batch.append(createTestRecord(t * 100 + i));
                 msg.max_offset = t * 100 + i;
                 worker.enqueue(std::move(msg));
             }
@@ -358,3 +361,472 @@ TEST_F(PartitionWorkerTest, EmptyMessageHandling) {
     worker.signalStop();
     worker.waitForStop(5);
 }
+
+// Test sealed buffers flush to the target table and commit offsets in order
+TEST_F(PartitionWorkerTest, SealedBuffersCommitOffsetsInOrder) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+
+    // A local table with the buffer schema stands in for the Iceberg table
+    Connection conn(*db_);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "flush_target"));
+
+    std::mutex offsets_mutex;
+    std::vector<int64_t> committed;
+
+    PartitionWorker worker(
+        9,
+        *db_,
+        config_,
+        "local_buffer_flush_target",
+        [&](int32_t, int64_t offset) {
+            std::lock_guard<std::mutex> lock(offsets_mutex);
+            committed.push_back(offset);
+        }
+    );
+
+    worker.start();
+
+    for (int64_t offset : {10, 20, 30}) {
+        PartitionMessage msg;
+        msg.batch.append(createTestRecord(offset));
+        msg.max_offset = offset;
+        worker.enqueue(std::move(msg));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        EXPECT_TRUE(worker.forceFlush());
+    }
+
+    EXPECT_EQ(worker.getLastCommittedOffset(), 30);
+    EXPECT_EQ(worker.getBufferRecordCount(), 0u);
+    EXPECT_EQ(worker.getPendingFlushCount(), 0u);
+    {
+        std::lock_guard<std::mutex> lock(offsets_mutex);
+        EXPECT_EQ(committed, (std::vector<int64_t>{10, 20, 30}));
+    }
+
+    auto result = conn.Query("SELECT COUNT(*) FROM local_buffer_flush_target");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    EXPECT_EQ(result->GetValue(0, 0).GetValue<int64_t>(), 3);
+
+    worker.signalStop();
+    EXPECT_TRUE(worker.waitForStop(5));
+}
+
+// Test the Parquet sink: buffer files are scanned into the target table and deleted
+TEST_F(PartitionWorkerTest, ParquetSinkFlushesDataFiles) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+    config_.buffer_sink = "parquet";
+    config_.parquet_staging_dir = "/tmp/partition_worker_test_parquet";
+
+    Connection conn(*db_);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "parquet_target"));
+
+    std::atomic<int64_t> committed_offset{-1};
+    PartitionWorker worker(
+        13,
+        *db_,
+        config_,
+        "local_buffer_parquet_target",
+        [&committed_offset](int32_t, int64_t offset) { committed_offset = offset; }
+    );
+
+    worker.start();
+
+    for (int64_t offset : {5, 6}) {
+        PartitionMessage msg;
+        msg.batch.append(createTestRecord(offset));
+        msg.max_offset = offset;
+        worker.enqueue(std::move(msg));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(worker.forceFlush());
+    EXPECT_EQ(committed_offset.load(), 6);
+
+    auto result = conn.Query("SELECT COUNT(*), MAX(_kafka_offset), MAX(cardinality(attributes)), "
+                             "MAX(service_name) FROM local_buffer_parquet_target");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    EXPECT_EQ(result->GetValue(0, 0).GetValue<int64_t>(), 2);
+    EXPECT_EQ(result->GetValue(1, 0).GetValue<int64_t>(), 6);
+    EXPECT_EQ(result->GetValue(2, 0).GetValue<int64_t>(), 1);
+    EXPECT_EQ(result->GetValue(3, 0).ToString(), "test-service");
+
+    worker.signalStop();
+    EXPECT_TRUE(worker.waitForStop(5));
+
+    // Flushed and active buffer files are gone
+    result = conn.Query("SELECT COUNT(*) FROM glob('/tmp/partition_worker_test_parquet/*.parquet')");
+    ASSERT_FALSE(result->HasError()) << result->GetError();
+    EXPECT_EQ(result->GetValue(0, 0).GetValue<int64_t>(), 0);
+}
+
+// Test ingestion continues into a fresh buffer while a sealed one cannot be flushed
+TEST_F(PartitionWorkerTest, IngestContinuesWhileFlushPending) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+
+    std::atomic<int> commit_count{0};
+
+    PartitionWorker worker(
+        10,
+        *db_,
+        config_,
+        "missing_table",  // Flushes fail, so the sealed buffer stays pending
+        [&commit_count](int32_t, int64_t) { commit_count++; }
+    );
+
+    worker.start();
+
+    PartitionMessage first;
+    first.batch.append(createTestRecord(1));
+    first.max_offset = 1;
+    worker.enqueue(std::move(first));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT_FALSE(worker.forceFlush());
+    EXPECT_EQ(worker.getPendingFlushCount(), 1u);
+
+    PartitionMessage second;
+    second.batch.append(createTestRecord(2));
+    second.max_offset = 2;
+    worker.enqueue(std::move(second));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // One record sealed, one in the new active buffer
+    EXPECT_EQ(worker.getBufferRecordCount(), 2u);
+    EXPECT_EQ(worker.getLastCommittedOffset(), -1);
+    EXPECT_EQ(commit_count.load(), 0);
+
+    worker.signalStop();
+    EXPECT_TRUE(worker.waitForStop(10));
+}
+
+// Test queue watermarks track enqueued and drained messages
+TEST_F(PartitionWorkerTest, QueueWatermarks) {
+    config_.partition_queue_max_messages = 4;
+    config_.partition_queue_max_mb = 64;
+    config_.partition_queue_resume_percent = 50;
+
+    PartitionWorker worker(11, *db_, config_, "test_table", nullptr);
+
+    EXPECT_FALSE(worker.isQueueFull());
+    EXPECT_TRUE(worker.isQueueDrained());
+
+    // Fill the queue before the worker starts taking messages
+    for (int i = 0; i < 4; ++i) {
+        PartitionMessage msg;
+        msg.batch.append(createTestRecord(i));
+        msg.max_offset = i;
+        worker.enqueue(std::move(msg));
+    }
+
+    EXPECT_EQ(worker.getQueuedMessages(), 4u);
+    EXPECT_GT(worker.getQueuedBytes(), 0u);
+    EXPECT_TRUE(worker.isQueueFull());
+    EXPECT_FALSE(worker.isQueueDrained());
+
+    worker.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    EXPECT_EQ(worker.getQueuedMessages(), 0u);
+    EXPECT_EQ(worker.getQueuedBytes(), 0u);
+    EXPECT_FALSE(worker.isQueueFull());
+    EXPECT_TRUE(worker.isQueueDrained());
+    EXPECT_EQ(worker.getBufferRecordCount(), 4u);
+
+    worker.signalStop();
+    EXPECT_TRUE(worker.waitForStop(5));
+}
+
+// Test messages stay queued while the active buffer is full and flushes are backlogged
+TEST_F(PartitionWorkerTest, QueueBacksUpWhenFlushesBacklogged) {
+    config_.partition_buffer_size_mb = 0;  // Every message fills the active buffer
+    config_.partition_buffer_time_seconds = 3600;
+    config_.partition_max_pending_flushes = 1;
+    config_.partition_queue_max_messages = 3;
+
+    PartitionWorker worker(
+        12,
+        *db_,
+        config_,
+        "missing_table",  // Flushes fail, so the sealed buffer stays pending
+        nullptr
+    );
+
+    worker.start();
+
+    PartitionMessage first;
+    first.batch.append(createTestRecord(1));
+    first.max_offset = 1;
+    worker.enqueue(std::move(first));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(worker.getPendingFlushCount(), 1u);
+
+    // No buffer may be sealed, so nothing more is taken off the queue
+    for (int i = 2; i <= 4; ++i) {
+        PartitionMessage msg;
+        msg.batch.append(createTestRecord(i));
+        msg.max_offset = i;
+        worker.enqueue(std::move(msg));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT_EQ(worker.getBufferRecordCount(), 1u);
+    EXPECT_EQ(worker.getQueuedMessages(), 3u);
+    EXPECT_TRUE(worker.isQueueFull());
+
+    worker.signalStop();
+    EXPECT_TRUE(worker.waitForStop(10));
+}
+
+// Test memory pressure seals early and spills DuckDB buffers past the pending flush limit
+TEST_F(PartitionWorkerTest, SpillsBufferUnderMemoryPressure) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+    config_.partition_max_pending_flushes = 1;
+    config_.parquet_staging_dir = "/tmp/partition_worker_spill_test_" + std::to_string(getpid());
+
+    PartitionWorker worker(
+        13,
+        *db_,
+        config_,
+        "missing_table",  // Flushes fail, so sealed buffers stay pending
+        nullptr
+    );
+
+    worker.start();
+
+    PartitionMessage first;
+    first.batch.append(createTestRecord(1));
+    first.max_offset = 1;
+    worker.enqueue(std::move(first));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(worker.forceFlush());
+    EXPECT_EQ(worker.getPendingFlushCount(), 1u);
+
+    PartitionMessage second;
+    second.batch.append(createTestRecord(2));
+    second.max_offset = 2;
+    worker.enqueue(std::move(second));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    size_t usage = worker.getMemoryUsage();
+    EXPECT_GT(usage, 0u);
+
+    // An early flush respects the pending limit
+    worker.requestFlush(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(worker.getPendingFlushCount(), 1u);
+    EXPECT_EQ(worker.getMemoryUsage(), usage);
+
+    // A spill moves the active buffer to disk and seals it anyway
+    worker.requestFlush(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(worker.getPendingFlushCount(), 2u);
+    EXPECT_LT(worker.getMemoryUsage(), usage);
+    EXPECT_EQ(worker.getBufferRecordCount(), 2u);
+
+    size_t spilled_files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(config_.parquet_staging_dir)) {
+        if (entry.path().extension() == ".parquet") {
+            spilled_files++;
+        }
+    }
+    EXPECT_EQ(spilled_files, 1u);
+
+    worker.signalStop();
+    EXPECT_TRUE(worker.waitForStop(10));
+    std::filesystem::remove_all(config_.parquet_staging_dir);
+}
+
+// Test a worker without a persistent buffer deletes its partition's leftover files
+TEST_F(PartitionWorkerTest, RemovesStaleStagingFiles) {
+    config_.parquet_staging_dir = "/tmp/partition_worker_stale_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(config_.parquet_staging_dir);
+
+    std::vector<std::string> stale = {
+        config_.parquet_staging_dir + "/local_buffer_17_1_1_0.parquet",
+        config_.parquet_staging_dir + "/local_buffer_17_1_1_1.parquet.tmp",
+    };
+    std::string other = config_.parquet_staging_dir + "/local_buffer_170_1_1_0.parquet";
+    for (const auto& path : stale) {
+        std::ofstream(path) << "left by a crashed run";
+    }
+    std::ofstream(other) << "another partition";
+
+    PartitionWorker worker(17, *db_, config_, "missing_table", nullptr);
+    for (const auto& path : stale) {
+        EXPECT_FALSE(std::filesystem::exists(path)) << path;
+    }
+    EXPECT_TRUE(std::filesystem::exists(other));
+
+    std::filesystem::remove_all(config_.parquet_staging_dir);
+}
+
+// Test a persistent buffer keeps unflushed data on shutdown and the next worker adopts it
+TEST_F(PartitionWorkerTest, RecoversPersistentLocalBuffers) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+    config_.buffer_db_path = "/tmp/unused.duckdb";  // The test database stands in for the file
+    config_.parquet_staging_dir = "/tmp/partition_worker_recovery_test_" + std::to_string(getpid());
+
+    {
+        PartitionWorker worker(14, *db_, config_, "missing_table", nullptr);
+        worker.start();
+        for (int64_t offset = 1; offset <= 3; ++offset) {
+            PartitionMessage msg;
+            msg.batch.append(createTestRecord(offset));
+            msg.max_offset = offset;
+            worker.enqueue(std::move(msg));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        worker.signalStop();
+        EXPECT_TRUE(worker.waitForStop(10));
+    }
+
+    // Offset 1 made it to Iceberg before the restart; 2 and 3 are flushed from disk
+    PartitionWorker next(14, *db_, config_, "missing_table", nullptr);
+    EXPECT_EQ(next.recoverLocalBuffers(1), 3);
+    EXPECT_EQ(next.getPendingFlushCount(), 1u);
+    EXPECT_EQ(next.getBufferRecordCount(), 2u);
+
+    // Other partitions' buffers are left alone
+    PartitionWorker other(4, *db_, config_, "missing_table", nullptr);
+    EXPECT_EQ(other.recoverLocalBuffers(-1), -1);
+    EXPECT_EQ(other.getPendingFlushCount(), 0u);
+
+    // New buffers do not collide with the adopted table
+    next.start();
+    PartitionMessage msg;
+    msg.batch.append(createTestRecord(4));
+    msg.max_offset = 4;
+    next.enqueue(std::move(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(next.getBufferRecordCount(), 3u);
+
+    next.signalStop();
+    EXPECT_TRUE(next.waitForStop(10));
+    std::filesystem::remove_all(config_.parquet_staging_dir);
+}
+
+// Test a spill interrupted before dropping its table is adopted once
+TEST_F(PartitionWorkerTest, RecoversInterruptedSpillOnce) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+    config_.buffer_db_path = "/tmp/unused.duckdb";  // The test database stands in for the file
+    config_.parquet_staging_dir = "/tmp/partition_worker_respill_test_" + std::to_string(getpid());
+
+    {
+        PartitionWorker worker(16, *db_, config_, "missing_table", nullptr);
+        worker.start();
+        for (int64_t offset = 2; offset <= 3; ++offset) {
+            PartitionMessage msg;
+            msg.batch.append(createTestRecord(offset));
+            msg.max_offset = offset;
+            worker.enqueue(std::move(msg));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        worker.signalStop();
+        EXPECT_TRUE(worker.waitForStop(10));
+    }
+
+    // The spilled copy was renamed into place but the table was never dropped
+    Connection conn(*db_);
+    std::string spilled = config_.parquet_staging_dir + "/local_buffer_16_1_1_0.parquet";
+    ASSERT_FALSE(conn.Query("COPY local_buffer_16_0 TO '" + spilled + "' (FORMAT PARQUET);")->HasError());
+
+    PartitionWorker next(16, *db_, config_, "missing_table", nullptr);
+    EXPECT_EQ(next.recoverLocalBuffers(1), 3);
+    EXPECT_EQ(next.getPendingFlushCount(), 1u);
+    EXPECT_EQ(next.getBufferRecordCount(), 2u);
+
+    // The file is kept and the duplicate table released
+    EXPECT_TRUE(std::filesystem::exists(spilled));
+    auto tables = conn.Query("SELECT COUNT(*) FROM duckdb_tables() WHERE table_name = 'local_buffer_16_0';");
+    EXPECT_EQ(tables->GetValue(0, 0).GetValue<int64_t>(), 0);
+
+    std::filesystem::remove_all(config_.parquet_staging_dir);
+}
+
+// Test an unreadable leftover stops recovery at the committed offset
+TEST_F(PartitionWorkerTest, UnreadableLocalBufferStopsRecovery) {
+    config_.partition_buffer_size_mb = 1000;
+    config_.partition_buffer_time_seconds = 3600;
+    config_.buffer_db_path = "/tmp/unused.duckdb";  // The test database stands in for the file
+    config_.parquet_staging_dir = "/tmp/partition_worker_unreadable_test_" + std::to_string(getpid());
+
+    {
+        PartitionWorker worker(15, *db_, config_, "missing_table", nullptr);
+        worker.start();
+        PartitionMessage msg;
+        msg.batch.append(createTestRecord(5));
+        msg.max_offset = 5;
+        worker.enqueue(std::move(msg));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        worker.signalStop();
+        EXPECT_TRUE(worker.waitForStop(10));
+    }
+
+    // Holds offsets unknown to recovery, possibly below the readable leftover's
+    std::string garbage = config_.parquet_staging_dir + "/local_buffer_15_1_1_0.parquet";
+    {
+        std::ofstream out(garbage);
+        out << "not parquet";
+    }
+
+    PartitionWorker next(15, *db_, config_, "missing_table", nullptr);
+    EXPECT_EQ(next.recoverLocalBuffers(1), 1);
+    EXPECT_EQ(next.getPendingFlushCount(), 0u);
+    EXPECT_FALSE(std::filesystem::exists(garbage));
+    EXPECT_TRUE(std::filesystem::exists(garbage + ".unreadable"));
+
+    // The readable leftover was dropped, so a later restart has nothing to adopt
+    PartitionWorker again(15, *db_, config_, "missing_table", nullptr);
+    EXPECT_EQ(again.recoverLocalBuffers(1), 1);
+    std::filesystem::remove_all(config_.parquet_staging_dir);
+}
+
+// Test recovery takes the offset from data file bounds instead of scanning
+TEST_F(PartitionWorkerTest, RecoverMaxOffsetFromFileBounds) {
+    Connection conn(*db_);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "bounds_target"));
+
+    TransformedLogRecord record = createTestRecord(123);
+    record.kafka_partition = 12;
+    ASSERT_TRUE(IcebergUtils::appendRecords(conn, "local_buffer_bounds_target", {record}));
+
+    PartitionWorker worker(12, *db_, config_, "local_buffer_bounds_target", [](int32_t, int64_t) {});
+
+    // Rows past the bounds (written since) are still found by the tail check
+    EXPECT_EQ(worker.recoverMaxOffset("test-topic", [](int32_t partition, int64_t& offset) {
+        EXPECT_EQ(partition, 12);
+        offset = 100;
+        return true;
+    }), 123);
+    EXPECT_EQ(worker.recoverMaxOffset("test-topic", [](int32_t, int64_t& offset) {
+        offset = 150;
+        return true;
+    }), 150);
+
+    // No files for the partition: nothing to recover, no scan
+    EXPECT_EQ(worker.recoverMaxOffset("test-topic", [](int32_t, int64_t& offset) {
+        offset = -1;
+        return true;
+    }), -1);
+
+    // Unusable bounds: scan
+    EXPECT_EQ(worker.recoverMaxOffset("test-topic", [](int32_t, int64_t&) { return false; }), 123);
+}
+
+// Test recovery falls back to the data table without file bounds
+TEST_F(PartitionWorkerTest, RecoverMaxOffsetFallsBackToDataTable) {
+    Connection conn(*db_);
+    ASSERT_TRUE(IcebergUtils::createBufferTable(conn, "legacy_target"));
+
+    TransformedLogRecord record = createTestRecord(123);
+    record.kafka_partition = 12;
+    ASSERT_TRUE(IcebergUtils::appendRecords(conn, "local_buffer_legacy_target", {record}));
+
+    // No REST catalog to read the manifests through
+    PartitionWorker worker(12, *db_, config_, "local_buffer_legacy_target", [](int32_t, int64_t) {});
+    EXPECT_EQ(worker.recoverMaxOffset("test-topic"), 123);
+}
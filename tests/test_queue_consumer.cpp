@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "../src/appender/queue_consumer.hpp"
+#include <librdkafka/rdkafka.h>
+
+namespace {
+
+const char* kTopic = "otel-logs";
+
+// A consumer with partitions assigned by hand; needs no broker
+cppkafka::Consumer makeConsumer() {
+    cppkafka::Configuration config = {
+        {"metadata.broker.list", "127.0.0.1:1"},
+        {"group.id", "queue_consumer_test"},
+        {"enable.auto.commit", "false"}
+    };
+    return cppkafka::Consumer(config);
+}
+
+int64_t position(cppkafka::Consumer& consumer, int32_t partition) {
+    rd_kafka_topic_partition_list_t* list = rd_kafka_topic_partition_list_new(1);
+    rd_kafka_topic_partition_list_add(list, kTopic, partition);
+    rd_kafka_position(consumer.get_handle(), list);
+    int64_t offset = list->elems[0].offset;
+    rd_kafka_topic_partition_list_destroy(list);
+    return offset;
+}
+
+}  // namespace
+
+TEST(QueueConsumerTest, SeeksOnlyTheGivenPartition) {
+    cppkafka::Consumer consumer = makeConsumer();
+    consumer.assign({cppkafka::TopicPartition(kTopic, 0, 10), cppkafka::TopicPartition(kTopic, 1, 20)});
+    consumer.pause_partitions({cppkafka::TopicPartition(kTopic, 1)});
+
+    EXPECT_TRUE(QueueConsumer::seekPartition(consumer, kTopic, 0, 42));
+
+    // The other partition is neither re-assigned nor moved
+    cppkafka::TopicPartitionList assignment = consumer.get_assignment();
+    ASSERT_EQ(assignment.size(), 2u);
+    EXPECT_EQ(position(consumer, 1), RD_KAFKA_OFFSET_INVALID);
+
+    // Partitions that are not assigned cannot be sought
+    EXPECT_FALSE(QueueConsumer::seekPartition(consumer, kTopic, 2, 5));
+    EXPECT_EQ(consumer.get_assignment().size(), 2u);
+}
+
+TEST(QueueConsumerTest, AppliesStartOffsetsToAssignment) {
+    cppkafka::TopicPartitionList partitions = {
+        cppkafka::TopicPartition(kTopic, 0),
+        cppkafka::TopicPartition(kTopic, 1),
+    };
+
+    QueueConsumer::applyStartOffsets(partitions, {{1, 101}, {7, 5}});
+
+    // Partition 0 still starts from its committed offset
+    EXPECT_EQ(partitions[0].get_offset(), RD_KAFKA_OFFSET_INVALID);
+    EXPECT_EQ(partitions[1].get_offset(), 101);
+    EXPECT_EQ(partitions.size(), 2u);
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "ingester/request_batcher.hpp"
+#include "telemetry_wrapper.pb.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using telemetry::v1::RawTelemetryBatch;
+
+// Collects flushed batches, parsed back into RawTelemetryBatch
+class RequestBatcherTest : public ::testing::Test {
+protected:
+    RequestBatcher::FlushFunction collector() {
+        return [this](std::unique_ptr<RequestBatch> batch) {
+            RawTelemetryBatch parsed;
+            EXPECT_TRUE(parsed.ParseFromArray(batch->data, static_cast<int>(batch->size)));
+            EXPECT_EQ(static_cast<size_t>(parsed.messages_size()), batch->count);
+            batch->complete(true);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            flushed_.push_back(std::move(parsed));
+        };
+    }
+
+    std::vector<RawTelemetryBatch> flushed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return flushed_;
+    }
+
+    bool addJson(RequestBatcher& batcher, const std::string& payload, DeliveryCallback callback = nullptr) {
+        return batcher.add("application/json", telemetry::v1::OTEL_LOGS, payload, "", std::move(callback));
+    }
+
+    std::mutex mutex_;
+    std::vector<RawTelemetryBatch> flushed_;
+};
+
+TEST_F(RequestBatcherTest, FlushesAfterLinger) {
+    RequestBatcher batcher(1 << 20, 100, std::chrono::milliseconds(20), collector());
+    batcher.start();
+
+    ASSERT_TRUE(addJson(batcher, "{\"a\":1}"));
+    ASSERT_TRUE(batcher.add("application/x-protobuf", telemetry::v1::OTEL_LOGS, "\x0a\x00", "gzip"));
+    EXPECT_TRUE(flushed().empty());
+    EXPECT_GT(batcher.getPendingBytes(), 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto batches = flushed();
+    ASSERT_EQ(batches.size(), 1u);
+    ASSERT_EQ(batches[0].messages_size(), 2);
+    EXPECT_EQ(batches[0].messages(0).content_type(), "application/json");
+    EXPECT_EQ(batches[0].messages(0).payload(), "{\"a\":1}");
+    EXPECT_EQ(batches[0].messages(1).content_type(), "application/x-protobuf");
+    EXPECT_EQ(batches[0].messages(1).content_encoding(), "gzip");
+    EXPECT_EQ(batches[0].messages(1).telemetry_type(), telemetry::v1::OTEL_LOGS);
+    EXPECT_EQ(batcher.getPendingBytes(), 0u);
+
+    batcher.stop();
+}
+
+TEST_F(RequestBatcherTest, FlushesAtMessageLimit) {
+    RequestBatcher batcher(1 << 20, 3, std::chrono::hours(1), collector());
+    batcher.start();
+
+    for (int i = 0; i < 7; ++i) {
+        ASSERT_TRUE(addJson(batcher, "payload-" + std::to_string(i)));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Two full batches; the seventh request waits for linger or stop
+    auto batches = flushed();
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_EQ(batches[1].messages(2).payload(), "payload-5");
+
+    batcher.stop();
+    batches = flushed();
+    ASSERT_EQ(batches.size(), 3u);
+    ASSERT_EQ(batches[2].messages_size(), 1);
+    EXPECT_EQ(batches[2].messages(0).payload(), "payload-6");
+}
+
+TEST_F(RequestBatcherTest, FlushesAtByteLimit) {
+    RequestBatcher batcher(1000, 100, std::chrono::hours(1), collector());
+    batcher.start();
+
+    const std::string payload(300, 'x');
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(addJson(batcher, payload));
+    }
+    batcher.stop();
+
+    // Three ~320 byte entries fit in 1000 bytes, the fourth starts a new batch
+    auto batches = flushed();
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_EQ(batches[0].messages_size(), 3);
+    EXPECT_EQ(batches[1].messages_size(), 1);
+    EXPECT_LE(batches[0].ByteSizeLong(), 1000u);
+}
+
+TEST_F(RequestBatcherTest, RejectsOversizedAndStoppedRequests) {
+    RequestBatcher batcher(100, 100, std::chrono::milliseconds(10), collector());
+
+    // Not started yet
+    EXPECT_FALSE(addJson(batcher, "small"));
+
+    batcher.start();
+    EXPECT_FALSE(addJson(batcher, std::string(200, 'x')));
+    EXPECT_TRUE(addJson(batcher, "small"));
+    batcher.stop();
+
+    EXPECT_FALSE(addJson(batcher, "small"));
+    EXPECT_EQ(flushed().size(), 1u);
+}
+
+TEST_F(RequestBatcherTest, KeepsKeysApart) {
+    std::mutex mutex;
+    std::vector<std::pair<std::string, std::string>> flushed;  // key, payloads
+    RequestBatcher batcher(1 << 20, 100, std::chrono::milliseconds(20),
+        [&](std::unique_ptr<RequestBatch> batch) {
+            RawTelemetryBatch parsed;
+            ASSERT_TRUE(parsed.ParseFromArray(batch->data, static_cast<int>(batch->size)));
+            std::string payloads;
+            for (const auto& message : parsed.messages()) {
+                payloads += message.payload();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            flushed.emplace_back(batch->key, payloads);
+        });
+    batcher.start();
+
+    const char* keys[] = {"checkout", "payments", "", "checkout", "payments", ""};
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(batcher.add("application/json", telemetry::v1::OTEL_LOGS,
+                                std::to_string(i), "", nullptr, keys[i]));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // One batch per key, each flushed by its own linger deadline
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(flushed.size(), 3u);
+    std::sort(flushed.begin(), flushed.end());
+    EXPECT_EQ(flushed[0], std::make_pair(std::string(), std::string("25")));
+    EXPECT_EQ(flushed[1], std::make_pair(std::string("checkout"), std::string("03")));
+    EXPECT_EQ(flushed[2], std::make_pair(std::string("payments"), std::string("14")));
+    EXPECT_EQ(batcher.getPendingBytes(), 0u);
+}
+
+TEST_F(RequestBatcherTest, CallbacksRunOncePerRequest) {
+    std::atomic<int> delivered{0};
+    std::atomic<int> failed{0};
+    auto callback = [&](bool ok) { (ok ? delivered : failed)++; };
+
+    RequestBatcher batcher(1 << 20, 2, std::chrono::hours(1), collector());
+    batcher.start();
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(addJson(batcher, "x", callback));
+    }
+    batcher.stop();
+    EXPECT_EQ(delivered.load(), 4);
+    EXPECT_EQ(failed.load(), 0);
+
+    // A flush function that drops the batch reports its requests as failed
+    RequestBatcher dropping(1 << 20, 2, std::chrono::hours(1), [](std::unique_ptr<RequestBatch>) {});
+    dropping.start();
+    ASSERT_TRUE(dropping.add("application/json", telemetry::v1::OTEL_LOGS, "x", "", callback));
+    ASSERT_TRUE(dropping.add("application/json", telemetry::v1::OTEL_LOGS, "y", "", callback));
+    dropping.stop();
+    EXPECT_EQ(failed.load(), 2);
+}
+
+TEST_F(RequestBatcherTest, ConcurrentAdds) {
+    RequestBatcher batcher(4096, 50, std::chrono::milliseconds(5), collector());
+    batcher.start();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&batcher, this, t]() {
+            for (int i = 0; i < 250; ++i) {
+                EXPECT_TRUE(addJson(batcher, std::to_string(t) + ":" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    batcher.stop();
+
+    size_t total = 0;
+    for (const auto& batch : flushed()) {
+        total += batch.messages_size();
+        EXPECT_LE(batch.ByteSizeLong(), 4096u);
+    }
+    EXPECT_EQ(total, 1000u);
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "ingester/spill_log.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class SpillLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/spill_log_test_XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir_);
+    }
+
+    SpillLog::Options options(size_t segment_bytes = 4096, size_t max_bytes = 1 << 20) {
+        SpillLog::Options opts;
+        opts.directory = dir_;
+        opts.segment_bytes = segment_bytes;
+        opts.max_bytes = max_bytes;
+        opts.fsync = SpillLog::FsyncPolicy::NONE;
+        return opts;
+    }
+
+    size_t segmentFiles() const {
+        size_t count = 0;
+        for (const auto& entry : fs::directory_iterator(dir_)) {
+            if (entry.path().extension() == ".log") {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    std::vector<std::string> readAll(SpillLog& log, size_t max = 1000) {
+        std::vector<SpillLog::Record> records;
+        log.peek(max, records);
+        std::vector<std::string> out;
+        for (const auto& record : records) {
+            out.push_back(std::string(record.key) + "=" + std::string(record.data));
+        }
+        return out;
+    }
+
+    std::string dir_;
+};
+
+TEST_F(SpillLogTest, AppendPeekConsumeInOrder) {
+    SpillLog log(options());
+    ASSERT_TRUE(log.open());
+    EXPECT_TRUE(log.empty());
+
+    ASSERT_TRUE(log.append("svc-a", "one"));
+    ASSERT_TRUE(log.append("", "two"));
+    ASSERT_TRUE(log.append("svc-b", "three"));
+    EXPECT_EQ(log.size(), 3u);
+
+    // Peeking does not consume
+    EXPECT_EQ(readAll(log, 2), (std::vector<std::string>{"svc-a=one", "=two"}));
+    EXPECT_EQ(readAll(log).size(), 3u);
+
+    log.consume(2);
+    EXPECT_EQ(readAll(log), (std::vector<std::string>{"svc-b=three"}));
+    log.consume(1);
+    EXPECT_TRUE(log.empty());
+    EXPECT_EQ(segmentFiles(), 0u);
+
+    auto stats = log.getStats();
+    EXPECT_EQ(stats.appended_total, 3u);
+    EXPECT_EQ(stats.consumed_total, 3u);
+    EXPECT_EQ(stats.pending_bytes, 0u);
+    EXPECT_EQ(stats.disk_bytes, 0u);
+
+    EXPECT_FALSE(log.append("k", ""));
+}
+
+TEST_F(SpillLogTest, RollsSegmentsAndDeletesDrainedOnes) {
+    SpillLog log(options(1024));
+    ASSERT_TRUE(log.open());
+
+    const std::string payload(300, 'x');
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(log.append(std::to_string(i), payload));
+    }
+    // Three ~313 byte records per 1KB segment
+    EXPECT_EQ(segmentFiles(), 4u);
+    EXPECT_EQ(log.getStats().segments, 4u);
+
+    log.consume(4);
+    EXPECT_EQ(segmentFiles(), 3u);
+    std::vector<SpillLog::Record> records;
+    ASSERT_EQ(log.peek(1, records), 1u);
+    EXPECT_EQ(records[0].key, "4");
+
+    // Records larger than a segment get a segment of their own
+    ASSERT_TRUE(log.append("big", std::string(5000, 'y')));
+    EXPECT_EQ(log.size(), 7u);
+}
+
+TEST_F(SpillLogTest, BoundsDiskUsage) {
+    SpillLog log(options(1024, 2048));
+    ASSERT_TRUE(log.open());
+
+    const std::string payload(300, 'x');
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(log.append("", payload));
+    }
+    EXPECT_FALSE(log.append("", payload));
+    EXPECT_TRUE(log.isFull());
+    EXPECT_EQ(log.getStats().rejected_total, 1u);
+    EXPECT_LE(log.getStats().disk_bytes, 2048u);
+
+    // Draining a segment makes room again
+    log.consume(3);
+    EXPECT_FALSE(log.isFull());
+    EXPECT_TRUE(log.append("", payload));
+}
+
+TEST_F(SpillLogTest, RecoversAfterReopen) {
+    {
+        SpillLog log(options(1024));
+        ASSERT_TRUE(log.open());
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(log.append("k" + std::to_string(i), "record-" + std::to_string(i)));
+        }
+        log.consume(1);
+    }
+
+    SpillLog log(options(1024));
+    ASSERT_TRUE(log.open());
+    // The consumed record is not replayed
+    auto records = readAll(log);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(log.size(), 4u);
+    EXPECT_EQ(records.front(), "k1=record-1");
+    EXPECT_EQ(records.back(), "k4=record-4");
+
+    // New records go after the recovered ones
+    ASSERT_TRUE(log.append("k5", "record-5"));
+    records = readAll(log);
+    ASSERT_EQ(records.size(), 5u);
+    EXPECT_EQ(records.back(), "k5=record-5");
+}
+
+TEST_F(SpillLogTest, RecoveryStopsAtTornRecord) {
+    std::string path;
+    {
+        SpillLog log(options(4096));
+        ASSERT_TRUE(log.open());
+        ASSERT_TRUE(log.append("a", "first"));
+        ASSERT_TRUE(log.append("b", "second"));
+        for (const auto& entry : fs::directory_iterator(dir_)) {
+            path = entry.path().string();
+        }
+    }
+
+    // Corrupt a byte of the second record's body
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(12 + 1 + 5 + 12 + 1 + 2);
+        file.put('X');
+    }
+
+    SpillLog log(options(4096));
+    ASSERT_TRUE(log.open());
+    EXPECT_EQ(readAll(log), (std::vector<std::string>{"a=first"}));
+
+    // The torn record is overwritten by the next append
+    ASSERT_TRUE(log.append("c", "third"));
+    EXPECT_EQ(readAll(log), (std::vector<std::string>{"a=first", "c=third"}));
+}
+
+TEST_F(SpillLogTest, SyncPolicies) {
+    EXPECT_EQ(SpillLog::parseFsyncPolicy("none"), SpillLog::FsyncPolicy::NONE);
+    EXPECT_EQ(SpillLog::parseFsyncPolicy("always"), SpillLog::FsyncPolicy::ALWAYS);
+    EXPECT_EQ(SpillLog::parseFsyncPolicy("interval"), SpillLog::FsyncPolicy::INTERVAL);
+    EXPECT_EQ(SpillLog::parseFsyncPolicy("bogus"), SpillLog::FsyncPolicy::INTERVAL);
+
+    for (auto policy : {SpillLog::FsyncPolicy::ALWAYS, SpillLog::FsyncPolicy::INTERVAL}) {
+        auto opts = options();
+        opts.fsync = policy;
+        opts.fsync_interval = std::chrono::milliseconds(5);
+        SpillLog log(opts);
+        ASSERT_TRUE(log.open());
+        EXPECT_EQ(log.syncsEveryAppend(), policy == SpillLog::FsyncPolicy::ALWAYS);
+        for (int i = 0; i < 20; ++i) {
+            ASSERT_TRUE(log.append("", "payload-" + std::to_string(i)));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        log.close();
+
+        SpillLog reopened(opts);
+        ASSERT_TRUE(reopened.open());
+        EXPECT_EQ(reopened.size(), 20u);
+        reopened.consume(20);
+    }
+}
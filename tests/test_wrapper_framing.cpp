@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "ingester/wrapper_framing.hpp"
+#include "telemetry_wrapper.pb.h"
+#include <cstdlib>
+#include <string>
+
+using telemetry::v1::RawTelemetryMessage;
+
+namespace {
+
+std::string serialize(const std::string& content_type,
+                      telemetry::v1::TelemetryType telemetry_type,
+                      const std::string& payload,
+                      const std::string& content_encoding = "") {
+    RawTelemetryMessage message;
+    message.set_content_type(content_type);
+    message.set_telemetry_type(telemetry_type);
+    message.set_payload(payload);
+    message.set_content_encoding(content_encoding);
+    return message.SerializeAsString();
+}
+
+std::string frame(const std::string& content_type,
+                  telemetry::v1::TelemetryType telemetry_type,
+                  const std::string& payload,
+                  const std::string& content_encoding = "") {
+    size_t size = 0;
+    char* buffer = WrapperFraming::frame(content_type, telemetry_type, payload, content_encoding, size);
+    EXPECT_NE(buffer, nullptr);
+    EXPECT_EQ(size, WrapperFraming::framedSize(content_type, telemetry_type, payload.size(), content_encoding));
+    std::string framed(buffer, size);
+    std::free(buffer);
+    return framed;
+}
+
+}  // namespace
+
+TEST(WrapperFramingTest, MatchesGeneratedSerializer) {
+    const std::string payload("\x0a\x00\xff payload", 11);
+    EXPECT_EQ(frame("application/x-protobuf", telemetry::v1::OTEL_LOGS, payload),
+              serialize("application/x-protobuf", telemetry::v1::OTEL_LOGS, payload));
+}
+
+TEST(WrapperFramingTest, ContentEncoding) {
+    const std::string payload("\x1f\x8b\x08 compressed", 13);
+    std::string framed = frame("application/json", telemetry::v1::OTEL_LOGS, payload, "gzip");
+    EXPECT_EQ(framed, serialize("application/json", telemetry::v1::OTEL_LOGS, payload, "gzip"));
+
+    RawTelemetryMessage parsed;
+    ASSERT_TRUE(parsed.ParseFromString(framed));
+    EXPECT_EQ(parsed.content_encoding(), "gzip");
+    EXPECT_EQ(parsed.payload(), payload);
+}
+
+TEST(WrapperFramingTest, OmitsDefaultFields) {
+    EXPECT_EQ(frame("", telemetry::v1::TELEMETRY_TYPE_UNSPECIFIED, ""),
+              serialize("", telemetry::v1::TELEMETRY_TYPE_UNSPECIFIED, ""));
+    EXPECT_EQ(frame("application/json", telemetry::v1::OTEL_LOGS, ""),
+              serialize("application/json", telemetry::v1::OTEL_LOGS, ""));
+    EXPECT_EQ(frame("", telemetry::v1::TELEMETRY_TYPE_UNSPECIFIED, "x"),
+              serialize("", telemetry::v1::TELEMETRY_TYPE_UNSPECIFIED, "x"));
+}
+
+TEST(WrapperFramingTest, MultiByteLengthPrefixes) {
+    // Lengths that need 1, 2 and 3 byte varints
+    for (size_t size : {127u, 128u, 16383u, 16384u, 1u << 20}) {
+        std::string payload(size, 'p');
+        std::string framed = frame("application/x-protobuf", telemetry::v1::OTEL_LOGS, payload);
+        EXPECT_EQ(framed, serialize("application/x-protobuf", telemetry::v1::OTEL_LOGS, payload)) << size;
+
+        RawTelemetryMessage parsed;
+        ASSERT_TRUE(parsed.ParseFromString(framed));
+        EXPECT_EQ(parsed.payload().size(), size);
+    }
+}